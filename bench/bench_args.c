@@ -0,0 +1,138 @@
+/**
+ * @file bench/bench_args.c
+ * @brief Typed argument parsing cost
+ *
+ * Times aud_args_parse() on one schema per argument type, next to the libc
+ * conversion a handler would otherwise call (strtol()/strtod() on a
+ * terminated copy). Then times dispatch_command_slice() on the same line
+ * registered once as a slice command and once as a typed command, so the
+ * last table is the whole cost a schema adds to a dispatch. The heap in use
+ * (mallinfo2()) is compared before and after every case: parsing must not
+ * allocate.
+ */
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_command_args.h"
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "bench_common.h"
+
+#define BENCH_PARSES 2000000                         // Parses timed per case
+#define BENCH_COPY_MAX 64
+
+static volatile unsigned long handler_calls;         // Incremented by every handler call
+
+static const char *const bench_words[] = { "off", "low", "medium", "high", NULL };
+static const aud_arg_spec_t int_args[] = { AUD_ARG_INT_SPEC("id", 0, 127), AUD_ARG_INT_SPEC("percent", 0, 200) };
+static const aud_arg_spec_t float_args[] = { AUD_ARG_FLOAT_SPEC("gain", -96.0, 12.0) };
+static const aud_arg_spec_t duration_args[] = { AUD_ARG_DURATION_SPEC("at", 0, 0) };
+static const aud_arg_spec_t path_args[] = { AUD_ARG_PATH_SPEC("file") };
+static const aud_arg_spec_t enum_args[] = { AUD_ARG_ENUM_SPEC("level", bench_words) };
+
+typedef struct {
+    const char *name;
+    aud_arg_schema_t schema;
+    const char *text;                                // Argument span parsed by every iteration
+    bool floating;                                   // Baseline is strtod() rather than strtol()
+} bench_case_t;
+
+static const bench_case_t cases[] = {
+    { "int x2", { int_args, 2, "" }, "17 150", false },
+    { "float", { float_args, 1, "" }, "-12.75", true },
+    { "duration", { duration_args, 1, "" }, "12.5s", true },
+    { "path", { path_args, 1, "" }, "music/long file name.wav", false },
+    { "enum", { enum_args, 1, "" }, "high", false },
+};
+
+static void slice_handler(const aud_command_line_t *line)
+{
+    (void)line;
+    handler_calls++;
+}
+
+static size_t heap_in_use(void)
+{
+    return mallinfo2().uordblks;
+}
+
+static double time_parse(const bench_case_t *c)
+{
+    aud_slice_t text = { c->text, strlen(c->text) };
+    aud_args_t values;
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_PARSES; i++)
+    {
+        bool ok = aud_args_parse(&c->schema, text, &values, NULL);
+        BENCH_KEEP(ok);
+        BENCH_KEEP(values.v[0].i);
+    }
+    return (double)(bench_now_ns() - start) / BENCH_PARSES;
+}
+
+// What a handler pays without a schema: copy, terminate, convert the first word
+static double time_libc(const bench_case_t *c)
+{
+    size_t len = strlen(c->text);
+    char copy[BENCH_COPY_MAX];
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_PARSES; i++)
+    {
+        memcpy(copy, c->text, len);
+        copy[len] = '\0';
+        if (c->floating)
+        {
+            double value = strtod(copy, NULL);
+            BENCH_KEEP(value);
+        }
+        else
+        {
+            long value = strtol(copy, NULL, 10);
+            BENCH_KEEP(value);
+        }
+    }
+    return (double)(bench_now_ns() - start) / BENCH_PARSES;
+}
+
+static double time_dispatch(const char *line)
+{
+    size_t len = strlen(line);
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_PARSES; i++)
+    {
+        dispatch_command_slice(line, len);
+    }
+    return (double)(bench_now_ns() - start) / BENCH_PARSES;
+}
+
+int main(void)
+{
+    int leaks = 0;
+    log_set_runtime_level(LOG_SEVERITY_NONE);
+    printf("%-10s %28s %12s %12s %8s\n", "schema", "arguments", "parse ns", "libc ns", "bytes");
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        size_t before = heap_in_use();
+        double parse_ns = time_parse(&cases[c]);
+        long grown = (long)(heap_in_use() - before);
+        double libc_ns = time_libc(&cases[c]);
+        printf("%-10s %28s %12.1f %12.1f %8ld\n", cases[c].name, cases[c].text, parse_ns, libc_ns, grown);
+        leaks += (grown != 0);
+    }
+
+    // The same line through a slice handler and a typed one
+    register_command_slice("slice", slice_handler);
+    register_command_typed("typed", &cases[0].schema, slice_handler);
+    freeze_command_processor();
+    size_t before = heap_in_use();
+    double slice_ns = time_dispatch("slice 17 150");
+    double typed_ns = time_dispatch("typed 17 150");
+    long grown = (long)(heap_in_use() - before);
+    free_command_processor();
+    leaks += (grown != 0);
+
+    printf("\n%-10s %12s %12s %12s %8s\n", "dispatch", "slice ns", "typed ns", "schema ns", "bytes");
+    printf("%-10s %12.1f %12.1f %12.1f %8ld\n", "int x2", slice_ns, typed_ns, typed_ns - slice_ns, grown);
+    return leaks ? 1 : 0;
+}
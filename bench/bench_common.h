@@ -0,0 +1,104 @@
+/**
+ * @file bench/bench_common.h
+ * @brief Shared helpers for the benchmark programs
+ */
+
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief Returns the monotonic clock in nanoseconds.
+ */
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Keeps the compiler from discarding a value computed by a benchmark.
+ */
+#define BENCH_KEEP(value) __asm__ volatile("" : : "r"(value) : "memory")
+
+typedef struct {
+    const char *name;                                 // Case name (also the JSON key)
+    uint64_t ops;                                     // Operations timed, warm-up excluded
+    double mean_ns;                                   // Mean ns/op over all samples
+    double min_ns;                                    // Fastest sample
+    double p50_ns;                                    // Median sample
+    double p90_ns;
+    double p99_ns;
+    double max_ns;                                    // Slowest sample
+} bench_result_t;
+
+static int bench_compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Summarizes per-sample ns/op timings (sorts the samples in place).
+ *
+ * @param result Receives the summary; result->name is left untouched.
+ * @param samples ns/op of every sample.
+ * @param count Number of samples.
+ * @param ops_per_sample Operations timed by each sample.
+ */
+static inline void bench_summarize(bench_result_t *result, double *samples, size_t count, uint64_t ops_per_sample)
+{
+    double sum = 0.0;
+    qsort(samples, count, sizeof(double), bench_compare_double);
+    for (size_t i = 0; i < count; i++)
+    {
+        sum += samples[i];
+    }
+    result->ops = (uint64_t)count * ops_per_sample;
+    result->mean_ns = sum / (double)count;
+    result->min_ns = samples[0];
+    result->p50_ns = samples[count / 2];
+    result->p90_ns = samples[(count * 90) / 100];
+    result->p99_ns = samples[(count * 99) / 100];
+    result->max_ns = samples[count - 1];
+}
+
+/**
+ * @brief Prints results as a table.
+ */
+static inline void bench_print_table(FILE *out, const bench_result_t *results, size_t count)
+{
+    fprintf(out, "%-28s %12s %10s %10s %10s %10s %10s\n", "case", "ops", "mean", "p50", "p90", "p99", "max");
+    for (size_t i = 0; i < count; i++)
+    {
+        const bench_result_t *r = &results[i];
+        fprintf(out, "%-28s %12llu %10.1f %10.1f %10.1f %10.1f %10.1f\n", r->name, (unsigned long long)r->ops,
+                r->mean_ns, r->p50_ns, r->p90_ns, r->p99_ns, r->max_ns);
+    }
+    fprintf(out, "(ns/op)\n");
+}
+
+/**
+ * @brief Prints results as JSON, one object per case.
+ */
+static inline void bench_print_json(FILE *out, const char *suite, const bench_result_t *results, size_t count)
+{
+    fprintf(out, "{\n  \"suite\": \"%s\",\n  \"unit\": \"ns/op\",\n  \"results\": [\n", suite);
+    for (size_t i = 0; i < count; i++)
+    {
+        const bench_result_t *r = &results[i];
+        fprintf(out, "    { \"name\": \"%s\", \"ops\": %llu, \"mean\": %.2f, \"min\": %.2f, "
+                     "\"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, \"max\": %.2f }%s\n",
+                r->name, (unsigned long long)r->ops, r->mean_ns, r->min_ns, r->p50_ns, r->p90_ns,
+                r->p99_ns, r->max_ns, (i + 1 < count) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+#endif // BENCH_COMMON_H
@@ -0,0 +1,139 @@
+/**
+ * @file bench/bench_dispatch.c
+ * @brief Dispatch cost on the staged commands versus the sealed table
+ *
+ * Registers 10, 100 and 1000 synthetic commands and times dispatch_command()
+ * over all of them, first on the staged array (a linear scan) and then after
+ * freeze_command_processor() seals them into the perfect-hash table.
+ * Only sealed commands carry latency statistics, so the default build
+ * (COMMAND_STATS=0) compares the lookups alone; COMMAND_STATS=1 adds the
+ * timing cost to the sealed column.
+ *
+ * Each sealed table is also checked against lines that must not reach a
+ * handler: a leading space (an empty command name), blank lines and many
+ * unknown names, about half of which hash to empty slots. A table built with
+ * build_command_hash() (the generator's path) must install and reject the
+ * same lines, and a zero-filled table must be refused.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_command_hash.h"
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "bench_common.h"
+
+#define BENCH_MAX_COMMANDS 1000                      // Largest registry size measured
+#define BENCH_DISPATCHES 2000000                     // Dispatches timed per configuration
+#define BENCH_MISSES 100000                          // Unknown names checked per table
+
+static char command_names[BENCH_MAX_COMMANDS][16];   // Storage for the synthetic names
+static volatile unsigned long handler_calls;         // Incremented by every handler call
+
+static void bench_handler(const char *args)
+{
+    (void)args;
+    handler_calls++;
+}
+
+static double time_dispatch(int count)
+{
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_DISPATCHES; i++)
+    {
+        dispatch_command(command_names[i % count]);
+    }
+    return (double)(bench_now_ns() - start) / BENCH_DISPATCHES;
+}
+
+// Counts lines that reached a handler or were not reported unknown; every one of them is a bug
+static int check_misses(void)
+{
+    static const char *const lines[] = { " command_1", "  command_1", " ", "  ", " x y" };
+    unsigned long calls = handler_calls;
+    int wrong = 0;
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++)
+    {
+        wrong += (dispatch_command_slice(lines[i], strlen(lines[i])) != AUD_DISPATCH_UNKNOWN);
+    }
+    for (int i = 0; i < BENCH_MISSES; i++)
+    {
+        char name[24];
+        int len = snprintf(name, sizeof(name), "missing_%d", i);
+        wrong += (dispatch_command_slice(name, (size_t)len) != AUD_DISPATCH_UNKNOWN);
+    }
+    return wrong + (handler_calls != calls);
+}
+
+// A table built outside the registry, as tools/gen_command_table.c does, must reject the same lines
+static int check_installed_table(int count)
+{
+    aud_command_slot_t *entries = calloc((size_t)count, sizeof(aud_command_slot_t));
+    aud_command_hash_t table;
+    int wrong = 0;
+    if (entries == NULL)
+    {
+        return 1;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        entries[i].command_name = command_names[i];
+        entries[i].name_len = (uint32_t)strlen(command_names[i]);
+        entries[i].handler = bench_handler;
+    }
+    if (!build_command_hash(entries, (size_t)count, &table))
+    {
+        free(entries);
+        return 1;
+    }
+
+    aud_command_slot_t *zeroed = calloc(table.slot_mask + 1, sizeof(aud_command_slot_t));
+    aud_command_hash_t unmarked = table;
+    unmarked.slots = zeroed;
+    wrong += (zeroed == NULL || install_command_table(&unmarked));   // Empty slots without the sentinel
+    wrong += !install_command_table(&table);
+    unsigned long calls = handler_calls;
+    dispatch_command(command_names[0]);
+    wrong += (handler_calls != calls + 1) + check_misses();
+
+    free_command_processor();
+    free_command_hash(&table);
+    free(zeroed);
+    free(entries);
+    return wrong;
+}
+
+int main(void)
+{
+    static const int sizes[] = { 10, 100, 1000 };
+    int status = 0;
+    log_set_runtime_level(LOG_SEVERITY_NONE);
+
+    for (int i = 0; i < BENCH_MAX_COMMANDS; i++)
+    {
+        snprintf(command_names[i], sizeof(command_names[i]), "command_%d", i);
+    }
+
+    printf("%-10s %14s %14s %10s\n", "commands", "staged ns/op", "sealed ns/op", "speedup");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        int count = sizes[s];
+        for (int i = 0; i < count; i++)
+        {
+            register_command(command_names[i], bench_handler);
+        }
+
+        double staged_ns = time_dispatch(count);
+        freeze_command_processor();
+        double sealed_ns = time_dispatch(count);
+        int wrong = check_misses();
+        free_command_processor();
+        wrong += check_installed_table(count);
+
+        printf("%-10d %14.1f %14.1f %9.1fx%s\n", count, staged_ns, sealed_ns, staged_ns / sealed_ns,
+               wrong ? "  WRONG" : "");
+        status |= (wrong != 0);
+    }
+    return status;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file bench/bench_gain.c
+ * @brief Gain stage throughput per ISA variant
+ *
+ * Runs the int16 and float gain kernels for every ISA this CPU supports and
+ * reports samples/sec. Each variant is also checked against the scalar kernel
+ * on a buffer that saturates.
+ *
+ * Then times the per-frame gain ramps (linear and exponential) on stereo
+ * chunks that stay inside the ramp, next to the constant-gain kernel on the
+ * same chunks. Vector ramps advance their lanes by a composite step, which
+ * rounds differently from the per-frame recurrence, so they are checked
+ * against the scalar ramp within 1e-4 of full scale (-80 dB).
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_gain.h"
+#include "bench_common.h"
+
+#define BENCH_SAMPLES 4096                           // Samples per kernel call (one large chunk)
+#define BENCH_CALLS 20000                            // Kernel calls timed per variant
+#define BENCH_RAMP_CHANNELS 2
+#define BENCH_RAMP_FRAMES (BENCH_SAMPLES / BENCH_RAMP_CHANNELS)
+
+static int16_t s16_source[BENCH_SAMPLES];
+static int16_t s16_work[BENCH_SAMPLES];
+static int16_t s16_reference[BENCH_SAMPLES];
+static float f32_source[BENCH_SAMPLES];
+static float f32_work[BENCH_SAMPLES];
+static float f32_reference[BENCH_SAMPLES];
+
+static double time_s16(float gain)
+{
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_CALLS; i++)
+    {
+        memcpy(s16_work, s16_source, sizeof(s16_work));
+        audio_gain_apply_s16(s16_work, BENCH_SAMPLES, gain);
+    }
+    BENCH_KEEP(s16_work[0]);
+    return (double)(bench_now_ns() - start) / 1e9;
+}
+
+static double time_f32(float gain)
+{
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_CALLS; i++)
+    {
+        memcpy(f32_work, f32_source, sizeof(f32_work));
+        audio_gain_apply_f32(f32_work, BENCH_SAMPLES, gain);
+    }
+    BENCH_KEEP(f32_work[0]);
+    return (double)(bench_now_ns() - start) / 1e9;
+}
+
+static audio_pcm_chunk_t *ramp_chunk;              // BENCH_RAMP_FRAMES stereo frames
+
+// Loads the source into the chunk and applies a fresh 0.9 -> 0.05 ramp (or a constant gain when frames is 0)
+static void run_ramp(const audio_pcm_config_t *config, audio_ramp_curve_t curve, uint32_t frames)
+{
+    if (config->format == AUDIO_SAMPLE_F32)
+    {
+        memcpy(audio_pcm_samples(ramp_chunk), f32_source, sizeof(f32_source));
+    }
+    else
+    {
+        memcpy(audio_pcm_samples(ramp_chunk), s16_source, sizeof(s16_source));
+    }
+    ramp_chunk->frames = BENCH_RAMP_FRAMES;
+    audio_gain_ramp_t ramp;
+    audio_gain_ramp_set(&ramp, 0.9f);
+    audio_gain_ramp_start(&ramp, 0.05f, frames, curve);
+    audio_gain_ramp_apply_chunk(&ramp, ramp_chunk, config);
+}
+
+static double time_ramp(const audio_pcm_config_t *config, audio_ramp_curve_t curve, uint32_t frames)
+{
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_CALLS; i++)
+    {
+        run_ramp(config, curve, frames);
+    }
+    BENCH_KEEP(ramp_chunk->frames);
+    return (double)(bench_now_ns() - start) / 1e9;
+}
+
+// Largest difference from the scalar ramp, in full-scale units
+static double ramp_error(const audio_pcm_config_t *config, audio_ramp_curve_t curve, audio_isa_t isa)
+{
+    audio_gain_select_isa(AUDIO_ISA_SCALAR);
+    run_ramp(config, curve, BENCH_RAMP_FRAMES * 4);
+    memcpy(s16_reference, audio_pcm_samples(ramp_chunk), sizeof(s16_reference));
+    memcpy(f32_reference, audio_pcm_samples(ramp_chunk), sizeof(f32_reference));
+    audio_gain_select_isa(isa);
+    run_ramp(config, curve, BENCH_RAMP_FRAMES * 4);
+    double worst = 0.0;
+    for (int i = 0; i < BENCH_SAMPLES; i++)
+    {
+        double d = (config->format == AUDIO_SAMPLE_F32)
+                       ? fabs((double)((float *)audio_pcm_samples(ramp_chunk))[i] - f32_reference[i])
+                       : fabs((double)((int16_t *)audio_pcm_samples(ramp_chunk))[i] - s16_reference[i]) / 32768.0;
+        worst = (d > worst) ? d : worst;
+    }
+    return worst;
+}
+
+static int bench_ramps(audio_isa_t best)
+{
+    static const char *const curves[] = { "linear", "exp" };
+    int status = 0;
+    ramp_chunk = malloc(sizeof(audio_pcm_chunk_t) + sizeof(f32_source));
+    printf("\n%-8s %-6s %-8s %14s %10s\n", "isa", "format", "ramp", "Msamples/sec", "max error");
+    for (audio_isa_t isa = AUDIO_ISA_SCALAR; isa <= best; isa++)
+    {
+        for (int f = 0; f < 2; f++)
+        {
+            const audio_pcm_config_t config = { f ? AUDIO_SAMPLE_F32 : AUDIO_SAMPLE_S16, BENCH_RAMP_CHANNELS,
+                                                BENCH_RAMP_FRAMES, 48000 };
+            double total = (double)BENCH_SAMPLES * BENCH_CALLS / 1e6;
+            audio_gain_select_isa(isa);
+            printf("%-8s %-6s %-8s %14.1f\n", audio_isa_name(isa), f ? "f32" : "s16", "none",
+                   total / time_ramp(&config, AUDIO_RAMP_LINEAR, 0));
+            for (int c = 0; c < 2; c++)
+            {
+                const double limit = 1e-4;
+                double error = ramp_error(&config, (audio_ramp_curve_t)c, isa);
+                audio_gain_select_isa(isa);
+                double seconds = time_ramp(&config, (audio_ramp_curve_t)c, BENCH_RAMP_FRAMES * 4);
+                printf("%-8s %-6s %-8s %14.1f %10.2g%s\n", audio_isa_name(isa), f ? "f32" : "s16", curves[c],
+                       total / seconds, error, (error > limit) ? "  MISMATCH" : "");
+                status |= (error > limit);
+            }
+        }
+    }
+    free(ramp_chunk);
+    return status;
+}
+
+int main(void)
+{
+    srand(1);
+    for (int i = 0; i < BENCH_SAMPLES; i++)
+    {
+        s16_source[i] = (int16_t)(rand() % 65536 - 32768);
+        f32_source[i] = (float)s16_source[i] / 32768.0f;
+    }
+
+    // Reference results from the scalar kernel with a saturating gain
+    audio_gain_select_isa(AUDIO_ISA_SCALAR);
+    memcpy(s16_reference, s16_source, sizeof(s16_reference));
+    audio_gain_apply_s16(s16_reference, BENCH_SAMPLES, 1.7f);
+    memcpy(f32_reference, f32_source, sizeof(f32_reference));
+    audio_gain_apply_f32(f32_reference, BENCH_SAMPLES, 1.7f);
+
+    audio_isa_t best = audio_gain_detect_isa();
+    printf("%-8s %-6s %8s %14s %10s\n", "isa", "format", "gain", "Msamples/sec", "mismatch");
+    for (audio_isa_t isa = AUDIO_ISA_SCALAR; isa <= best; isa++)
+    {
+        audio_gain_select_isa(isa);
+
+        memcpy(s16_work, s16_source, sizeof(s16_work));
+        audio_gain_apply_s16(s16_work, BENCH_SAMPLES, 1.7f);
+        int s16_mismatch = memcmp(s16_work, s16_reference, sizeof(s16_work)) != 0;
+        memcpy(f32_work, f32_source, sizeof(f32_work));
+        audio_gain_apply_f32(f32_work, BENCH_SAMPLES, 1.7f);
+        int f32_mismatch = memcmp(f32_work, f32_reference, sizeof(f32_work)) != 0;
+
+        static const float gains[] = { 0.5f, 1.7f };
+        for (size_t g = 0; g < sizeof(gains) / sizeof(gains[0]); g++)
+        {
+            double s16_seconds = time_s16(gains[g]);
+            double f32_seconds = time_f32(gains[g]);
+            double total = (double)BENCH_SAMPLES * BENCH_CALLS / 1e6;
+            printf("%-8s %-6s %8.2f %14.1f %10s\n", audio_isa_name(isa), "s16", gains[g],
+                   total / s16_seconds, s16_mismatch ? "YES" : "no");
+            printf("%-8s %-6s %8.2f %14.1f %10s\n", audio_isa_name(isa), "f32", gains[g],
+                   total / f32_seconds, f32_mismatch ? "YES" : "no");
+        }
+    }
+
+    // Fast paths: unity returns immediately and mute only clears
+    double unity = time_s16(1.0f);
+    double mute = time_s16(0.0f);
+    printf("%-8s %-6s %8s %14.1f\n", "fast", "s16", "unity", (double)BENCH_SAMPLES * BENCH_CALLS / 1e6 / unity);
+    printf("%-8s %-6s %8s %14.1f\n", "fast", "s16", "mute", (double)BENCH_SAMPLES * BENCH_CALLS / 1e6 / mute);
+
+    int status = bench_ramps(best);
+    audio_gain_select_isa(best);
+    return status;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file bench/bench_journal.c
+ * @brief Command journal: append overhead and restart time
+ *
+ * Append overhead: the registered volumeSet command is dispatched with
+ * alternating values (every call changes the state, so every call is
+ * journaled) with no journal, with the default asynchronous group commit,
+ * with an immediate asynchronous sync, and durable (each command waits for
+ * its fdatasync()). Samples time 16 commands; the default snapshot interval
+ * applies, so snapshot cost shows in the tail.
+ *
+ * Restart time: a child process journals N commands without ever
+ * snapshotting and exits without closing (as a crash would), then the
+ * journal is reopened and replayed. Closing that writes a snapshot, and a
+ * second open shows the restart time with the snapshot in place.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "audio_command_processor.h"
+#include "audio_journal.h"
+#include "audio_logger.h"
+#include "bench_common.h"
+
+#define BENCH_COMMANDS 65536                         // Commands timed per asynchronous case
+#define BENCH_DURABLE_COMMANDS 1024                  // Commands timed per durable case
+#define BENCH_SAMPLE 16                              // Commands per timed sample
+
+extern void register_audio_commands(void);
+
+static char journal_path[64];
+static unsigned long volume_calls;
+
+static void remove_journal(void)
+{
+    char snapshot[80];
+    snprintf(snapshot, sizeof(snapshot), "%s.snap", journal_path);
+    unlink(journal_path);
+    unlink(snapshot);
+}
+
+// Alternates the volume so that every command is a state change
+static void dispatch_volume(void)
+{
+    static const char *const commands[] = { "volumeSet 40", "volumeSet 60" };
+    dispatch_command_slice(commands[volume_calls & 1u], 12);
+    volume_calls++;
+}
+
+static void run_append(bench_result_t *result, const char *name, bool journal, uint64_t window_ns, bool durable,
+                       size_t commands)
+{
+    size_t samples = commands / BENCH_SAMPLE;
+    double *timings = malloc(sizeof(double) * samples);
+    audio_journal_config_t config;
+    audio_journal_default_config(&config);
+    config.path = journal_path;
+    config.commit_interval_ns = window_ns;
+    config.durable = durable;
+
+    remove_journal();
+    if (journal && !audio_journal_open(&config, NULL))
+    {
+        fprintf(stderr, "cannot open %s\n", journal_path);
+        exit(1);
+    }
+    for (size_t s = 0; s < samples; s++)
+    {
+        uint64_t start = bench_now_ns();
+        for (int i = 0; i < BENCH_SAMPLE; i++)
+        {
+            dispatch_volume();
+        }
+        timings[s] = (double)(bench_now_ns() - start) / BENCH_SAMPLE;
+    }
+    audio_journal_stats_t stats = audio_journal_stats();
+    audio_journal_close();
+
+    bench_summarize(result, timings, samples, BENCH_SAMPLE);
+    result->name = name;
+    if (journal)
+    {
+        printf("  %-20s %llu records, %llu syncs, largest group %llu, %llu snapshots\n", name,
+               (unsigned long long)stats.records, (unsigned long long)stats.syncs,
+               (unsigned long long)stats.largest_group, (unsigned long long)stats.snapshots);
+    }
+    free(timings);
+}
+
+// Journals count commands in a child that exits without closing the journal
+static bool write_crashed_journal(size_t count)
+{
+    pid_t child = fork();
+    if (child == 0)
+    {
+        audio_journal_config_t config;
+        audio_journal_default_config(&config);
+        config.path = journal_path;
+        config.snapshot_every = 0;
+        if (!audio_journal_open(&config, NULL))
+        {
+            _exit(1);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            dispatch_volume();
+        }
+        _exit(0);                                    // No close: no snapshot, journal left as after a crash
+    }
+    int status = 0;
+    return child > 0 && waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static double open_and_close(audio_journal_recovery_t *recovery)
+{
+    audio_journal_config_t config;
+    audio_journal_default_config(&config);
+    config.path = journal_path;
+    if (!audio_journal_open(&config, recovery))
+    {
+        return -1.0;
+    }
+    audio_journal_close();
+    return recovery->seconds * 1e3;
+}
+
+int main(void)
+{
+    static const size_t lengths[] = { 1000, 10000, 100000, 1000000 };
+    bench_result_t results[4];
+
+    log_set_runtime_level(LOG_SEVERITY_NONE);
+    register_audio_commands();
+    freeze_command_processor();
+    snprintf(journal_path, sizeof(journal_path), "/tmp/bench_journal_%d.aj", (int)getpid());
+
+    printf("Append overhead per journaled command:\n");
+    run_append(&results[0], "no journal", false, 0, false, BENCH_COMMANDS);
+    run_append(&results[1], "async, 2 ms window", true, AUDIO_JOURNAL_COMMIT_NS, false, BENCH_COMMANDS);
+    run_append(&results[2], "async, no window", true, 0, false, BENCH_COMMANDS);
+    run_append(&results[3], "durable", true, 0, true, BENCH_DURABLE_COMMANDS);
+    bench_print_table(stdout, results, 4);
+
+    printf("\nRestart time against journal length:\n");
+    printf("%10s %12s %12s %16s\n", "records", "file MiB", "replay ms", "with snapshot ms");
+    int status = 0;
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+    {
+        remove_journal();
+        if (!write_crashed_journal(lengths[i]))
+        {
+            fprintf(stderr, "cannot write the journal\n");
+            status = 1;
+            break;
+        }
+        FILE *file = fopen(journal_path, "rb");
+        long bytes = 0;
+        if (file != NULL && fseek(file, 0, SEEK_END) == 0)
+        {
+            bytes = ftell(file);
+        }
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+        audio_journal_recovery_t replayed;
+        audio_journal_recovery_t snapshotted;
+        double replay_ms = open_and_close(&replayed);
+        double snapshot_ms = open_and_close(&snapshotted);
+        printf("%10zu %12.1f %12.3f %16.3f\n", lengths[i], (double)bytes / (1 << 20), replay_ms, snapshot_ms);
+        if (replayed.replayed != lengths[i] || snapshotted.replayed != 0 || !snapshotted.snapshot_loaded)
+        {
+            fprintf(stderr, "unexpected recovery: %llu replayed, then %llu\n",
+                    (unsigned long long)replayed.replayed, (unsigned long long)snapshotted.replayed);
+            status = 1;
+        }
+    }
+    remove_journal();
+    free_command_processor();
+    return status;
+}
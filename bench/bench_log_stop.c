@@ -0,0 +1,114 @@
+/**
+ * @file bench/bench_log_stop.c
+ * @brief Async logger restarts while other threads keep logging
+ *
+ * N producer threads log as fast as they can while the main thread stops and
+ * restarts asynchronous logging BENCH_CYCLES times. Each stop must wait for
+ * the log calls already queuing and send later ones down the synchronous
+ * path, so no record is written into a freed queue and none is lost. Output
+ * goes to a temporary file; with LOG_OVERFLOW_BLOCK nothing may be dropped,
+ * so its line count must equal the number of log calls. Reported: ns per
+ * stop + start cycle and records/sec.
+ *
+ * The check is only as strong as the memory checker watching it; build it
+ * under ThreadSanitizer or AddressSanitizer to re-check the stop protocol:
+ *   make -f MakeFile -B bench_log_stop BENCH_CFLAGS="-Wall -Iinc -Ibench -pthread -O1 -g -fsanitize=thread"
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "audio_logger.h"
+#include "bench_common.h"
+
+#define BENCH_CYCLES 200                             // Stop + start cycles per run
+#define BENCH_MAX_PRODUCERS 4
+
+static atomic_bool producers_done;
+static unsigned long produced[BENCH_MAX_PRODUCERS];  // Log calls made by each producer
+
+static void *producer_main(void *arg)
+{
+    unsigned long *calls = arg;
+    while (!atomic_load_explicit(&producers_done, memory_order_relaxed))
+    {
+        LOG_INFO("bench record %lu", *calls);
+        (*calls)++;
+    }
+    return NULL;
+}
+
+// Lines written to fd since offset 0
+static unsigned long count_lines(int fd)
+{
+    char buffer[65536];
+    unsigned long lines = 0;
+    ssize_t got;
+    lseek(fd, 0, SEEK_SET);
+    while ((got = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t i = 0; i < got; i++)
+        {
+            lines += (buffer[i] == '\n');
+        }
+    }
+    return lines;
+}
+
+int main(void)
+{
+    static const int counts[] = { 1, 2, 4 };
+    int status = 0;
+    printf("%10s %10s %14s %14s %12s\n", "producers", "cycles", "cycle us", "records/sec", "lost");
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        int n = counts[c];
+        FILE *log_file = tmpfile();
+        int saved_stdout = dup(STDOUT_FILENO);
+        if (log_file == NULL || saved_stdout < 0)
+        {
+            fprintf(stderr, "cannot redirect the log\n");
+            return 1;
+        }
+        fflush(stdout);
+        dup2(fileno(log_file), STDOUT_FILENO);       // Records from both paths land in the file
+
+        log_start_async(LOG_OVERFLOW_BLOCK);
+        atomic_store(&producers_done, false);
+        pthread_t threads[BENCH_MAX_PRODUCERS];
+        for (int i = 0; i < n; i++)
+        {
+            produced[i] = 0;
+            pthread_create(&threads[i], NULL, producer_main, &produced[i]);
+        }
+
+        uint64_t start = bench_now_ns();
+        for (int r = 0; r < BENCH_CYCLES; r++)
+        {
+            log_stop_async();
+            log_start_async(LOG_OVERFLOW_BLOCK);
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+
+        atomic_store(&producers_done, true);
+        unsigned long calls = 0;
+        for (int i = 0; i < n; i++)
+        {
+            pthread_join(threads[i], NULL);
+            calls += produced[i];
+        }
+        log_stop_async();
+        fflush(stdout);
+        dup2(saved_stdout, STDOUT_FILENO);
+        close(saved_stdout);
+
+        unsigned long lines = count_lines(fileno(log_file));
+        fclose(log_file);
+        long lost = (long)calls - (long)lines;
+        printf("%10d %10d %14.1f %14.0f %12ld%s\n", n, BENCH_CYCLES, (double)elapsed / BENCH_CYCLES / 1e3,
+               (double)calls * 1e9 / (double)elapsed, lost, (lost != 0) ? "  WRONG" : "");
+        status |= (lost != 0);
+    }
+    return status;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file bench/bench_replay.c
+ * @brief Text script dispatch versus compiled binary replay
+ *
+ * Writes a BENCH_COMMANDS-line script to the temp directory, compiles it
+ * with aud_binary_compile() and replays both files through
+ * run_command_script() with logging off and the pipeline on the null sink.
+ * The handlers do the same work either way, so the difference is the cost
+ * of finding and tokenizing each command. Reports the fastest of
+ * BENCH_PASSES passes as commands/sec and ns per command, plus file sizes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "audio_batch.h"
+#include "audio_command_binary.h"
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "audio_pipeline.h"
+#include "bench_common.h"
+
+#define BENCH_COMMANDS 1000000                       // Lines in the generated script
+#define BENCH_PASSES 5                               // Replays per format; the fastest is reported
+#define BENCH_SEED 12345u
+
+extern void register_audio_commands(void);
+
+static long write_script(const char *path)
+{
+    static const char *const commands[] = {
+        "volumeUp", "volumeDown", "mute", "unmute", "play track1.wav", "play track2.wav", "pause",
+        "volumeGet", "streamGain 3 75",
+    };
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+    {
+        return -1;
+    }
+    uint32_t seed = BENCH_SEED;
+    for (int i = 0; i < BENCH_COMMANDS; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;       // LCG: same script every run
+        fprintf(f, "%s\n", commands[(seed >> 16) % (sizeof(commands) / sizeof(commands[0]))]);
+    }
+    long size = ftell(f);
+    return (fclose(f) == 0) ? size : -1;
+}
+
+static bool compile_script(const char *text_path, long text_size, const char *bin_path, size_t *bytes)
+{
+    FILE *in = fopen(text_path, "rb");
+    FILE *out = fopen(bin_path, "wb");
+    char *text = malloc((size_t)text_size);
+    bool ok = in != NULL && out != NULL && text != NULL && fread(text, 1, (size_t)text_size, in) == (size_t)text_size;
+    aud_binary_compile_result_t result;
+    ok = ok && aud_binary_compile(text, (size_t)text_size, out, &result);
+    *bytes = ok ? result.bytes : 0;
+    free(text);
+    if (in != NULL)
+    {
+        fclose(in);
+    }
+    return (out != NULL && fclose(out) == 0) && ok;
+}
+
+// Fastest replay of a script in seconds
+static double best_replay(const char *path)
+{
+    double best = 0.0;
+    for (int pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        audio_batch_result_t result;
+        if (run_command_script(path, &result) != 0 || result.commands != BENCH_COMMANDS)
+        {
+            return 0.0;
+        }
+        if (best == 0.0 || result.seconds < best)
+        {
+            best = result.seconds;
+        }
+    }
+    return best;
+}
+
+int main(void)
+{
+    const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char text_path[256];
+    char bin_path[256];
+    snprintf(text_path, sizeof(text_path), "%s/bench_replay_%d.txt", dir, (int)getpid());
+    snprintf(bin_path, sizeof(bin_path), "%s/bench_replay_%d.bin", dir, (int)getpid());
+
+    log_set_runtime_level(LOG_SEVERITY_NONE);
+    register_audio_commands();
+    freeze_command_processor();
+    audio_pipeline_config_t config;
+    audio_pipeline_default_config(&config);
+    config.sink = "null";
+
+    size_t bin_size = 0;
+    long text_size = write_script(text_path);
+    if (text_size < 0 || !compile_script(text_path, text_size, bin_path, &bin_size) || !start_audio_pipeline(&config))
+    {
+        fprintf(stderr, "Cannot prepare %s\n", text_path);
+        return 1;
+    }
+
+    double text = best_replay(text_path);
+    double binary = best_replay(bin_path);
+    printf("%d commands, logging off, null sink, best of %d passes\n", BENCH_COMMANDS, BENCH_PASSES);
+    printf("%-8s %12s %16s %12s\n", "format", "bytes", "commands/sec", "ns/command");
+    printf("%-8s %12ld %16.0f %12.1f\n", "text", text_size, BENCH_COMMANDS / text, text * 1e9 / BENCH_COMMANDS);
+    printf("%-8s %12zu %16.0f %12.1f\n", "binary", bin_size, BENCH_COMMANDS / binary, binary * 1e9 / BENCH_COMMANDS);
+    printf("speedup  %.2fx\n", text / binary);
+
+    stop_audio_pipeline();
+    free_command_processor();
+    unlink(text_path);
+    unlink(bin_path);
+    return 0;
+}
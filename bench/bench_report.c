@@ -0,0 +1,120 @@
+/**
+ * @file bench/bench_report.c
+ * @brief Batch throughput with immediate versus coalesced state reports
+ *
+ * Writes a BENCH_COMMANDS-line script of volume, mute, play, pause and
+ * volumeGet commands to the temp directory and replays it through
+ * run_command_script() with the pipeline on the null sink, once per report
+ * mode. Stdout goes to a temp file while the script runs, so the cost of
+ * formatting and writing every report is timed without a terminal in the
+ * way. Reports commands/sec, output bytes and the coalescing counters.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "audio_batch.h"
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "audio_pipeline.h"
+#include "audio_report.h"
+#include "bench_common.h"
+
+#define BENCH_COMMANDS 1000000                       // Lines in the generated script
+#define BENCH_SEED 12345u
+
+extern void register_audio_commands(void);
+
+static bool write_script(const char *path)
+{
+    static const char *const commands[] = {
+        "volumeUp", "volumeDown", "mute", "unmute", "play track1.wav", "play track2.wav", "pause", "volumeGet",
+    };
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+    {
+        return false;
+    }
+    uint32_t seed = BENCH_SEED;
+    for (int i = 0; i < BENCH_COMMANDS; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;       // LCG: same script every run
+        fprintf(f, "%s\n", commands[(seed >> 16) % (sizeof(commands) / sizeof(commands[0]))]);
+    }
+    return fclose(f) == 0;
+}
+
+// Replays the script with stdout sent to out_fd; returns the batch result
+static audio_batch_result_t replay(const char *script, int out_fd, off_t *bytes)
+{
+    audio_batch_result_t result = { 0, 0.0 };
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    ftruncate(out_fd, 0);
+    lseek(out_fd, 0, SEEK_SET);
+    dup2(out_fd, STDOUT_FILENO);
+
+    run_command_script(script, &result);
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    struct stat st;
+    *bytes = (fstat(out_fd, &st) == 0) ? st.st_size : 0;
+    return result;
+}
+
+int main(void)
+{
+    static const audio_report_mode_t modes[] = { AUDIO_REPORT_IMMEDIATE, AUDIO_REPORT_COALESCED };
+    static const char *const mode_names[] = { "immediate", "coalesced" };
+    const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char script[256];
+    char output[256];
+    snprintf(script, sizeof(script), "%s/bench_report_%d.txt", dir, (int)getpid());
+    snprintf(output, sizeof(output), "%s/bench_report_%d.out", dir, (int)getpid());
+
+    int out_fd = open(output, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (!write_script(script) || out_fd < 0)
+    {
+        fprintf(stderr, "Cannot write %s\n", script);
+        return 1;
+    }
+
+    register_audio_commands();
+    freeze_command_processor();
+    audio_pipeline_config_t config;
+    audio_pipeline_default_config(&config);
+    config.sink = "null";
+    if (!start_audio_pipeline(&config))
+    {
+        return 1;
+    }
+
+    printf("%d-command script, null sink\n", BENCH_COMMANDS);
+    printf("%-10s %14s %14s %12s %12s %12s\n", "mode", "commands/sec", "output bytes", "requested", "printed", "suppressed");
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        audio_report_set_mode(modes[m]);
+        audio_report_counters_t before = audio_report_counters();
+        off_t bytes = 0;
+        audio_batch_result_t result = replay(script, out_fd, &bytes);
+        audio_report_counters_t after = audio_report_counters();
+
+        printf("%-10s %14.0f %14lld %12llu %12llu %12llu\n", mode_names[m],
+               result.seconds > 0.0 ? (double)result.commands / result.seconds : 0.0, (long long)bytes,
+               (unsigned long long)(after.requested - before.requested),
+               (unsigned long long)(after.emitted - before.emitted),
+               (unsigned long long)(after.suppressed - before.suppressed));
+    }
+
+    stop_audio_pipeline();
+    free_command_processor();
+    close(out_fd);
+    unlink(output);
+    unlink(script);
+    return 0;
+}
@@ -0,0 +1,201 @@
+/**
+ * @file bench/bench_ring.c
+ * @brief Throughput of the SPSC ring versus the audio_buffer_t byte ring
+ *
+ * Moves the same number of chunks from a producer to a consumer with:
+ *  - audio_buffer_t on one thread (enqueue, then peek/release in place),
+ *  - audio_buffer_t shared by two threads under a mutex,
+ *  - audio_spsc_ring_t shared by two threads without locks.
+ *
+ * A last case interleaves small command records with large PCM-sized
+ * records in one byte ring and reports how many fit at once, next to the
+ * count fixed slots of the large size would hold in the same memory.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include "audio_buffer.h"
+#include "audio_spsc_ring.h"
+#include "bench_common.h"
+
+#define BENCH_CHUNKS 2000000                         // Chunks moved per run
+#define BENCH_RING_CAPACITY 1024                     // Slots in the SPSC ring
+#define BENCH_SLOT_SIZE 256                          // Bytes per SPSC slot
+#define BENCH_CHUNK_LABEL "AUDIO_CHUNK_0000"         // Payload moved through every ring
+#define BENCH_LABEL_LEN (sizeof(BENCH_CHUNK_LABEL) - 1)
+#define BENCH_MIXED_BYTES 65536                      // Byte ring of the mixed-size case
+#define BENCH_SMALL_RECORD 24                        // A command line
+#define BENCH_LARGE_RECORD 4096                      // 1024 stereo s16 frames
+
+static audio_buffer_t locked_buffer;
+static pthread_mutex_t locked_buffer_lock = PTHREAD_MUTEX_INITIALIZER;
+static audio_spsc_ring_t spsc_ring;
+
+static void *locked_producer(void *arg)
+{
+    (void)arg;
+    for (int i = 0; i < BENCH_CHUNKS; )
+    {
+        pthread_mutex_lock(&locked_buffer_lock);
+        bool full = !enqueue_audio_record(&locked_buffer, BENCH_CHUNK_LABEL, BENCH_LABEL_LEN);
+        if (!full)
+        {
+            i++;
+        }
+        pthread_mutex_unlock(&locked_buffer_lock);
+        if (full)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *locked_consumer(void *arg)
+{
+    (void)arg;
+    size_t len = 0;
+    for (int i = 0; i < BENCH_CHUNKS; )
+    {
+        pthread_mutex_lock(&locked_buffer_lock);
+        const char *chunk = peek_audio_record(&locked_buffer, &len);
+        bool empty = (chunk == NULL);
+        if (!empty)
+        {
+            BENCH_KEEP(chunk[0]);
+            release_audio_record(&locked_buffer);
+            i++;
+        }
+        pthread_mutex_unlock(&locked_buffer_lock);
+        if (empty)
+        {
+            sched_yield();
+        }
+    }
+    BENCH_KEEP(len);
+    return NULL;
+}
+
+static void *spsc_producer(void *arg)
+{
+    (void)arg;
+    for (int i = 0; i < BENCH_CHUNKS; i++)
+    {
+        while (!audio_spsc_ring_push(&spsc_ring, BENCH_CHUNK_LABEL, sizeof(BENCH_CHUNK_LABEL)))
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *spsc_consumer(void *arg)
+{
+    (void)arg;
+    char chunk[BENCH_SLOT_SIZE];
+    for (int i = 0; i < BENCH_CHUNKS; i++)
+    {
+        while (!audio_spsc_ring_pop(&spsc_ring, chunk, NULL))
+        {
+            sched_yield();
+        }
+    }
+    BENCH_KEEP(chunk[0]);
+    return NULL;
+}
+
+static double run_threads(void *(*producer)(void *), void *(*consumer)(void *))
+{
+    pthread_t p, c;
+    uint64_t start = bench_now_ns();
+    pthread_create(&c, NULL, consumer, NULL);
+    pthread_create(&p, NULL, producer, NULL);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+    return (double)(bench_now_ns() - start) / 1e9;
+}
+
+static void report(const char *name, double seconds)
+{
+    printf("%-34s %10.1f ns/chunk %12.0f chunks/sec\n",
+           name, seconds * 1e9 / BENCH_CHUNKS, BENCH_CHUNKS / seconds);
+}
+
+// Fills a byte ring with alternating small and large records, drains it, and repeats
+static void run_mixed(void)
+{
+    static uint8_t payload[BENCH_LARGE_RECORD];
+    audio_buffer_t ring;
+    init_audio_buffer(&ring, BENCH_MIXED_BYTES);
+    size_t moved = 0;
+    size_t peak = 0;
+    size_t peak_payload = 0;
+    uint64_t start = bench_now_ns();
+    while (moved < BENCH_CHUNKS / 8)
+    {
+        for (size_t i = 0; ; i++)
+        {
+            size_t len = (i % 2 == 0) ? BENCH_SMALL_RECORD : BENCH_LARGE_RECORD;
+            if (!enqueue_audio_record(&ring, payload, len))
+            {
+                break;
+            }
+        }
+        audio_buffer_fill_t fill = audio_buffer_fill(&ring);
+        peak = (fill.records > peak) ? fill.records : peak;
+        peak_payload = (fill.payload_bytes > peak_payload) ? fill.payload_bytes : peak_payload;
+
+        size_t len;
+        const uint8_t *record;
+        while ((record = peek_audio_record(&ring, &len)) != NULL)
+        {
+            BENCH_KEEP(record[len - 1]);
+            release_audio_record(&ring);
+            moved++;
+        }
+    }
+    double seconds = (double)(bench_now_ns() - start) / 1e9;
+    free_audio_buffer(&ring);
+
+    printf("%-34s %10.1f ns/record %12.0f records/sec\n", "audio_buffer_t mixed sizes", seconds * 1e9 / moved, moved / seconds);
+    printf("  %d-byte ring, %d/%d-byte records: %zu records (%zu payload bytes) at once;"
+           " %d-byte slots would hold %d\n", BENCH_MIXED_BYTES, BENCH_SMALL_RECORD, BENCH_LARGE_RECORD,
+           peak, peak_payload, BENCH_LARGE_RECORD, BENCH_MIXED_BYTES / BENCH_LARGE_RECORD);
+}
+
+int main(void)
+{
+    // Single-threaded baseline: fill half the ring, then drain it in place
+    int half = (int)(AUDIO_BUFFER_DEFAULT_BYTES / AUDIO_RECORD_BYTES(BENCH_LABEL_LEN) / 2);
+    init_audio_buffer(&locked_buffer, AUDIO_BUFFER_DEFAULT_BYTES);
+    size_t len = 0;
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_CHUNKS; i += half)
+    {
+        for (int j = 0; j < half; j++)
+        {
+            enqueue_audio_record(&locked_buffer, BENCH_CHUNK_LABEL, BENCH_LABEL_LEN);
+        }
+        for (int j = 0; j < half; j++)
+        {
+            const void *chunk = peek_audio_record(&locked_buffer, &len);
+            BENCH_KEEP(chunk);
+            release_audio_record(&locked_buffer);
+        }
+    }
+    BENCH_KEEP(len);
+    report("audio_buffer_t (1 thread)", (double)(bench_now_ns() - start) / 1e9);
+
+    reset_audio_buffer(&locked_buffer);
+    report("audio_buffer_t + mutex (2 threads)", run_threads(locked_producer, locked_consumer));
+    free_audio_buffer(&locked_buffer);
+
+    audio_spsc_ring_init(&spsc_ring, BENCH_RING_CAPACITY, BENCH_SLOT_SIZE);
+    report("audio_spsc_ring_t (2 threads)", run_threads(spsc_producer, spsc_consumer));
+    audio_spsc_ring_free(&spsc_ring);
+
+    run_mixed();
+    return 0;
+}
@@ -0,0 +1,227 @@
+/**
+ * @file bench/bench_server.c
+ * @brief Local load test of the Unix socket command server
+ *
+ * Runs audio_server_run() on its own thread with one cheap command
+ * registered, then:
+ *  - opens BENCH_IDLE idle connections and reports the server heap and
+ *    process RSS each one costs,
+ *  - with those still open, drives the server from 1, 4 and 16 client
+ *    threads, each on its own connection, sending 1 or 32 commands per
+ *    write (pipelined) and waiting for all of their replies.
+ *
+ * Reports commands/sec and the round-trip time of each write (p50, p99,
+ * p99.9 and max): a command's latency is at most the round trip of the
+ * write that carried it.
+ */
+
+#include <malloc.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "audio_server.h"
+#include "bench_common.h"
+
+#define BENCH_IDLE 4000                              // Idle connections held open during the load
+#define BENCH_COMMANDS 200000                        // Commands sent per configuration
+#define BENCH_MAX_DEPTH 32
+#define BENCH_COMMAND "ping 42\n"
+
+typedef struct {
+    int fd;
+    int depth;                                       // Commands per write
+    size_t writes;                                   // Writes to make
+    double *round_trips;                             // ns per write
+} bench_client_t;
+
+static struct sockaddr_un server_address = { .sun_family = AF_UNIX };
+static volatile unsigned long handler_calls;         // Incremented by every handler call
+
+static void ping_handler(const aud_command_line_t *line)
+{
+    (void)line;
+    handler_calls++;
+}
+
+static void *server_thread(void *arg)
+{
+    (void)arg;
+    audio_server_run();
+    return NULL;
+}
+
+static int connect_client(void)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr *)&server_address, sizeof(server_address)) != 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+// Reads until count reply lines have arrived
+static bool read_replies(int fd, int count)
+{
+    char buffer[BENCH_MAX_DEPTH * AUDIO_SERVER_REPLY_MAX];
+    while (count > 0)
+    {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0)
+        {
+            return false;
+        }
+        for (ssize_t i = 0; i < n; i++)
+        {
+            count -= (buffer[i] == '\n');
+        }
+    }
+    return true;
+}
+
+// One command, answered, so the server has surely accepted the connection
+static bool ping(int fd)
+{
+    return send(fd, BENCH_COMMAND, sizeof(BENCH_COMMAND) - 1, MSG_NOSIGNAL) > 0 && read_replies(fd, 1);
+}
+
+static void *client_thread(void *arg)
+{
+    bench_client_t *client = arg;
+    char batch[BENCH_MAX_DEPTH * sizeof(BENCH_COMMAND)];
+    size_t len = 0;
+    for (int i = 0; i < client->depth; i++, len += sizeof(BENCH_COMMAND) - 1)
+    {
+        memcpy(batch + len, BENCH_COMMAND, sizeof(BENCH_COMMAND) - 1);
+    }
+    for (size_t w = 0; w < client->writes; w++)
+    {
+        uint64_t start = bench_now_ns();
+        if (send(client->fd, batch, len, MSG_NOSIGNAL) != (ssize_t)len || !read_replies(client->fd, client->depth))
+        {
+            client->writes = w;
+            break;
+        }
+        client->round_trips[w] = (double)(bench_now_ns() - start);
+    }
+    return NULL;
+}
+
+static size_t rss_bytes(void)
+{
+    long size = 0;
+    long pages = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm != NULL)
+    {
+        if (fscanf(statm, "%ld %ld", &size, &pages) != 2)
+        {
+            pages = 0;
+        }
+        fclose(statm);
+    }
+    return (size_t)pages * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static void run_load(int clients, int depth)
+{
+    bench_client_t state[16];
+    pthread_t threads[16];
+    size_t writes = BENCH_COMMANDS / (size_t)(clients * depth);
+    double *samples = malloc(sizeof(double) * writes * (size_t)clients);
+
+    for (int c = 0; c < clients; c++)
+    {
+        state[c] = (bench_client_t){ connect_client(), depth, writes, samples + (size_t)c * writes };
+    }
+    uint64_t start = bench_now_ns();
+    for (int c = 0; c < clients; c++)
+    {
+        pthread_create(&threads[c], NULL, client_thread, &state[c]);
+    }
+    size_t done = 0;
+    for (int c = 0; c < clients; c++)
+    {
+        pthread_join(threads[c], NULL);
+        memmove(samples + done, state[c].round_trips, state[c].writes * sizeof(double));   // Pack short runs
+        done += state[c].writes;
+        close(state[c].fd);
+    }
+    double seconds = (double)(bench_now_ns() - start) / 1e9;
+
+    bench_result_t result;
+    bench_summarize(&result, samples, done, 1);
+    printf("%8d %6d %14.0f %10.1f %10.1f %10.1f %10.1f\n", clients, depth, (double)done * depth / seconds,
+           result.p50_ns / 1e3, result.p99_ns / 1e3, samples[(done * 999) / 1000] / 1e3, result.max_ns / 1e3);
+    free(samples);
+}
+
+int main(void)
+{
+    static const int client_counts[] = { 1, 4, 16 };
+    static const int depths[] = { 1, BENCH_MAX_DEPTH };
+    static int idle[BENCH_IDLE];
+
+    log_set_runtime_level(LOG_SEVERITY_NONE);
+    struct rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;                 // Both ends of every connection live in this process
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    register_command_slice("ping", ping_handler);
+    freeze_command_processor();
+    snprintf(server_address.sun_path, sizeof(server_address.sun_path), "/tmp/bench_server_%d.sock", (int)getpid());
+    audio_server_config_t config;
+    audio_server_default_config(&config);
+    config.path = server_address.sun_path;
+    config.max_connections = BENCH_IDLE + 64;
+    pthread_t server;
+    if (!audio_server_open(&config) || pthread_create(&server, NULL, server_thread, NULL) != 0)
+    {
+        fprintf(stderr, "cannot start the server\n");
+        return 1;
+    }
+
+    // Idle connections: each answers one command, then stays open
+    size_t heap_before = mallinfo2().uordblks;
+    size_t rss_before = rss_bytes();
+    int opened = 0;
+    while (opened < BENCH_IDLE && (idle[opened] = connect_client()) >= 0 && ping(idle[opened]))
+    {
+        opened++;
+    }
+    printf("%d idle connections: %.0f bytes of server heap and %.0f bytes of RSS each (both ends in one process)\n\n",
+           opened, (double)(mallinfo2().uordblks - heap_before) / (opened ? opened : 1),
+           (double)(rss_bytes() - rss_before) / (opened ? opened : 1));
+
+    printf("%8s %6s %14s %10s %10s %10s %10s\n", "clients", "depth", "commands/sec", "p50 us", "p99 us", "p99.9 us", "max us");
+    for (size_t c = 0; c < sizeof(client_counts) / sizeof(client_counts[0]); c++)
+    {
+        for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++)
+        {
+            run_load(client_counts[c], depths[d]);
+        }
+    }
+
+    audio_server_stop();
+    pthread_join(server, NULL);
+    audio_server_stats_t stats = audio_server_stats();
+    printf("\nserver: %llu commands, %llu reads, %llu stalled replies, peak %llu connections\n",
+           (unsigned long long)stats.commands, (unsigned long long)stats.reads,
+           (unsigned long long)stats.stalled, (unsigned long long)stats.peak);
+    for (int i = 0; i < opened; i++)
+    {
+        close(idle[i]);
+    }
+    audio_server_close();
+    free_command_processor();
+    return (opened == BENCH_IDLE) ? 0 : 1;
+}
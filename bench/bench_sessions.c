@@ -0,0 +1,138 @@
+/**
+ * @file bench/bench_sessions.c
+ * @brief Multi-session throughput of the work-stealing scheduler
+ *
+ * Creates BENCH_SESSIONS sessions and submits the same command mix to each
+ * from the main thread, then waits for the pool to drain. Runs with 1, 2, 4
+ * and 8 workers and reports commands/sec and the speedup over one worker.
+ *
+ * A "seq <n>" command checks per-session ordering: every session must see
+ * its sequence numbers in submission order, and never on two threads at once.
+ */
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "audio_scheduler.h"
+#include "audio_session.h"
+#include "bench_common.h"
+
+#define BENCH_SESSIONS 256                           // Independent zones
+#define BENCH_COMMANDS_PER_SESSION 4000              // Commands submitted to each zone
+#define BENCH_HANDLER_WORK 200                       // Busy-loop iterations per command (simulated handler cost)
+
+typedef struct {
+    _Alignas(64) long next_seq;                      // Next sequence number expected
+    atomic_int running;                              // Threads currently inside the session
+    unsigned long errors;                            // Ordering or exclusivity violations
+} session_check_t;
+
+extern void register_audio_commands(void);
+
+static session_check_t checks[BENCH_SESSIONS];
+
+static void handle_seq_command(const aud_command_line_t *line)
+{
+    session_check_t *check = &checks[audio_session_current()->id];
+    if (atomic_fetch_add(&check->running, 1) != 0)
+    {
+        check->errors++;                             // Session ran on two workers at once
+    }
+
+    long seq = 0;
+    for (size_t i = 0; i < line->args.len; i++)      // The arguments are not terminated
+    {
+        seq = seq * 10 + (line->args.ptr[i] - '0');
+    }
+    if (seq != check->next_seq)
+    {
+        check->errors++;                             // Out of submission order
+    }
+    check->next_seq = seq + 1;
+
+    volatile unsigned sink = 0;
+    for (unsigned i = 0; i < BENCH_HANDLER_WORK; i++)
+    {
+        sink += i;
+    }
+    atomic_fetch_sub(&check->running, 1);
+}
+
+static double run(unsigned workers, audio_session_t **sessions, unsigned long *errors)
+{
+    static const char *mix[] = { "volumeUp", "mute", "volumeDown", "unmute", "play zone", "pause" };
+    char line[32];
+
+    for (int s = 0; s < BENCH_SESSIONS; s++)
+    {
+        checks[s].next_seq = 0;
+        checks[s].errors = 0;
+        atomic_store(&checks[s].running, 0);
+    }
+
+    audio_scheduler_start(workers);
+    uint64_t start = bench_now_ns();
+    for (int c = 0; c < BENCH_COMMANDS_PER_SESSION; c++)
+    {
+        for (int s = 0; s < BENCH_SESSIONS; s++)
+        {
+            int len = (c & 1) ? snprintf(line, sizeof(line), "seq %d", c / 2)
+                              : snprintf(line, sizeof(line), "%s", mix[(c / 2) % 6]);
+            while (!audio_session_submit(sessions[s], line, (size_t)len))
+            {
+                sched_yield();                       // Session queue full: let the workers catch up
+            }
+        }
+    }
+    audio_scheduler_wait_idle();
+    uint64_t elapsed = bench_now_ns() - start;
+    audio_scheduler_stop();
+
+    *errors = 0;
+    for (int s = 0; s < BENCH_SESSIONS; s++)
+    {
+        *errors += checks[s].errors + (checks[s].next_seq != BENCH_COMMANDS_PER_SESSION / 2);
+    }
+    return (double)BENCH_SESSIONS * BENCH_COMMANDS_PER_SESSION * 1e9 / (double)elapsed;
+}
+
+int main(void)
+{
+    static const unsigned worker_counts[] = { 1, 2, 4, 8 };
+    audio_session_t *sessions[BENCH_SESSIONS];
+
+    log_set_runtime_level(LOG_SEVERITY_NONE);
+    register_audio_commands();
+    register_command_slice("seq", handle_seq_command);
+    freeze_command_processor();
+    for (int s = 0; s < BENCH_SESSIONS; s++)
+    {
+        sessions[s] = audio_session_create((uint32_t)s);
+    }
+
+    printf("%d sessions x %d commands, %ld online CPUs\n", BENCH_SESSIONS, BENCH_COMMANDS_PER_SESSION,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-8s %16s %10s %10s\n", "workers", "commands/sec", "speedup", "errors");
+    double base = 0.0;
+    for (size_t i = 0; i < sizeof(worker_counts) / sizeof(worker_counts[0]); i++)
+    {
+        unsigned long errors;
+        double rate = run(worker_counts[i], sessions, &errors);
+        if (i == 0)
+        {
+            base = rate;
+        }
+        printf("%-8u %16.0f %9.2fx %10lu\n", worker_counts[i], rate, rate / base, errors);
+    }
+
+    for (int s = 0; s < BENCH_SESSIONS; s++)
+    {
+        audio_session_destroy(sessions[s]);
+    }
+    free_command_processor();
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file bench/bench_state.c
+ * @brief Audio state contention: packed atomic word versus a mutex
+ *
+ * One writer performs a fixed number of volume and flag transitions while N
+ * reader threads take snapshots as fast as they can. Every snapshot is
+ * checked for consistency (volume in range and on the 10-step grid, only
+ * the flag bits the writer uses). The same workload runs against a
+ * mutex-guarded struct for comparison.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include "audio_systemState.h"
+#include "audio_logger.h"
+#include "bench_common.h"
+
+#define BENCH_WRITES 200000                          // Transitions made by the writer per run
+#define BENCH_MAX_READERS 8
+
+typedef struct {
+    unsigned long snapshots;                         // Snapshots taken
+    unsigned long inconsistent;                      // Snapshots that failed the checks
+} reader_result_t;
+
+static atomic_bool writer_done;
+static reader_result_t reader_results[BENCH_MAX_READERS];
+
+// Mutex baseline: the same transitions on a plain struct
+static pthread_mutex_t locked_state_lock = PTHREAD_MUTEX_INITIALIZER;
+static audioState locked_state = { .volume = AUDIO_VOLUME_DEFAULT };
+
+static bool snapshot_consistent(audioState state)
+{
+    return state.volume >= AUDIO_VOLUME_MIN && state.volume <= AUDIO_VOLUME_MAX &&
+           state.volume % AUDIO_VOLUME_STEP == 0 && !state.flags.is_playing && state.flags.reserved == 0;
+}
+
+static void *atomic_reader(void *arg)
+{
+    reader_result_t *result = arg;
+    while (!atomic_load_explicit(&writer_done, memory_order_acquire))
+    {
+        audioState state = snapshot_audio_state();
+        result->snapshots++;
+        result->inconsistent += !snapshot_consistent(state);
+    }
+    return NULL;
+}
+
+static void *locked_reader(void *arg)
+{
+    reader_result_t *result = arg;
+    while (!atomic_load_explicit(&writer_done, memory_order_acquire))
+    {
+        pthread_mutex_lock(&locked_state_lock);
+        audioState state = locked_state;
+        pthread_mutex_unlock(&locked_state_lock);
+        result->snapshots++;
+        result->inconsistent += !snapshot_consistent(state);
+    }
+    return NULL;
+}
+
+static void atomic_write(int i)
+{
+    switch (i & 3)
+    {
+        case 0: audio_state_step_volume(AUDIO_VOLUME_STEP); break;
+        case 1: audio_state_set_flags(AUDIO_FLAG_MUTED, 0); break;
+        case 2: audio_state_step_volume(-AUDIO_VOLUME_STEP); break;
+        default: audio_state_set_flags(0, AUDIO_FLAG_MUTED); break;
+    }
+}
+
+static void locked_write(int i)
+{
+    pthread_mutex_lock(&locked_state_lock);
+    switch (i & 3)
+    {
+        case 0: locked_state.volume = (locked_state.volume + 10 > 100) ? 100 : locked_state.volume + 10; break;
+        case 1: locked_state.flags.is_muted = 1; break;
+        case 2: locked_state.volume = (locked_state.volume - 10 < 0) ? 0 : locked_state.volume - 10; break;
+        default: locked_state.flags.is_muted = 0; break;
+    }
+    locked_state.generation++;
+    pthread_mutex_unlock(&locked_state_lock);
+}
+
+static void run(const char *name, int readers, void *(*reader)(void *), void (*write)(int))
+{
+    pthread_t threads[BENCH_MAX_READERS];
+    atomic_store(&writer_done, false);
+    for (int r = 0; r < readers; r++)
+    {
+        reader_results[r] = (reader_result_t){ 0, 0 };
+        pthread_create(&threads[r], NULL, reader, &reader_results[r]);
+    }
+
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_WRITES; i++)
+    {
+        write(i);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    atomic_store_explicit(&writer_done, true, memory_order_release);
+
+    unsigned long snapshots = 0;
+    unsigned long inconsistent = 0;
+    for (int r = 0; r < readers; r++)
+    {
+        pthread_join(threads[r], NULL);
+        snapshots += reader_results[r].snapshots;
+        inconsistent += reader_results[r].inconsistent;
+    }
+
+    printf("%-8s %8d %14.1f %16.0f %14lu\n", name, readers, (double)elapsed / BENCH_WRITES,
+           (double)snapshots * 1e9 / (double)elapsed, inconsistent);
+}
+
+int main(void)
+{
+    static const int reader_counts[] = { 1, 2, 4, 8 };
+
+    log_set_runtime_level(LOG_SEVERITY_NONE);
+    printf("%-8s %8s %14s %16s %14s\n", "state", "readers", "write ns/op", "snapshots/sec", "inconsistent");
+    for (size_t i = 0; i < sizeof(reader_counts) / sizeof(reader_counts[0]); i++)
+    {
+        run("atomic", reader_counts[i], atomic_reader, atomic_write);
+        run("mutex", reader_counts[i], locked_reader, locked_write);
+    }
+    return 0;
+}
@@ -0,0 +1,222 @@
+/**
+ * @file bench/bench_suite.c
+ * @brief Hot-path microbenchmarks with percentiles and JSON output
+ *
+ * Every case runs a fixed number of warm-up samples and then BENCH_SAMPLES
+ * timed samples of a fixed operation count, so the work done is identical
+ * from build to build. The table (or JSON with --json) reports ns/op per case:
+ *  - dispatch_command() for a hit, a miss and a long argument,
+ *  - enqueue/peek/release round trips on the audio_buffer_t byte ring at several fill levels,
+ *  - log_message() as text, as a binary record and when filtered out,
+ *  - print_audio_buffer_state() rendering.
+ *
+ * Output of the logging and rendering cases goes to /dev/null while timed.
+ *
+ * Usage:
+ *   bench_suite [--json]
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "audio_buffer.h"
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "bench_common.h"
+
+#define BENCH_SAMPLES 200                            // Timed samples per case
+#define BENCH_WARMUP_SAMPLES 20                      // Untimed samples run first
+#define BENCH_MAX_CASES 16
+#define BENCH_LONG_ARG 240                           // Argument bytes of the long dispatch case
+
+typedef void (*bench_op_t)(uint64_t iterations);
+
+static bench_result_t results[BENCH_MAX_CASES];
+static size_t result_count = 0;
+static volatile unsigned long handler_calls;         // Incremented by every handler call
+static char long_command[8 + BENCH_LONG_ARG];        // "play <long argument>"
+static audio_buffer_t bench_buffer;
+static int saved_stdout = -1;
+
+static void bench_handler(const char *args)
+{
+    (void)args;
+    handler_calls++;
+}
+
+/**
+ * @brief Sends stdout to /dev/null so printing cases do not flood the terminal.
+ */
+static void silence_stdout(void)
+{
+    fflush(stdout);
+    saved_stdout = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+}
+
+static void restore_stdout(void)
+{
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+}
+
+/**
+ * @brief Runs one case and records its summary.
+ *
+ * @param name Case name.
+ * @param op Runs the operation the given number of times.
+ * @param iterations Operations per sample.
+ */
+static void run_case(const char *name, bench_op_t op, uint64_t iterations)
+{
+    static double samples[BENCH_SAMPLES];
+
+    for (int i = 0; i < BENCH_WARMUP_SAMPLES; i++)
+    {
+        op(iterations);
+    }
+    for (int i = 0; i < BENCH_SAMPLES; i++)
+    {
+        uint64_t start = bench_now_ns();
+        op(iterations);
+        samples[i] = (double)(bench_now_ns() - start) / (double)iterations;
+    }
+
+    bench_result_t *result = &results[result_count++];
+    result->name = name;
+    bench_summarize(result, samples, BENCH_SAMPLES, iterations);
+}
+
+// ====================================================================================
+// Cases
+
+static void op_dispatch_hit(uint64_t n)
+{
+    for (uint64_t i = 0; i < n; i++)
+    {
+        dispatch_command("volume_up");
+    }
+}
+
+static void op_dispatch_miss(uint64_t n)
+{
+    for (uint64_t i = 0; i < n; i++)
+    {
+        dispatch_command("rewind");
+    }
+}
+
+static void op_dispatch_long_arg(uint64_t n)
+{
+    for (uint64_t i = 0; i < n; i++)
+    {
+        dispatch_command(long_command);
+    }
+}
+
+static void op_buffer_round_trip(uint64_t n)
+{
+    size_t len = 0;
+    for (uint64_t i = 0; i < n; i++)
+    {
+        enqueue_audio_command(&bench_buffer, "AUDIO_CHUNK_0001");
+        const void *chunk = peek_audio_record(&bench_buffer, &len);
+        BENCH_KEEP(chunk);
+        release_audio_record(&bench_buffer);
+    }
+    BENCH_KEEP(len);
+}
+
+static void op_log_message(uint64_t n)
+{
+    for (uint64_t i = 0; i < n; i++)
+    {
+        LOG_INFO("Handling volume up command: %s (volume %d)", "bench", (int)i);
+    }
+}
+
+static void op_print_buffer(uint64_t n)
+{
+    for (uint64_t i = 0; i < n; i++)
+    {
+        print_audio_buffer_state(&bench_buffer);
+    }
+}
+
+/**
+ * @brief Resets the bench buffer and queues a number of chunks.
+ */
+static void fill_bench_buffer(int level)
+{
+    reset_audio_buffer(&bench_buffer);
+    for (int i = 0; i < level; i++)
+    {
+        enqueue_audio_command(&bench_buffer, "AUDIO_CHUNK_0000");
+    }
+}
+
+static void bench_buffer_at(const char *name, int level)
+{
+    fill_bench_buffer(level);
+    run_case(name, op_buffer_round_trip, 100000);
+}
+
+int main(int argc, char *argv[])
+{
+    bool json = (argc > 1 && strcmp(argv[1], "--json") == 0);
+
+    // Dispatch: the miss path logs a warning, so logging is filtered out to time the lookup alone
+    log_set_runtime_level(LOG_SEVERITY_NONE);
+    static const char *names[] = { "play", "pause", "volume_up", "volume_down", "mute", "unmute", "reset", "status" };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        register_command(names[i], bench_handler);
+    }
+    freeze_command_processor();
+    memcpy(long_command, "play ", 5);
+    memset(long_command + 5, 'x', BENCH_LONG_ARG);
+    long_command[5 + BENCH_LONG_ARG] = '\0';
+
+    run_case("dispatch_hit", op_dispatch_hit, 100000);
+    run_case("dispatch_miss", op_dispatch_miss, 100000);
+    run_case("dispatch_long_arg", op_dispatch_long_arg, 100000);
+    run_case("log_message_filtered", op_log_message, 100000);
+    log_set_runtime_level(LOG_SEVERITY_INFO);
+
+    // Fill levels in records of the same size as the round-trip record
+    int buffer_records = (int)(AUDIO_BUFFER_DEFAULT_BYTES / AUDIO_RECORD_BYTES(sizeof("AUDIO_CHUNK_0000") - 1));
+    init_audio_buffer(&bench_buffer, AUDIO_BUFFER_DEFAULT_BYTES);
+    bench_buffer_at("buffer_round_trip_empty", 0);
+    bench_buffer_at("buffer_round_trip_half", buffer_records / 2);
+    bench_buffer_at("buffer_round_trip_90pct", buffer_records - 1);
+
+    silence_stdout();
+    run_case("log_message_text", op_log_message, 2000);
+    fill_bench_buffer(buffer_records / 2);
+    run_case("print_audio_buffer_state", op_print_buffer, 500);
+    if (log_start_binary("/dev/null"))
+    {
+        run_case("log_message_binary", op_log_message, 20000);
+        log_stop_binary();
+    }
+    restore_stdout();
+
+    log_set_runtime_level(LOG_SEVERITY_NONE);
+    free_command_processor();
+    free_audio_buffer(&bench_buffer);
+    BENCH_KEEP(handler_calls);
+
+    if (json)
+    {
+        bench_print_json(stdout, "bench_suite", results, result_count);
+    }
+    else
+    {
+        bench_print_table(stdout, results, result_count);
+    }
+    return 0;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file bench/bench_wav.c
+ * @brief Streaming throughput of the memory-mapped WAV reader
+ *
+ * Writes a large stereo file in each supported encoding to the temp
+ * directory, then streams every file through audio_wav_decode() into a
+ * 256-frame chunk the way the decoder thread does, once into s16 stereo and
+ * once into f32 stereo. Files already in the output format take the memcpy
+ * path; the rest are converted per sample. Reports MB/s of file data and
+ * frames/s for the fastest of BENCH_PASSES passes (page cache warm).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "audio_logger.h"
+#include "audio_wav.h"
+#include "bench_common.h"
+
+#define BENCH_FRAMES (8u << 20)                      // Frames per file (~32-64 MB of stereo data)
+#define BENCH_CHANNELS 2
+#define BENCH_PASSES 3                               // Passes per case; the fastest is reported
+#define BENCH_CHUNK_FRAMES 256
+
+typedef struct {
+    audio_wav_encoding_t encoding;
+    uint16_t format_tag;                             // WAVE_FORMAT_PCM or WAVE_FORMAT_IEEE_FLOAT
+    uint16_t bits;
+} bench_file_t;
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static bool write_file(const char *path, const bench_file_t *file)
+{
+    uint32_t sample_bytes = file->bits / 8;
+    uint32_t block_align = BENCH_CHANNELS * sample_bytes;
+    uint32_t data_len = BENCH_FRAMES * block_align;
+    uint8_t header[44];
+
+    memcpy(header, "RIFF", 4);
+    put_u32(header + 4, 36 + data_len);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put_u32(header + 16, 16);
+    put_u16(header + 20, file->format_tag);
+    put_u16(header + 22, BENCH_CHANNELS);
+    put_u32(header + 24, 48000);
+    put_u32(header + 28, 48000 * block_align);
+    put_u16(header + 32, (uint16_t)block_align);
+    put_u16(header + 34, file->bits);
+    memcpy(header + 36, "data", 4);
+    put_u32(header + 40, data_len);
+
+    FILE *out = fopen(path, "wb");
+    if (out == NULL)
+    {
+        return false;
+    }
+    fwrite(header, 1, sizeof(header), out);
+
+    uint8_t block[4096 * 8];
+    uint32_t per_block = sizeof(block) / block_align;
+    uint32_t phase = 0;
+    for (uint32_t written = 0; written < BENCH_FRAMES; written += per_block)
+    {
+        uint32_t frames = (BENCH_FRAMES - written < per_block) ? BENCH_FRAMES - written : per_block;
+        uint8_t *p = block;
+        for (uint32_t i = 0; i < frames * BENCH_CHANNELS; i++, p += sample_bytes)
+        {
+            int32_t v = (int32_t)((phase++ * 2654435761u) >> 8) - (1 << 23);   // Noise in 24-bit range
+            if (file->format_tag == 3)
+            {
+                float f = (float)v / 8388608.0f;
+                memcpy(p, &f, sizeof(f));
+            }
+            else if (file->bits == 24)
+            {
+                p[0] = (uint8_t)v;
+                p[1] = (uint8_t)(v >> 8);
+                p[2] = (uint8_t)(v >> 16);
+            }
+            else
+            {
+                put_u16(p, (uint16_t)(v >> 8));
+            }
+        }
+        fwrite(block, 1, (size_t)frames * block_align, out);
+    }
+    return fclose(out) == 0;
+}
+
+// Streams the whole file into one chunk buffer; returns ns for the pass
+static uint64_t stream_file(const char *path, const audio_pcm_config_t *out, void *samples)
+{
+    audio_wav_t wav;
+    if (!audio_wav_open(&wav, path))
+    {
+        return 0;
+    }
+    uint64_t start = bench_now_ns();
+    uint64_t frame = 0;
+    uint32_t frames;
+    while ((frames = audio_wav_decode(&wav, frame, out->frames_per_chunk, out, samples)) > 0)
+    {
+        frame += frames;
+        BENCH_KEEP(samples);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    audio_wav_close(&wav);
+    return elapsed;
+}
+
+int main(void)
+{
+    static const bench_file_t files[] = {
+        { AUDIO_WAV_PCM16, 1, 16 },
+        { AUDIO_WAV_PCM24, 1, 24 },
+        { AUDIO_WAV_F32,   3, 32 },
+    };
+    static const audio_sample_format_t outputs[] = { AUDIO_SAMPLE_S16, AUDIO_SAMPLE_F32 };
+    static float samples[BENCH_CHUNK_FRAMES * BENCH_CHANNELS];
+    const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+
+    log_set_runtime_level(LOG_SEVERITY_NONE);
+    printf("%u frames x %d ch per file, %d-frame chunks\n", BENCH_FRAMES, BENCH_CHANNELS, BENCH_CHUNK_FRAMES);
+    printf("%-8s %-6s %-8s %12s %16s\n", "file", "output", "path", "MB/s", "frames/sec");
+
+    for (size_t f = 0; f < sizeof(files) / sizeof(files[0]); f++)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/bench_wav_%d.wav", dir, (int)getpid());
+        if (!write_file(path, &files[f]))
+        {
+            fprintf(stderr, "Cannot write %s\n", path);
+            return 1;
+        }
+        double mb = (double)BENCH_FRAMES * BENCH_CHANNELS * (files[f].bits / 8) / (1024.0 * 1024.0);
+
+        for (size_t o = 0; o < sizeof(outputs) / sizeof(outputs[0]); o++)
+        {
+            audio_pcm_config_t out = { outputs[o], BENCH_CHANNELS, BENCH_CHUNK_FRAMES, 48000 };
+            uint64_t best = UINT64_MAX;
+            for (int pass = 0; pass < BENCH_PASSES; pass++)
+            {
+                uint64_t ns = stream_file(path, &out, samples);
+                if (ns > 0 && ns < best)
+                {
+                    best = ns;
+                }
+            }
+            bool copy = (files[f].encoding == AUDIO_WAV_PCM16 && outputs[o] == AUDIO_SAMPLE_S16) ||
+                        (files[f].encoding == AUDIO_WAV_F32 && outputs[o] == AUDIO_SAMPLE_F32);
+            printf("%-8s %-6s %-8s %12.0f %16.0f\n", audio_wav_encoding_name(files[f].encoding),
+                   audio_pcm_format_name(outputs[o]), copy ? "memcpy" : "convert",
+                   mb * 1e9 / (double)best, (double)BENCH_FRAMES * 1e9 / (double)best);
+        }
+        unlink(path);
+    }
+    return 0;
+}
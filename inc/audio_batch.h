@@ -0,0 +1,50 @@
+/**
+ * @file inc/audio_batch.h
+ * @brief Batch Script Mode Header
+ *
+ * Replays a command script without prompts: the file is memory-mapped, split
+ * into lines in place and every line is dispatched straight from the mapping.
+ * A compiled script (see audio_command_binary.h) is recognized by its header
+ * and dispatched by opcode instead.
+ */
+
+#ifndef AUDIO_BATCH_H
+#define AUDIO_BATCH_H
+
+#include <stddef.h>
+
+/**
+ * @brief Result of a batch run.
+ */
+typedef struct {
+    size_t commands;                        // Number of lines dispatched
+    double seconds;                         // Wall-clock time spent dispatching
+} audio_batch_result_t;
+
+/**
+ * @brief Runs every command of a script file.
+ *
+ * Blank lines are skipped and an "exit" line ends the run early, matching the
+ * interactive loop. Delayed commands ("after") that come due are run between
+ * lines, and the run waits for the ones still pending once the script ends;
+ * that wait is not part of the timing. A summary with commands/sec is logged
+ * at the end.
+ *
+ * @param path Path of the script file.
+ * @param result Receives the counters; may be NULL.
+ * @return 0 on success, -1 if the file could not be mapped.
+ */
+int run_command_script(const char *path, audio_batch_result_t *result);
+
+/**
+ * @brief Finds the next newline in a byte range.
+ *
+ * Uses a 16-byte SSE2 compare where available and a scalar scan otherwise.
+ *
+ * @param p Start of the range.
+ * @param end One past the end of the range.
+ * @return Pointer to the newline, or @p end if there is none.
+ */
+const char *find_next_newline(const char *p, const char *end);
+
+#endif // AUDIO_BATCH_H
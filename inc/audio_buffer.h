@@ -1,6 +1,14 @@
 /**
  * @file inc/audio_buffer.h
  * @brief Audio Buffer Header
+ *
+ * A contiguous byte ring of length-prefixed records of any size, for one
+ * thread (see audio_spsc_ring.h for a ring shared by two threads). Each
+ * record is a u32 length and its bytes, padded to AUDIO_RECORD_ALIGN. A
+ * record never wraps: when it does not fit before the end of the ring, a
+ * padding marker fills the rest and the record starts at offset 0, so every
+ * record is written and read in place. Small commands and large chunks share
+ * the same bytes; the ring is full only when the bytes run out.
  */
 
 
@@ -8,24 +16,59 @@
 #define AUDIO_BUFFER_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-#define AUDIO_BUFFER_SIZE 256                                                          // Define the size of the audio buffer
-#define AUDIO_BUFFER_CAPACITY 10                                                       // Define the maximum number of audio commands in the buffer
+#define AUDIO_BUFFER_DEFAULT_BYTES 2048                                                // Default ring size in bytes
+#define AUDIO_BUFFER_MIN_BYTES 64                                                      // Smallest ring accepted
+#define AUDIO_RECORD_ALIGN 4                                                           // Records start on this boundary
+#define AUDIO_RECORD_HEADER 4                                                          // u32 length in front of every record
+#define AUDIO_RECORD_WRAP UINT32_MAX                                                   // Length marking padding up to the end of the ring
+#define AUDIO_RECORD_BYTES(len) ((AUDIO_RECORD_HEADER + (size_t)(len) + AUDIO_RECORD_ALIGN - 1) & ~(size_t)(AUDIO_RECORD_ALIGN - 1))  // Ring bytes a record takes
+#define AUDIO_BUFFER_VIEW_CELLS 16                                                     // Cells drawn by the byte ring view
+#define AUDIO_VIEW_MAX_SLOTS 512                                                       // Slots drawn by the buffer view
+#define AUDIO_VIEW_REPORT_SIZE (128 + AUDIO_VIEW_MAX_SLOTS * 8)                        // Fill line plus a full view, in bytes
 
 typedef struct{
-    char audio_buffer_chunks[AUDIO_BUFFER_CAPACITY][AUDIO_BUFFER_SIZE];                // Array to hold audio commands
-    int buffer_head;                                                                   // Index of the next command to be added
-    int buffer_tail;                                                                   // Index of the next command to be processed
-    int buffer_count;                                                                  // Current number of commands in the buffer
+    uint8_t *data;                                                                     // Ring storage
+    size_t capacity;                                                                   // Bytes of storage (a power of two)
+    size_t head;                                                                       // Byte offset of the front record (free-running)
+    size_t tail;                                                                       // Byte offset of the next record (free-running)
+    size_t records;                                                                    // Records queued
+    size_t payload;                                                                    // Bytes of record data queued
 } audio_buffer_t;
 
+typedef struct {
+    size_t records;                                                                    // Records queued
+    size_t payload_bytes;                                                              // Bytes of record data
+    size_t used_bytes;                                                                 // Ring bytes taken, headers and padding included
+    size_t capacity_bytes;                                                             // Ring size
+} audio_buffer_fill_t;
 
-void init_audio_buffer(audio_buffer_t *aud_buffer);                                    // Initialize the audio buffer
-bool enqueue_audio_command(audio_buffer_t *aud_buffer, const char *command);           // Add a command to the buffer
-bool dequeue_audio_command(audio_buffer_t *aud_buffer, char *command);                 // Remove a command from the buffer
+typedef struct {
+    int count;                                                                         // Occupied slots
+    int capacity;                                                                      // Total slots
+    int head;                                                                          // Front slot index
+    int tail;                                                                          // Next free slot index
+} audio_ring_view_t;
+
+
+bool init_audio_buffer(audio_buffer_t *aud_buffer, size_t capacity_bytes);           // Allocate the ring (rounded up to a power of two)
+void free_audio_buffer(audio_buffer_t *aud_buffer);                                    // Release the ring storage
+void *reserve_audio_record(audio_buffer_t *aud_buffer, size_t len);                    // Space for a record of up to len bytes, or NULL
+void commit_audio_record(audio_buffer_t *aud_buffer, size_t len);                      // Queue the reserved record with its final length
+bool enqueue_audio_record(audio_buffer_t *aud_buffer, const void *data, size_t len);   // Copy a record into the ring
+bool enqueue_audio_command(audio_buffer_t *aud_buffer, const char *command);           // Queue a command's text as a record
+const void *peek_audio_record(const audio_buffer_t *aud_buffer, size_t *len);          // Front record in place, or NULL when empty
+void release_audio_record(audio_buffer_t *aud_buffer);                                 // Drop the front record
+bool dequeue_audio_command(audio_buffer_t *aud_buffer, char *command, size_t size);    // Copy the front record out as a string and drop it
 bool is_audio_buffer_empty(const audio_buffer_t *aud_buffer);                          // Check if the buffer is empty
-bool is_audio_buffer_full(const audio_buffer_t *aud_buffer);                           // Check if the buffer is full
-void reset_audio_buffer(audio_buffer_t *aud_buffer);                                   // Reset the audio buffer
-void print_audio_buffer_state(const audio_buffer_t *aud_buffer);                       // Print the contents of the audio buffer
+bool audio_buffer_fits(const audio_buffer_t *aud_buffer, size_t len);                  // Whether a record of len bytes fits now
+audio_buffer_fill_t audio_buffer_fill(const audio_buffer_t *aud_buffer);               // Fill in records and bytes
+void reset_audio_buffer(audio_buffer_t *aud_buffer);                                   // Drop every record
+void print_audio_buffer_state(const audio_buffer_t *aud_buffer);                       // Print the fill and the byte view of the buffer
+void print_audio_buffer_view(int count, int capacity, int head, int tail);             // Print the slot view shared by all rings
+size_t render_audio_buffer_view(char *out, size_t size, int count, int capacity, int head, int tail);  // Render the slot view into a string
+void print_audio_ring_report(const char *label, int count, int capacity, int head, int tail);  // Print fill line and view in one write
 
 #endif // AUDIO_BUFFER_H
\ No newline at end of file
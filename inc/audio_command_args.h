@@ -0,0 +1,92 @@
+/**
+ * @file inc/audio_command_args.h
+ * @brief Typed Command Arguments Header
+ *
+ * A command registered with register_command_typed() declares a schema: one
+ * spec per argument, each an int with a range, a float, a duration, a path
+ * or one word of a fixed set. The dispatcher parses the argument span once
+ * into an aud_args_t on its own stack, and only calls the handler if every
+ * argument is valid; otherwise it logs why and the usage line.
+ *
+ * Arguments are separated by spaces. A path that is the last argument takes
+ * the rest of the line, so it may contain spaces. Durations are a number and
+ * a unit (ns, us, ms or s, e.g. 12.5s or 2000ms); a bare number is in
+ * milliseconds. Parsing never allocates.
+ */
+
+#ifndef AUDIO_COMMAND_ARGS_H
+#define AUDIO_COMMAND_ARGS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "audio_command_processor.h"
+
+#define AUD_ARGS_MAX 4                                                                 // Most arguments a schema declares
+
+typedef enum {
+    AUD_ARG_INT,                                                                       // Signed integer in [min, max]
+    AUD_ARG_FLOAT,                                                                     // Decimal number in [min, max]
+    AUD_ARG_DURATION,                                                                  // Time span, stored in ns, in [min, max] ns
+    AUD_ARG_PATH,                                                                      // Non-empty word (the rest of the line if last)
+    AUD_ARG_ENUM,                                                                      // One of choices; stored as its index
+} aud_arg_type_t;
+
+typedef struct {
+    const char *name;                                                                  // Shown in error messages
+    aud_arg_type_t type;
+    bool optional;                                                                     // May be left out (trailing arguments only)
+    double min;                                                                        // Range of numbers; min == max == 0 is unbounded
+    double max;
+    const char *const *choices;                                                        // Enum words, NULL-terminated
+} aud_arg_spec_t;
+
+struct aud_arg_schema {
+    const aud_arg_spec_t *args;                                                        // Argument specs, in order
+    size_t count;                                                                      // Number of specs (at most AUD_ARGS_MAX)
+    const char *usage;                                                                 // Usage line printed on a parse error
+};
+
+typedef union {
+    int64_t i;                                                                         // AUD_ARG_INT
+    double f;                                                                          // AUD_ARG_FLOAT
+    int64_t ns;                                                                        // AUD_ARG_DURATION
+    aud_slice_t path;                                                                  // AUD_ARG_PATH (points into the command line)
+    int choice;                                                                        // AUD_ARG_ENUM
+} aud_arg_value_t;
+
+struct aud_args {
+    size_t count;                                                                      // Arguments given (optional ones may be missing)
+    aud_arg_value_t v[AUD_ARGS_MAX];                                                   // Parsed values, in schema order
+};
+
+typedef struct {
+    const char *reason;                                                                // What is wrong
+    const char *arg;                                                                   // Name of the argument at fault ("" for the line)
+} aud_args_error_t;
+
+// Spec initializers for schema tables
+#define AUD_ARG_INT_SPEC(label, lo, hi)       { (label), AUD_ARG_INT, false, (lo), (hi), NULL }
+#define AUD_ARG_FLOAT_SPEC(label, lo, hi)     { (label), AUD_ARG_FLOAT, false, (lo), (hi), NULL }
+#define AUD_ARG_DURATION_SPEC(label, lo, hi)  { (label), AUD_ARG_DURATION, false, (lo), (hi), NULL }
+#define AUD_ARG_PATH_SPEC(label)              { (label), AUD_ARG_PATH, false, 0, 0, NULL }
+#define AUD_ARG_ENUM_SPEC(label, words)       { (label), AUD_ARG_ENUM, false, 0, 0, (words) }
+#define AUD_ARG_OPTIONAL_PATH_SPEC(label)     { (label), AUD_ARG_PATH, true, 0, 0, NULL }
+#define AUD_ARG_OPTIONAL_ENUM_SPEC(label, words) { (label), AUD_ARG_ENUM, true, 0, 0, (words) }
+
+/**
+ * @brief Parses an argument span against a schema.
+ *
+ * @param schema The command's schema.
+ * @param text The argument span (not terminated).
+ * @param out Receives the values.
+ * @param error Receives the first problem (static strings); may be NULL.
+ * @return true if every argument is valid.
+ */
+bool aud_args_parse(const aud_arg_schema_t *schema, aud_slice_t text, aud_args_t *out, aud_args_error_t *error);
+
+bool aud_parse_int(const char *p, size_t len, int64_t *out);                          // Optional sign, decimal digits
+bool aud_parse_float(const char *p, size_t len, double *out);                         // [sign] digits [. digits] [e exp]
+bool aud_parse_duration(const char *p, size_t len, int64_t *out_ns);                  // Number and unit (ns, us, ms, s)
+
+#endif // AUDIO_COMMAND_ARGS_H
@@ -0,0 +1,80 @@
+/**
+ * @file inc/audio_command_binary.h
+ * @brief Compiled Command Script Header
+ *
+ * A compiled script replaces each text line with a record that is dispatched
+ * by opcode, so a replay never scans, hashes or compares a command name.
+ *
+ * Layout (all integers little endian):
+ *
+ *   header  "ACB1" | u16 version | u16 opcode count | u32 fingerprint | u32 records
+ *   record  u16 size | u16 opcode | size - 2 bytes of arguments
+ *   typed   u16 size | u16 opcode + 0x8000 | u8 count | count x 8-byte values | arguments
+ *
+ * The opcode count and fingerprint identify the command set the script was
+ * compiled against (see command_opcode_fingerprint()); a replay refuses a
+ * script from another set. Arguments are stored as the bytes after the
+ * command name and are handed to the handler in place, straight from the
+ * mapping. A command with an argument schema (see audio_command_args.h) is
+ * parsed by the compiler and written as a typed record: the replay rebuilds
+ * its values with no parsing at all. A path value is stored as its offset
+ * and length within the argument bytes. A line naming no known command is kept as an
+ * AUD_BINARY_OPCODE_UNKNOWN record holding the whole line, so a replay logs
+ * the same warning the text dispatch would.
+ */
+
+#ifndef AUDIO_COMMAND_BINARY_H
+#define AUDIO_COMMAND_BINARY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define AUD_BINARY_MAGIC "ACB1"                                                        // First four bytes of a compiled script
+#define AUD_BINARY_VERSION 2                                                           // 2 added typed records; 1 still replays
+#define AUD_BINARY_HEADER_BYTES 16
+#define AUD_BINARY_RECORD_BYTES 4                                                      // Size and opcode before the arguments
+#define AUD_BINARY_OPCODE_UNKNOWN 0xFFFFu                                              // Not a registered command
+#define AUD_BINARY_TYPED 0x8000u                                                       // Opcode flag: the arguments are pre-parsed
+#define AUD_BINARY_ARGS_MAX (0xFFFFu - 2)                                              // Longest argument span a record holds
+
+typedef struct {
+    size_t records;                                                                    // Records written
+    size_t typed;                                                                      // Records with pre-parsed arguments
+    size_t unknown;                                                                    // Lines kept as unknown commands
+    size_t skipped;                                                                    // Lines too long to encode
+    size_t bytes;                                                                      // Size of the compiled script
+} aud_binary_compile_result_t;
+
+/**
+ * @brief Compiles a command script to the binary format.
+ *
+ * Lines are split like the batch mode does: blank lines are skipped, CRLF is
+ * accepted and an "exit" line ends the script. The command table must be
+ * frozen.
+ *
+ * @param text The script text.
+ * @param len Length of @p text.
+ * @param out Receives the compiled script.
+ * @param result Receives the counters; may be NULL.
+ * @return false if the table is not frozen or a write failed.
+ */
+bool aud_binary_compile(const char *text, size_t len, FILE *out, aud_binary_compile_result_t *result);
+
+/**
+ * @brief Tells whether a buffer starts with a compiled script header.
+ */
+bool aud_binary_is_script(const void *data, size_t size);
+
+/**
+ * @brief Dispatches every record of a compiled script.
+ *
+ * @param data The compiled script, header included.
+ * @param size Length of @p data.
+ * @return Records dispatched, or -1 if the header does not match the frozen
+ *         command set or a record is truncated.
+ */
+long aud_binary_replay(const void *data, size_t size);
+
+#endif // AUDIO_COMMAND_BINARY_H
@@ -0,0 +1,161 @@
+/**
+ * @file inc/audio_command_hash.h
+ * @brief Frozen perfect-hash command table
+ *
+ * A command table is built once from the registered command names and is then
+ * read-only. Lookups cost one hash pass over the input (fused with the search
+ * for the name delimiter), one displacement load and one name compare.
+ *
+ * Construction uses "hash and displace": every name hashes to a bucket, and
+ * each bucket stores a small displacement that moves its names to free slots.
+ */
+
+#ifndef AUDIO_COMMAND_HASH_H
+#define AUDIO_COMMAND_HASH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "audio_command_processor.h"
+
+#define AUD_COMMAND_SLOT_EMPTY_LEN UINT32_MAX    // name_len of an empty slot: no scanned name is this long
+
+/**
+ * @brief Initializer of an empty slot.
+ *
+ * Empty slots have no name and a length no lookup can produce, so a name that
+ * hashes to one (including the empty name of a line starting with a space)
+ * is never matched to the slot's missing handler.
+ */
+#define AUD_COMMAND_SLOT_EMPTY { .command_name = NULL, .name_len = AUD_COMMAND_SLOT_EMPTY_LEN }
+
+/**
+ * @brief One slot of the frozen table.
+ */
+typedef struct {
+    const char *command_name;                   // Name of the command (NULL for an empty slot)
+    uint32_t name_len;                          // Length of the command name
+    command_handler_t handler;                  // Legacy handler invoked for the command
+    command_slice_handler_t slice_handler;      // Slice handler invoked for the command
+    const aud_arg_schema_t *schema;             // Argument schema of a typed command, or NULL
+#ifdef AUDIO_COMMAND_STATS
+    audio_command_stats_t *stats;               // Statistics of the command (NULL in generated tables)
+#endif
+} aud_command_slot_t;
+
+/**
+ * @brief Frozen, collision-free command table.
+ *
+ * May be produced at runtime by build_command_hash() or emitted as static
+ * data by tools/gen_command_table.c.
+ */
+typedef struct {
+    uint32_t seed;                              // Seed of the key hash
+    uint32_t slot_mask;                         // Slot count - 1 (slot count is a power of two)
+    uint32_t bucket_count;                      // Number of displacement buckets
+    const uint16_t *displacements;              // Displacement per bucket
+    const aud_command_slot_t *slots;            // Contiguous slot array
+} aud_command_hash_t;
+
+/**
+ * @brief Hashes a command name and finds where it ends.
+ *
+ * Scans @p text until a space or the end of the span, hashing the bytes on
+ * the way.
+ *
+ * @param text The command line (or bare name) to hash.
+ * @param len Length of @p text.
+ * @param seed The table seed.
+ * @param out_len Receives the length of the name.
+ * @return The 64-bit hash of the name.
+ */
+static inline uint64_t command_hash_scan(const char *text, size_t len, uint32_t seed, size_t *out_len)
+{
+    uint64_t h = 0xcbf29ce484222325ULL ^ seed;                  // FNV-1a offset basis, seeded
+    const char *p = text;
+    const char *end = text + len;
+    while (p < end && *p != ' ')
+    {
+        h ^= (unsigned char)*p++;
+        h *= 0x100000001b3ULL;                                  // FNV-1a prime
+    }
+    *out_len = (size_t)(p - text);
+    h ^= h >> 29;                                               // Finalize so the high bits mix
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ * @brief Maps a key hash to its slot index.
+ */
+static inline uint32_t command_hash_slot(const aud_command_hash_t *table, uint64_t h)
+{
+    uint32_t bucket = (uint32_t)(h >> 32) % table->bucket_count;
+    uint32_t f1 = (uint32_t)h;
+    uint32_t f2 = (uint32_t)(h >> 17) | 1u;
+    return (f1 + (uint32_t)table->displacements[bucket] * f2) & table->slot_mask;
+}
+
+/**
+ * @brief Looks up a command by the name at the start of a line.
+ *
+ * @param table The frozen table.
+ * @param line The command line; the name ends at the first space.
+ * @param len Length of @p line.
+ * @param out_len Receives the length of the name.
+ * @return The matching slot or NULL if the name is not in the table.
+ */
+static inline const aud_command_slot_t *command_hash_lookup(const aud_command_hash_t *table,
+                                                            const char *line, size_t len, size_t *out_len)
+{
+    uint64_t h = command_hash_scan(line, len, table->seed, out_len);
+    const aud_command_slot_t *slot = &table->slots[command_hash_slot(table, h)];
+    if (*out_len == 0 || slot->command_name == NULL)                 // Empty name (leading space) or empty slot
+    {
+        return NULL;
+    }
+    if (slot->name_len == *out_len && memcmp(slot->command_name, line, *out_len) == 0)
+    {
+        return slot;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Builds a frozen table from a list of commands.
+ *
+ * Duplicate names keep the first occurrence in @p entries. The arrays of the
+ * result are heap allocated and must be released with free_command_hash().
+ *
+ * @param entries The commands to place.
+ * @param count Number of entries.
+ * @param table Receives the frozen table.
+ * @return true on success; false on allocation failure, more than 2^24
+ *         entries, or no placement within 8 slots per entry.
+ */
+bool build_command_hash(const aud_command_slot_t *entries, size_t count, aud_command_hash_t *table);
+
+/**
+ * @brief Releases a table produced by build_command_hash().
+ */
+void free_command_hash(aud_command_hash_t *table);
+
+/**
+ * @brief Installs a prebuilt, statically allocated command table.
+ *
+ * Used with tables generated at compile time by tools/gen_command_table.c.
+ * The processor does not free an installed table.
+ *
+ * The table is checked first: every slot must be either empty
+ * (AUD_COMMAND_SLOT_EMPTY) or hold a named command with a handler, and a
+ * command with a schema must have a slice handler. A table that fails the
+ * check is refused and the current one stays active.
+ *
+ * @param table The table to dispatch through.
+ * @return true if the table was installed.
+ */
+bool install_command_table(const aud_command_hash_t *table);
+
+#endif // AUDIO_COMMAND_HASH_H
@@ -6,7 +6,10 @@
 #ifndef COMMAND_PROCESSOR_H
 #define COMMAND_PROCESSOR_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include "audio_stats.h"
 
 /**
  * @brief Command handler function type
@@ -17,15 +20,57 @@
 typedef void (*command_handler_t)(const char *command);
 
 /**
- * @brief Audio command node structure
+ * @brief Non-owning view of a byte range.
  *
- * This structure represents a node in the linked list of audio commands.
+ * Points into the caller's input buffer; it is not NUL-terminated and is only
+ * valid for the duration of the handler call.
  */
-typedef struct aud_command_node{
-    const char* command_name;               // Name of the command being processed
-    command_handler_t handler;              // Pointer to the command handler function
-    struct aud_command_node *next;          // Pointer to the next command node in the linked list
-} aud_command_node_t;
+typedef struct {
+    const char *ptr;                        // First byte of the range
+    size_t len;                             // Number of bytes in the range
+} aud_slice_t;
+
+// printf helpers for slices: printf("%.*s", AUD_SLICE_ARG(s))
+#define AUD_SLICE_ARG(s) (int)(s).len, (s).ptr
+
+typedef struct aud_arg_schema aud_arg_schema_t;   // Argument schema (see audio_command_args.h)
+typedef struct aud_args aud_args_t;               // Parsed arguments (see audio_command_args.h)
+
+/**
+ * @brief A tokenized command line.
+ *
+ * Both spans point straight into the input buffer handed to dispatch.
+ */
+typedef struct {
+    aud_slice_t name;                       // Command name
+    aud_slice_t args;                       // Everything after the first space (may be empty)
+    const aud_args_t *values;               // Parsed arguments of a typed command, NULL otherwise
+} aud_command_line_t;
+
+/**
+ * @brief Slice-based command handler function type
+ *
+ * Receives the command name and argument span without any copy of the input.
+ */
+typedef void (*command_slice_handler_t)(const aud_command_line_t *line);
+
+/**
+ * @brief Outcome of dispatching one line.
+ */
+typedef enum {
+    AUD_DISPATCH_OK,                        // The handler ran
+    AUD_DISPATCH_EMPTY,                     // Nothing to dispatch
+    AUD_DISPATCH_UNKNOWN,                   // No such command
+    AUD_DISPATCH_BAD_ARGS,                  // Arguments rejected; the handler did not run
+} aud_dispatch_status_t;
+
+/**
+ * @brief Callback run after each dispatched command, on the dispatching thread.
+ *
+ * Sees every command that reached a handler (or was rejected by its argument
+ * schema), from any input path. Unknown commands are not observed.
+ */
+typedef void (*command_observer_t)(const aud_command_line_t *line, aud_dispatch_status_t status);
 
 /**
  * @brief Dispatches a command to the appropriate handler.
@@ -37,21 +82,126 @@ typedef struct aud_command_node{
  */
 void dispatch_command(const char *audio_command);
 
+/**
+ * @brief Dispatches a command given as a slice of an input buffer.
+ *
+ * The line does not need to be NUL-terminated and is never copied for slice
+ * handlers. Legacy handlers receive a terminated copy of the arguments only
+ * when the line itself is not terminated.
+ *
+ * @param line Start of the command line.
+ * @param len Length of the command line, without any newline.
+ * @return How the line was handled (the error itself is logged).
+ */
+aud_dispatch_status_t dispatch_command_slice(const char *line, size_t len);
+
+/**
+ * @brief Installs the command observer.
+ *
+ * @param observer Called after every dispatched command; NULL removes it.
+ */
+void set_command_observer(command_observer_t observer);
+
 /**
  * @brief Registers a command with its handler.
  *
- * This function creates a new command node and adds it to the command linked list.
+ * The name is copied into the registry's string pool, so the caller's string
+ * need not outlive the call. Registering a name again replaces its handler.
+ * Registration is refused once the registry is sealed.
  *
  * @param command_name The name of the command to register.
  * @param handler The function to handle the command.
  */
 void register_command(const char *command_name, command_handler_t handler);
 
+/**
+ * @brief Registers a command with a slice-based handler.
+ *
+ * @param command_name The name of the command to register.
+ * @param handler The function to handle the command.
+ */
+void register_command_slice(const char *command_name, command_slice_handler_t handler);
+
+/**
+ * @brief Registers a slice handler with an argument schema.
+ *
+ * Dispatch parses the arguments against @p schema before calling the
+ * handler, which finds them in line->values; invalid arguments are reported
+ * and the handler is not called.
+ *
+ * @param command_name The name of the command to register.
+ * @param schema The argument schema; must outlive the registry.
+ * @param handler The function to handle the command.
+ */
+void register_command_typed(const char *command_name, const aud_arg_schema_t *schema, command_slice_handler_t handler);
+
+/**
+ * @brief Seals the registered commands into a read-only perfect-hash table.
+ *
+ * Call once after all commands are registered. The commands, the hash table
+ * and the interned names are copied into one mapping that is then made
+ * read-only, so dispatch is safe from any thread and costs one hash and one
+ * compare regardless of the number of commands. The registry stays sealed
+ * until free_command_processor(); later registrations are rejected.
+ *
+ * @return true if the registry is sealed.
+ */
+bool freeze_command_processor(void);
+
+/**
+ * @brief Returns the opcode of a command name.
+ *
+ * Opcodes number the frozen commands in name order, so they only change
+ * when the set of command names changes.
+ *
+ * @param name The command name (not terminated).
+ * @param len Length of the name.
+ * @return The opcode, or -1 if the name is unknown or the registry is not sealed.
+ */
+int command_opcode(const char *name, size_t len);
+
+/**
+ * @brief Returns the number of opcodes (0 while not sealed).
+ */
+size_t command_opcode_count(void);
+
+/**
+ * @brief Returns a hash of the sealed command names.
+ *
+ * Stored in compiled scripts so a replay can tell that its opcodes match.
+ */
+uint32_t command_opcode_fingerprint(void);
+
+/**
+ * @brief Dispatches a command by opcode, with no name lookup.
+ *
+ * @param opcode The command's opcode.
+ * @param args The arguments; not terminated, valid for the call only.
+ * @return false if the opcode is out of range.
+ */
+bool dispatch_command_opcode(uint32_t opcode, aud_slice_t args);
+
+/**
+ * @brief Dispatches a typed command by opcode with arguments parsed earlier.
+ *
+ * @param opcode The command's opcode.
+ * @param args The argument text, passed to the handler as is.
+ * @param values The arguments, already checked against the command's schema.
+ * @return false if the opcode is out of range.
+ */
+bool dispatch_command_opcode_parsed(uint32_t opcode, aud_slice_t args, const aud_args_t *values);
+
+/**
+ * @brief Returns the argument schema of an opcode, or NULL if it has none.
+ */
+const aud_arg_schema_t *command_opcode_schema(uint32_t opcode);
+
 /**
  * @brief Frees the resources used by the command processor.
  *
- * This function traverses the command linked list and frees each node.
- * It should be called when the command processor is no longer needed.
+ * Releases the sealed registry in one call (or the staged commands if it was
+ * never sealed). It should be called when the command processor is no longer
+ * needed.
  */
 void free_command_processor(void);
 
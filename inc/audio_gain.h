@@ -0,0 +1,59 @@
+/**
+ * @file inc/audio_gain.h
+ * @brief Gain Stage Header
+ *
+ * Applies a linear gain to interleaved PCM samples in place. The kernel is
+ * chosen once at runtime from the best instruction set the CPU supports
+ * (AVX2, SSE2 or scalar). Results saturate: int16 samples clamp to
+ * [-32768, 32767] and float samples clamp to [-1, 1]. Unity gain returns
+ * without touching the samples and zero gain only clears them.
+ *
+ * A gain ramp moves the gain per frame, linearly or exponentially, from its
+ * current value to a target over a number of frames. The ramp kernels keep
+ * one gain per vector lane and advance all of them with one multiply-add per
+ * vector; once the ramp ends, chunks go back to the constant-gain kernels.
+ */
+
+#ifndef AUDIO_GAIN_H
+#define AUDIO_GAIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "audio_pcm.h"
+
+#define AUDIO_RAMP_FLOOR 0.001f                                                        // -60 dB: exponential ramps start and end here instead of 0
+
+typedef enum {
+    AUDIO_ISA_SCALAR,                                                                  // Portable C loop
+    AUDIO_ISA_SSE2,                                                                    // 128-bit x86 vectors
+    AUDIO_ISA_AVX2,                                                                    // 256-bit x86 vectors
+    AUDIO_ISA_COUNT,
+} audio_isa_t;
+
+typedef enum {
+    AUDIO_RAMP_LINEAR,                                                                 // Equal gain steps per frame
+    AUDIO_RAMP_EXPONENTIAL,                                                            // Equal ratio (dB) steps per frame
+} audio_ramp_curve_t;
+
+typedef struct {
+    float gain;                                                                        // Gain of the next frame
+    float target;                                                                      // Gain once the ramp ends
+    float mul;                                                                         // Per frame: gain = gain * mul + add
+    float add;
+    uint64_t frames;                                                                   // Frames left in the ramp (0: steady)
+} audio_gain_ramp_t;
+
+audio_isa_t audio_gain_detect_isa(void);                                              // Best ISA supported by this CPU
+audio_isa_t audio_gain_active_isa(void);                                              // ISA of the kernels in use
+void audio_gain_select_isa(audio_isa_t isa);                                          // Force a kernel variant (falls back if unsupported)
+const char *audio_isa_name(audio_isa_t isa);                                          // Printable ISA name
+
+void audio_gain_apply_s16(int16_t *samples, size_t count, float gain);                // Scale int16 samples in place
+void audio_gain_apply_f32(float *samples, size_t count, float gain);                  // Scale float samples in place
+void audio_gain_apply_chunk(audio_pcm_chunk_t *chunk, const audio_pcm_config_t *config, float gain);  // Scale one PCM chunk in place
+void audio_gain_ramp_set(audio_gain_ramp_t *ramp, float gain);                        // Jump to a gain, ending any ramp
+void audio_gain_ramp_start(audio_gain_ramp_t *ramp, float target, uint32_t frames, audio_ramp_curve_t curve);  // Ramp to target over frames
+float audio_gain_ramp_apply_chunk(audio_gain_ramp_t *ramp, audio_pcm_chunk_t *chunk, const audio_pcm_config_t *config);  // Ramp or steady gain; returns the end gain
+float audio_gain_from_volume(int volume, int muted);                                  // Map volume 0-100 and mute to a linear gain
+
+#endif // AUDIO_GAIN_H
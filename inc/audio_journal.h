@@ -0,0 +1,81 @@
+/**
+ * @file inc/audio_journal.h
+ * @brief Command Journal and State Snapshot Header
+ *
+ * An optional write-ahead journal that lets a restart pick up the audio
+ * state where the last run left it, instead of at volume 50, unmuted and
+ * stopped.
+ *
+ * Every dispatched command that changes the process-wide state is appended
+ * to a memory-mapped, append-only file as a CRC32C-checked record holding
+ * the command line and the packed state it produced. Commands that only read
+ * (help, stats, volumeGet, ...) and commands run by sessions are not
+ * journaled. A flush thread makes appends durable in groups: it waits for
+ * the commit window, then one fdatasync() covers every record appended
+ * meanwhile. With durable set, an append returns only once its group is on
+ * disk; otherwise a crash can lose at most the last window.
+ *
+ * Every snapshot_every records (and on a clean close) the state and the
+ * playback ring metadata are written to <path>.snap (written aside, synced,
+ * renamed into place), and the journal restarts empty after it. Opening the
+ * journal loads the snapshot and replays only the records after it, through
+ * the normal dispatcher with logging silenced; each replayed record's stored
+ * state is checked against the state the replay produced. Replay stops at
+ * the first torn or corrupt record. Playback itself is not resumed: the
+ * pipeline is not running yet when the journal is replayed, so the playing
+ * flag is cleared once replay ends.
+ *
+ *   journal   "AJN1" | u32 version | u64 first sequence | 12 reserved | u32 crc
+ *   record    u32 crc | u32 length | u64 sequence | u32 state | u32 0 | command, padded to 8
+ *   snapshot  "ASN1" | u32 version | u64 last sequence | u32 state | ring view | u32 crc
+ *
+ * Numbers are little-endian; record CRCs cover everything after the CRC.
+ */
+
+#ifndef AUDIO_JOURNAL_H
+#define AUDIO_JOURNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AUDIO_JOURNAL_VERSION 1
+#define AUDIO_JOURNAL_HEADER_BYTES 32                                                  // File header
+#define AUDIO_JOURNAL_RECORD_BYTES 24                                                  // Record header, before the command
+#define AUDIO_JOURNAL_GROW_BYTES (1u << 20)                                            // File and mapping grow in these steps
+#define AUDIO_JOURNAL_COMMIT_NS 2000000ULL                                             // Default group commit window
+#define AUDIO_JOURNAL_SNAPSHOT_EVERY 4096                                              // Default records between snapshots
+
+typedef struct {
+    const char *path;                                                                  // Journal file; the snapshot is <path>.snap
+    uint64_t commit_interval_ns;                                                       // Group commit window (0: sync as soon as possible)
+    size_t snapshot_every;                                                             // Records between snapshots (0: only on close)
+    bool durable;                                                                      // An append waits until its group is synced
+} audio_journal_config_t;
+
+typedef struct {
+    bool snapshot_loaded;                                                              // A valid snapshot was found
+    uint64_t snapshot_sequence;                                                        // Last sequence the snapshot covers
+    uint64_t replayed;                                                                 // Journal records replayed after it
+    uint64_t corrected;                                                                // Replays whose state differed from the record
+    bool torn_tail;                                                                    // Replay stopped at a torn or corrupt record
+    double seconds;                                                                    // Time to load and replay
+} audio_journal_recovery_t;
+
+typedef struct {
+    uint64_t records;                                                                  // Records appended since open
+    uint64_t bytes;                                                                    // Journal bytes appended since open
+    uint64_t syncs;                                                                    // fdatasync() calls (group commits)
+    uint64_t largest_group;                                                            // Most records made durable by one sync
+    uint64_t snapshots;                                                                // Snapshots written
+    uint64_t sequence;                                                                 // Last sequence appended
+} audio_journal_stats_t;
+
+void audio_journal_default_config(audio_journal_config_t *config);                    // Defaults: 2 ms window, snapshot every 4096
+bool audio_journal_open(const audio_journal_config_t *config, audio_journal_recovery_t *recovery);  // Recover, then journal new commands
+bool audio_journal_snapshot(void);                                                     // Snapshot now and restart the journal
+void audio_journal_close(void);                                                        // Snapshot, sync and unmap
+audio_journal_stats_t audio_journal_stats(void);                                       // Counters since open
+uint32_t audio_crc32c(uint32_t crc, const void *data, size_t len);                     // CRC32C (SSE4.2 when available)
+
+#endif // AUDIO_JOURNAL_H
@@ -0,0 +1,137 @@
+/**
+ * @file inc/audio_log_binary.h
+ * @brief Binary (deferred formatting) log format
+ *
+ * In binary mode a log call stores the format-string pointer, a timestamp and
+ * the raw arguments; nothing is formatted. Every format string is written once
+ * as a definition record the first time it is used, so tools/audio_log_decode.c
+ * can turn the file back into text offline.
+ *
+ * File layout: the 8-byte magic followed by records. Every record starts with
+ * a one-byte tag:
+ *  - LOG_BINARY_TAG_FORMAT: uint64 format id, uint32 length, format bytes
+ *  - LOG_BINARY_TAG_RECORD: uint64 format id, uint64 timestamp (ns), uint8 level,
+ *    uint16 payload length, payload (the encoded arguments)
+ *
+ * Arguments are encoded in format-string order: integers, pointers and
+ * doubles as 8 bytes, strings as a uint16 length and the bytes.
+ */
+
+#ifndef AUDIO_LOG_BINARY_H
+#define AUDIO_LOG_BINARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LOG_BINARY_MAGIC "ACPLOG1"                                                     // 8 bytes including the NUL
+#define LOG_BINARY_TAG_FORMAT 'F'                                                      // Format string definition
+#define LOG_BINARY_TAG_RECORD 'R'                                                      // Log record
+#define LOG_BINARY_MAX_STRING 1024                                                     // Longest string argument kept
+
+typedef enum {
+    LOG_ARG_NONE,                                                                      // Literal text or %%
+    LOG_ARG_INT,                                                                       // int and smaller
+    LOG_ARG_INT64,                                                                     // long, long long, size_t, intmax_t, ptrdiff_t
+    LOG_ARG_PTR,                                                                       // %p
+    LOG_ARG_DOUBLE,                                                                    // float and double
+    LOG_ARG_STRING,                                                                    // %s
+} log_arg_kind_t;
+
+typedef struct {
+    const char *start;                                                                 // The '%' of the conversion
+    const char *end;                                                                   // One past the conversion character
+    log_arg_kind_t kind;                                                               // Argument consumed by the conversion
+    int star_count;                                                                    // '*' width/precision int arguments before it
+    int precision_star;                                                                // Whether the precision is '*'
+} log_spec_t;
+
+/**
+ * @brief Finds the next conversion in a format string.
+ *
+ * @param p Current position in the format string.
+ * @param spec Receives the conversion.
+ * @return true if a conversion was found, false at the end of the string.
+ */
+static inline int log_next_spec(const char *p, log_spec_t *spec)
+{
+    while (*p != '\0')
+    {
+        if (*p != '%')
+        {
+            p++;
+            continue;
+        }
+
+        spec->start = p++;
+        spec->star_count = 0;
+        spec->precision_star = 0;
+        if (*p == '%')
+        {
+            spec->kind = LOG_ARG_NONE;
+            spec->end = p + 1;
+            return 1;
+        }
+
+        while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+        {
+            p++;
+        }
+        if (*p == '*')
+        {
+            spec->star_count++;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9')
+        {
+            p++;
+        }
+        if (*p == '.')
+        {
+            p++;
+            if (*p == '*')
+            {
+                spec->star_count++;
+                spec->precision_star = 1;
+                p++;
+            }
+            while (*p >= '0' && *p <= '9')
+            {
+                p++;
+            }
+        }
+
+        int wide = 0;
+        while (*p == 'h' || *p == 'l' || *p == 'L' || *p == 'z' || *p == 'j' || *p == 't' || *p == 'q')
+        {
+            if (*p == 'l' || *p == 'z' || *p == 'j' || *p == 't' || *p == 'q')
+            {
+                wide = 1;
+            }
+            p++;
+        }
+
+        switch (*p)
+        {
+            case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+                spec->kind = wide ? LOG_ARG_INT64 : LOG_ARG_INT;
+                break;
+            case 'p':
+                spec->kind = LOG_ARG_PTR;
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                spec->kind = LOG_ARG_DOUBLE;
+                break;
+            case 's':
+                spec->kind = LOG_ARG_STRING;
+                break;
+            default:
+                spec->kind = LOG_ARG_NONE;                                             // Unsupported: printed literally
+                break;
+        }
+        spec->end = (*p != '\0') ? p + 1 : p;
+        return 1;
+    }
+    return 0;
+}
+
+#endif // AUDIO_LOG_BINARY_H
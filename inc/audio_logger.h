@@ -9,6 +9,9 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 /**
  * @brief Log levels for the audio command processor.
  *
@@ -32,10 +35,113 @@ typedef enum {
  */
 void log_message(log_level_t level, const char *format, ...);
 
+/**
+ * @brief What an asynchronous log call does when the queue is full.
+ */
+typedef enum {
+    LOG_OVERFLOW_DROP,                      // Discard the record and count it
+    LOG_OVERFLOW_BLOCK,                     // Wait until the flush thread frees a slot
+} log_overflow_policy_t;
+
+/**
+ * @brief Switches logging to asynchronous mode.
+ *
+ * Log calls then render the message into a slot of a lock-free multi-producer
+ * queue and return; a dedicated flush thread adds the level prefix and writes
+ * records to stdout in large batched write() calls. Output written directly
+ * with printf is not ordered with respect to queued records.
+ *
+ * @param policy What to do when the queue is full.
+ * @return true if the flush thread is running.
+ */
+bool log_start_async(log_overflow_policy_t policy);
+
+/**
+ * @brief Waits until every record queued before the call has been written.
+ */
+void log_flush(void);
+
+/**
+ * @brief Flushes the queue, stops the flush thread and returns to synchronous logging.
+ *
+ * Reports the number of dropped records, if any. Safe while other threads
+ * are logging: log calls made after the stop begins write synchronously, and
+ * the queue is freed only once the calls already queuing have finished.
+ * free_command_processor() calls this on shutdown.
+ */
+void log_stop_async(void);
+
+/**
+ * @brief Returns the number of records dropped by the overflow policy.
+ */
+uint64_t log_dropped_count(void);
+
+/**
+ * @brief Switches logging to binary deferred-formatting mode.
+ *
+ * Log calls then store the format-string pointer, a monotonic timestamp and
+ * the raw arguments in a compact in-memory buffer that is appended to @p path
+ * when it fills up and on log_stop_binary(). No text is formatted; decode the
+ * file with tools/audio_log_decode.c. See audio_log_binary.h for the layout.
+ *
+ * @param path File that receives the binary log.
+ * @return true if the file was opened.
+ */
+bool log_start_binary(const char *path);
+
+/**
+ * @brief Writes buffered binary records, closes the file and returns to text logging.
+ */
+void log_stop_binary(void);
+
+/**
+ * @brief Severities used for filtering.
+ *
+ * INPUT echoes are informational, so they share the INFO severity.
+ */
+#define LOG_SEVERITY_INFO    0
+#define LOG_SEVERITY_WARNING 1
+#define LOG_SEVERITY_ERROR   2
+#define LOG_SEVERITY_NONE    3
+
+/**
+ * @brief Compile-time minimum severity.
+ *
+ * Calls below it are removed by the compiler, arguments included
+ * (e.g. build with -DAUDIO_LOG_MIN_LEVEL=LOG_SEVERITY_WARNING).
+ */
+#ifndef AUDIO_LOG_MIN_LEVEL
+#define AUDIO_LOG_MIN_LEVEL LOG_SEVERITY_INFO
+#endif
+
+/**
+ * @brief Runtime minimum severity, checked before any argument is evaluated.
+ *
+ * Set with log_set_runtime_level(); a plain int so the check is one load.
+ */
+extern int log_runtime_level;
+
+/**
+ * @brief Sets the runtime minimum severity.
+ *
+ * @param severity One of the LOG_SEVERITY_* values.
+ */
+void log_set_runtime_level(int severity);
+
+// Whether output at a severity passes the compile-time and runtime filters
+#define LOG_ENABLED(severity) ((severity) >= AUDIO_LOG_MIN_LEVEL && (severity) >= log_runtime_level)
+
+// Filters a log call at compile time and at runtime before evaluating its arguments
+#define LOG_AT(severity, level, fmt, ...)                                        \
+    do {                                                                         \
+        if (LOG_ENABLED(severity))                                               \
+            log_message(level, fmt, ##__VA_ARGS__);                              \
+    } while (0)
+
 // Logging macros for convenience
-#define LOG_INFO(fmt, ...)    log_message(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
-#define LOG_WARNING(fmt, ...) log_message(LOG_LEVEL_WARNING, fmt, ##__VA_ARGS__)
-#define LOG_ERROR(fmt, ...)   log_message(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
-#define LOG_INPUT(fmt, ...)   log_message(LOG_LEVEL_INPUT, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)    LOG_AT(LOG_SEVERITY_INFO, LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_WARNING(fmt, ...) LOG_AT(LOG_SEVERITY_WARNING, LOG_LEVEL_WARNING, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...)   LOG_AT(LOG_SEVERITY_ERROR, LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_INPUT(fmt, ...)   LOG_AT(LOG_SEVERITY_INFO, LOG_LEVEL_INPUT, fmt, ##__VA_ARGS__)
 
 #endif // LOGGER_H
\ No newline at end of file
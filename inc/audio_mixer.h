@@ -0,0 +1,99 @@
+/**
+ * @file inc/audio_mixer.h
+ * @brief Multi-Stream Mixer Header
+ *
+ * Plays up to AUDIO_MIXER_MAX_STREAMS streams next to the main play queue.
+ * Every stream has its own PCM ring and gain. A feeder thread decodes each
+ * stream (a WAV file or a sine tone) into its ring; the playback thread pulls
+ * one chunk per stream per period and mixes them into one output chunk.
+ *
+ * Mixing accumulates into a float buffer (acc += sample * gain) and
+ * saturates once on the way out, with SSE2/AVX2 kernels picked from the same
+ * ISA as the gain stage. The cost is one accumulate pass per live stream, so
+ * it grows linearly with the stream count.
+ *
+ * A stream slot moves through FREE -> CLAIMED -> OPENING -> ACTIVE -> ENDED ->
+ * FREE, or to STOPPING -> DRAINED -> FREE when stopped. Commands only claim free slots
+ * and request stops; the feeder owns the source and the producer side of the
+ * ring; the consumer (audio_mixer_live() and audio_mixer_mix()) discards and
+ * frees slots, so a ring is never reset while either side is using it.
+ */
+
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "audio_pcm.h"
+#include "audio_wav.h"
+
+#define AUDIO_MIXER_MAX_STREAMS 128                                                    // Streams played at once
+#define AUDIO_MIXER_STREAM_CHUNKS 8                                                    // Chunks buffered per stream
+#define AUDIO_MIXER_SOURCE_MAX 128                                                     // Longest stream source accepted
+#define AUDIO_MIXER_GAIN_MAX 2.0f                                                      // Largest per-stream gain
+
+typedef enum {
+    AUDIO_STREAM_FREE,                                                                 // Slot unused
+    AUDIO_STREAM_CLAIMED,                                                              // A command is filling in the slot
+    AUDIO_STREAM_OPENING,                                                              // Claimed; the feeder opens the source
+    AUDIO_STREAM_ACTIVE,                                                               // Feeding and mixing
+    AUDIO_STREAM_ENDED,                                                                // Source finished; mixing what is queued
+    AUDIO_STREAM_STOPPING,                                                             // Stop requested; the feeder releases the source
+    AUDIO_STREAM_DRAINED,                                                              // Source released; the consumer frees the slot
+} audio_stream_state_t;
+
+typedef struct {
+    atomic_int state;                                                                  // audio_stream_state_t
+    _Atomic float gain;                                                                // Linear gain applied while mixing
+    _Atomic int64_t seek_frame;                                                        // Frame to decode from next (-1: none)
+    char source[AUDIO_MIXER_SOURCE_MAX];                                               // WAV path, or a tone frequency in Hz
+
+    // Feeder side
+    audio_pcm_ring_t ring;                                                             // Decoded chunks waiting to be mixed
+    bool ring_ready;                                                                   // Ring allocated (kept for reuse)
+    audio_wav_t wav;                                                                   // Open file, when not a tone
+    double tone_hz;                                                                    // Tone frequency (0 for a file)
+    uint64_t next_frame;                                                               // Next frame to decode
+
+    // Consumer side
+    uint64_t chunks_mixed;                                                             // Chunks mixed since the stream started
+    uint64_t underruns;                                                                // Periods the stream had no chunk ready
+} audio_mix_stream_t;
+
+typedef struct {
+    audio_pcm_config_t config;                                                         // Format of every chunk
+    float *accumulator;                                                                // frames_per_chunk * channels floats
+    audio_pcm_chunk_t *scratch;                                                        // Output chunk when there is no base chunk
+    uint32_t scratch_sequence;                                                         // Periods mixed into the scratch chunk
+    pthread_t feeder;                                                                  // Decodes into the stream rings
+    atomic_bool feeder_running;                                                        // Cleared to stop the feeder
+    bool feeder_started;
+    audio_mix_stream_t streams[AUDIO_MIXER_MAX_STREAMS];
+} audio_mixer_t;
+
+bool audio_mixer_init(audio_mixer_t *mixer, const audio_pcm_config_t *config);        // Allocate the mix buffers
+void audio_mixer_free(audio_mixer_t *mixer);                                           // Release rings and buffers (feeder stopped)
+bool audio_mixer_start_feeder(audio_mixer_t *mixer);                                   // Start the feeder thread
+void audio_mixer_stop_feeder(audio_mixer_t *mixer);                                    // Join the feeder thread
+size_t audio_mixer_feed(audio_mixer_t *mixer);                                         // One feeder pass; returns chunks decoded
+
+int audio_mixer_add_stream(audio_mixer_t *mixer, const char *source, size_t len, float gain);  // Claim a slot; returns the stream id or -1
+bool audio_mixer_stop_stream(audio_mixer_t *mixer, int id);                           // Request a stop
+void audio_mixer_stop_all(audio_mixer_t *mixer);                                       // Request a stop of every stream
+bool audio_mixer_set_gain(audio_mixer_t *mixer, int id, float gain);                   // Change a stream's gain
+bool audio_mixer_seek(audio_mixer_t *mixer, int id, uint64_t frame);                   // Continue a stream from another frame
+bool audio_mixer_idle(audio_mixer_t *mixer);                                           // Every slot is free
+
+unsigned audio_mixer_live(audio_mixer_t *mixer);                                       // Consumer: free finished slots, count streams to mix
+audio_pcm_chunk_t *audio_mixer_mix(audio_mixer_t *mixer, audio_pcm_chunk_t *base, float master);  // Consumer: mix one period; returns the chunk to play
+void print_audio_mixer_streams(audio_mixer_t *mixer);                                  // Print every claimed stream
+
+void audio_mix_accumulate_s16(float *acc, const int16_t *in, size_t count, float gain);  // acc += in * gain
+void audio_mix_accumulate_f32(float *acc, const float *in, size_t count, float gain);    // acc += in * gain
+void audio_mix_store_s16(int16_t *out, const float *acc, size_t count, float gain);      // out = saturate(acc * gain)
+void audio_mix_store_f32(float *out, const float *acc, size_t count, float gain);        // out = clamp(acc * gain, -1, 1)
+
+#endif // AUDIO_MIXER_H
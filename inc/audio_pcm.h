@@ -0,0 +1,69 @@
+/**
+ * @file inc/audio_pcm.h
+ * @brief PCM Frame Ring Header
+ *
+ * Typed PCM chunks on top of audio_spsc_ring_t. Each slot holds a small chunk
+ * header followed by interleaved samples. Producers decode straight into the
+ * slot returned by audio_pcm_acquire_write() and consumers process samples in
+ * place between audio_pcm_acquire_read() and audio_pcm_release_read(), so a
+ * chunk is never copied on its way through the ring.
+ */
+
+#ifndef AUDIO_PCM_H
+#define AUDIO_PCM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "audio_spsc_ring.h"
+
+#define AUDIO_PCM_DEFAULT_CAPACITY 16                                                  // Default chunks held by the ring
+#define AUDIO_PCM_DEFAULT_FRAMES 256                                                   // Default frames per chunk
+#define AUDIO_PCM_DEFAULT_CHANNELS 2                                                   // Default interleaved channels
+#define AUDIO_PCM_DEFAULT_RATE 48000                                                   // Default sample rate in Hz
+
+typedef enum {
+    AUDIO_SAMPLE_S16,                                                                  // Signed 16-bit integer samples
+    AUDIO_SAMPLE_F32,                                                                  // 32-bit float samples in [-1, 1]
+} audio_sample_format_t;
+
+typedef struct {
+    audio_sample_format_t format;                                                      // Sample type
+    uint32_t channels;                                                                 // Interleaved channels per frame
+    uint32_t frames_per_chunk;                                                         // Frame capacity of one chunk
+    uint32_t sample_rate;                                                              // Frames per second
+} audio_pcm_config_t;
+
+typedef struct {
+    uint32_t frames;                                                                   // Valid frames in the chunk
+    uint32_t generation;                                                               // Producer tag (e.g. flush generation)
+    uint32_t sequence;                                                                 // Chunk number within its stream
+    uint32_t reserved;                                                                 // Keeps the samples 16-byte aligned
+} audio_pcm_chunk_t;
+
+typedef struct {
+    audio_spsc_ring_t ring;                                                            // Slot storage and indices
+    audio_pcm_config_t config;                                                         // Format of every chunk
+    size_t frame_bytes;                                                                // Bytes per interleaved frame
+} audio_pcm_ring_t;
+
+
+size_t audio_pcm_sample_bytes(audio_sample_format_t format);                          // Bytes per sample
+const char *audio_pcm_format_name(audio_sample_format_t format);                      // Printable format name
+bool audio_pcm_ring_init(audio_pcm_ring_t *ring, size_t capacity, const audio_pcm_config_t *config);  // Allocate a PCM ring
+void audio_pcm_ring_free(audio_pcm_ring_t *ring);                                     // Release the ring storage
+audio_pcm_chunk_t *audio_pcm_acquire_write(audio_pcm_ring_t *ring);                   // Producer: chunk to decode into, NULL if full
+void audio_pcm_commit_write(audio_pcm_ring_t *ring, audio_pcm_chunk_t *chunk);        // Producer: publish chunk->frames frames
+audio_pcm_chunk_t *audio_pcm_acquire_read(audio_pcm_ring_t *ring);                    // Consumer: oldest chunk (writable in place), NULL if empty
+void audio_pcm_release_read(audio_pcm_ring_t *ring);                                  // Consumer: hand the chunk back
+void audio_pcm_fill_tone(audio_pcm_chunk_t *chunk, const audio_pcm_config_t *config, double hz, uint64_t first_frame);  // Fill a chunk with a sine tone
+
+/**
+ * @brief Returns the interleaved samples that follow a chunk header.
+ */
+static inline void *audio_pcm_samples(const audio_pcm_chunk_t *chunk)
+{
+    return (void *)(chunk + 1);
+}
+
+#endif // AUDIO_PCM_H
@@ -0,0 +1,65 @@
+/**
+ * @file inc/audio_pipeline.h
+ * @brief Audio Pipeline Header
+ *
+ * Runs a decoder (producer) thread and a playback (consumer) thread around an
+ * audio_pcm_ring_t. Command handlers only post requests to the pipeline; all
+ * chunk production and playback happens on the pipeline threads. Playback is
+ * paced at the stream's sample rate and goes to a sink (see audio_sink.h).
+ * Extra streams started through the mixer (see audio_mixer.h) are mixed
+ * with the main play queue. Files at another sample rate are converted to
+ * the output rate on the decoder thread (see audio_resampler.h).
+ */
+
+#ifndef AUDIO_PIPELINE_H
+#define AUDIO_PIPELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "audio_buffer.h"
+#include "audio_gain.h"
+#include "audio_pcm.h"
+#include "audio_resampler.h"
+#include "audio_sink.h"
+#include "audio_stats.h"
+
+#define AUDIO_PIPELINE_CHUNKS_PER_REQUEST 5                                            // Chunks produced per play request
+#define AUDIO_PIPELINE_RT_PRIORITY 70                                                  // SCHED_FIFO priority of the playback thread
+
+typedef struct {
+    size_t capacity;                                                                   // Chunks held by the pipeline ring
+    audio_pcm_config_t pcm;                                                            // Format and size of every chunk
+    const char *sink;                                                                  // Sink spec (NULL = "log")
+    bool realtime;                                                                     // mlockall() and SCHED_FIFO playback when permitted
+    audio_resample_quality_t resample_quality;                                         // Filter used for files at another rate
+} audio_pipeline_config_t;
+
+typedef struct {
+    uint64_t periods;                                                                  // Deadlines reached while streaming
+    uint64_t underruns;                                                                // Deadlines with an empty ring while decoding
+    uint64_t late_wakeups;                                                             // Wakeups more than half a period late
+    uint64_t resyncs;                                                                  // Timeline restarts after a whole period late
+    uint64_t max_lateness_ns;                                                          // Latest wakeup
+    size_t min_fill;                                                                   // Lowest ring fill at a deadline
+    uint32_t lateness[AUDIO_STATS_BUCKETS];                                            // Wakeup lateness histogram (ns)
+    uint32_t fill[AUDIO_STATS_BUCKETS];                                                // Ring fill histogram (chunks)
+} audio_playback_stats_t;
+
+void audio_pipeline_default_config(audio_pipeline_config_t *config);                  // Fill in the default ring geometry and format
+bool start_audio_pipeline(const audio_pipeline_config_t *config);                     // Start the decoder and playback threads (NULL = defaults)
+void stop_audio_pipeline(void);                                                        // Finish queued work and join both threads
+bool request_audio_playback(const char *source, size_t len);                           // Post a play request to the decoder
+bool request_audio_gain_ramp(float target, uint64_t duration_ns, audio_ramp_curve_t curve);  // Ramp to the next volume instead of jumping
+void flush_audio_pipeline(void);                                                       // Abort decoding and drop queued chunks
+void print_audio_pipeline_state(void);                                                 // Print the ring fill state
+bool audio_pipeline_ring_view(audio_ring_view_t *view);                                // Ring fill state for reporting; false if stopped
+int start_audio_stream(const char *source, size_t len, float gain);                    // Start a mixer stream; returns its id or -1
+bool stop_audio_stream(int id);                                                        // Stop a mixer stream
+bool set_audio_stream_gain(int id, float gain);                                        // Change a mixer stream's gain
+bool seek_audio_stream(int id, int64_t offset_ns);                                     // Move a mixer stream to an offset from its start
+void print_audio_streams(void);                                                        // Print every mixer stream
+void print_audio_playback_stats(void);                                                 // Print underruns, lateness and fill percentiles
+void reset_audio_playback_stats(void);                                                 // Clear the playback statistics
+
+#endif // AUDIO_PIPELINE_H
@@ -0,0 +1,43 @@
+/**
+ * @file inc/audio_report.h
+ * @brief Coalesced State Reporting Header
+ *
+ * Command handlers report "the state changed" instead of printing it. In
+ * immediate mode (the default) every report prints at once, as before. In
+ * coalesced mode a report only sets a dirty bit; audio_report_flush() prints
+ * each dirty view once, at the end of a batch or on a timer tick, and drops
+ * a report that is identical to the last one printed.
+ *
+ * Handlers running for a session (see audio_session.h) always print at once,
+ * since their state lives in the session and not in the process-wide view.
+ * Flushes happen on the dispatching thread.
+ */
+
+#ifndef AUDIO_REPORT_H
+#define AUDIO_REPORT_H
+
+#include <stdint.h>
+
+#define AUDIO_REPORT_TICK_NS 100000000ULL                                              // Coalesced reports are flushed at least this often
+#define AUDIO_REPORT_TICK_COMMANDS 1024                                                // Batch commands dispatched between tick checks
+
+typedef enum {
+    AUDIO_REPORT_IMMEDIATE,                                                            // Print every report (the default)
+    AUDIO_REPORT_COALESCED,                                                            // Mark dirty; print once per flush
+} audio_report_mode_t;
+
+typedef struct {
+    uint64_t requested;                                                                // Reports made by handlers
+    uint64_t emitted;                                                                  // Reports printed by a flush
+    uint64_t suppressed;                                                               // Flushed reports identical to the last one printed
+} audio_report_counters_t;
+
+void audio_report_set_mode(audio_report_mode_t mode);                                  // Select immediate or coalesced reporting
+audio_report_mode_t audio_report_mode(void);                                           // Current mode
+void audio_report_state(void);                                                         // The system status changed
+void audio_report_ring(void);                                                          // The playback ring changed
+void audio_report_flush(void);                                                         // Print the dirty views that differ from the last print
+void audio_report_tick(void);                                                          // Flush when a tick has passed since the last flush
+audio_report_counters_t audio_report_counters(void);                                   // Coalescing counters since startup
+
+#endif // AUDIO_REPORT_H
@@ -0,0 +1,68 @@
+/**
+ * @file inc/audio_resampler.h
+ * @brief Polyphase Sample-Rate Converter Header
+ *
+ * Converts a stream of interleaved float frames from one sample rate to
+ * another with a polyphase FIR. The ratio is reduced to out/in = L/M; the
+ * Kaiser-windowed sinc prototype is split into L phases of taps coefficients
+ * each, computed once at init, so every output sample is one dot product of
+ * taps input samples and one coefficient row. The low-pass cutoff follows
+ * the lower of the two Nyquist rates, so downsampling does not alias.
+ *
+ * The converter keeps the last taps input frames of every channel (planar)
+ * between calls, so a stream can be fed chunk by chunk with no seams and no
+ * allocation after init. Output is time-aligned with the input (no filter
+ * delay): the first output frame is centred on the first input frame.
+ *
+ * The dot-product kernel variant follows audio_gain_active_isa(), like the
+ * mixer. Rate pairs whose reduced L exceeds AUDIO_RESAMPLER_MAX_PHASES
+ * are refused.
+ */
+
+#ifndef AUDIO_RESAMPLER_H
+#define AUDIO_RESAMPLER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "audio_pcm.h"
+
+#define AUDIO_RESAMPLER_MAX_PHASES 1024                                                // Largest reduced output rate (e.g. 11025 -> 48000 is 640)
+
+typedef enum {
+    AUDIO_RESAMPLE_LOW,                                                                // 8 taps per phase
+    AUDIO_RESAMPLE_MEDIUM,                                                             // 16 taps per phase
+    AUDIO_RESAMPLE_HIGH,                                                               // 32 taps per phase
+    AUDIO_RESAMPLE_QUALITY_COUNT,
+} audio_resample_quality_t;
+
+typedef struct {
+    uint32_t in_rate;                                                                  // Input frames per second
+    uint32_t out_rate;                                                                 // Output frames per second
+    uint32_t phases;                                                                   // L: reduced output rate
+    uint32_t step;                                                                     // M: reduced input rate
+    uint32_t taps;                                                                     // Coefficients per phase (multiple of 8)
+    uint32_t channels;                                                                 // Interleaved channels per frame
+    uint32_t max_out;                                                                  // Most frames produced per call
+    uint32_t max_in;                                                                   // Most frames accepted per call
+    audio_resample_quality_t quality;
+    float *coeffs;                                                                     // phases x taps, row per phase
+    float *history;                                                                    // channels planes of stride frames
+    float *scratch;                                                                    // max_out x channels interleaved output
+    size_t stride;                                                                     // Frames per history plane
+    size_t count;                                                                      // Frames buffered in every plane
+    size_t start;                                                                      // First frame of the next output's window
+    uint32_t phase;                                                                    // Phase of the next output (0..phases-1)
+} audio_resampler_t;
+
+bool audio_resampler_init(audio_resampler_t *rs, uint32_t in_rate, uint32_t out_rate, uint32_t channels,
+                          uint32_t max_out, audio_resample_quality_t quality);          // Build the tables and history
+void audio_resampler_free(audio_resampler_t *rs);                                      // Release the tables and history
+void audio_resampler_reset(audio_resampler_t *rs);                                     // Start a new stream (clears the history)
+uint32_t audio_resampler_input_needed(const audio_resampler_t *rs, uint32_t out_frames);  // Input frames still needed for out_frames
+uint32_t audio_resampler_process(audio_resampler_t *rs, const float *in, uint32_t in_frames, uint32_t *consumed,
+                                 const audio_pcm_config_t *out_config, void *out, uint32_t out_frames);  // Feed input, produce output
+const char *audio_resample_quality_name(audio_resample_quality_t quality);            // Printable quality name
+bool audio_resample_quality_parse(const char *name, audio_resample_quality_t *quality);  // "low", "medium" or "high"
+
+#endif // AUDIO_RESAMPLER_H
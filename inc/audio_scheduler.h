@@ -0,0 +1,31 @@
+/**
+ * @file inc/audio_scheduler.h
+ * @brief Session Scheduler Header
+ *
+ * A fixed pool of worker threads runs sessions that have queued commands.
+ * Each worker owns a Chase-Lev work-stealing deque: a session rescheduled by
+ * a worker goes to the bottom of its own deque, idle workers steal from the
+ * top of other deques, and sessions scheduled from outside the pool go
+ * through a shared injection queue.
+ *
+ * A session is in the scheduler at most once (audio_session_t.scheduled), so
+ * it never runs on two workers at the same time and its commands keep their
+ * submission order.
+ */
+
+#ifndef AUDIO_SCHEDULER_H
+#define AUDIO_SCHEDULER_H
+
+#include <stdbool.h>
+#include "audio_session.h"
+
+#define AUDIO_SCHEDULER_MAX_WORKERS 64                                                 // Largest pool
+#define AUDIO_SCHEDULER_DEQUE_CAPACITY 1024                                            // Sessions per worker deque (power of two)
+
+bool audio_scheduler_start(unsigned workers);                                          // Start the pool (0 = one worker per online CPU)
+void audio_scheduler_stop(void);                                                       // Run every queued command, then join the workers
+void audio_scheduler_wait_idle(void);                                                  // Block until no session has queued commands
+void audio_scheduler_schedule(audio_session_t *session);                               // Hand a session with pending commands to the pool
+unsigned audio_scheduler_worker_count(void);                                           // Workers in the running pool
+
+#endif // AUDIO_SCHEDULER_H
@@ -0,0 +1,65 @@
+/**
+ * @file inc/audio_server.h
+ * @brief Unix Domain Socket Command Server Header
+ *
+ * Serves commands to many local control clients at once from one thread.
+ * The server listens on a Unix stream socket and runs a single epoll loop:
+ * every connection is non-blocking and has its own line buffer, so a read
+ * may carry any number of commands and a command may arrive split across
+ * reads. Each complete line is dispatched in place with
+ * dispatch_command_slice() and answered with one reply line:
+ *
+ *   ok
+ *   error unknown command
+ *   error invalid arguments
+ *   error empty command
+ *   error line too long
+ *
+ * Replies to every command of one read go back in a single send(). A client
+ * that stops reading its replies is not read from until they drain, so one
+ * slow client only holds its own queue. An "exit" line closes the
+ * connection. An idle connection costs its socket and about
+ * AUDIO_SERVER_LINE_MAX + 80 bytes of heap for its unfinished-line buffer.
+ *
+ * Handlers run on the server thread, so commands from every client are
+ * serialized exactly as they are from the terminal.
+ */
+
+#ifndef AUDIO_SERVER_H
+#define AUDIO_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AUDIO_SERVER_LINE_MAX 256                                                      // Longest command line, newline included
+#define AUDIO_SERVER_MAX_CONNECTIONS 4096                                              // Default limit of open connections
+#define AUDIO_SERVER_EVENTS 256                                                        // Events taken per epoll_wait()
+#define AUDIO_SERVER_REPLY_MAX 32                                                      // Longest reply line
+
+typedef struct {
+    const char *path;                                                                  // Socket path (replaced if it exists)
+    size_t max_connections;                                                            // Connections beyond this are refused
+} audio_server_config_t;
+
+typedef struct {
+    uint64_t accepted;                                                                 // Connections accepted
+    uint64_t refused;                                                                  // Connections closed at once: over the limit
+    uint64_t open;                                                                     // Connections open now
+    uint64_t peak;                                                                     // Most connections open at once
+    uint64_t commands;                                                                 // Lines dispatched
+    uint64_t errors;                                                                   // Lines answered with an error
+    uint64_t reads;                                                                    // Reads that returned data
+    uint64_t bytes_in;                                                                 // Command bytes received
+    uint64_t bytes_out;                                                                // Reply bytes sent
+    uint64_t stalled;                                                                  // Times a client's replies had to wait for it
+} audio_server_stats_t;
+
+void audio_server_default_config(audio_server_config_t *config);                      // Defaults: no path, AUDIO_SERVER_MAX_CONNECTIONS
+bool audio_server_open(const audio_server_config_t *config);                          // Bind, listen and create the event loop
+int audio_server_run(void);                                                            // Serve until audio_server_stop(); returns 0 or -1
+void audio_server_stop(void);                                                          // Ask the loop to return (async-signal-safe)
+void audio_server_close(void);                                                         // Close every connection and remove the socket
+audio_server_stats_t audio_server_stats(void);                                         // Counters (read on the server thread or after run)
+
+#endif // AUDIO_SERVER_H
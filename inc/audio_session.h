@@ -0,0 +1,61 @@
+/**
+ * @file inc/audio_session.h
+ * @brief Audio Session Header
+ *
+ * A session is one independent audio zone. It owns its audio state, a chunk
+ * buffer and a queue of commands waiting to run. Any thread may submit
+ * commands; the scheduler runs a session on one worker at a time, so the
+ * commands of a session execute in submission order and never concurrently.
+ *
+ * While a session runs, its worker is bound to it: command handlers see the
+ * session's state through snapshot_audio_state() and friends, and
+ * audio_session_current() returns it.
+ */
+
+#ifndef AUDIO_SESSION_H
+#define AUDIO_SESSION_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "audio_buffer.h"
+#include "audio_spsc_ring.h"
+#include "audio_systemState.h"
+
+#define AUDIO_SESSION_QUEUE_CAPACITY 64                                                // Commands queued per session (power of two)
+#define AUDIO_SESSION_COMMAND_MAX 120                                                  // Longest command line accepted
+#define AUDIO_SESSION_BATCH 32                                                         // Commands run before a session yields its worker
+#define AUDIO_SESSION_CHUNKS_PER_REQUEST 5                                             // Chunks queued by a play command
+#define AUDIO_SESSION_CHUNK_BYTES 1024                                                 // Byte ring holding a session's chunks
+
+typedef struct {
+    atomic_size_t sequence;                                                            // Cell turn: pos when free, pos + 1 when filled
+    uint32_t length;                                                                   // Bytes of command text
+    char text[AUDIO_SESSION_COMMAND_MAX];                                              // Command line (not terminated)
+} audio_session_cell_t;
+
+typedef struct audio_session {
+    uint32_t id;                                                                       // Caller-chosen session id
+    audio_state_cell_t state;                                                          // Volume and flags of this zone
+    audio_buffer_t chunks;                                                             // Chunks waiting to be played
+    uint64_t commands_run;                                                             // Commands executed (owned by the running worker)
+    uint64_t chunks_played;                                                            // Chunks drained from the buffer
+
+    _Alignas(AUDIO_CACHE_LINE) atomic_size_t enqueue_pos;                              // Next queue position claimed by a submitter
+    _Alignas(AUDIO_CACHE_LINE) size_t dequeue_pos;                                     // Next queue position run (worker only)
+    atomic_bool scheduled;                                                             // Queued on, or running in, the scheduler
+    struct audio_session *next_ready;                                                  // Link in the scheduler's injection queue
+    audio_session_cell_t queue[AUDIO_SESSION_QUEUE_CAPACITY];                          // Bounded multi-producer command queue
+} audio_session_t;
+
+audio_session_t *audio_session_create(uint32_t id);                                   // Allocate a session at the default state
+void audio_session_destroy(audio_session_t *session);                                 // Free an idle session
+bool audio_session_submit(audio_session_t *session, const char *line, size_t len);    // Queue a command and schedule the session
+size_t audio_session_run(audio_session_t *session, size_t max_commands);              // Run queued commands on the calling thread
+bool audio_session_has_pending(const audio_session_t *session);                       // Whether commands are waiting
+audio_session_t *audio_session_current(void);                                          // Session running on this thread, or NULL
+void audio_session_queue_chunks(audio_session_t *session, const char *source, size_t len);  // Queue the chunks of a play request
+void audio_session_flush_chunks(audio_session_t *session);                            // Drop queued chunks
+
+#endif // AUDIO_SESSION_H
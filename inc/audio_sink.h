@@ -0,0 +1,48 @@
+/**
+ * @file inc/audio_sink.h
+ * @brief Playback Sink Header
+ *
+ * A sink is where the playback thread sends each chunk once its deadline
+ * arrives. It is chosen by a spec string:
+ *
+ *   log            print one line per chunk (the default)
+ *   null           discard the samples (pacing and accounting only)
+ *   raw:<path>     append interleaved samples to a file
+ *   wav:<path>     write a WAV file; the header is completed on close
+ *   pipe:<command> write interleaved samples to a command's stdin
+ *
+ * A sink that fails to write logs one error and discards from then on, so a
+ * closed pipe never stops playback.
+ */
+
+#ifndef AUDIO_SINK_H
+#define AUDIO_SINK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "audio_pcm.h"
+
+typedef enum {
+    AUDIO_SINK_LOG,                                                                    // One printed line per chunk
+    AUDIO_SINK_NULL,                                                                   // Samples discarded
+    AUDIO_SINK_RAW,                                                                    // Raw interleaved samples in a file
+    AUDIO_SINK_WAV,                                                                    // WAV file
+    AUDIO_SINK_PIPE,                                                                   // Raw samples to a command's stdin
+} audio_sink_kind_t;
+
+typedef struct {
+    audio_sink_kind_t kind;                                                            // Where the samples go
+    audio_pcm_config_t config;                                                         // Format of every chunk written
+    FILE *out;                                                                         // File or pipe (NULL for log and null)
+    uint64_t frames_written;                                                           // Frames accepted, silence included
+    bool failed;                                                                       // A write failed; discarding from now on
+} audio_sink_t;
+
+bool audio_sink_open(audio_sink_t *sink, const char *spec, const audio_pcm_config_t *config);  // Open the sink described by spec
+void audio_sink_write(audio_sink_t *sink, const audio_pcm_chunk_t *chunk, float gain);         // Play one chunk (gain is only reported)
+void audio_sink_write_silence(audio_sink_t *sink, uint32_t frames);                    // Fill an underrun with silence
+void audio_sink_close(audio_sink_t *sink);                                             // Flush and close (completes a WAV header)
+const char *audio_sink_kind_name(audio_sink_kind_t kind);                              // Printable sink kind
+
+#endif // AUDIO_SINK_H
@@ -0,0 +1,59 @@
+/**
+ * @file inc/audio_spsc_ring.h
+ * @brief Lock-free Single-Producer/Single-Consumer Audio Ring Header
+ *
+ * Thread-safe counterpart of audio_buffer_t for one producer thread (the
+ * decoder) and one consumer thread (playback). Head and tail are free-running
+ * counters published with acquire/release atomics; there is no shared count.
+ * Each index lives on its own cache line together with the owner's cached copy
+ * of the other index, so the two threads only share a line when they have to.
+ *
+ * Slots can be filled and read in place with the acquire/commit and
+ * acquire/release pairs; push and pop are copying wrappers around them.
+ * Slot storage is cache-line aligned, so slots whose size is a multiple of
+ * AUDIO_CACHE_LINE are aligned for any vector width.
+ */
+
+#ifndef AUDIO_SPSC_RING_H
+#define AUDIO_SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "audio_buffer.h"
+
+#define AUDIO_CACHE_LINE 64                                                            // Cache line size used for padding
+
+typedef struct {
+    // Consumer cache line
+    _Alignas(AUDIO_CACHE_LINE) atomic_size_t head;                                     // Next slot to read (written by consumer)
+    size_t cached_tail;                                                                // Consumer's last observed tail
+
+    // Producer cache line
+    _Alignas(AUDIO_CACHE_LINE) atomic_size_t tail;                                     // Next slot to write (written by producer)
+    size_t cached_head;                                                                // Producer's last observed head
+
+    // Read-only after init
+    _Alignas(AUDIO_CACHE_LINE) size_t capacity;                                        // Number of slots (power of two)
+    size_t mask;                                                                       // capacity - 1
+    size_t slot_size;                                                                  // Bytes per slot
+    uint32_t *lengths;                                                                 // Payload length per slot
+    unsigned char *slots;                                                              // capacity * slot_size bytes
+} audio_spsc_ring_t;
+
+
+bool audio_spsc_ring_init(audio_spsc_ring_t *ring, size_t capacity, size_t slot_size);  // Allocate a ring (capacity rounded up to a power of two)
+void audio_spsc_ring_free(audio_spsc_ring_t *ring);                                    // Release the ring storage
+void *audio_spsc_ring_acquire_write(audio_spsc_ring_t *ring);                         // Producer: free slot to fill in place, NULL if full
+void audio_spsc_ring_commit_write(audio_spsc_ring_t *ring, size_t len);                // Producer: publish the acquired slot
+const void *audio_spsc_ring_acquire_read(audio_spsc_ring_t *ring, size_t *len);        // Consumer: oldest slot to read in place, NULL if empty
+void audio_spsc_ring_release_read(audio_spsc_ring_t *ring);                            // Consumer: hand the read slot back
+bool audio_spsc_ring_push(audio_spsc_ring_t *ring, const void *data, size_t len);      // Producer: copy one chunk in, false if full
+bool audio_spsc_ring_pop(audio_spsc_ring_t *ring, void *out, size_t *len);             // Consumer: copy one chunk out, false if empty
+size_t audio_spsc_ring_discard(audio_spsc_ring_t *ring);                               // Consumer: drop every queued chunk
+size_t audio_spsc_ring_count(const audio_spsc_ring_t *ring);                           // Approximate number of queued chunks
+audio_ring_view_t audio_spsc_ring_view(const audio_spsc_ring_t *ring);                // Fill state for reporting
+void print_audio_spsc_ring_state(const audio_spsc_ring_t *ring);                       // Print fill state with the buffer view
+
+#endif // AUDIO_SPSC_RING_H
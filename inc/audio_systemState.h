@@ -1,12 +1,32 @@
 /* Define the audio system header file
  * This file contains the declarations for the audio system functions and data structures.
+ *
+ * The state is packed into one 32-bit atomic word (flags, volume and a change
+ * counter). Readers take a consistent copy with snapshot_audio_state() and
+ * never block; every change is a single compare-and-swap of the whole word,
+ * so concurrent writers cannot lose updates or publish torn state.
+ *
+ * Each session owns an audio_state_cell_t. A thread bound to a cell with
+ * audio_state_bind() reads and changes that cell; unbound threads use the
+ * process-wide state.
  */
 
 #ifndef AUDIO_SYSTEM_H
 #define AUDIO_SYSTEM_H
 
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+#define AUDIO_VOLUME_MIN 0                                        // Lowest volume level
+#define AUDIO_VOLUME_MAX 100                                      // Highest volume level
+#define AUDIO_VOLUME_DEFAULT 50                                   // Volume after start-up and reset
+#define AUDIO_VOLUME_STEP 10                                      // Change applied by volumeUp/volumeDown
+
+#define AUDIO_FLAG_PLAYING 0x01u                                  // Flag mask: audio is playing
+#define AUDIO_FLAG_MUTED 0x02u                                    // Flag mask: audio is muted
+#define AUDIO_STATE_VALUE_BITS 0xFFFFu                            // Flags and volume of a packed word (the rest is the change counter)
+
 
 // Define Bitfield for audio system control
 typedef struct {
@@ -16,21 +36,42 @@ typedef struct {
 } audioFlags;
 
 
-// Complete audio system state
+// Complete audio system state (a decoded snapshot of the packed word)
 typedef struct {
     audioFlags flags;
     int volume;                // Volume level (0-100)
+    uint16_t generation;       // Bumped by every change (wraps)
 } audioState;
 
 
-// Audio system state instance
-audioState* get_audio_state(void);
+// One packed state word
+typedef struct {
+    _Atomic uint32_t word;
+} audio_state_cell_t;
+
+
+void audio_state_cell_init(audio_state_cell_t *cell);                  // Start a cell at the default state
+audio_state_cell_t *audio_state_bind(audio_state_cell_t *cell);        // Bind this thread to a cell (NULL = process-wide); returns the previous binding
+
+
+// Consistent copy of the current state; safe from any thread
+audioState snapshot_audio_state(void);
+
+// Atomic state transitions; each returns the state it published
+audioState audio_state_step_volume(int delta);                    // Add delta and clamp to 0-100
+audioState audio_state_set_volume(int volume);                    // Set the volume, clamped to 0-100
+audioState audio_state_set_flags(unsigned set, unsigned clear);   // Set, then clear, AUDIO_FLAG_* bits
+bool audio_state_start_playing(void);                             // Set playing unless muted; false if muted
+
+// Packed word access, for saving and restoring the state
+uint32_t audio_state_word(void);                                  // Current packed word
+void audio_state_restore(uint32_t word);                          // Publish a saved packed word
 
 
-// Utility audio state functions 
+// Utility audio state functions
 void reset_audio_system(void);
 void print_audio_state(void);
 
 
 
-#endif // AUDIO_SYSTEM_H
\ No newline at end of file
+#endif // AUDIO_SYSTEM_H
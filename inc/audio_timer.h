@@ -0,0 +1,88 @@
+/**
+ * @file inc/audio_timer.h
+ * @brief Hierarchical Timer Wheel Header
+ *
+ * Holds commands to run at a later time ("after 2s pause"). Pending commands
+ * sit in a hierarchical timer wheel of AUDIO_TIMER_LEVELS levels of
+ * AUDIO_TIMER_SLOTS slots with a tick of AUDIO_TIMER_TICK_NS: level 0 covers
+ * the next 64 ticks one slot per tick, each level above covers 64 times the
+ * span of the one below, and a single overflow list holds anything further
+ * out than the top level. A timer goes into the level of the highest 6-bit
+ * digit in which its expiry tick differs from the current tick, so insert is
+ * O(1); entries are linked into their slot by pool index in both directions,
+ * so cancel is O(1) too. When the current tick reaches the start of a higher
+ * level slot, that slot's entries are redistributed (cascaded) to the levels
+ * below; each timer is cascaded at most once per level.
+ *
+ * Advancing the wheel jumps from event tick to event tick (the next slot
+ * with entries, found from per-level occupancy bitmaps) instead of visiting
+ * every tick, so a wheel with a few far-away timers costs nothing while it
+ * waits. Expired timers move to a FIFO list from which the owner pops them
+ * one at a time.
+ *
+ * Timer ids carry the pool index plus one in the low 32 bits and the
+ * entry's generation, which changes whenever the entry is reused, in the
+ * high 32 bits (counted from 0), so cancelling a timer that already fired
+ * or was cancelled is detected. The first timers get ids 1, 2, 3, ...; an
+ * id is never 0.
+ *
+ * The audio_*_command functions keep one process-wide wheel on the monotonic
+ * clock, guarded by a mutex; the command loops (interactive, batch and
+ * server) run the due commands between input lines and bound their waits by
+ * audio_next_command_timeout_ms().
+ */
+
+#ifndef AUDIO_TIMER_H
+#define AUDIO_TIMER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AUDIO_TIMER_TICK_NS 1000000ULL                                                 // Wheel resolution: 1 ms
+#define AUDIO_TIMER_SLOT_BITS 6
+#define AUDIO_TIMER_SLOTS (1u << AUDIO_TIMER_SLOT_BITS)                                // Slots per level
+#define AUDIO_TIMER_LEVELS 4                                                           // Levels before the overflow list (64^4 ticks, ~4.6 h)
+#define AUDIO_TIMER_TEXT_MAX 104                                                       // Longest command a timer holds
+#define AUDIO_TIMER_INITIAL_ENTRIES 64                                                 // Pool size before the first growth
+
+typedef struct {
+    uint32_t next;                                                                     // Next entry in its list (pool index)
+    uint32_t prev;                                                                     // Previous entry in its list
+    uint32_t generation;                                                               // High half of the timer id
+    uint16_t list;                                                                     // List holding the entry
+    uint16_t len;                                                                      // Command length
+    uint64_t expiry;                                                                   // Tick the timer fires at
+    char text[AUDIO_TIMER_TEXT_MAX];                                                   // Command to run (not NUL-terminated)
+} audio_timer_entry_t;
+
+typedef struct {
+    audio_timer_entry_t *entries;                                                      // Entry pool, grown by doubling
+    uint32_t capacity;                                                                 // Entries in the pool
+    uint32_t free_head;                                                                // First unused entry
+    uint32_t *heads;                                                                   // First entry of every list
+    uint32_t *tails;                                                                   // Last entry of every list
+    uint64_t occupied[AUDIO_TIMER_LEVELS];                                             // Non-empty slots of every level
+    uint64_t start_ns;                                                                 // Time of tick 0
+    uint64_t now;                                                                      // Last tick processed
+    size_t pending;                                                                    // Timers not yet popped
+} audio_timer_wheel_t;
+
+bool audio_timer_wheel_init(audio_timer_wheel_t *wheel, uint64_t now_ns);             // Empty wheel whose tick 0 is now_ns
+void audio_timer_wheel_free(audio_timer_wheel_t *wheel);                               // Release the pool
+uint64_t audio_timer_wheel_schedule(audio_timer_wheel_t *wheel, uint64_t now_ns, uint64_t delay_ns,
+                                    const char *text, size_t len);                     // Add a timer; returns its id, 0 on failure
+bool audio_timer_wheel_cancel(audio_timer_wheel_t *wheel, uint64_t id);                // Drop a timer that has not fired
+void audio_timer_wheel_advance(audio_timer_wheel_t *wheel, uint64_t now_ns);           // Expire every timer due by now_ns
+bool audio_timer_wheel_pop(audio_timer_wheel_t *wheel, uint64_t *id, char *text, size_t *len);  // Take the oldest expired timer
+uint64_t audio_timer_wheel_next_ns(const audio_timer_wheel_t *wheel);                  // When to advance next (UINT64_MAX: never, 0: now)
+
+uint64_t audio_delay_command(uint64_t delay_ns, const char *text, size_t len);         // Run a command after delay_ns; returns its id, 0 on failure
+bool audio_cancel_command(uint64_t id);                                                // Drop a delayed command
+size_t audio_run_due_commands(void);                                                   // Dispatch every due command; returns how many ran
+int audio_next_command_timeout_ms(void);                                               // Wait bound for poll()/epoll_wait(): -1 if none pending
+size_t audio_pending_commands(void);                                                   // Delayed commands not yet run
+void audio_drain_delayed_commands(void);                                               // Sleep until every delayed command has run
+void audio_free_delayed_commands(void);                                                // Drop every delayed command and the wheel
+
+#endif // AUDIO_TIMER_H
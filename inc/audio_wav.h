@@ -0,0 +1,49 @@
+/**
+ * @file inc/audio_wav.h
+ * @brief Memory-Mapped WAV Reader Header
+ *
+ * Opens a RIFF/WAVE file by mapping it read-only and decodes frames straight
+ * from the mapping into the caller's chunk. PCM16, PCM24 and float32 data
+ * with any channel count are supported (including WAVE_FORMAT_EXTENSIBLE).
+ * When the file already has the output sample format and channel count, a
+ * chunk is one memcpy from the mapping; otherwise samples are converted on
+ * the way. The mapping is read with sequential readahead hints.
+ */
+
+#ifndef AUDIO_WAV_H
+#define AUDIO_WAV_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "audio_pcm.h"
+
+#define AUDIO_WAV_READAHEAD (2u << 20)                                                 // Bytes hinted ahead of the decode position
+
+typedef enum {
+    AUDIO_WAV_PCM16,                                                                   // 16-bit signed integer
+    AUDIO_WAV_PCM24,                                                                   // 24-bit signed integer, packed
+    AUDIO_WAV_F32,                                                                     // 32-bit IEEE float
+} audio_wav_encoding_t;
+
+typedef struct {
+    const uint8_t *map;                                                                // Whole-file mapping
+    size_t map_len;                                                                    // Bytes mapped
+    const uint8_t *data;                                                               // First byte of the sample data
+    uint64_t frames;                                                                   // Frames in the data chunk
+    uint32_t channels;                                                                 // Interleaved channels per frame
+    uint32_t sample_rate;                                                              // Frames per second
+    uint32_t block_align;                                                              // Bytes per frame
+    audio_wav_encoding_t encoding;                                                     // Sample encoding
+    size_t advised_end;                                                                // Data offset covered by readahead hints so far
+    bool mapped;                                                                       // Opened with audio_wav_open() (owns the mapping)
+} audio_wav_t;
+
+bool audio_wav_open(audio_wav_t *wav, const char *path);                              // Map and parse a file (never blocks on FIFOs or devices)
+bool audio_wav_parse(audio_wav_t *wav, const uint8_t *bytes, size_t len);             // Parse a RIFF image already in memory
+void audio_wav_close(audio_wav_t *wav);                                                // Unmap a file opened with audio_wav_open()
+uint32_t audio_wav_decode(audio_wav_t *wav, uint64_t first_frame, uint32_t max_frames,
+                          const audio_pcm_config_t *out, void *samples);               // Decode frames into out's format; returns frames written
+const char *audio_wav_encoding_name(audio_wav_encoding_t encoding);                    // Printable encoding name
+
+#endif // AUDIO_WAV_H
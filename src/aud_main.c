@@ -6,11 +6,22 @@
 * handling command input and processing.
  */
 
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include "audio_logger.h"
 #include "audio_command_processor.h"
+#include "audio_batch.h"
+#include "audio_journal.h"
+#include "audio_pipeline.h"
+#include "audio_report.h"
+#include "audio_server.h"
+#include "audio_timer.h"
 
 #define MAX_LINE_LENGTH 256                           // Maximum length of a command line
 
@@ -22,34 +33,296 @@
  */
 extern void register_audio_commands(void);
 
+/**
+ * @brief Prints the command line usage.
+ *
+ * @param program Name of the executable.
+ */
+static void print_usage(const char *program)
+{
+    printf("Usage: %s [options] [script]\n", program);
+    printf("  -c <chunks>   chunks held by the audio ring (default %d)\n", AUDIO_PCM_DEFAULT_CAPACITY);
+    printf("  -f <frames>   frames per chunk (default %d)\n", AUDIO_PCM_DEFAULT_FRAMES);
+    printf("  -n <channels> interleaved channels (default %d)\n", AUDIO_PCM_DEFAULT_CHANNELS);
+    printf("  -r <rate>     sample rate in Hz (default %d)\n", AUDIO_PCM_DEFAULT_RATE);
+    printf("  -s <s16|f32>  sample format (default s16)\n");
+    printf("  -l <mode>     logging: sync, async (drop when full) or async-block (default sync)\n");
+    printf("  -L <file>     write a binary log to <file> (decode with audio_log_decode)\n");
+    printf("  -V <level>    minimum log level: info, warning, error or none (default info)\n");
+    printf("  -o <sink>     playback sink: log, null, raw:<file>, wav:<file> or pipe:<command> (default log)\n");
+    printf("  -Q <quality>  resampling of files at another rate: low, medium or high (default medium)\n");
+    printf("  -R            lock memory and run playback under SCHED_FIFO when permitted\n");
+    printf("  -m <mode>     state reports: immediate or coalesced (once per batch/tick, repeats dropped)\n");
+    printf("  -S <path>     serve commands on a Unix socket instead of stdin (one reply line per command)\n");
+    printf("  -C <count>    most server connections open at once (default %d)\n", AUDIO_SERVER_MAX_CONNECTIONS);
+    printf("  -J <path>     journal state-changing commands to <path> and recover from it at startup\n");
+    printf("  -D            with -J, a command returns only once its journal record is on disk\n");
+}
+
+/**
+ * @brief Stops the server loop on SIGINT or SIGTERM.
+ */
+static void handle_stop_signal(int signo)
+{
+    (void)signo;
+    audio_server_stop();
+}
+
+/**
+ * @brief Serves commands on a Unix socket until SIGINT or SIGTERM.
+ *
+ * @param config Server configuration.
+ * @return 0 on a clean stop.
+ */
+static int run_command_server(const audio_server_config_t *config)
+{
+    if (!audio_server_open(config))
+    {
+        return -1;
+    }
+    struct sigaction action = { .sa_handler = handle_stop_signal };
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    int status = audio_server_run();
+    audio_server_stats_t stats = audio_server_stats();
+    audio_server_close();
+    LOG_INFO("Server stopped: %llu commands (%llu errors) from %llu connections, peak %llu open",
+             (unsigned long long)stats.commands, (unsigned long long)stats.errors,
+             (unsigned long long)stats.accepted, (unsigned long long)stats.peak);
+    return status;
+}
+
+/**
+ * @brief Reads one command line from stdin, waking up for delayed commands.
+ *
+ * Replaces fgets(): input is read with read() into a line buffer and the
+ * wait is bounded by poll() with the time left until the next delayed
+ * command, so timers fire while the prompt is waiting. A line longer than
+ * the buffer is cut, like fgets() would.
+ *
+ * @param command Receives the line, NUL-terminated, without its newline.
+ * @param size Size of command.
+ * @return 1 for a line, 0 if the wait ended for a delayed command, -1 at end of input.
+ */
+static int read_command_line(char *command, size_t size)
+{
+    static char input[MAX_LINE_LENGTH];
+    static size_t input_len = 0;
+    for (;;)
+    {
+        char *nl = memchr(input, '\n', input_len);
+        bool eof = false;
+        if (nl == NULL && input_len < sizeof(input))
+        {
+            struct pollfd fd = { .fd = STDIN_FILENO, .events = POLLIN };
+            int ready = poll(&fd, 1, audio_next_command_timeout_ms());
+            if (ready == 0 || (ready < 0 && errno == EINTR))
+            {
+                return 0;
+            }
+            ssize_t got = read(STDIN_FILENO, input + input_len, sizeof(input) - input_len);
+            if (got < 0 && errno != EINTR)
+            {
+                LOG_ERROR("Failed to read command");
+                return -1;
+            }
+            input_len += (got > 0) ? (size_t)got : 0;
+            eof = (got == 0);
+            if (!eof)
+            {
+                continue;
+            }
+        }
+        if (eof && input_len == 0)
+        {
+            return -1;
+        }
+        size_t line = (nl != NULL) ? (size_t)(nl - input) : input_len;   // Whole buffer when cut or at the end
+        size_t used = (nl != NULL) ? line + 1 : line;
+        size_t copy = (line < size - 1) ? line : size - 1;
+        memcpy(command, input, copy);
+        command[copy] = '\0';
+        memmove(input, input + used, input_len - used);
+        input_len -= used;
+        return 1;
+    }
+}
+
+/**
+ * @brief Parses the pipeline options.
+ *
+ * @param argc The number of command line arguments.
+ * @param argv The array of command line arguments.
+ * @param config Receives the pipeline configuration.
+ * @param server Receives the server configuration (path NULL unless -S).
+ * @param journal Receives the journal configuration (path NULL unless -J).
+ * @return true if the options are valid.
+ */
+static bool parse_options(int argc, char *argv[], audio_pipeline_config_t *config, audio_server_config_t *server,
+                          audio_journal_config_t *journal)
+{
+    audio_pipeline_default_config(config);
+    audio_server_default_config(server);
+    audio_journal_default_config(journal);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "c:f:n:r:s:l:L:V:o:Q:Rm:S:C:J:Dh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'c': config->capacity = strtoul(optarg, NULL, 10); break;
+            case 'f': config->pcm.frames_per_chunk = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'n': config->pcm.channels = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'r': config->pcm.sample_rate = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 's':
+                if (strcmp(optarg, "f32") == 0) {
+                    config->pcm.format = AUDIO_SAMPLE_F32;
+                } else if (strcmp(optarg, "s16") == 0) {
+                    config->pcm.format = AUDIO_SAMPLE_S16;
+                } else {
+                    return false;
+                }
+                break;
+            case 'l':
+                if (strcmp(optarg, "async") == 0) {
+                    log_start_async(LOG_OVERFLOW_DROP);
+                } else if (strcmp(optarg, "async-block") == 0) {
+                    log_start_async(LOG_OVERFLOW_BLOCK);
+                } else if (strcmp(optarg, "sync") != 0) {
+                    return false;
+                }
+                break;
+            case 'L':
+                if (!log_start_binary(optarg)) {
+                    return false;
+                }
+                break;
+            case 'V':
+                if (strcmp(optarg, "info") == 0) {
+                    log_set_runtime_level(LOG_SEVERITY_INFO);
+                } else if (strcmp(optarg, "warning") == 0) {
+                    log_set_runtime_level(LOG_SEVERITY_WARNING);
+                } else if (strcmp(optarg, "error") == 0) {
+                    log_set_runtime_level(LOG_SEVERITY_ERROR);
+                } else if (strcmp(optarg, "none") == 0) {
+                    log_set_runtime_level(LOG_SEVERITY_NONE);
+                } else {
+                    return false;
+                }
+                break;
+            case 'o': config->sink = optarg; break;
+            case 'Q':
+                if (!audio_resample_quality_parse(optarg, &config->resample_quality)) {
+                    return false;
+                }
+                break;
+            case 'R': config->realtime = true; break;
+            case 'm':
+                if (strcmp(optarg, "coalesced") == 0) {
+                    audio_report_set_mode(AUDIO_REPORT_COALESCED);
+                } else if (strcmp(optarg, "immediate") != 0) {
+                    return false;
+                }
+                break;
+            case 'S': server->path = optarg; break;
+            case 'C': server->max_connections = strtoul(optarg, NULL, 10); break;
+            case 'J': journal->path = optarg; break;
+            case 'D': journal->durable = true; break;
+            default:
+                return false;
+        }
+    }
+    return config->capacity > 0 && config->pcm.frames_per_chunk > 0 &&
+           config->pcm.channels > 0 && config->pcm.sample_rate > 0;
+}
+
 /**
  * @brief Main function for the audio command processor.
  *
  * This function initializes the command processor, reads commands from a file,
- * and dispatches them to the appropriate handlers.
+ * and dispatches them to the appropriate handlers. With a script argument the
+ * commands are replayed in batch mode; otherwise they are read interactively
+ * from stdin.
  *
  * @param argc The number of command line arguments.
  * @param argv The array of command line arguments.
  * @return int Exit status of the program.
  */
-int main() 
+int main(int argc, char *argv[]) 
 {
+    audio_pipeline_config_t pipeline_config;
+    audio_server_config_t server_config;
+    audio_journal_config_t journal_config;
+    if (!parse_options(argc, argv, &pipeline_config, &server_config, &journal_config))
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
     LOG_INFO("Command Processor Initialized.", __func__);
 
     register_audio_commands();  // Register all commands dynamically
+    freeze_command_processor(); // Build the perfect-hash dispatch table
+    if (journal_config.path != NULL && !audio_journal_open(&journal_config, NULL))  // Recover the last run's state
+    {
+        free_command_processor();
+        return 1;
+    }
+    if (!start_audio_pipeline(&pipeline_config))  // Start the decoder and playback threads
+    {
+        audio_journal_close();
+        free_command_processor();
+        return 1;
+    }
+
+    if (server_config.path != NULL)
+    {
+        int status = run_command_server(&server_config);
+        audio_free_delayed_commands();
+        audio_journal_close();
+        stop_audio_pipeline();
+        free_command_processor();
+        return (status == 0) ? 0 : 1;
+    }
+
+    if (optind < argc)
+    {
+        int status = run_command_script(argv[optind], NULL);
+        audio_free_delayed_commands();
+        audio_journal_close();     // Snapshot while the ring is still live
+        stop_audio_pipeline();
+        free_command_processor();  // clean up
+        return (status == 0) ? 0 : 1;
+    }
 
     char command[MAX_LINE_LENGTH];
+    bool prompt = true;
 
     while(1)
     {
-        printf("Enter command: ");
-        if (fgets(command, sizeof(command), stdin) == NULL) {
-            LOG_ERROR("Failed to read command");
-            continue;
+        prompt |= (audio_run_due_commands() > 0);  // Delayed commands whose time has come
+        audio_report_flush();      // Print coalesced state reports for the last command
+        log_flush();               // Show queued log output before prompting
+        if (prompt) {
+            printf("Enter command: ");
+            fflush(stdout);
+        }
+        int got = read_command_line(command, sizeof(command));
+        prompt = (got != 0);
+        if (got == 0) {
+            continue;              // Woken up for a delayed command
+        }
+        if (got < 0) {
+            LOG_INFO("End of input.");
+            audio_drain_delayed_commands();   // Let the pending delayed commands run
+            break;
         }
 
         // Remove trailing newline characters
-        command[strcspn(command, "\r\n")] = 0;
+        size_t len = strcspn(command, "\r\n");
+        command[len] = 0;
 
         if (strcmp(command, "exit") == 0) {
             LOG_INFO("Exiting interactive mode.");
@@ -57,9 +330,13 @@ int main()
         }
 
         LOG_INPUT("Received: \"%s\"", command);
-        dispatch_command(command);
+        dispatch_command_slice(command, len);
     }
 
+    audio_report_flush();
+    audio_free_delayed_commands();  // "exit" drops what is still pending
+    audio_journal_close();
+    stop_audio_pipeline();     // Play out queued chunks and join the pipeline threads
     free_command_processor();  // clean up
 
     return 0;
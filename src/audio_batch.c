@@ -0,0 +1,176 @@
+/**
+ * @file src/audio_batch.c
+ * @brief Batch Script Mode Implementation
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "audio_batch.h"
+#include "audio_command_binary.h"
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "audio_report.h"
+#include "audio_timer.h"
+
+/**
+ * @brief Finds the next newline in a byte range.
+ */
+const char *find_next_newline(const char *p, const char *end)
+{
+#if defined(__SSE2__)
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)p);
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+        if (mask != 0)
+        {
+            return p + __builtin_ctz((unsigned)mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '\n')
+    {
+        p++;
+    }
+    return p;
+}
+
+static double elapsed_seconds(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Dispatches every line of a text script.
+ *
+ * @return Number of lines dispatched.
+ */
+static size_t dispatch_script_text(const char *data, size_t size)
+{
+    size_t commands = 0;
+    const char *p = data;
+    const char *end = data + size;
+    while (p < end)
+    {
+        const char *nl = find_next_newline(p, end);
+        size_t len = (size_t)(nl - p);
+        if (len > 0 && p[len - 1] == '\r')
+        {
+            len--;                                               // Accept CRLF scripts
+        }
+
+        if (len == 4 && memcmp(p, "exit", 4) == 0)
+        {
+            break;
+        }
+        if (len > 0)
+        {
+            if (audio_pending_commands() > 0)
+            {
+                audio_run_due_commands();                        // Delayed commands that came due meanwhile
+            }
+            dispatch_command_slice(p, len);
+            if ((++commands % AUDIO_REPORT_TICK_COMMANDS) == 0)
+            {
+                audio_report_tick();                             // Coalesced reports go out once per tick
+            }
+        }
+        p = nl + 1;
+    }
+    return commands;
+}
+
+/**
+ * @brief Runs every command of a script file.
+ */
+int run_command_script(const char *path, audio_batch_result_t *result)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        LOG_ERROR("Cannot open command script: %s", path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        LOG_ERROR("Cannot stat command script: %s", path);
+        close(fd);
+        return -1;
+    }
+
+    size_t size = (size_t)st.st_size;
+    const char *data = NULL;
+    if (size > 0)
+    {
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            LOG_ERROR("Cannot map command script: %s", path);
+            close(fd);
+            return -1;
+        }
+        madvise((void *)data, size, MADV_SEQUENTIAL);          // Aggressive readahead, early page reclaim
+        madvise((void *)data, size, MADV_WILLNEED);
+    }
+    close(fd);                                                   // The mapping keeps the file alive
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    size_t commands = 0;
+    if (aud_binary_is_script(data, size))
+    {
+        long records = aud_binary_replay(data, size);            // Compiled script: dispatch by opcode
+        if (records < 0)
+        {
+            munmap((void *)data, size);
+            return -1;
+        }
+        commands = (size_t)records;
+    }
+    else
+    {
+        commands = dispatch_script_text(data, size);
+    }
+
+    audio_report_flush();                                        // Last coalesced reports belong to the batch
+    double seconds = elapsed_seconds(&start);
+    if (audio_pending_commands() > 0)
+    {
+        audio_drain_delayed_commands();                          // The run ends once its delayed commands ran
+        audio_report_flush();
+    }
+    if (size > 0)
+    {
+        munmap((void *)data, size);
+    }
+
+    LOG_INFO("Batch complete: %zu commands in %.3f s (%.0f commands/sec)",
+             commands, seconds, seconds > 0.0 ? (double)commands / seconds : 0.0);
+    if (audio_report_mode() == AUDIO_REPORT_COALESCED)
+    {
+        audio_report_counters_t counters = audio_report_counters();
+        LOG_INFO("Reports: %llu requested, %llu printed, %llu identical suppressed",
+                 (unsigned long long)counters.requested, (unsigned long long)counters.emitted,
+                 (unsigned long long)counters.suppressed);
+    }
+    if (result != NULL)
+    {
+        result->commands = commands;
+        result->seconds = seconds;
+    }
+    return 0;
+}
@@ -5,153 +5,405 @@
 
 #include "audio_buffer.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "audio_logger.h"
 
 /**
- * @brief Initializes the audio buffer.
+ * @brief Allocates an empty byte ring.
  *
- * This function sets the head, tail, and count of the audio buffer to zero.
- *
- * @param aud_buffer Pointer to the audio buffer to initialize.
+ * @param buffer Pointer to the audio buffer to initialize.
+ * @param capacity_bytes Ring size; rounded up to a power of two of at least AUDIO_BUFFER_MIN_BYTES.
+ * @return false on allocation failure.
  */
-void init_audio_buffer(audio_buffer_t *buffer)
+bool init_audio_buffer(audio_buffer_t *buffer, size_t capacity_bytes)
 {
-    buffer->buffer_head = 0;
-    buffer->buffer_tail = 0;
-    buffer->buffer_count = 0;
+    size_t capacity = AUDIO_BUFFER_MIN_BYTES;
+    while (capacity < capacity_bytes && capacity < UINT32_MAX / 2)
+    {
+        capacity <<= 1;
+    }
+
+    buffer->data = malloc(capacity);
+    buffer->capacity = (buffer->data != NULL) ? capacity : 0;
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->records = 0;
+    buffer->payload = 0;
+    if (buffer->data == NULL)
+    {
+        LOG_ERROR("Memory allocation failed for a %zu-byte audio buffer", capacity);
+        return false;
+    }
+    return true;
 }
 
 /**
- * @brief Adds a command to the audio buffer.
+ * @brief Releases the ring storage.
+ */
+void free_audio_buffer(audio_buffer_t *buffer)
+{
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->capacity = 0;
+    reset_audio_buffer(buffer);
+}
+
+static inline uint32_t record_length(const audio_buffer_t *buffer, size_t offset)
+{
+    return *(const uint32_t *)(buffer->data + offset);
+}
+
+/**
+ * @brief Returns the ring offset of the front record's header, past any padding.
+ */
+static size_t front_offset(const audio_buffer_t *buffer)
+{
+    size_t offset = buffer->head & (buffer->capacity - 1);
+    return (record_length(buffer, offset) == AUDIO_RECORD_WRAP) ? 0 : offset;
+}
+
+/**
+ * @brief Reserves space for a record at the tail.
  *
- * This function adds a command to the audio buffer if it is not full.
+ * When the record does not fit before the end of the ring, the rest of the
+ * ring is marked as padding and the record starts at offset 0, so the space
+ * returned is always contiguous. An empty ring restarts at offset 0.
  *
- * @param aud_buffer Pointer to the audio buffer.
- * @param command The command to add to the buffer.
+ * @param buffer Pointer to the audio buffer.
+ * @param len Most bytes the record will hold.
+ * @return Where to write the record, or NULL if it does not fit.
  */
-bool enqueue_audio_command(audio_buffer_t *buffer, const char *command)
+void *reserve_audio_record(audio_buffer_t *buffer, size_t len)
 {
-    if(is_audio_buffer_full(buffer)) 
+    if (len > buffer->capacity)
     {
-        printf("Audio buffer is full. Cannot enqueue command: %s\n", command);
-        return false;
+        return NULL;
+    }
+    size_t need = AUDIO_RECORD_BYTES(len);
+    if (buffer->records == 0)
+    {
+        buffer->head = 0;
+        buffer->tail = 0;
+    }
+
+    size_t offset = buffer->tail & (buffer->capacity - 1);
+    size_t contiguous = buffer->capacity - offset;
+    size_t pad = (contiguous < need) ? contiguous : 0;
+    if ((buffer->tail - buffer->head) + pad + need > buffer->capacity)
+    {
+        return NULL;
     }
+    if (pad != 0)
+    {
+        *(uint32_t *)(buffer->data + offset) = AUDIO_RECORD_WRAP;
+        buffer->tail += pad;
+        offset = 0;
+    }
+    return buffer->data + offset + AUDIO_RECORD_HEADER;
+}
 
-    // Copy the command into the buffer at the tail index
-    strncpy(buffer->audio_buffer_chunks[buffer->buffer_tail], command, AUDIO_BUFFER_SIZE - 1);
-    buffer->buffer_tail = (buffer->buffer_tail + 1) % AUDIO_BUFFER_CAPACITY; // Move tail to next position
-    buffer->buffer_count++; // Increment the count of commands in the buffer
+/**
+ * @brief Queues the record written into the last reservation.
+ *
+ * @param buffer Pointer to the audio buffer.
+ * @param len Bytes actually written; at most the reserved length.
+ */
+void commit_audio_record(audio_buffer_t *buffer, size_t len)
+{
+    *(uint32_t *)(buffer->data + (buffer->tail & (buffer->capacity - 1))) = (uint32_t)len;
+    buffer->tail += AUDIO_RECORD_BYTES(len);
+    buffer->records++;
+    buffer->payload += len;
+}
 
+/**
+ * @brief Copies a record into the ring.
+ *
+ * @param buffer Pointer to the audio buffer.
+ * @param data The record bytes.
+ * @param len Length of the record.
+ * @return false if the record does not fit.
+ */
+bool enqueue_audio_record(audio_buffer_t *buffer, const void *data, size_t len)
+{
+    void *record = reserve_audio_record(buffer, len);
+    if (record == NULL)
+    {
+        return false;
+    }
+    memcpy(record, data, len);
+    commit_audio_record(buffer, len);
     return true;
 }
 
+/**
+ * @brief Queues a command's text (without the terminator) as a record.
+ *
+ * @param buffer Pointer to the audio buffer.
+ * @param command The command to add to the buffer.
+ * @return false if the command does not fit.
+ */
+bool enqueue_audio_command(audio_buffer_t *buffer, const char *command)
+{
+    return enqueue_audio_record(buffer, command, strlen(command));
+}
 
 /**
- * @brief Checks if the audio buffer is empty.
+ * @brief Returns the front record in place.
  *
- * This function checks if the audio buffer has no commands.
+ * The bytes stay valid until the record is released.
  *
- * @param aud_buffer Pointer to the audio buffer.
- * @return true if the buffer is empty, false otherwise.
+ * @param buffer Pointer to the audio buffer.
+ * @param len Receives the record length.
+ * @return The record bytes, or NULL when the buffer is empty.
  */
-bool dequeue_audio_command(audio_buffer_t *buffer, char *command)
+const void *peek_audio_record(const audio_buffer_t *buffer, size_t *len)
 {
-    if(is_audio_buffer_empty(buffer)) 
+    if (buffer->records == 0)
     {
-        printf("Audio buffer is empty. Cannot dequeue command.\n");
-        return false;
+        return NULL;
     }
+    size_t offset = front_offset(buffer);
+    *len = record_length(buffer, offset);
+    return buffer->data + offset + AUDIO_RECORD_HEADER;
+}
 
-    // Copy the command from the head index to the provided command buffer
-    strncpy(command, buffer->audio_buffer_chunks[buffer->buffer_head], AUDIO_BUFFER_SIZE - 1);
-    command[AUDIO_BUFFER_SIZE - 1] = '\0'; // Ensure null termination
-    buffer->buffer_head = (buffer->buffer_head + 1) % AUDIO_BUFFER_CAPACITY; // Move head to next position
-    buffer->buffer_count--; // Decrement the count of commands in the buffer
+/**
+ * @brief Drops the front record.
+ */
+void release_audio_record(audio_buffer_t *buffer)
+{
+    if (buffer->records == 0)
+    {
+        return;
+    }
+    size_t offset = buffer->head & (buffer->capacity - 1);
+    if (record_length(buffer, offset) == AUDIO_RECORD_WRAP)
+    {
+        buffer->head += buffer->capacity - offset;    // Skip the padding
+        offset = 0;
+    }
+    uint32_t len = record_length(buffer, offset);
+    buffer->head += AUDIO_RECORD_BYTES(len);
+    buffer->payload -= len;
+    if (--buffer->records == 0)
+    {
+        buffer->head = buffer->tail;                  // Drop padding left by an unused reservation
+    }
+}
 
+/**
+ * @brief Copies the front record out as a string and drops it.
+ *
+ * @param buffer Pointer to the audio buffer.
+ * @param command Receives the record, truncated to size - 1 bytes and terminated.
+ * @param size Size of command.
+ * @return false if the buffer is empty.
+ */
+bool dequeue_audio_command(audio_buffer_t *buffer, char *command, size_t size)
+{
+    size_t len;
+    const char *record = peek_audio_record(buffer, &len);
+    if (record == NULL || size == 0)
+    {
+        return false;
+    }
+    len = (len < size - 1) ? len : size - 1;
+    memcpy(command, record, len);
+    command[len] = '\0';
+    release_audio_record(buffer);
     return true;
 }
 
 /**
  * @brief Checks if the audio buffer is empty.
  *
- * This function checks if the audio buffer has no commands.
- *
- * @param aud_buffer Pointer to the audio buffer.
- * @return true if the buffer is empty, false otherwise.
+ * @param buffer Pointer to the audio buffer.
+ * @return true if the buffer holds no records.
  */
 bool is_audio_buffer_empty(const audio_buffer_t *buffer)
 {
-    return buffer->buffer_count == 0;
+    return buffer->records == 0;
 }
 
 /**
- * @brief Checks if the audio buffer is full.
- *
- * This function checks if the audio buffer has reached its capacity.
+ * @brief Checks whether a record of len bytes can be queued now.
  *
- * @param aud_buffer Pointer to the audio buffer.
- * @return true if the buffer is full, false otherwise.
+ * Accounts for the padding the record would need at the end of the ring.
  */
-bool is_audio_buffer_full(const audio_buffer_t *buffer)
+bool audio_buffer_fits(const audio_buffer_t *buffer, size_t len)
 {
-    return buffer->buffer_count == AUDIO_BUFFER_CAPACITY;
+    if (len > buffer->capacity)
+    {
+        return false;
+    }
+    size_t need = AUDIO_RECORD_BYTES(len);
+    if (buffer->records == 0)
+    {
+        return need <= buffer->capacity;
+    }
+    size_t contiguous = buffer->capacity - (buffer->tail & (buffer->capacity - 1));
+    size_t pad = (contiguous < need) ? contiguous : 0;
+    return (buffer->tail - buffer->head) + pad + need <= buffer->capacity;
 }
 
 /**
- * @brief Resets the audio buffer.
- *
- * This function clears the audio buffer by resetting the head, tail, and count.
+ * @brief Returns the fill of the buffer in records and bytes.
+ */
+audio_buffer_fill_t audio_buffer_fill(const audio_buffer_t *buffer)
+{
+    audio_buffer_fill_t fill = { buffer->records, buffer->payload, buffer->tail - buffer->head, buffer->capacity };
+    return fill;
+}
+
+/**
+ * @brief Drops every record.
  *
- * @param aud_buffer Pointer to the audio buffer to reset.
+ * @param buffer Pointer to the audio buffer to reset.
  */
 void reset_audio_buffer(audio_buffer_t *buffer)
 {
-    buffer->buffer_head = 0;
-    buffer->buffer_tail = 0;
-    buffer->buffer_count = 0;
-    printf("Audio buffer has been reset.\n");
-    print_audio_buffer_state(buffer);
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->records = 0;
+    buffer->payload = 0;
 }
 
 /**
- * @brief Prints the current state of the audio buffer.
+ * @brief Prints the fill of the audio buffer and a byte view of the ring.
  *
- * This function prints the contents of the audio buffer, including the head, tail, and count.
+ * The view draws the ring as AUDIO_BUFFER_VIEW_CELLS cells of capacity / cells
+ * bytes each; a cell is filled when any of its bytes are in use.
  *
- * @param aud_buffer Pointer to the audio buffer to print.
+ * @param buffer Pointer to the audio buffer to print.
  */
 void print_audio_buffer_state(const audio_buffer_t *buffer)
 {
-    printf("[INFO] Audio Buffer - Chunks: %d / %d | Front: %d | Rear: %d\n",
-           buffer->buffer_count, AUDIO_BUFFER_CAPACITY, buffer->buffer_head, buffer->buffer_tail);
+    static _Thread_local char report[AUDIO_VIEW_REPORT_SIZE];
+    audio_buffer_fill_t fill = audio_buffer_fill(buffer);
+    size_t mask = buffer->capacity - 1;
+    int cells = AUDIO_BUFFER_VIEW_CELLS;
+    size_t cell_bytes = (buffer->capacity > 0) ? buffer->capacity / cells : 1;
+    int head = (int)((buffer->head & mask) / cell_bytes);
+    int used = (int)((fill.used_bytes + cell_bytes - 1) / cell_bytes);
+    int tail = (head + used) % cells;
+
+    int header = snprintf(report, sizeof(report),
+                          "[INFO] Audio Buffer - Records: %zu | Bytes: %zu / %zu (payload %zu) | Front: %zu | Rear: %zu\n",
+                          fill.records, fill.used_bytes, fill.capacity_bytes, fill.payload_bytes,
+                          buffer->head & mask, buffer->tail & mask);
+    size_t len = (size_t)header;
+    len += render_audio_buffer_view(report + len, sizeof(report) - len, used, cells, head, tail);
+    fwrite(report, 1, len, stdout);
+}
+
+// Appends a string literal to the view, keeping room for the terminator
+#define VIEW_APPEND(lit)                                              \
+    do                                                                \
+    {                                                                 \
+        if (len + sizeof(lit) > size)                                 \
+        {                                                             \
+            return len;                                               \
+        }                                                             \
+        memcpy(out + len, lit, sizeof(lit) - 1);                      \
+        len += sizeof(lit) - 1;                                       \
+    } while (0)
 
-    printf("Buffer View: ");
-    for (int i = 0; i < AUDIO_BUFFER_CAPACITY; i++) 
+/**
+ * @brief Renders the slot-by-slot view of a circular buffer into a string.
+ *
+ * Shared by every ring type so they render the same way. Rings with more
+ * than AUDIO_VIEW_MAX_SLOTS slots show the first slots and a count of the rest.
+ *
+ * @param out Receives the view (NUL-terminated).
+ * @param size Size of out; AUDIO_VIEW_REPORT_SIZE always fits.
+ * @param count Number of occupied slots.
+ * @param capacity Total number of slots.
+ * @param head Index of the front slot.
+ * @param tail Index of the next free slot.
+ * @return Bytes written, excluding the terminator.
+ */
+size_t render_audio_buffer_view(char *out, size_t size, int count, int capacity, int head, int tail)
+{
+    size_t len = 0;
+    int shown = (capacity > AUDIO_VIEW_MAX_SLOTS) ? AUDIO_VIEW_MAX_SLOTS : capacity;
+    if (size == 0)
+    {
+        return 0;
+    }
+    out[0] = '\0';
+
+    VIEW_APPEND("Buffer View: ");
+    for (int i = 0; i < shown; i++)
     {
-        bool isFilled = ((buffer->buffer_head <= buffer->buffer_tail && i >= buffer->buffer_head && i < buffer->buffer_tail) ||
-                         (buffer->buffer_head > buffer->buffer_tail && (i >= buffer->buffer_head || i < buffer->buffer_tail)));
+        bool isFilled = ((head <= tail && i >= head && i < tail) ||
+                         (head > tail && (i >= head || i < tail)));
 
-        if (i == buffer->buffer_head && i == buffer->buffer_tail && buffer->buffer_count != 0) 
+        if (i == head && i == tail && count != 0)
         {
             // Front == Rear but buffer not empty => Full buffer wrap-around
-            printf("[FR🟩]");
-        } 
-        else if (i == buffer->buffer_head && buffer->buffer_count != 0) 
+            VIEW_APPEND("[FR🟩]");
+        }
+        else if (i == head && count != 0)
         {
-            printf("[F🟩]");
-        } 
-        else if (i == buffer->buffer_tail && buffer->buffer_count != 0) 
+            VIEW_APPEND("[F🟩]");
+        }
+        else if (i == tail && count != 0)
         {
-            printf("[R🟩]");
-        } 
-        else if (isFilled) 
+            VIEW_APPEND("[R🟩]");
+        }
+        else if (isFilled)
         {
-            printf("[🟩]");
-        } 
-        else 
+            VIEW_APPEND("[🟩]");
+        }
+        else
         {
-            printf("[⬜]");
+            VIEW_APPEND("[⬜]");
         }
     }
-    printf("\n\n");
-}
\ No newline at end of file
+    if (shown < capacity && len + 32 < size)
+    {
+        len += (size_t)snprintf(out + len, size - len, " ... +%d slots", capacity - shown);
+    }
+    VIEW_APPEND("\n\n");
+    out[len] = '\0';
+    return len;
+}
+
+/**
+ * @brief Prints the slot-by-slot view of a circular buffer in one write.
+ *
+ * @param count Number of occupied slots.
+ * @param capacity Total number of slots.
+ * @param head Index of the front slot.
+ * @param tail Index of the next free slot.
+ */
+void print_audio_buffer_view(int count, int capacity, int head, int tail)
+{
+    static _Thread_local char view[AUDIO_VIEW_REPORT_SIZE];
+    size_t len = render_audio_buffer_view(view, sizeof(view), count, capacity, head, tail);
+    fwrite(view, 1, len, stdout);
+}
+
+/**
+ * @brief Prints a ring's fill line and slot view in one write.
+ *
+ * The report is rendered into a preallocated per-thread string, so a report
+ * costs one stdio call however many slots the ring has.
+ *
+ * @param label Ring name shown in the fill line.
+ * @param count Number of occupied slots.
+ * @param capacity Total number of slots.
+ * @param head Index of the front slot.
+ * @param tail Index of the next free slot.
+ */
+void print_audio_ring_report(const char *label, int count, int capacity, int head, int tail)
+{
+    static _Thread_local char report[AUDIO_VIEW_REPORT_SIZE];
+    int header = snprintf(report, sizeof(report), "[INFO] %s - Chunks: %d / %d | Front: %d | Rear: %d\n",
+                          label, count, capacity, head, tail);
+    size_t len = (size_t)header;
+    len += render_audio_buffer_view(report + len, sizeof(report) - len, count, capacity, head, tail);
+    fwrite(report, 1, len, stdout);
+}
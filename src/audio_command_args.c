@@ -0,0 +1,319 @@
+/**
+ * @file src/audio_command_args.c
+ * @brief Typed Command Arguments Implementation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "audio_command_args.h"
+
+#define FLOAT_MAX_DIGITS 19                           // Significant digits that fit a uint64_t
+#define FLOAT_FAST_EXP 22                             // Largest power of ten a double holds exactly
+#define FLOAT_SLOW_MAX 64                             // Longest number handed to strtod()
+
+static const double exact_powers[FLOAT_FAST_EXP + 1] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static inline bool is_digit(char c)
+{
+    return (unsigned)(c - '0') < 10u;
+}
+
+/**
+ * @brief Parses a decimal integer that fills the whole span.
+ *
+ * @return false on an empty span, a stray character or overflow.
+ */
+bool aud_parse_int(const char *p, size_t len, int64_t *out)
+{
+    const char *end = p + len;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = (*p++ == '-');
+    }
+    if (p == end)
+    {
+        return false;
+    }
+
+    uint64_t value = 0;
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    for (; p < end; p++)
+    {
+        if (!is_digit(*p))
+        {
+            return false;
+        }
+        uint64_t digit = (uint64_t)(*p - '0');
+        if (value > (limit - digit) / 10)
+        {
+            return false;                             // Overflow
+        }
+        value = value * 10 + digit;
+    }
+    *out = negative ? (int64_t)(0 - value) : (int64_t)value;
+    return true;
+}
+
+/**
+ * @brief Parses a decimal number that fills the whole span.
+ *
+ * Digits are gathered into a 64-bit mantissa and a power-of-ten exponent.
+ * When the mantissa fits in 53 bits and the exponent is at most 22 the
+ * result is one exactly rounded multiply or divide; anything else (very
+ * long or extreme numbers) goes through strtod() on a stack copy.
+ */
+bool aud_parse_float(const char *p, size_t len, double *out)
+{
+    const char *start = p;
+    const char *end = p + len;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = (*p++ == '-');
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; p < end && is_digit(*p); p++, any = true)
+    {
+        if (digits < FLOAT_MAX_DIGITS)
+        {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            digits += (mantissa != 0);
+        }
+        else
+        {
+            exponent++;                               // Dropped integer digit
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && is_digit(*p); p++, any = true)
+        {
+            if (digits < FLOAT_MAX_DIGITS)
+            {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                digits += (mantissa != 0);
+                exponent--;
+            }
+        }
+    }
+    if (!any)
+    {
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        int64_t e;
+        if (!aud_parse_int(p + 1, (size_t)(end - p - 1), &e) || e > 400 || e < -400)
+        {
+            return false;
+        }
+        exponent += (int)e;
+        p = end;
+    }
+    if (p != end)
+    {
+        return false;
+    }
+
+    double value;
+    if (mantissa < (1ULL << 53) && exponent >= -FLOAT_FAST_EXP && exponent <= FLOAT_FAST_EXP)
+    {
+        value = (double)mantissa;
+        value = (exponent < 0) ? value / exact_powers[-exponent] : value * exact_powers[exponent];
+    }
+    else
+    {
+        char copy[FLOAT_SLOW_MAX];
+        if (len >= sizeof(copy))
+        {
+            return false;
+        }
+        memcpy(copy, start, len);
+        copy[len] = '\0';
+        *out = strtod(copy, NULL);
+        return true;
+    }
+    *out = negative ? -value : value;
+    return true;
+}
+
+/**
+ * @brief Parses a duration: a number and an optional unit (ns, us, ms, s).
+ *
+ * A bare number is in milliseconds.
+ */
+bool aud_parse_duration(const char *p, size_t len, int64_t *out_ns)
+{
+    size_t number = len;
+    while (number > 0 && !is_digit(p[number - 1]) && p[number - 1] != '.')
+    {
+        number--;                                     // Split off the unit
+    }
+    const char *unit = p + number;
+    size_t unit_len = len - number;
+
+    double scale;
+    if (unit_len == 0 || (unit_len == 2 && memcmp(unit, "ms", 2) == 0))
+    {
+        scale = 1e6;
+    }
+    else if (unit_len == 1 && unit[0] == 's')
+    {
+        scale = 1e9;
+    }
+    else if (unit_len == 2 && memcmp(unit, "us", 2) == 0)
+    {
+        scale = 1e3;
+    }
+    else if (unit_len == 2 && memcmp(unit, "ns", 2) == 0)
+    {
+        scale = 1.0;
+    }
+    else
+    {
+        return false;
+    }
+
+    int64_t whole;
+    if (aud_parse_int(p, number, &whole) && whole >= 0 && (double)whole * scale < 9.2e18)
+    {
+        *out_ns = whole * (int64_t)scale;             // Integers stay exact
+        return true;
+    }
+    double value;
+    if (!aud_parse_float(p, number, &value) || value < 0.0 || value * scale >= 9.2e18)
+    {
+        return false;
+    }
+    *out_ns = (int64_t)(value * scale + 0.5);
+    return true;
+}
+
+/**
+ * @brief Returns the next space-separated word, advancing @p rest past it.
+ */
+static aud_slice_t next_word(aud_slice_t *rest)
+{
+    while (rest->len > 0 && *rest->ptr == ' ')
+    {
+        rest->ptr++;
+        rest->len--;
+    }
+    aud_slice_t word = { rest->ptr, 0 };
+    while (word.len < rest->len && rest->ptr[word.len] != ' ')
+    {
+        word.len++;
+    }
+    rest->ptr += word.len;
+    rest->len -= word.len;
+    return word;
+}
+
+static bool in_range(const aud_arg_spec_t *spec, double value)
+{
+    return (spec->min == 0.0 && spec->max == 0.0) || (value >= spec->min && value <= spec->max);
+}
+
+/**
+ * @brief Parses one word into a value.
+ *
+ * @return NULL on success, or a description of the problem.
+ */
+static const char *parse_value(const aud_arg_spec_t *spec, aud_slice_t word, aud_arg_value_t *value)
+{
+    switch (spec->type)
+    {
+        case AUD_ARG_INT:
+            if (!aud_parse_int(word.ptr, word.len, &value->i))
+            {
+                return "not an integer";
+            }
+            return in_range(spec, (double)value->i) ? NULL : "out of range";
+        case AUD_ARG_FLOAT:
+            if (!aud_parse_float(word.ptr, word.len, &value->f))
+            {
+                return "not a number";
+            }
+            return in_range(spec, value->f) ? NULL : "out of range";
+        case AUD_ARG_DURATION:
+            if (!aud_parse_duration(word.ptr, word.len, &value->ns))
+            {
+                return "not a duration";
+            }
+            return in_range(spec, (double)value->ns) ? NULL : "out of range";
+        case AUD_ARG_PATH:
+            value->path = word;
+            return NULL;
+        case AUD_ARG_ENUM:
+            for (int i = 0; spec->choices[i] != NULL; i++)
+            {
+                if (strlen(spec->choices[i]) == word.len && memcmp(spec->choices[i], word.ptr, word.len) == 0)
+                {
+                    value->choice = i;
+                    return NULL;
+                }
+            }
+            return "not a known word";
+    }
+    return "unknown argument type";
+}
+
+static bool fail(aud_args_error_t *error, const char *reason, const char *arg)
+{
+    if (error != NULL)
+    {
+        error->reason = reason;
+        error->arg = arg;
+    }
+    return false;
+}
+
+/**
+ * @brief Parses an argument span against a schema.
+ */
+bool aud_args_parse(const aud_arg_schema_t *schema, aud_slice_t text, aud_args_t *out, aud_args_error_t *error)
+{
+    aud_slice_t rest = text;
+    out->count = 0;
+    for (size_t i = 0; i < schema->count; i++)
+    {
+        const aud_arg_spec_t *spec = &schema->args[i];
+        aud_slice_t word = next_word(&rest);
+        if (spec->type == AUD_ARG_PATH && i + 1 == schema->count && word.len > 0)
+        {
+            word.len += rest.len;                     // A trailing path takes the rest of the line
+            while (word.len > 0 && word.ptr[word.len - 1] == ' ')
+            {
+                word.len--;
+            }
+            rest.len = 0;
+        }
+        if (word.len == 0)
+        {
+            if (spec->optional)
+            {
+                break;
+            }
+            return fail(error, "missing", spec->name);
+        }
+        const char *problem = parse_value(spec, word, &out->v[i]);
+        if (problem != NULL)
+        {
+            return fail(error, problem, spec->name);
+        }
+        out->count++;
+    }
+    if (next_word(&rest).len != 0)
+    {
+        return fail(error, "too many arguments", "");
+    }
+    return true;
+}
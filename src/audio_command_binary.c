@@ -0,0 +1,302 @@
+/**
+ * @file src/audio_command_binary.c
+ * @brief Compiled Command Script Implementation
+ */
+
+#include <string.h>
+#include "audio_command_binary.h"
+#include "audio_command_args.h"
+#include "audio_batch.h"
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "audio_report.h"
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static void put_u64(uint8_t *p, uint64_t v)
+{
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint64_t get_u64(const uint8_t *p)
+{
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+/**
+ * @brief Packs one parsed argument into 8 bytes.
+ *
+ * A path is stored as its offset and length within the argument text.
+ */
+static uint64_t pack_value(aud_arg_type_t type, const aud_arg_value_t *value, const char *args)
+{
+    uint64_t bits;
+    switch (type)
+    {
+        case AUD_ARG_FLOAT:
+            memcpy(&bits, &value->f, sizeof(bits));
+            return bits;
+        case AUD_ARG_PATH:
+            return (uint64_t)(value->path.ptr - args) | ((uint64_t)value->path.len << 32);
+        case AUD_ARG_ENUM:
+            return (uint64_t)value->choice;
+        case AUD_ARG_DURATION:
+            return (uint64_t)value->ns;
+        default:
+            return (uint64_t)value->i;
+    }
+}
+
+static void unpack_value(aud_arg_type_t type, uint64_t bits, const char *args, aud_arg_value_t *value)
+{
+    switch (type)
+    {
+        case AUD_ARG_FLOAT:
+            memcpy(&value->f, &bits, sizeof(bits));
+            break;
+        case AUD_ARG_PATH:
+            value->path.ptr = args + (uint32_t)bits;
+            value->path.len = (size_t)(bits >> 32);
+            break;
+        case AUD_ARG_ENUM:
+            value->choice = (int)bits;
+            break;
+        case AUD_ARG_DURATION:
+            value->ns = (int64_t)bits;
+            break;
+        default:
+            value->i = (int64_t)bits;
+            break;
+    }
+}
+
+static bool write_header(FILE *out, uint32_t records)
+{
+    uint8_t header[AUD_BINARY_HEADER_BYTES];
+    memcpy(header, AUD_BINARY_MAGIC, 4);
+    put_u16(header + 4, AUD_BINARY_VERSION);
+    put_u16(header + 6, (uint16_t)command_opcode_count());
+    put_u32(header + 8, command_opcode_fingerprint());
+    put_u32(header + 12, records);
+    return fwrite(header, 1, sizeof(header), out) == sizeof(header);
+}
+
+/**
+ * @brief Writes one record.
+ *
+ * @param values Parsed arguments of a typed command, or NULL for a text record.
+ * @return Bytes written, or 0 on a write error.
+ */
+static size_t write_record(FILE *out, uint16_t opcode, const char *args, size_t len,
+                           const aud_arg_schema_t *schema, const aud_args_t *values)
+{
+    uint8_t head[AUD_BINARY_RECORD_BYTES + 1 + AUD_ARGS_MAX * 8];
+    size_t head_len = AUD_BINARY_RECORD_BYTES;
+    if (values != NULL)
+    {
+        head[head_len++] = (uint8_t)values->count;
+        for (size_t i = 0; i < values->count; i++, head_len += 8)
+        {
+            put_u64(head + head_len, pack_value(schema->args[i].type, &values->v[i], args));
+        }
+        opcode |= AUD_BINARY_TYPED;
+    }
+    put_u16(head, (uint16_t)(head_len - 2 + len));
+    put_u16(head + 2, opcode);
+    if (fwrite(head, 1, head_len, out) != head_len || (len > 0 && fwrite(args, 1, len, out) != len))
+    {
+        return 0;
+    }
+    return head_len + len;
+}
+
+/**
+ * @brief Compiles a command script to the binary format.
+ *
+ * The header is written first with a zero record count and patched at the
+ * end when @p out is seekable.
+ */
+bool aud_binary_compile(const char *text, size_t len, FILE *out, aud_binary_compile_result_t *result)
+{
+    aud_binary_compile_result_t counts = { 0, 0, 0, 0, AUD_BINARY_HEADER_BYTES };
+    if (command_opcode_count() == 0)
+    {
+        LOG_ERROR("Cannot compile a script before the command table is frozen");
+        return false;
+    }
+    long start = ftell(out);
+    if (!write_header(out, 0))
+    {
+        return false;
+    }
+
+    const char *p = text;
+    const char *end = text + len;
+    while (p < end)
+    {
+        const char *nl = find_next_newline(p, end);
+        size_t line_len = (size_t)(nl - p);
+        if (line_len > 0 && p[line_len - 1] == '\r')
+        {
+            line_len--;                                          // Accept CRLF scripts
+        }
+        if (line_len == 4 && memcmp(p, "exit", 4) == 0)
+        {
+            break;
+        }
+
+        if (line_len > 0)
+        {
+            const char *space = memchr(p, ' ', line_len);
+            size_t name_len = (space != NULL) ? (size_t)(space - p) : line_len;
+            int opcode = command_opcode(p, name_len);
+            const char *args = p;
+            size_t args_len = line_len;                          // Unknown: keep the whole line
+            if (opcode >= 0)
+            {
+                args = (space != NULL) ? space + 1 : p + line_len;
+                args_len = (space != NULL) ? line_len - name_len - 1 : 0;
+            }
+            else
+            {
+                opcode = AUD_BINARY_OPCODE_UNKNOWN;
+                counts.unknown++;
+            }
+
+            if (args_len > AUD_BINARY_ARGS_MAX)
+            {
+                LOG_WARNING("Skipping a %zu-byte command line: too long to compile", line_len);
+                counts.skipped++;
+            }
+            else
+            {
+                // Typed commands are parsed now; invalid ones stay text so the replay reports them
+                const aud_arg_schema_t *schema = (opcode != AUD_BINARY_OPCODE_UNKNOWN) ? command_opcode_schema((uint32_t)opcode) : NULL;
+                aud_args_t values;
+                bool typed = schema != NULL && args_len <= AUD_BINARY_ARGS_MAX - 1 - AUD_ARGS_MAX * 8 &&
+                             aud_args_parse(schema, (aud_slice_t){ args, args_len }, &values, NULL);
+                size_t written = write_record(out, (uint16_t)opcode, args, args_len, schema, typed ? &values : NULL);
+                if (written == 0)
+                {
+                    return false;
+                }
+                counts.records++;
+                counts.typed += typed;
+                counts.bytes += written;
+            }
+        }
+        p = nl + 1;
+    }
+
+    if (start >= 0 && fseek(out, start, SEEK_SET) == 0)
+    {
+        if (!write_header(out, (uint32_t)counts.records) || fseek(out, 0, SEEK_END) != 0)
+        {
+            return false;
+        }
+    }
+    if (result != NULL)
+    {
+        *result = counts;
+    }
+    return fflush(out) == 0;
+}
+
+/**
+ * @brief Tells whether a buffer starts with a compiled script header.
+ */
+bool aud_binary_is_script(const void *data, size_t size)
+{
+    return size >= AUD_BINARY_HEADER_BYTES && memcmp(data, AUD_BINARY_MAGIC, 4) == 0;
+}
+
+/**
+ * @brief Dispatches every record of a compiled script.
+ *
+ * Known opcodes go straight to dispatch_command_opcode(); unknown records go
+ * through the text dispatch so they are reported like any unknown line.
+ */
+long aud_binary_replay(const void *data, size_t size)
+{
+    const uint8_t *p = data;
+    if (!aud_binary_is_script(data, size) || get_u16(p + 4) == 0 || get_u16(p + 4) > AUD_BINARY_VERSION)
+    {
+        LOG_ERROR("Not a compiled command script");
+        return -1;
+    }
+    if (get_u16(p + 6) != command_opcode_count() || get_u32(p + 8) != command_opcode_fingerprint())
+    {
+        LOG_ERROR("Compiled script does not match the registered commands; recompile it");
+        return -1;
+    }
+
+    const uint8_t *end = p + size;
+    p += AUD_BINARY_HEADER_BYTES;
+    long records = 0;
+    while (end - p >= AUD_BINARY_RECORD_BYTES)
+    {
+        uint16_t record = get_u16(p);
+        uint16_t opcode = get_u16(p + 2);
+        if (record < 2 || (size_t)(end - p) < (size_t)record + 2)
+        {
+            LOG_ERROR("Compiled script truncated after %ld records", records);
+            return -1;
+        }
+        aud_slice_t args = { (const char *)p + AUD_BINARY_RECORD_BYTES, (size_t)record - 2 };
+        if (opcode == AUD_BINARY_OPCODE_UNKNOWN)
+        {
+            dispatch_command_slice(args.ptr, args.len);
+        }
+        else if (opcode & AUD_BINARY_TYPED)
+        {
+            opcode &= (uint16_t)~AUD_BINARY_TYPED;
+            const aud_arg_schema_t *schema = command_opcode_schema(opcode);
+            aud_args_t values;
+            values.count = (args.len > 0) ? (uint8_t)args.ptr[0] : 0;
+            size_t packed = 1 + values.count * 8;
+            if (schema == NULL || args.len < packed || values.count > schema->count)
+            {
+                LOG_ERROR("Compiled script has a bad typed record after %ld records", records);
+                return -1;
+            }
+            const uint8_t *bits = (const uint8_t *)args.ptr + 1;
+            aud_slice_t text = { args.ptr + packed, args.len - packed };
+            for (size_t i = 0; i < values.count; i++)
+            {
+                unpack_value(schema->args[i].type, get_u64(bits + i * 8), text.ptr, &values.v[i]);
+            }
+            dispatch_command_opcode_parsed(opcode, text, &values);
+        }
+        else
+        {
+            dispatch_command_opcode(opcode, args);
+        }
+        p += (size_t)record + 2;
+        if ((++records % AUDIO_REPORT_TICK_COMMANDS) == 0)
+        {
+            audio_report_tick();                                 // Coalesced reports go out once per tick
+        }
+    }
+    return records;
+}
@@ -0,0 +1,239 @@
+/**
+ * @file src/audio_command_hash.c
+ * @brief Frozen perfect-hash command table construction
+ *
+ * Builds a collision-free slot table with the "hash and displace" scheme:
+ * names are grouped into buckets by the high half of their hash, the largest
+ * buckets are placed first, and each bucket searches for a displacement that
+ * moves all of its names into free slots.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "audio_command_hash.h"
+
+#define COMMAND_HASH_MAX_SEEDS 64                    // Seeds tried before the slot table is grown
+#define COMMAND_HASH_MAX_DISPLACEMENT 0xFFFF         // Largest displacement stored per bucket
+#define COMMAND_HASH_MAX_LOAD_INVERSE 8              // Give up once the table would have 8x more slots than names
+#define COMMAND_HASH_MAX_ENTRIES (1u << 24)          // Keeps every slot count well inside uint32_t
+
+typedef struct {
+    uint32_t bucket;                                 // Bucket index
+    uint32_t size;                                   // Number of names in the bucket
+} bucket_order_t;
+
+static int compare_bucket_size(const void *a, const void *b)
+{
+    const bucket_order_t *x = a;
+    const bucket_order_t *y = b;
+    if (x->size != y->size)
+    {
+        return (x->size < y->size) ? 1 : -1;         // Largest buckets first
+    }
+    return (x->bucket > y->bucket) - (x->bucket < y->bucket);
+}
+
+static uint32_t next_power_of_two(size_t value)
+{
+    uint32_t result = 8;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Tries to place every entry with one seed and slot count.
+ *
+ * @return true if a displacement was found for every bucket.
+ */
+static bool try_place(const aud_command_slot_t *entries, size_t count, aud_command_hash_t *table,
+                      uint16_t *displacements, aud_command_slot_t *slots,
+                      uint64_t *hashes, uint32_t *members, uint32_t *bucket_start,
+                      bucket_order_t *order, uint32_t *candidate)
+{
+    uint32_t bucket_count = table->bucket_count;
+    uint32_t slot_count = table->slot_mask + 1;
+
+    memset(bucket_start, 0, (bucket_count + 1) * sizeof(uint32_t));
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t len;
+        hashes[i] = command_hash_scan(entries[i].command_name, entries[i].name_len, table->seed, &len);
+        bucket_start[(uint32_t)(hashes[i] >> 32) % bucket_count + 1]++;
+    }
+    for (uint32_t b = 0; b < bucket_count; b++)
+    {
+        bucket_start[b + 1] += bucket_start[b];
+    }
+
+    // Counting sort of entry indices by bucket; bucket_start[b] is used as the fill cursor
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t b = (uint32_t)(hashes[i] >> 32) % bucket_count;
+        members[bucket_start[b]++] = (uint32_t)i;
+    }
+    for (uint32_t b = bucket_count; b > 0; b--)
+    {
+        bucket_start[b] = bucket_start[b - 1];
+    }
+    bucket_start[0] = 0;
+
+    for (uint32_t b = 0; b < bucket_count; b++)
+    {
+        order[b].bucket = b;
+        order[b].size = bucket_start[b + 1] - bucket_start[b];
+    }
+    qsort(order, bucket_count, sizeof(bucket_order_t), compare_bucket_size);
+
+    memset(displacements, 0, bucket_count * sizeof(uint16_t));
+    for (uint32_t s = 0; s < slot_count; s++)
+    {
+        slots[s] = (aud_command_slot_t)AUD_COMMAND_SLOT_EMPTY;
+    }
+
+    for (uint32_t o = 0; o < bucket_count && order[o].size > 0; o++)
+    {
+        uint32_t b = order[o].bucket;
+        uint32_t first = bucket_start[b];
+        uint32_t size = 0;
+
+        // Drop duplicate names; entries are in registration order so the first one wins
+        for (uint32_t k = first; k < bucket_start[b + 1]; k++)
+        {
+            const aud_command_slot_t *e = &entries[members[k]];
+            bool duplicate = false;
+            for (uint32_t j = first; j < first + size; j++)
+            {
+                const aud_command_slot_t *kept = &entries[members[j]];
+                if (kept->name_len == e->name_len && memcmp(kept->command_name, e->command_name, e->name_len) == 0)
+                {
+                    duplicate = true;
+                    break;
+                }
+            }
+            if (!duplicate)
+            {
+                members[first + size++] = members[k];
+            }
+        }
+
+        bool placed = false;
+        for (uint32_t d = 0; d <= COMMAND_HASH_MAX_DISPLACEMENT && !placed; d++)
+        {
+            displacements[b] = (uint16_t)d;
+            placed = true;
+            for (uint32_t k = 0; k < size; k++)
+            {
+                uint32_t slot = command_hash_slot(table, hashes[members[first + k]]);
+                bool taken = slots[slot].command_name != NULL;
+                for (uint32_t j = 0; j < k && !taken; j++)
+                {
+                    taken = (candidate[j] == slot);
+                }
+                if (taken)
+                {
+                    placed = false;
+                    break;
+                }
+                candidate[k] = slot;
+            }
+        }
+        if (!placed)
+        {
+            return false;
+        }
+        for (uint32_t k = 0; k < size; k++)
+        {
+            slots[candidate[k]] = entries[members[first + k]];
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Builds a frozen table from a list of commands.
+ *
+ * Each round tries every seed at one slot count and doubles the slot count
+ * for the next round. Placement that still fails at
+ * COMMAND_HASH_MAX_LOAD_INVERSE slots per name is reported as a failure
+ * rather than growing the table without bound.
+ */
+bool build_command_hash(const aud_command_slot_t *entries, size_t count, aud_command_hash_t *table)
+{
+    memset(table, 0, sizeof(*table));
+    if (count > COMMAND_HASH_MAX_ENTRIES)
+    {
+        return false;
+    }
+
+    uint32_t bucket_count = (uint32_t)((count + 3) / 4);
+    if (bucket_count == 0)
+    {
+        bucket_count = 1;
+    }
+    uint32_t slot_count = next_power_of_two(count * 2);
+    uint32_t slot_limit = next_power_of_two(count * COMMAND_HASH_MAX_LOAD_INVERSE);
+
+    uint64_t *hashes = malloc((count + 1) * sizeof(uint64_t));
+    uint32_t *members = malloc((count + 1) * sizeof(uint32_t));
+    uint32_t *candidate = malloc((count + 1) * sizeof(uint32_t));
+    uint32_t *bucket_start = malloc((bucket_count + 1) * sizeof(uint32_t));
+    bucket_order_t *order = malloc(bucket_count * sizeof(bucket_order_t));
+    uint16_t *displacements = malloc(bucket_count * sizeof(uint16_t));
+    aud_command_slot_t *slots = NULL;
+    bool built = false;
+
+    if (hashes == NULL || members == NULL || candidate == NULL || bucket_start == NULL ||
+        order == NULL || displacements == NULL)
+    {
+        goto cleanup;
+    }
+
+    while (!built && slot_count <= slot_limit)
+    {
+        free(slots);
+        slots = malloc(slot_count * sizeof(aud_command_slot_t));
+        if (slots == NULL)
+        {
+            goto cleanup;
+        }
+
+        table->slot_mask = slot_count - 1;
+        table->bucket_count = bucket_count;
+        for (uint32_t seed = 1; seed <= COMMAND_HASH_MAX_SEEDS && !built; seed++)
+        {
+            table->seed = seed * 0x9E3779B9u;
+            table->displacements = displacements;
+            table->slots = slots;
+            built = try_place(entries, count, table, displacements, slots,
+                              hashes, members, bucket_start, order, candidate);
+        }
+        slot_count <<= 1;                            // Sparser table for the next round of seeds
+    }
+
+cleanup:
+    free(hashes);
+    free(members);
+    free(candidate);
+    free(bucket_start);
+    free(order);
+    if (!built)
+    {
+        free(displacements);
+        free(slots);
+        memset(table, 0, sizeof(*table));
+    }
+    return built;
+}
+
+/**
+ * @brief Releases a table produced by build_command_hash().
+ */
+void free_command_hash(aud_command_hash_t *table)
+{
+    free((void *)table->displacements);
+    free((void *)table->slots);
+    memset(table, 0, sizeof(*table));
+}
@@ -1,69 +1,683 @@
 /**
- * @brief Dispatches a command to the appropriate handler.
+ * @file src/audio_command_processor.c
+ * @brief Command registry and dispatch
  *
- * @param command The command to dispatch.
+ * Registration stages commands in two growable arrays: the entries and a
+ * pool holding a copy of every name. freeze_command_processor() seals the
+ * registry: the entries, sorted by name, the perfect-hash table and the name
+ * pool are laid out in one mapping that is then made read-only. Dispatch
+ * only reads that mapping, so any thread may dispatch without locking, and
+ * teardown releases it with a single munmap().
  */
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include "audio_command_processor.h"
 #include "audio_logger.h"
 #include "audio_command_registery.h"
+#include "audio_command_hash.h"
+#include "audio_command_args.h"
+#include "audio_stats.h"
+
+#ifdef AUDIO_COMMAND_STATS
+#define COMMAND_STATS_OF(entry) ((entry)->stats)
+#define COUNT_UNKNOWN_COMMAND() audio_stats_count_unknown()
+#else
+#define COMMAND_STATS_OF(entry) NULL
+#define COUNT_UNKNOWN_COMMAND() ((void)0)
+#endif
+
+#define REGISTRY_INITIAL_COMMANDS 32                                  // Staged entries before the first growth
+#define REGISTRY_INITIAL_POOL 512                                     // Staged name bytes before the first growth
+
+/**
+ * @brief A command registered before the seal.
+ *
+ * The name is an offset into the staging pool, which may move as it grows.
+ */
+typedef struct {
+    uint32_t name_offset;                                             // Start of the name in staged_pool
+    uint32_t name_len;                                                // Length of the name
+    command_handler_t handler;                                        // Legacy handler, or NULL
+    command_slice_handler_t slice_handler;                            // Slice handler, or NULL
+    const aud_arg_schema_t *schema;                                   // Argument schema, or NULL
+} staged_command_t;
+
+// Staging area: only used between the first registration and the seal
+static staged_command_t *staged_commands = NULL;
+static size_t staged_count = 0;
+static size_t staged_capacity = 0;
+static char *staged_pool = NULL;                                      // Names, each NUL-terminated
+static size_t staged_pool_used = 0;
+static size_t staged_pool_capacity = 0;
 
+// Sealed registry: every pointer below points into aud_arena
+static void *aud_arena = NULL;                                        // Read-only mapping holding the sealed registry
+static size_t aud_arena_size = 0;
+static const aud_command_slot_t *aud_commands = NULL;                 // Commands sorted by name; the index is the opcode
+static size_t aud_command_count = 0;                                  // Entries in aud_commands
+static uint32_t aud_command_fingerprint = 0;                          // Hash of the sorted command names
+static aud_command_hash_t aud_frozen_table;                           // Perfect-hash table over aud_commands
+static const aud_command_hash_t *aud_active_table = NULL;             // Table used by dispatch, NULL while not frozen
+static command_observer_t command_observer = NULL;                    // Called after every dispatched command
+
+/**
+ * @brief Grows a staging array to hold at least @p needed elements.
+ */
+static bool reserve(void **array, size_t *capacity, size_t needed, size_t element, size_t initial)
+{
+    if (needed <= *capacity)
+    {
+        return true;
+    }
+    size_t grown = (*capacity == 0) ? initial : *capacity;
+    while (grown < needed)
+    {
+        grown *= 2;
+    }
+    void *moved = realloc(*array, grown * element);
+    if (moved == NULL)
+    {
+        return false;
+    }
+    *array = moved;
+    *capacity = grown;
+    return true;
+}
 
-static aud_command_node_t *aud_command_table = NULL;                  // Pointer to the head of the command linked list
+/**
+ * @brief Finds a staged command by name.
+ *
+ * @return The entry, or NULL if the name is not staged.
+ */
+static staged_command_t *find_staged(const char *name, size_t len)
+{
+    for (size_t i = 0; i < staged_count; i++)
+    {
+        staged_command_t *entry = &staged_commands[i];
+        if (entry->name_len == len && memcmp(staged_pool + entry->name_offset, name, len) == 0)
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Stages a command, copying its name into the pool.
+ *
+ * Registering a name again replaces its handler, so the newest registration
+ * wins as it always has.
+ *
+ * @param command_name The name of the command to register.
+ * @param handler The legacy handler, or NULL.
+ * @param slice_handler The slice handler, or NULL.
+ * @param schema The argument schema of a typed slice handler, or NULL.
+ */
+static void stage_command(const char *command_name, command_handler_t handler, command_slice_handler_t slice_handler,
+                          const aud_arg_schema_t *schema)
+{
+    if (command_name == NULL || *command_name == '\0' || (handler == NULL && slice_handler == NULL)) 
+    {
+        LOG_ERROR("Invalid command registration attempt");
+        return;
+    }
+    if (aud_arena != NULL)
+    {
+        LOG_ERROR("Command \"%s\" registered after the registry was sealed; ignored", command_name);
+        return;
+    }
+
+    size_t len = strlen(command_name);
+    staged_command_t *entry = find_staged(command_name, len);
+    if (entry == NULL)
+    {
+        if (len > UINT16_MAX ||
+            !reserve((void **)&staged_commands, &staged_capacity, staged_count + 1, sizeof(staged_command_t), REGISTRY_INITIAL_COMMANDS) ||
+            !reserve((void **)&staged_pool, &staged_pool_capacity, staged_pool_used + len + 1, 1, REGISTRY_INITIAL_POOL))
+        {
+            LOG_ERROR("Memory allocation failed for command \"%s\"", command_name);
+            return;
+        }
+        entry = &staged_commands[staged_count++];
+        entry->name_offset = (uint32_t)staged_pool_used;             // Intern the name: the caller's copy is not kept
+        entry->name_len = (uint32_t)len;
+        memcpy(staged_pool + staged_pool_used, command_name, len + 1);
+        staged_pool_used += len + 1;
+    }
+    entry->handler = handler;
+    entry->slice_handler = slice_handler;
+    entry->schema = schema;
+}
 
 /**
  * @brief Registers a command with its handler.
  *
- * This function creates a new command node and adds it to the command linked list.
+ * This function stages the command until the registry is sealed.
  *
  * @param command_name The name of the command to register.
  * @param handler The function to handle the command.
  */
 void register_command(const char *command_name, command_handler_t handler)
 {
-    if (command_name == NULL || handler == NULL) 
+    stage_command(command_name, handler, NULL, NULL);
+}
+
+/**
+ * @brief Registers a command with a slice-based handler.
+ *
+ * @param command_name The name of the command to register.
+ * @param handler The function to handle the command.
+ */
+void register_command_slice(const char *command_name, command_slice_handler_t handler)
+{
+    stage_command(command_name, NULL, handler, NULL);
+}
+
+/**
+ * @brief Registers a slice handler with an argument schema.
+ *
+ * @param command_name The name of the command to register.
+ * @param schema The argument schema.
+ * @param handler The function to handle the command.
+ */
+void register_command_typed(const char *command_name, const aud_arg_schema_t *schema, command_slice_handler_t handler)
+{
+    if (schema == NULL || schema->count > AUD_ARGS_MAX)
     {
-        LOG_ERROR("Invalid command registration attempt");
+        LOG_ERROR("Invalid argument schema for command \"%s\"", command_name ? command_name : "");
         return;
     }
+    stage_command(command_name, NULL, handler, schema);
+}
+
+static int compare_slot_name(const void *a, const void *b)
+{
+    return strcmp(((const aud_command_slot_t *)a)->command_name, ((const aud_command_slot_t *)b)->command_name);
+}
+
+static size_t align_up(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
 
-    aud_command_node_t *new_aud_command = malloc(sizeof(aud_command_node_t));
-    if (new_aud_command == NULL) 
+/**
+ * @brief FNV-1a over the sorted names, NUL included, identifying the command set.
+ */
+static uint32_t fingerprint_commands(const aud_command_slot_t *commands, size_t count)
+{
+    uint32_t h = 0x811c9dc5u;                                    // FNV-1a offset basis
+    for (size_t i = 0; i < count; i++)
     {
-        LOG_ERROR("Memory allocation failed for command node");
-        return;
+        for (const char *p = commands[i].command_name; ; p++)
+        {
+            h = (h ^ (unsigned char)*p) * 0x01000193u;           // FNV-1a prime; the NUL separates names
+            if (*p == '\0')
+            {
+                break;
+            }
+        }
+    }
+    return h;
+}
+
+static void release_staging(void)
+{
+    free(staged_commands);
+    free(staged_pool);
+    staged_commands = NULL;
+    staged_pool = NULL;
+    staged_count = staged_capacity = 0;
+    staged_pool_used = staged_pool_capacity = 0;
+}
+
+/**
+ * @brief Seals the registered commands into a read-only perfect-hash table.
+ *
+ * The arena holds, in order: the commands sorted by name (the opcode order),
+ * the hash slots, the bucket displacements and the name pool. Opcodes only
+ * depend on the set of names, not on the registration order, so a compiled
+ * script stays valid for any build with the same commands. After this call
+ * every dispatch costs one hash of the command name and one name compare,
+ * independent of the number of registered commands.
+ *
+ * @return true if the registry was sealed, false if dispatch stays on the staged commands.
+ */
+bool freeze_command_processor(void)
+{
+    if (aud_arena != NULL)
+    {
+        return true;
+    }
+
+    size_t count = staged_count;
+    aud_command_slot_t *entries = malloc((count + 1) * sizeof(aud_command_slot_t));
+    if (entries == NULL)
+    {
+        LOG_ERROR("Memory allocation failed for command table");
+        return false;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        entries[i].command_name = staged_pool + staged_commands[i].name_offset;
+        entries[i].name_len = staged_commands[i].name_len;
+        entries[i].handler = staged_commands[i].handler;
+        entries[i].slice_handler = staged_commands[i].slice_handler;
+        entries[i].schema = staged_commands[i].schema;
+#ifdef AUDIO_COMMAND_STATS
+        entries[i].stats = NULL;
+#endif
+    }
+    qsort(entries, count, sizeof(aud_command_slot_t), compare_slot_name);
+
+    aud_command_hash_t hash;
+    if (!build_command_hash(entries, count, &hash))
+    {
+        LOG_ERROR("Failed to build command table");
+        free(entries);
+        return false;
+    }
+
+    size_t slot_count = (size_t)hash.slot_mask + 1;
+    size_t slots_at = align_up(count * sizeof(aud_command_slot_t), sizeof(void *));
+    size_t displacements_at = slots_at + slot_count * sizeof(aud_command_slot_t);
+    size_t pool_at = displacements_at + hash.bucket_count * sizeof(uint16_t);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t arena_size = align_up(pool_at + staged_pool_used, page);
+    uint8_t *arena = mmap(NULL, arena_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (arena == MAP_FAILED)
+    {
+        LOG_ERROR("Memory allocation failed for command table");
+        free_command_hash(&hash);
+        free(entries);
+        return false;
+    }
+
+    // Rebase the name pointers from the staging pool onto the arena's copy
+    char *pool = (char *)arena + pool_at;
+    memcpy(pool, staged_pool, staged_pool_used);
+    aud_command_slot_t *commands = (aud_command_slot_t *)arena;
+    aud_command_slot_t *slots = (aud_command_slot_t *)(arena + slots_at);
+    for (size_t i = count; i-- > 0; )                                 // Stats print newest first: create them Z to A
+    {
+        commands[i] = entries[i];
+        commands[i].command_name = pool + (entries[i].command_name - staged_pool);
+#ifdef AUDIO_COMMAND_STATS
+        commands[i].stats = audio_stats_create(commands[i].command_name);   // Latency histogram for this command
+#endif
+    }
+    for (size_t i = 0; i < slot_count; i++)
+    {
+        slots[i] = hash.slots[i];                                     // Empty slots stay empty
+        if (hash.slots[i].command_name != NULL)
+        {
+            const aud_command_slot_t *sorted = bsearch(&hash.slots[i], entries, count,
+                                                       sizeof(aud_command_slot_t), compare_slot_name);
+            slots[i] = commands[sorted - entries];
+        }
+    }
+    uint16_t *displacements = (uint16_t *)(arena + displacements_at);
+    memcpy(displacements, hash.displacements, hash.bucket_count * sizeof(uint16_t));
+
+    aud_frozen_table.seed = hash.seed;
+    aud_frozen_table.slot_mask = hash.slot_mask;
+    aud_frozen_table.bucket_count = hash.bucket_count;
+    aud_frozen_table.displacements = displacements;
+    aud_frozen_table.slots = slots;
+    free_command_hash(&hash);
+    free(entries);
+
+    if (mprotect(arena, arena_size, PROT_READ) != 0)
+    {
+        LOG_WARNING("Cannot make the command table read-only");
+    }
+    aud_arena = arena;
+    aud_arena_size = arena_size;
+    aud_commands = commands;
+    aud_command_count = count;
+    aud_command_fingerprint = fingerprint_commands(commands, count);
+    aud_active_table = &aud_frozen_table;
+    release_staging();
+    LOG_INFO("Command table frozen: %zu commands in %u slots", count, aud_frozen_table.slot_mask + 1);
+    return true;
+}
+
+/**
+ * @brief Installs a prebuilt, statically allocated command table.
+ *
+ * The table is typically generated at compile time by tools/gen_command_table.c.
+ * It is not freed by the processor, and dispatch by opcode is not available.
+ * Slots are checked before the table is used, so a malformed table is
+ * refused rather than crashing the first dispatch that lands on a bad slot.
+ *
+ * @param table The table to dispatch through.
+ * @return true if the table was installed.
+ */
+bool install_command_table(const aud_command_hash_t *table)
+{
+    if (table == NULL || table->slots == NULL || table->displacements == NULL || table->bucket_count == 0)
+    {
+        LOG_ERROR("Invalid command table");
+        return false;
+    }
+    for (uint32_t s = 0; s <= table->slot_mask; s++)
+    {
+        const aud_command_slot_t *slot = &table->slots[s];
+        bool empty = (slot->command_name == NULL && slot->name_len == AUD_COMMAND_SLOT_EMPTY_LEN);
+        bool valid = (slot->command_name != NULL && slot->name_len > 0 &&
+                      (slot->handler != NULL || slot->slice_handler != NULL) &&
+                      (slot->schema == NULL || (slot->slice_handler != NULL && slot->schema->count <= AUD_ARGS_MAX)));
+        if (!empty && !valid)
+        {
+            LOG_ERROR("Invalid command table: slot %u is neither empty nor a complete command", s);
+            return false;
+        }
     }
+    aud_active_table = table;
+    return true;
+}
+
+/**
+ * @brief Returns the opcode of a command name.
+ *
+ * @param name The command name (not terminated).
+ * @param len Length of the name.
+ * @return The opcode, or -1 if the name is unknown or the registry is not sealed.
+ */
+int command_opcode(const char *name, size_t len)
+{
+    size_t lo = 0;
+    size_t hi = aud_command_count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        const aud_command_slot_t *slot = &aud_commands[mid];
+        size_t common = (len < slot->name_len) ? len : slot->name_len;
+        int order = memcmp(name, slot->command_name, common);
+        if (order == 0)
+        {
+            order = (len > slot->name_len) - (len < slot->name_len);
+        }
+        if (order == 0)
+        {
+            return (int)mid;
+        }
+        if (order < 0)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+    return -1;
+}
 
-    new_aud_command->command_name = command_name;                // Set the command name
-    new_aud_command->handler = handler;                          // Set the command handler
-    new_aud_command->next = aud_command_table;                   // Insert at the head of the list
-    aud_command_table = new_aud_command;                         // Update the head of the list
+/**
+ * @brief Returns the number of opcodes (0 while not sealed).
+ */
+size_t command_opcode_count(void)
+{
+    return aud_command_count;
 }
 
+/**
+ * @brief Returns the fingerprint of the sealed command set.
+ */
+uint32_t command_opcode_fingerprint(void)
+{
+    return aud_command_fingerprint;
+}
 
 /**
  * @brief Frees the resources used by the command processor.
  *
- * This function traverses the command linked list and frees each node.
- * It should be called when the command processor is no longer needed.
+ * The sealed registry goes with one munmap(); commands that were never
+ * sealed go with their staging arrays. Any asynchronous log records are
+ * flushed before it returns.
  */
 void free_command_processor(void)
 {
-    aud_command_node_t *current = aud_command_table;
-    while (current != NULL) 
+    if (aud_arena != NULL)
     {
-        aud_command_node_t *next = current->next;           // Save next node
-        free(current);                                      // Free current node
-        current = next;                                     // Move to next node
+        munmap(aud_arena, aud_arena_size);
     }
-    aud_command_table = NULL;                               // Reset the head of the list
+    aud_arena = NULL;
+    aud_arena_size = 0;
+    aud_commands = NULL;
+    aud_command_count = 0;
+    aud_command_fingerprint = 0;
+    aud_active_table = NULL;
+    release_staging();
+    audio_stats_free_all();                                 // Release the per-command statistics
     LOG_INFO("Command processor freed");
+    log_stop_async();                                       // Flush queued log records before exit
+    log_stop_binary();
+}
+
+
+/**
+ * @brief Parses the arguments of a typed command and calls its handler.
+ *
+ * The values live on this frame for the duration of the call.
+ */
+static aud_dispatch_status_t invoke_typed(command_slice_handler_t slice_handler, const aud_arg_schema_t *schema,
+                                          const aud_command_line_t *line)
+{
+    aud_args_t values;
+    aud_args_error_t error;
+    if (!aud_args_parse(schema, line->args, &values, &error))
+    {
+        LOG_ERROR("%.*s: %s%s%s (usage: %s)", AUD_SLICE_ARG(line->name), error.arg, (*error.arg != '\0') ? " " : "",
+                  error.reason, schema->usage);
+        return AUD_DISPATCH_BAD_ARGS;
+    }
+    aud_command_line_t typed = *line;
+    typed.values = &values;
+    slice_handler(&typed);
+    return AUD_DISPATCH_OK;
+}
+
+/**
+ * @brief Calls a handler with the tokenized line.
+ *
+ * Legacy handlers need NUL-terminated arguments; those are passed in place
+ * when the input is terminated and copied once otherwise. Typed commands
+ * get their arguments parsed first unless the line already carries values.
+ *
+ * @param handler The legacy handler, or NULL.
+ * @param slice_handler The slice handler, or NULL.
+ * @param schema The argument schema, or NULL.
+ * @param line The tokenized command line.
+ * @param terminated Whether the arguments end at a NUL byte.
+ * @return AUD_DISPATCH_BAD_ARGS if the handler was not called.
+ */
+static aud_dispatch_status_t invoke_handler(command_handler_t handler, command_slice_handler_t slice_handler,
+                                            const aud_arg_schema_t *schema, const aud_command_line_t *line, bool terminated)
+{
+    if (schema != NULL && line->values == NULL)
+    {
+        return invoke_typed(slice_handler, schema, line);
+    }
+    if (slice_handler != NULL)
+    {
+        slice_handler(line);
+        return AUD_DISPATCH_OK;
+    }
+
+    if (terminated)
+    {
+        handler(line->args.ptr);
+        return AUD_DISPATCH_OK;
+    }
+
+    char stack_args[256];
+    char *args = stack_args;
+    if (line->args.len >= sizeof(stack_args))
+    {
+        args = malloc(line->args.len + 1);                  // Rare: long arguments from an unterminated source
+        if (args == NULL)
+        {
+            LOG_ERROR("Memory allocation failed for command arguments");
+            return AUD_DISPATCH_BAD_ARGS;
+        }
+    }
+    memcpy(args, line->args.ptr, line->args.len);
+    args[line->args.len] = '\0';
+    handler(args);
+    if (args != stack_args)
+    {
+        free(args);
+    }
+    return AUD_DISPATCH_OK;
+}
+
+/**
+ * @brief Calls a handler, timing it when the command has statistics.
+ *
+ * @param stats The command's statistics, or NULL (always NULL when compiled out).
+ */
+static inline aud_dispatch_status_t invoke_command(command_handler_t handler, command_slice_handler_t slice_handler,
+                                                   const aud_arg_schema_t *schema, audio_command_stats_t *stats,
+                                                   const aud_command_line_t *line, bool terminated)
+{
+#ifdef AUDIO_COMMAND_STATS
+    if (stats != NULL)
+    {
+        uint64_t started = audio_stats_now();
+        aud_dispatch_status_t status = invoke_handler(handler, slice_handler, schema, line, terminated);
+        audio_stats_record(stats, audio_stats_now() - started);
+        return status;
+    }
+#endif
+    (void)stats;
+    return invoke_handler(handler, slice_handler, schema, line, terminated);
+}
+
+/**
+ * @brief Installs the command observer.
+ */
+void set_command_observer(command_observer_t observer)
+{
+    command_observer = observer;
+}
+
+/**
+ * @brief Hands a dispatched command to the observer, if one is installed.
+ */
+static inline aud_dispatch_status_t observe(const aud_command_line_t *line, aud_dispatch_status_t status)
+{
+    if (command_observer != NULL)
+    {
+        command_observer(line, status);
+    }
+    return status;
+}
+
+/**
+ * @brief Tokenizes a line and dispatches it to the matching handler.
+ *
+ * @param text The command line.
+ * @param len Length of the command line.
+ * @param terminated Whether text[len] is a NUL byte.
+ * @return How the line was handled.
+ */
+static aud_dispatch_status_t dispatch_line(const char *text, size_t len, bool terminated)
+{
+    if (text == NULL || len == 0) {
+        LOG_ERROR("Received empty command");
+        return AUD_DISPATCH_EMPTY;
+    }
+
+    aud_command_line_t line;
+    line.name.ptr = text;
+    line.args.ptr = (terminated ? text + len : "");
+    line.args.len = 0;
+    line.values = NULL;
+
+    if (aud_active_table != NULL)
+    {
+        const aud_command_slot_t *slot = command_hash_lookup(aud_active_table, text, len, &line.name.len);
+        if (slot != NULL)
+        {
+            if (line.name.len < len)
+            {
+                line.args.ptr = text + line.name.len + 1;          // Skip the separating space
+                line.args.len = len - line.name.len - 1;
+            }
+            return observe(&line, invoke_command(slot->handler, slot->slice_handler, slot->schema,
+                                                 COMMAND_STATS_OF(slot), &line, terminated));
+        }
+        COUNT_UNKNOWN_COMMAND();
+        LOG_WARNING("Unknown command received: \"%.*s\"", (int)len, text);
+        return AUD_DISPATCH_UNKNOWN;
+    }
+
+    const char *space = memchr(text, ' ', len);
+    line.name.len = (space != NULL) ? (size_t)(space - text) : len;
+    if (space != NULL)
+    {
+        line.args.ptr = space + 1;
+        line.args.len = len - line.name.len - 1;
+    }
+
+    staged_command_t *staged = find_staged(text, line.name.len);
+    if (staged != NULL)
+    {
+        return observe(&line, invoke_command(staged->handler, staged->slice_handler, staged->schema, NULL, &line, terminated));
+    }
+    COUNT_UNKNOWN_COMMAND();
+    LOG_WARNING("Unknown command received: \"%.*s\"", (int)len, text);
+    return AUD_DISPATCH_UNKNOWN;
 }
 
 
+/**
+ * @brief Dispatches a command by opcode.
+ *
+ * No name is hashed or compared: the opcode indexes the frozen commands.
+ *
+ * @param opcode The command's opcode (see command_opcode()).
+ * @param args The arguments; not terminated.
+ * @return false if the opcode is out of range.
+ */
+bool dispatch_command_opcode(uint32_t opcode, aud_slice_t args)
+{
+    return dispatch_command_opcode_parsed(opcode, args, NULL);
+}
+
+/**
+ * @brief Dispatches a typed command by opcode with arguments parsed earlier.
+ *
+ * @param opcode The command's opcode.
+ * @param args The argument text.
+ * @param values The parsed arguments, or NULL to parse @p args.
+ * @return false if the opcode is out of range.
+ */
+bool dispatch_command_opcode_parsed(uint32_t opcode, aud_slice_t args, const aud_args_t *values)
+{
+    if (opcode >= aud_command_count)
+    {
+        return false;
+    }
+    const aud_command_slot_t *slot = &aud_commands[opcode];
+    aud_command_line_t line = { { slot->command_name, slot->name_len }, args, values };
+    observe(&line, invoke_command(slot->handler, slot->slice_handler, slot->schema, COMMAND_STATS_OF(slot), &line, false));
+    return true;
+}
+
+/**
+ * @brief Returns the argument schema of an opcode, or NULL if it has none.
+ */
+const aud_arg_schema_t *command_opcode_schema(uint32_t opcode)
+{
+    return (opcode < aud_command_count) ? aud_commands[opcode].schema : NULL;
+}
+
 /**
  * @brief Dispatches a command to the appropriate handler.
  *
@@ -74,27 +688,21 @@ void free_command_processor(void)
  */
 void dispatch_command(const char *audio_command)
 {
-    if (audio_command == NULL || strlen(audio_command) == 0) {
+    if (audio_command == NULL) {
         LOG_ERROR("Received empty command");
         return;
     }
+    dispatch_line(audio_command, strlen(audio_command), true);
+}
 
-    char buffer[100];
-    strncpy(buffer, audio_command, sizeof(buffer));
-    buffer[sizeof(buffer) - 1] = '\0';
-
-    aud_command_node_t *curr = aud_command_table;
-
-    while (curr != NULL) 
-    {
-        size_t len = strlen(curr->command_name);
-        if (strncmp(buffer, curr->command_name, len) == 0 && (buffer[len] == ' ' || buffer[len] == '\0')) 
-        {
-            const char *args = (buffer[len] == ' ') ? buffer + len + 1 : "";
-            curr->handler(args);
-            return;
-        }
-        curr = curr->next;
-    }
-    LOG_WARNING("Unknown command received: \"%s\"", buffer);
+/**
+ * @brief Dispatches a command given as a slice of an input buffer.
+ *
+ * @param line Start of the command line.
+ * @param len Length of the command line, without any newline.
+ * @return How the line was handled.
+ */
+aud_dispatch_status_t dispatch_command_slice(const char *line, size_t len)
+{
+    return dispatch_line(line, len, false);
 }
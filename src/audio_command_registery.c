@@ -2,7 +2,7 @@
  * @file audio_command_regsistry.c
  * @brief Audio Command Registry Implementation
  * This file implements the command registration and processing functionality for the audio command processor.
- * It includes functions to register commands, dispatch them, and manage the command linked list.
+ * It includes the command handlers and registers them with the command processor.
  */
 
 #include <stdio.h>
@@ -11,149 +11,374 @@
 #include "audio_command_processor.h"
 #include "audio_logger.h"
 #include "audio_command_registery.h"
+#include "audio_command_args.h"
 #include "audio_systemState.h"
-#include "audio_buffer.h"
+#include "audio_mixer.h"
+#include "audio_pipeline.h"
+#include "audio_report.h"
+#include "audio_stats.h"
+#include "audio_session.h"
+#include "audio_timer.h"
 
-audio_buffer_t audio_buffer;  // Global audio buffer instance
+// ====================================================================================
+// Playback routing: commands run by a session use its chunk buffer, all others the pipeline
+
+static void post_playback(aud_slice_t source)
+{
+    audio_session_t *session = audio_session_current();
+    if (session != NULL)
+    {
+        audio_session_queue_chunks(session, source.ptr, source.len);
+        return;
+    }
+    // Hand the source to the decoder thread; playback drains the ring concurrently
+    request_audio_playback(source.ptr, source.len);
+}
+
+static void flush_playback(void)
+{
+    audio_session_t *session = audio_session_current();
+    if (session != NULL)
+    {
+        audio_session_flush_chunks(session);
+        return;
+    }
+    flush_audio_pipeline();
+}
+
+static void report_playback_state(void)
+{
+    if (!LOG_ENABLED(LOG_SEVERITY_INFO))
+    {
+        return;
+    }
+    audio_session_t *session = audio_session_current();
+    if (session != NULL)
+    {
+        print_audio_buffer_state(&session->chunks);
+        return;
+    }
+    audio_report_ring();
+}
+
+// ====================================================================================
+// Argument schemas of the typed commands
+
+#define AUDIO_RAMP_MAX_NS 600e9                                  // Longest fade or ramp: 10 minutes
+
+static const char *const reset_words[] = { "reset", NULL };
+
+static const aud_arg_spec_t play_args[] = { AUD_ARG_OPTIONAL_PATH_SPEC("source") };
+static const aud_arg_spec_t volume_set_args[] = { AUD_ARG_INT_SPEC("volume", AUDIO_VOLUME_MIN, AUDIO_VOLUME_MAX) };
+static const aud_arg_spec_t reset_args[] = { AUD_ARG_OPTIONAL_ENUM_SPEC("action", reset_words) };
+static const aud_arg_spec_t stream_start_args[] = { AUD_ARG_PATH_SPEC("source") };
+static const aud_arg_spec_t stream_id_args[] = { AUD_ARG_INT_SPEC("id", 0, AUDIO_MIXER_MAX_STREAMS - 1) };
+static const aud_arg_spec_t stream_gain_args[] = {
+    AUD_ARG_INT_SPEC("id", 0, AUDIO_MIXER_MAX_STREAMS - 1),
+    AUD_ARG_INT_SPEC("percent", 0, AUDIO_MIXER_GAIN_MAX * 100),
+};
+static const aud_arg_spec_t stream_seek_args[] = {
+    AUD_ARG_INT_SPEC("id", 0, AUDIO_MIXER_MAX_STREAMS - 1),
+    AUD_ARG_DURATION_SPEC("offset", 0, 0),
+};
+static const aud_arg_spec_t after_args[] = {
+    AUD_ARG_DURATION_SPEC("delay", 0, 0),
+    AUD_ARG_PATH_SPEC("command"),
+};
+static const aud_arg_spec_t cancel_args[] = { AUD_ARG_INT_SPEC("id", 1, INT64_MAX) };    // Timer ids are never 0
+static const aud_arg_spec_t fade_args[] = {
+    AUD_ARG_INT_SPEC("volume", AUDIO_VOLUME_MIN, AUDIO_VOLUME_MAX),
+    AUD_ARG_DURATION_SPEC("duration", 0, AUDIO_RAMP_MAX_NS),
+};
+
+#define ARG_SCHEMA(specs, text) { (specs), sizeof(specs) / sizeof((specs)[0]), (text) }
+
+static const aud_arg_schema_t play_schema = ARG_SCHEMA(play_args, "play [file.wav]");
+static const aud_arg_schema_t volume_set_schema = ARG_SCHEMA(volume_set_args, "volumeSet <0-100>");
+static const aud_arg_schema_t stats_schema = ARG_SCHEMA(reset_args, "stats [reset]");
+static const aud_arg_schema_t playback_schema = ARG_SCHEMA(reset_args, "playback [reset]");
+static const aud_arg_schema_t stream_start_schema = ARG_SCHEMA(stream_start_args, "streamStart <file.wav | tone Hz>");
+static const aud_arg_schema_t stream_stop_schema = ARG_SCHEMA(stream_id_args, "streamStop <id>");
+static const aud_arg_schema_t stream_gain_schema = ARG_SCHEMA(stream_gain_args, "streamGain <id> <percent 0-200>");
+static const aud_arg_schema_t stream_seek_schema = ARG_SCHEMA(stream_seek_args, "streamSeek <id> <offset, e.g. 12.5s>");
+static const aud_arg_schema_t after_schema = ARG_SCHEMA(after_args, "after <delay, e.g. 2s> <command>");
+static const aud_arg_schema_t cancel_schema = ARG_SCHEMA(cancel_args, "cancel <timer id>");
+static const aud_arg_schema_t fade_schema = ARG_SCHEMA(fade_args, "fade <0-100> <duration, e.g. 2s>");
+static const aud_arg_schema_t ramp_schema = ARG_SCHEMA(fade_args, "ramp <0-100> <duration, e.g. 500ms>");
 
 // ====================================================================================
 // Audio command handlers
 
 // Implementation for handling help command
-static void handle_help_command(const char *command)
+static void handle_help_command(const aud_command_line_t *line)
 {
+    (void)line;
     printf("\nAvailable Commands:\n");
     printf(" - play       : Start playing audio\n");
     printf(" - pause      : Pause audio playback and clear buffer\n");
     printf(" - volumeUp   : Increase volume by 10 units (max 100)\n");
     printf(" - volumeDown : Decrease volume by 10 units (min 0)\n");
+    printf(" - volumeSet  : Set the volume: volumeSet <0-100>\n");
     printf(" - mute       : Mute the audio\n");
     printf(" - unmute     : Unmute the audio\n");
     printf(" - reset      : Reset system state and buffer\n");
+    printf(" - stats      : Show handler latency per command (stats reset clears it)\n");
+    printf(" - playback   : Show underruns, wakeup lateness and ring fill (playback reset clears it)\n");
+    printf(" - streamStart: Mix another stream: streamStart <file.wav | tone Hz>\n");
+    printf(" - streamStop : Stop a mixed stream: streamStop <id>\n");
+    printf(" - streamGain : Set a stream's gain: streamGain <id> <percent 0-200>\n");
+    printf(" - streamSeek : Move a stream: streamSeek <id> <offset, e.g. 12.5s or 2000ms>\n");
+    printf(" - streams    : List the mixed streams\n");
+    printf(" - fade       : Fade the volume in equal dB steps: fade <0-100> <duration, e.g. 2s>\n");
+    printf(" - ramp       : Ramp the volume linearly: ramp <0-100> <duration, e.g. 500ms>\n");
+    printf(" - after      : Run a command later: after <delay, e.g. 2s> <command>\n");
+    printf(" - cancel     : Cancel a delayed command: cancel <timer id>\n");
     printf(" - help       : Show the list of commands supported\n\n");
 
     LOG_INFO("Displayed help information.");
 }
 
 // Implementation for handling play command
-static void handle_play_command(const char *command)
+static void handle_play_command(const aud_command_line_t *line)
 {
-    audioState *state = get_audio_state();
-    if (!state->flags.is_muted) 
+    if (audio_state_start_playing())                    // Set playing flag unless muted
     {
-        state->flags.is_playing = 1;                   // Set playing flag
-        LOG_INFO("Playing audio: %s", command);
-
-        // Simulate enqueueing 5 chunks
-        for (int i = 1; i <= 5; i++) {
-            char dummy_chunk[AUDIO_BUFFER_SIZE];
-            snprintf(dummy_chunk, AUDIO_BUFFER_SIZE, "AUDIO_CHUNK_%d", i);
-            enqueue_audio_command(&audio_buffer, dummy_chunk);
-        }
-
-        // Show buffer state after enqueue
-        print_audio_buffer_state(&audio_buffer);
-
-        // Simulate dequeuing 2 chunks (playback)
-        for (int i = 0; i < 2; i++) {
-            char out_chunk[AUDIO_BUFFER_SIZE];
-            if (dequeue_audio_command(&audio_buffer, out_chunk)) 
-            {
-                printf("[AUDIO] Playing chunk: %s\n", out_chunk);
-            }
+        LOG_INFO("Playing audio: %.*s", AUD_SLICE_ARG(line->args));
+        aud_slice_t source = { "", 0 };
+        if (line->values->count > 0)
+        {
+            source = line->values->v[0].path;
         }
+        post_playback(source);
 
-        // Show buffer state after dequeue
-        print_audio_buffer_state(&audio_buffer);
+        // Show ring state after the request
+        report_playback_state();
     }
-    LOG_INFO("Handling play command: %s", command);
-    print_audio_state();
+    LOG_INFO("Handling play command: %.*s", AUD_SLICE_ARG(line->args));
+    audio_report_state();
 }
 
 // Implementation for handling stop command
-static void handle_pause_command(const char *command) 
+static void handle_pause_command(const aud_command_line_t *line)
 {
-    audioState *state = get_audio_state();
-    state->flags.is_playing = 0;                        // Clear playing flag
+    audio_state_set_flags(0, AUDIO_FLAG_PLAYING);       // Clear playing flag
 
-    // Reset the audio buffer
-    reset_audio_buffer(&audio_buffer);
+    // Abort decoding and drop queued chunks
+    flush_playback();
+    if (LOG_ENABLED(LOG_SEVERITY_INFO))
+    {
+        printf("Audio buffer has been reset.\n");
+    }
+    report_playback_state();
 
-    LOG_INFO("Handling pause command: %s", command);
-    print_audio_state();
+    LOG_INFO("Handling pause command: %.*s", AUD_SLICE_ARG(line->args));
+    audio_report_state();
 }
 
 // Implementation for handling volume get command
-static void handle_volume_get_command(const char *command)
+static void handle_volume_get_command(const aud_command_line_t *line)
 {
-    audioState *state = get_audio_state();
-    printf("Current volume: %d\n", state->volume);
-    LOG_INFO("Handling volume get command: %s", command);
-    print_audio_state();
+    audioState state = snapshot_audio_state();
+    if (LOG_ENABLED(LOG_SEVERITY_INFO))
+    {
+        printf("Current volume: %d\n", state.volume);
+    }
+    LOG_INFO("Handling volume get command: %.*s", AUD_SLICE_ARG(line->args));
+    audio_report_state();
 }
 
 // Implementation for handling volume up command
-static void handle_volume_up_command(const char *command)
+static void handle_volume_up_command(const aud_command_line_t *line)
 {
-    audioState *state = get_audio_state();
-    if (state->volume < 100) 
-    {
-        state->volume += 10;                            // Increase volume by 10
-        if (state->volume > 100) 
-        {
-            state->volume = 100;                        // Cap volume at 100
-        }
-    }
-    LOG_INFO("Handling volume up command: %s", command);
-    print_audio_state();
+    audio_state_step_volume(AUDIO_VOLUME_STEP);         // Increase volume by 10, capped at 100
+    LOG_INFO("Handling volume up command: %.*s", AUD_SLICE_ARG(line->args));
+    audio_report_state();
+}
+
+// Implementation for handling volume set command ("volumeSet <0-100>")
+static void handle_volume_set_command(const aud_command_line_t *line)
+{
+    audio_state_set_volume((int)line->values->v[0].i);
+    LOG_INFO("Handling volume set command: %.*s", AUD_SLICE_ARG(line->args));
+    audio_report_state();
 }
 
 // Implementation for handling volume down command
-static void handle_volume_down_command(const char *command)
+static void handle_volume_down_command(const aud_command_line_t *line)
 {
-    audioState *state = get_audio_state();
-    if (state->volume > 0) 
-    {
-        state->volume -= 10;                             // Decrease volume by 10
-        if (state->volume < 0) 
-        {
-            state->volume = 0;                           // Cap volume at 0
-        }
-    }
-    LOG_INFO("Handling volume down command: %s", command);
-    print_audio_state();
+    audio_state_step_volume(-AUDIO_VOLUME_STEP);         // Decrease volume by 10, capped at 0
+    LOG_INFO("Handling volume down command: %.*s", AUD_SLICE_ARG(line->args));
+    audio_report_state();
 }
 
 // Implementation for handling reset command
-static void handle_reset_command(const char *command)
+static void handle_reset_command(const aud_command_line_t *line)
 {
     reset_audio_system();                                // Reset the audio system state
-    LOG_INFO("Handling reset command: %s", command);
-    print_audio_state();
+    LOG_INFO("Handling reset command: %.*s", AUD_SLICE_ARG(line->args));
+    audio_report_state();
 }
 
 // Implementation for handling mute command
-static void handle_mute_command(const char *command)
+static void handle_mute_command(const aud_command_line_t *line)
 {
-    audioState *state = get_audio_state();
-    state->flags.is_muted = 1;                           // Set muted flag
-    LOG_INFO("Handling mute command: %s", command);
-    print_audio_state();
+    audio_state_set_flags(AUDIO_FLAG_MUTED, 0);          // Set muted flag
+    LOG_INFO("Handling mute command: %.*s", AUD_SLICE_ARG(line->args));
+    audio_report_state();
 }
 
 // Implementation for handling unmute command
-static void handle_unmute_command(const char *command)
+static void handle_unmute_command(const aud_command_line_t *line)
 {
-    audioState *state = get_audio_state();
-    state->flags.is_muted = 0;                           // Clear muted flag
-    LOG_INFO("Handling unmute command: %s", command);
-    print_audio_state();
+    audio_state_set_flags(0, AUDIO_FLAG_MUTED);          // Clear muted flag
+    LOG_INFO("Handling unmute command: %.*s", AUD_SLICE_ARG(line->args));
+    audio_report_state();
 }
 
 // Implementation for handling invalid command
-static void handle_invalid_command(const char *command)
+static void handle_invalid_command(const aud_command_line_t *line)
 {
-    LOG_ERROR("Invalid command received: %s", command);
+    LOG_ERROR("Invalid command received: %.*s", AUD_SLICE_ARG(line->args));
+}
+
+// Implementation for handling stats command ("stats reset" clears the counters)
+static void handle_stats_command(const aud_command_line_t *line)
+{
+    if (line->values->count > 0)                                   // The only action is "reset"
+    {
+        audio_stats_reset();
+        LOG_INFO("Command statistics reset.");
+        return;
+    }
+    print_command_stats();
+}
+
+// Implementation for handling playback command ("playback reset" clears the counters)
+static void handle_playback_command(const aud_command_line_t *line)
+{
+    if (line->values->count > 0)                                   // The only action is "reset"
+    {
+        reset_audio_playback_stats();
+        LOG_INFO("Playback statistics reset.");
+        return;
+    }
+    print_audio_playback_stats();
+}
+
+// Implementation for handling stream start command ("streamStart <file.wav | tone Hz>")
+static void handle_stream_start_command(const aud_command_line_t *line)
+{
+    aud_slice_t source = line->values->v[0].path;
+    int id = start_audio_stream(source.ptr, source.len, 1.0f);
+    if (id < 0)
+    {
+        LOG_ERROR("Cannot start stream: %.*s", AUD_SLICE_ARG(source));
+        return;
+    }
+    LOG_INFO("Started stream %d: %.*s", id, AUD_SLICE_ARG(source));
+}
+
+// Implementation for handling stream stop command ("streamStop <id>")
+static void handle_stream_stop_command(const aud_command_line_t *line)
+{
+    int id = (int)line->values->v[0].i;
+    if (!stop_audio_stream(id))
+    {
+        LOG_ERROR("No such stream: %d", id);
+        return;
+    }
+    LOG_INFO("Stopped stream %d", id);
+}
+
+// Implementation for handling stream gain command ("streamGain <id> <percent 0-200>")
+static void handle_stream_gain_command(const aud_command_line_t *line)
+{
+    int id = (int)line->values->v[0].i;
+    int percent = (int)line->values->v[1].i;
+    if (!set_audio_stream_gain(id, (float)percent / 100.0f))
+    {
+        LOG_ERROR("No such stream: %d", id);
+        return;
+    }
+    LOG_INFO("Stream %d gain set to %d%%", id, percent);
+}
+
+// Implementation for handling stream seek command ("streamSeek <id> <offset>")
+static void handle_stream_seek_command(const aud_command_line_t *line)
+{
+    int id = (int)line->values->v[0].i;
+    int64_t offset_ns = line->values->v[1].ns;
+    if (!seek_audio_stream(id, offset_ns))
+    {
+        LOG_ERROR("No such stream: %d", id);
+        return;
+    }
+    LOG_INFO("Stream %d seeking to %.3f s", id, (double)offset_ns / 1e9);
+}
+
+// Implementation for handling streams command
+static void handle_streams_command(const aud_command_line_t *line)
+{
+    (void)line;
+    print_audio_streams();
+}
+
+// Moves the volume over a duration: the gain stage ramps to the new volume instead of jumping
+static void ramp_volume(const aud_command_line_t *line, audio_ramp_curve_t curve)
+{
+    int volume = (int)line->values->v[0].i;
+    int64_t duration_ns = line->values->v[1].ns;
+    if (audio_session_current() == NULL)                           // Sessions have no gain stage to ramp
+    {
+        audioState state = snapshot_audio_state();
+        request_audio_gain_ramp(audio_gain_from_volume(volume, state.flags.is_muted), (uint64_t)duration_ns, curve);
+    }
+    audio_state_set_volume(volume);
+    LOG_INFO("Handling %s command: %.*s", (curve == AUDIO_RAMP_EXPONENTIAL) ? "fade" : "ramp", AUD_SLICE_ARG(line->args));
+    audio_report_state();
+}
+
+// Implementation for handling fade command ("fade <0-100> <duration>")
+static void handle_fade_command(const aud_command_line_t *line)
+{
+    ramp_volume(line, AUDIO_RAMP_EXPONENTIAL);
+}
+
+// Implementation for handling ramp command ("ramp <0-100> <duration>")
+static void handle_ramp_command(const aud_command_line_t *line)
+{
+    ramp_volume(line, AUDIO_RAMP_LINEAR);
+}
+
+// Implementation for handling after command ("after <delay> <command>")
+static void handle_after_command(const aud_command_line_t *line)
+{
+    if (audio_session_current() != NULL)
+    {
+        LOG_ERROR("Delayed commands are not available in sessions");
+        return;
+    }
+    aud_slice_t command = line->values->v[1].path;
+    uint64_t id = audio_delay_command((uint64_t)line->values->v[0].ns, command.ptr, command.len);
+    if (id == 0)
+    {
+        LOG_ERROR("Cannot schedule command (at most %d bytes): %.*s", AUDIO_TIMER_TEXT_MAX, AUD_SLICE_ARG(command));
+        return;
+    }
+    LOG_INFO("Scheduled timer %llu in %.3f s: %.*s", (unsigned long long)id, (double)line->values->v[0].ns / 1e9,
+             AUD_SLICE_ARG(command));
+}
+
+// Implementation for handling cancel command ("cancel <timer id>")
+static void handle_cancel_command(const aud_command_line_t *line)
+{
+    uint64_t id = (uint64_t)line->values->v[0].i;
+    if (!audio_cancel_command(id))
+    {
+        LOG_ERROR("No such timer: %llu", (unsigned long long)id);
+        return;
+    }
+    LOG_INFO("Cancelled timer %llu", (unsigned long long)id);
 }
 
 
@@ -169,14 +394,26 @@ static void handle_invalid_command(const char *command)
 void register_audio_commands(void) 
 {
     // Registering commands with their respective handlers
-    register_command("help", handle_help_command);
-    register_command("play", handle_play_command);
-    register_command("pause", handle_pause_command);
-    register_command("volumeGet", handle_volume_get_command);
-    register_command("volumeUp", handle_volume_up_command);
-    register_command("volumeDown", handle_volume_down_command);
-    register_command("reset", handle_reset_command);
-    register_command("mute", handle_mute_command);
-    register_command("unmute", handle_unmute_command);
-    register_command("invalid", handle_invalid_command); 
+    register_command_slice("help", handle_help_command);
+    register_command_typed("play", &play_schema, handle_play_command);
+    register_command_slice("pause", handle_pause_command);
+    register_command_slice("volumeGet", handle_volume_get_command);
+    register_command_slice("volumeUp", handle_volume_up_command);
+    register_command_slice("volumeDown", handle_volume_down_command);
+    register_command_typed("volumeSet", &volume_set_schema, handle_volume_set_command);
+    register_command_slice("reset", handle_reset_command);
+    register_command_slice("mute", handle_mute_command);
+    register_command_slice("unmute", handle_unmute_command);
+    register_command_slice("invalid", handle_invalid_command);
+    register_command_typed("stats", &stats_schema, handle_stats_command);
+    register_command_typed("playback", &playback_schema, handle_playback_command);
+    register_command_typed("streamStart", &stream_start_schema, handle_stream_start_command);
+    register_command_typed("streamStop", &stream_stop_schema, handle_stream_stop_command);
+    register_command_typed("streamGain", &stream_gain_schema, handle_stream_gain_command);
+    register_command_typed("streamSeek", &stream_seek_schema, handle_stream_seek_command);
+    register_command_slice("streams", handle_streams_command);
+    register_command_typed("fade", &fade_schema, handle_fade_command);
+    register_command_typed("ramp", &ramp_schema, handle_ramp_command);
+    register_command_typed("after", &after_schema, handle_after_command);
+    register_command_typed("cancel", &cancel_schema, handle_cancel_command);
 }
\ No newline at end of file
@@ -0,0 +1,597 @@
+/**
+ * @file src/audio_gain.c
+ * @brief Gain Stage Implementation
+ *
+ * int16 samples are widened to float, scaled, clamped and packed back with
+ * signed saturation, so any gain (including boosts above 1.0) saturates
+ * correctly. The AVX2 kernels are compiled with a function-level target
+ * attribute so the rest of the program does not require AVX2.
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include "audio_gain.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AUDIO_GAIN_X86 1
+#include <immintrin.h>
+#endif
+
+typedef void (*gain_s16_fn)(int16_t *samples, size_t count, float gain);
+typedef void (*gain_f32_fn)(float *samples, size_t count, float gain);
+typedef float (*ramp_s16_fn)(int16_t *samples, size_t frames, uint32_t channels, float gain, float mul, float add);
+typedef float (*ramp_f32_fn)(float *samples, size_t frames, uint32_t channels, float gain, float mul, float add);
+
+static gain_s16_fn gain_s16_kernel;                   // Selected int16 kernel
+static gain_f32_fn gain_f32_kernel;                   // Selected float kernel
+static ramp_s16_fn ramp_s16_kernel;                   // Selected int16 ramp kernel
+static ramp_f32_fn ramp_f32_kernel;                   // Selected float ramp kernel
+static audio_isa_t gain_isa = AUDIO_ISA_SCALAR;       // ISA of the selected kernels
+static pthread_once_t gain_once = PTHREAD_ONCE_INIT;
+
+// ====================================================================================
+// Scalar kernels
+
+static void gain_s16_scalar(int16_t *samples, size_t count, float gain)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        float v = (float)samples[i] * gain;
+        if (v > 32767.0f)
+        {
+            v = 32767.0f;
+        }
+        else if (v < -32768.0f)
+        {
+            v = -32768.0f;
+        }
+        samples[i] = (int16_t)__builtin_lrintf(v);
+    }
+}
+
+static void gain_f32_scalar(float *samples, size_t count, float gain)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        float v = samples[i] * gain;
+        samples[i] = (v > 1.0f) ? 1.0f : (v < -1.0f) ? -1.0f : v;
+    }
+}
+
+// Ramps: the gain of each frame follows g' = g * mul + add (linear ramps have
+// mul 1, exponential ramps add 0), so one kernel serves both curves
+
+static float ramp_s16_scalar(int16_t *samples, size_t frames, uint32_t channels, float gain, float mul, float add)
+{
+    for (size_t f = 0; f < frames; f++, samples += channels)
+    {
+        for (uint32_t c = 0; c < channels; c++)
+        {
+            float v = (float)samples[c] * gain;
+            v = (v > 32767.0f) ? 32767.0f : (v < -32768.0f) ? -32768.0f : v;
+            samples[c] = (int16_t)__builtin_lrintf(v);
+        }
+        gain = gain * mul + add;
+    }
+    return gain;
+}
+
+static float ramp_f32_scalar(float *samples, size_t frames, uint32_t channels, float gain, float mul, float add)
+{
+    for (size_t f = 0; f < frames; f++, samples += channels)
+    {
+        for (uint32_t c = 0; c < channels; c++)
+        {
+            float v = samples[c] * gain;
+            samples[c] = (v > 1.0f) ? 1.0f : (v < -1.0f) ? -1.0f : v;
+        }
+        gain = gain * mul + add;
+    }
+    return gain;
+}
+
+/**
+ * @brief Spreads a ramp over vector lanes.
+ *
+ * Fills the gain of each of width interleaved samples and the (mul, add)
+ * pair that advances every lane by width / channels frames at once.
+ */
+static void ramp_lanes(float *lanes, uint32_t width, uint32_t channels, float gain, float mul, float add,
+                       float *step_mul, float *step_add)
+{
+    for (uint32_t l = 0; l < width; l++)
+    {
+        float g = gain;
+        for (uint32_t f = 0; f < l / channels; f++)
+        {
+            g = g * mul + add;
+        }
+        lanes[l] = g;
+    }
+    *step_mul = 1.0f;
+    *step_add = 0.0f;
+    for (uint32_t f = 0; f < width / channels; f++)
+    {
+        *step_add = *step_add * mul + add;
+        *step_mul *= mul;
+    }
+}
+
+#ifdef AUDIO_GAIN_X86
+// ====================================================================================
+// SSE2 kernels
+
+__attribute__((target("sse2")))
+static void gain_s16_sse2(int16_t *samples, size_t count, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(samples + i));
+        __m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);         // Sign-extend the low four samples
+        __m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);         // Sign-extend the high four samples
+        __m128 fa = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(a), g), lo), hi);
+        __m128 fb = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(b), g), lo), hi);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(fa), _mm_cvtps_epi32(fb));
+        _mm_storeu_si128((__m128i *)(samples + i), packed);
+    }
+    gain_s16_scalar(samples + i, count - i, gain);
+}
+
+__attribute__((target("sse2")))
+static void gain_f32_sse2(float *samples, size_t count, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(samples + i), g);
+        _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(v, lo), hi));
+    }
+    gain_f32_scalar(samples + i, count - i, gain);
+}
+
+__attribute__((target("sse2")))
+static float ramp_s16_sse2(int16_t *samples, size_t frames, uint32_t channels, float gain, float mul, float add)
+{
+    size_t count = frames * channels;
+    size_t i = 0;
+    if (8 % channels == 0)                            // Each step must cover whole frames; two vectors per step
+    {
+        float lanes[8];
+        float step_mul;
+        float step_add;
+        ramp_lanes(lanes, 8, channels, gain, mul, add, &step_mul, &step_add);
+        __m128 ga = _mm_loadu_ps(lanes);
+        __m128 gb = _mm_loadu_ps(lanes + 4);
+        const __m128 m = _mm_set1_ps(step_mul);
+        const __m128 a = _mm_set1_ps(step_add);
+        const __m128 hi = _mm_set1_ps(32767.0f);
+        const __m128 lo = _mm_set1_ps(-32768.0f);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(samples + i));
+            __m128 fa = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+            __m128 fb = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+            fa = _mm_min_ps(_mm_max_ps(_mm_mul_ps(fa, ga), lo), hi);
+            fb = _mm_min_ps(_mm_max_ps(_mm_mul_ps(fb, gb), lo), hi);
+            _mm_storeu_si128((__m128i *)(samples + i), _mm_packs_epi32(_mm_cvtps_epi32(fa), _mm_cvtps_epi32(fb)));
+            ga = _mm_add_ps(_mm_mul_ps(ga, m), a);
+            gb = _mm_add_ps(_mm_mul_ps(gb, m), a);
+        }
+        gain = _mm_cvtss_f32(ga);                     // Lane 0 is the next frame's gain
+    }
+    return ramp_s16_scalar(samples + i, (count - i) / channels, channels, gain, mul, add);
+}
+
+__attribute__((target("sse2")))
+static float ramp_f32_sse2(float *samples, size_t frames, uint32_t channels, float gain, float mul, float add)
+{
+    size_t count = frames * channels;
+    size_t i = 0;
+    if (8 % channels == 0)                            // Two vectors per step: independent multiply-add chains
+    {
+        float lanes[8];
+        float step_mul;
+        float step_add;
+        ramp_lanes(lanes, 8, channels, gain, mul, add, &step_mul, &step_add);
+        __m128 ga = _mm_loadu_ps(lanes);
+        __m128 gb = _mm_loadu_ps(lanes + 4);
+        const __m128 m = _mm_set1_ps(step_mul);
+        const __m128 a = _mm_set1_ps(step_add);
+        const __m128 hi = _mm_set1_ps(1.0f);
+        const __m128 lo = _mm_set1_ps(-1.0f);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128 va = _mm_mul_ps(_mm_loadu_ps(samples + i), ga);
+            __m128 vb = _mm_mul_ps(_mm_loadu_ps(samples + i + 4), gb);
+            _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(va, lo), hi));
+            _mm_storeu_ps(samples + i + 4, _mm_min_ps(_mm_max_ps(vb, lo), hi));
+            ga = _mm_add_ps(_mm_mul_ps(ga, m), a);
+            gb = _mm_add_ps(_mm_mul_ps(gb, m), a);
+        }
+        gain = _mm_cvtss_f32(ga);
+    }
+    return ramp_f32_scalar(samples + i, (count - i) / channels, channels, gain, mul, add);
+}
+
+// ====================================================================================
+// AVX2 kernels
+
+__attribute__((target("avx2")))
+static void gain_s16_avx2(int16_t *samples, size_t count, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    const __m256 hi = _mm256_set1_ps(32767.0f);
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)(samples + i));
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(samples + i + 8));
+        __m256 f0 = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v0));
+        __m256 f1 = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v1));
+        f0 = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(f0, g), lo), hi);
+        f1 = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(f1, g), lo), hi);
+        __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(f0), _mm256_cvtps_epi32(f1));
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);                 // Undo the per-lane interleave of packs
+        _mm256_storeu_si256((__m256i *)(samples + i), packed);
+    }
+    gain_s16_sse2(samples + i, count - i, gain);
+}
+
+__attribute__((target("avx2")))
+static void gain_f32_avx2(float *samples, size_t count, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    const __m256 hi = _mm256_set1_ps(1.0f);
+    const __m256 lo = _mm256_set1_ps(-1.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(samples + i), g);
+        _mm256_storeu_ps(samples + i, _mm256_min_ps(_mm256_max_ps(v, lo), hi));
+    }
+    gain_f32_sse2(samples + i, count - i, gain);
+}
+
+__attribute__((target("avx2")))
+static float ramp_s16_avx2(int16_t *samples, size_t frames, uint32_t channels, float gain, float mul, float add)
+{
+    size_t count = frames * channels;
+    size_t i = 0;
+    if (16 % channels == 0)
+    {
+        float lanes[16];
+        float step_mul;
+        float step_add;
+        ramp_lanes(lanes, 16, channels, gain, mul, add, &step_mul, &step_add);
+        __m256 g0 = _mm256_loadu_ps(lanes);
+        __m256 g1 = _mm256_loadu_ps(lanes + 8);
+        const __m256 m = _mm256_set1_ps(step_mul);
+        const __m256 a = _mm256_set1_ps(step_add);
+        const __m256 hi = _mm256_set1_ps(32767.0f);
+        const __m256 lo = _mm256_set1_ps(-32768.0f);
+        for (; i + 16 <= count; i += 16)
+        {
+            __m256 f0 = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(samples + i))));
+            __m256 f1 = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(samples + i + 8))));
+            f0 = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(f0, g0), lo), hi);
+            f1 = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(f1, g1), lo), hi);
+            __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(f0), _mm256_cvtps_epi32(f1));
+            _mm256_storeu_si256((__m256i *)(samples + i), _mm256_permute4x64_epi64(packed, 0xD8));
+            g0 = _mm256_add_ps(_mm256_mul_ps(g0, m), a);
+            g1 = _mm256_add_ps(_mm256_mul_ps(g1, m), a);
+        }
+        gain = _mm256_cvtss_f32(g0);
+    }
+    return ramp_s16_scalar(samples + i, (count - i) / channels, channels, gain, mul, add);
+}
+
+__attribute__((target("avx2")))
+static float ramp_f32_avx2(float *samples, size_t frames, uint32_t channels, float gain, float mul, float add)
+{
+    size_t count = frames * channels;
+    size_t i = 0;
+    if (16 % channels == 0)
+    {
+        float lanes[16];
+        float step_mul;
+        float step_add;
+        ramp_lanes(lanes, 16, channels, gain, mul, add, &step_mul, &step_add);
+        __m256 g0 = _mm256_loadu_ps(lanes);
+        __m256 g1 = _mm256_loadu_ps(lanes + 8);
+        const __m256 m = _mm256_set1_ps(step_mul);
+        const __m256 a = _mm256_set1_ps(step_add);
+        const __m256 hi = _mm256_set1_ps(1.0f);
+        const __m256 lo = _mm256_set1_ps(-1.0f);
+        for (; i + 16 <= count; i += 16)
+        {
+            __m256 v0 = _mm256_mul_ps(_mm256_loadu_ps(samples + i), g0);
+            __m256 v1 = _mm256_mul_ps(_mm256_loadu_ps(samples + i + 8), g1);
+            _mm256_storeu_ps(samples + i, _mm256_min_ps(_mm256_max_ps(v0, lo), hi));
+            _mm256_storeu_ps(samples + i + 8, _mm256_min_ps(_mm256_max_ps(v1, lo), hi));
+            g0 = _mm256_add_ps(_mm256_mul_ps(g0, m), a);
+            g1 = _mm256_add_ps(_mm256_mul_ps(g1, m), a);
+        }
+        gain = _mm256_cvtss_f32(g0);
+    }
+    return ramp_f32_scalar(samples + i, (count - i) / channels, channels, gain, mul, add);
+}
+#endif // AUDIO_GAIN_X86
+
+// ====================================================================================
+// Kernel selection
+
+/**
+ * @brief Returns the best ISA supported by this CPU.
+ */
+audio_isa_t audio_gain_detect_isa(void)
+{
+#ifdef AUDIO_GAIN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return AUDIO_ISA_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return AUDIO_ISA_SSE2;
+    }
+#endif
+    return AUDIO_ISA_SCALAR;
+}
+
+/**
+ * @brief Installs the kernels for an ISA, capped at what the CPU supports.
+ */
+static void set_gain_kernels(audio_isa_t isa)
+{
+    audio_isa_t best = audio_gain_detect_isa();
+    if (isa > best)
+    {
+        isa = best;
+    }
+
+    gain_s16_kernel = gain_s16_scalar;
+    gain_f32_kernel = gain_f32_scalar;
+    ramp_s16_kernel = ramp_s16_scalar;
+    ramp_f32_kernel = ramp_f32_scalar;
+#ifdef AUDIO_GAIN_X86
+    if (isa == AUDIO_ISA_AVX2)
+    {
+        gain_s16_kernel = gain_s16_avx2;
+        gain_f32_kernel = gain_f32_avx2;
+        ramp_s16_kernel = ramp_s16_avx2;
+        ramp_f32_kernel = ramp_f32_avx2;
+    }
+    else if (isa == AUDIO_ISA_SSE2)
+    {
+        gain_s16_kernel = gain_s16_sse2;
+        gain_f32_kernel = gain_f32_sse2;
+        ramp_s16_kernel = ramp_s16_sse2;
+        ramp_f32_kernel = ramp_f32_sse2;
+    }
+#endif
+    gain_isa = isa;
+}
+
+static void gain_select_best(void)
+{
+    set_gain_kernels(audio_gain_detect_isa());
+}
+
+/**
+ * @brief Forces a kernel variant.
+ *
+ * Requests for an ISA the CPU lacks fall back to the best supported one.
+ *
+ * @param isa The requested ISA.
+ */
+void audio_gain_select_isa(audio_isa_t isa)
+{
+    pthread_once(&gain_once, gain_select_best);      // Keep a later lazy init from overriding the choice
+    set_gain_kernels(isa);
+}
+
+/**
+ * @brief Returns the ISA of the kernels in use.
+ */
+audio_isa_t audio_gain_active_isa(void)
+{
+    pthread_once(&gain_once, gain_select_best);
+    return gain_isa;
+}
+
+/**
+ * @brief Returns a printable ISA name.
+ */
+const char *audio_isa_name(audio_isa_t isa)
+{
+    switch (isa)
+    {
+        case AUDIO_ISA_AVX2: return "avx2";
+        case AUDIO_ISA_SSE2: return "sse2";
+        default:             return "scalar";
+    }
+}
+
+// ====================================================================================
+// Public entry points
+
+/**
+ * @brief Scales int16 samples in place with saturation.
+ *
+ * @param samples The samples.
+ * @param count Number of samples (frames * channels).
+ * @param gain Linear gain.
+ */
+void audio_gain_apply_s16(int16_t *samples, size_t count, float gain)
+{
+    if (gain == 1.0f)
+    {
+        return;                                       // Unity: nothing to do
+    }
+    if (gain == 0.0f)
+    {
+        memset(samples, 0, count * sizeof(int16_t));  // Mute: silence without multiplying
+        return;
+    }
+    pthread_once(&gain_once, gain_select_best);
+    gain_s16_kernel(samples, count, gain);
+}
+
+/**
+ * @brief Scales float samples in place with saturation.
+ *
+ * @param samples The samples.
+ * @param count Number of samples (frames * channels).
+ * @param gain Linear gain.
+ */
+void audio_gain_apply_f32(float *samples, size_t count, float gain)
+{
+    if (gain == 1.0f)
+    {
+        return;
+    }
+    if (gain == 0.0f)
+    {
+        memset(samples, 0, count * sizeof(float));
+        return;
+    }
+    pthread_once(&gain_once, gain_select_best);
+    gain_f32_kernel(samples, count, gain);
+}
+
+/**
+ * @brief Scales every sample of a PCM chunk in place.
+ *
+ * @param chunk The chunk to scale.
+ * @param config Format of the chunk.
+ * @param gain Linear gain.
+ */
+void audio_gain_apply_chunk(audio_pcm_chunk_t *chunk, const audio_pcm_config_t *config, float gain)
+{
+    size_t count = (size_t)chunk->frames * config->channels;
+    if (config->format == AUDIO_SAMPLE_F32)
+    {
+        audio_gain_apply_f32(audio_pcm_samples(chunk), count, gain);
+    }
+    else
+    {
+        audio_gain_apply_s16(audio_pcm_samples(chunk), count, gain);
+    }
+}
+
+/**
+ * @brief Jumps to a gain, ending any ramp.
+ */
+void audio_gain_ramp_set(audio_gain_ramp_t *ramp, float gain)
+{
+    ramp->gain = gain;
+    ramp->target = gain;
+    ramp->mul = 1.0f;
+    ramp->add = 0.0f;
+    ramp->frames = 0;
+}
+
+/**
+ * @brief Starts a ramp from the current gain to target.
+ *
+ * An exponential ramp moves by equal ratios (equal steps in dB); it starts
+ * and ends at AUDIO_RAMP_FLOOR instead of silence and snaps to the exact
+ * target on its last frame.
+ *
+ * @param ramp The ramp state.
+ * @param target Gain once the ramp ends.
+ * @param frames Ramp length in frames (0 jumps at once).
+ * @param curve Linear or exponential.
+ */
+void audio_gain_ramp_start(audio_gain_ramp_t *ramp, float target, uint32_t frames, audio_ramp_curve_t curve)
+{
+    if (frames == 0 || target == ramp->gain)
+    {
+        audio_gain_ramp_set(ramp, target);
+        return;
+    }
+    ramp->target = target;
+    ramp->frames = frames;
+    if (curve == AUDIO_RAMP_EXPONENTIAL)
+    {
+        float from = (ramp->gain > AUDIO_RAMP_FLOOR) ? ramp->gain : AUDIO_RAMP_FLOOR;
+        float to = (target > AUDIO_RAMP_FLOOR) ? target : AUDIO_RAMP_FLOOR;
+        ramp->gain = from;
+        ramp->mul = (float)pow((double)to / from, 1.0 / frames);
+        ramp->add = 0.0f;
+    }
+    else
+    {
+        ramp->mul = 1.0f;
+        ramp->add = (target - ramp->gain) / (float)frames;
+    }
+}
+
+/**
+ * @brief Applies the ramp (or the steady gain) to one PCM chunk in place.
+ *
+ * Outside a ramp this is audio_gain_apply_chunk() with the steady gain, so
+ * the steady state keeps the constant-gain kernels and their fast paths.
+ *
+ * @return The gain at the end of the chunk.
+ */
+float audio_gain_ramp_apply_chunk(audio_gain_ramp_t *ramp, audio_pcm_chunk_t *chunk, const audio_pcm_config_t *config)
+{
+    if (ramp->frames == 0)
+    {
+        audio_gain_apply_chunk(chunk, config, ramp->gain);
+        return ramp->gain;
+    }
+    pthread_once(&gain_once, gain_select_best);
+    uint32_t frames = (chunk->frames < ramp->frames) ? chunk->frames : (uint32_t)ramp->frames;
+    size_t done = (size_t)frames * config->channels;
+    size_t rest = (size_t)(chunk->frames - frames) * config->channels;
+    bool f32 = (config->format == AUDIO_SAMPLE_F32);
+    ramp->gain = f32 ? ramp_f32_kernel(audio_pcm_samples(chunk), frames, config->channels, ramp->gain, ramp->mul, ramp->add)
+                     : ramp_s16_kernel(audio_pcm_samples(chunk), frames, config->channels, ramp->gain, ramp->mul, ramp->add);
+    ramp->frames -= frames;
+    if (ramp->frames == 0)
+    {
+        audio_gain_ramp_set(ramp, ramp->target);
+        if (f32)
+        {
+            audio_gain_apply_f32((float *)audio_pcm_samples(chunk) + done, rest, ramp->gain);
+        }
+        else
+        {
+            audio_gain_apply_s16((int16_t *)audio_pcm_samples(chunk) + done, rest, ramp->gain);
+        }
+    }
+    return ramp->gain;
+}
+
+/**
+ * @brief Maps the system volume and mute flag to a linear gain.
+ *
+ * @param volume Volume level 0-100 (100 is unity gain).
+ * @param muted Non-zero when muted.
+ * @return The linear gain.
+ */
+float audio_gain_from_volume(int volume, int muted)
+{
+    if (muted || volume <= 0)
+    {
+        return 0.0f;
+    }
+    if (volume >= 100)
+    {
+        return 1.0f;
+    }
+    return (float)volume / 100.0f;
+}
@@ -0,0 +1,691 @@
+/**
+ * @file src/audio_journal.c
+ * @brief Command Journal and State Snapshot Implementation
+ *
+ * Appends happen on the dispatching thread, under journal_lock, straight
+ * into the shared file mapping; on Linux fdatasync() writes back the dirty
+ * pages of a shared mapping, so no msync() is needed. The flush thread only
+ * ever touches the file descriptor, and a snapshot waits for a running sync
+ * before it replaces the file.
+ */
+
+#define _GNU_SOURCE                                   // mremap()
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "audio_command_processor.h"
+#include "audio_journal.h"
+#include "audio_logger.h"
+#include "audio_pipeline.h"
+#include "audio_session.h"
+#include "audio_systemState.h"
+
+#define JOURNAL_MAGIC "AJN1"
+#define SNAPSHOT_MAGIC "ASN1"
+#define SNAPSHOT_BYTES 48
+#define JOURNAL_PATH_MAX 4096
+#define JOURNAL_ALIGN 8                               // Records start on this boundary
+#define RECORD_SIZE(len) (AUDIO_JOURNAL_RECORD_BYTES + (((size_t)(len) + JOURNAL_ALIGN - 1) & ~(size_t)(JOURNAL_ALIGN - 1)))
+
+static pthread_mutex_t journal_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t journal_work = PTHREAD_COND_INITIALIZER;   // Records wait to be synced
+static pthread_cond_t journal_synced = PTHREAD_COND_INITIALIZER; // A group commit finished
+static pthread_t journal_flusher;
+static bool journal_running = false;
+static bool journal_syncing = false;                  // The flush thread is inside fdatasync()
+static bool journal_replaying = false;                // Recovery is dispatching journal records
+
+static audio_journal_config_t journal_config;
+static char journal_path[JOURNAL_PATH_MAX];
+static char snapshot_path[JOURNAL_PATH_MAX];
+static int journal_fd = -1;
+static uint8_t *journal_map = NULL;
+static size_t journal_map_size = 0;
+static size_t journal_tail = 0;                       // Offset of the next record
+static uint64_t appended_sequence = 0;                // Last sequence written to the mapping
+static uint64_t synced_sequence = 0;                  // Last sequence known to be on disk
+static uint32_t journaled_state = 0;                  // State word after the last journaled command
+static size_t records_since_snapshot = 0;
+static audio_journal_stats_t journal_stats;
+
+// ====================================================================================
+// CRC32C
+
+static uint32_t crc_table[256];
+static bool crc_hardware = false;
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+
+static void crc_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t c = i;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            c = (c & 1u) ? (c >> 1) ^ 0x82F63B78u : c >> 1;   // Castagnoli polynomial, reflected
+        }
+        crc_table[i] = c;
+    }
+#if defined(__x86_64__)
+    crc_hardware = __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t *p, size_t len)
+{
+    uint64_t c = crc;
+    for (; len >= 8; p += 8, len -= 8)
+    {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        c = __builtin_ia32_crc32di(c, v);
+    }
+    crc = (uint32_t)c;
+    for (; len > 0; p++, len--)
+    {
+        crc = __builtin_ia32_crc32qi(crc, *p);
+    }
+    return crc;
+}
+#endif
+
+/**
+ * @brief Computes CRC32C, continuing from a previous result.
+ *
+ * @param crc 0 to start, or the CRC of the preceding bytes.
+ * @param data The bytes.
+ * @param len Number of bytes.
+ */
+uint32_t audio_crc32c(uint32_t crc, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    pthread_once(&crc_once, crc_init);
+    crc = ~crc;
+#if defined(__x86_64__)
+    if (crc_hardware)
+    {
+        return ~crc32c_sse42(crc, p, len);
+    }
+#endif
+    for (; len > 0; p++, len--)
+    {
+        crc = crc_table[(crc ^ *p) & 0xFFu] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// ====================================================================================
+// Little-endian fields
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_u64(uint8_t *p, uint64_t v)
+{
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint64_t get_u64(const uint8_t *p)
+{
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+// ====================================================================================
+// Files
+
+/**
+ * @brief Makes a rename in the directory of path durable.
+ */
+static void sync_parent_directory(const char *path)
+{
+    char directory[JOURNAL_PATH_MAX];
+    const char *slash = strrchr(path, '/');
+    size_t len = (slash == NULL) ? 0 : (slash == path) ? 1 : (size_t)(slash - path);
+    memcpy(directory, (len == 0) ? "." : path, (len == 0) ? 2 : len);
+    directory[(len == 0) ? 1 : len] = '\0';
+    int fd = open(directory, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd >= 0)
+    {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+/**
+ * @brief Writes a whole file aside, syncs it and renames it over path.
+ */
+static bool replace_file(const char *path, const void *data, size_t len, size_t reserve)
+{
+    char temporary[JOURNAL_PATH_MAX + 8];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    int fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool ok = write(fd, data, len) == (ssize_t)len;
+    if (ok && reserve > len)
+    {
+        ok = posix_fallocate(fd, 0, (off_t)reserve) == 0 || ftruncate(fd, (off_t)reserve) == 0;
+    }
+    ok = ok && fdatasync(fd) == 0;
+    close(fd);
+    if (!ok || rename(temporary, path) != 0)
+    {
+        unlink(temporary);
+        return false;
+    }
+    sync_parent_directory(path);
+    return true;
+}
+
+/**
+ * @brief Writes a snapshot of the state after the given sequence.
+ */
+static bool write_snapshot(uint64_t sequence, uint32_t state)
+{
+    uint8_t snapshot[SNAPSHOT_BYTES] = { 0 };
+    audio_ring_view_t ring = { 0, 0, 0, 0 };
+    audio_pipeline_ring_view(&ring);                  // Left empty when the pipeline is not running
+
+    memcpy(snapshot, SNAPSHOT_MAGIC, 4);
+    put_u32(snapshot + 4, AUDIO_JOURNAL_VERSION);
+    put_u64(snapshot + 8, sequence);
+    put_u32(snapshot + 16, state);
+    put_u32(snapshot + 20, (uint32_t)ring.count);
+    put_u32(snapshot + 24, (uint32_t)ring.capacity);
+    put_u32(snapshot + 28, (uint32_t)ring.head);
+    put_u32(snapshot + 32, (uint32_t)ring.tail);
+    put_u32(snapshot + SNAPSHOT_BYTES - 4, audio_crc32c(0, snapshot, SNAPSHOT_BYTES - 4));
+    return replace_file(snapshot_path, snapshot, sizeof(snapshot), 0);
+}
+
+/**
+ * @brief Loads the snapshot, if a valid one exists, and restores its state.
+ */
+static bool load_snapshot(uint64_t *sequence)
+{
+    uint8_t snapshot[SNAPSHOT_BYTES];
+    int fd = open(snapshot_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool ok = read(fd, snapshot, sizeof(snapshot)) == (ssize_t)sizeof(snapshot) &&
+              memcmp(snapshot, SNAPSHOT_MAGIC, 4) == 0 && get_u32(snapshot + 4) == AUDIO_JOURNAL_VERSION &&
+              get_u32(snapshot + SNAPSHOT_BYTES - 4) == audio_crc32c(0, snapshot, SNAPSHOT_BYTES - 4);
+    close(fd);
+    if (!ok)
+    {
+        LOG_WARNING("Ignoring invalid journal snapshot %s", snapshot_path);
+        return false;
+    }
+    *sequence = get_u64(snapshot + 8);
+    audio_state_restore(get_u32(snapshot + 16));
+    LOG_INFO("Journal snapshot %s: sequence %llu, ring held %u of %u chunks", snapshot_path,
+             (unsigned long long)*sequence, get_u32(snapshot + 20), get_u32(snapshot + 24));
+    return true;
+}
+
+static void fill_header(uint8_t *header, uint64_t first_sequence)
+{
+    memset(header, 0, AUDIO_JOURNAL_HEADER_BYTES);
+    memcpy(header, JOURNAL_MAGIC, 4);
+    put_u32(header + 4, AUDIO_JOURNAL_VERSION);
+    put_u64(header + 8, first_sequence);
+    put_u32(header + AUDIO_JOURNAL_HEADER_BYTES - 4, audio_crc32c(0, header, AUDIO_JOURNAL_HEADER_BYTES - 4));
+}
+
+static bool valid_header(const uint8_t *header)
+{
+    return memcmp(header, JOURNAL_MAGIC, 4) == 0 && get_u32(header + 4) == AUDIO_JOURNAL_VERSION &&
+           get_u32(header + AUDIO_JOURNAL_HEADER_BYTES - 4) == audio_crc32c(0, header, AUDIO_JOURNAL_HEADER_BYTES - 4);
+}
+
+/**
+ * @brief Replaces the journal with an empty one starting at first_sequence.
+ */
+static bool create_journal(uint64_t first_sequence)
+{
+    uint8_t header[AUDIO_JOURNAL_HEADER_BYTES];
+    fill_header(header, first_sequence);
+    return replace_file(journal_path, header, sizeof(header), AUDIO_JOURNAL_GROW_BYTES);
+}
+
+/**
+ * @brief Opens and maps the journal file.
+ */
+static bool map_journal(void)
+{
+    struct stat st;
+    journal_fd = open(journal_path, O_RDWR | O_CLOEXEC);
+    if (journal_fd < 0 || fstat(journal_fd, &st) != 0 || (size_t)st.st_size < AUDIO_JOURNAL_HEADER_BYTES)
+    {
+        return false;
+    }
+    journal_map_size = (size_t)st.st_size;
+    journal_map = mmap(NULL, journal_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, journal_fd, 0);
+    if (journal_map == MAP_FAILED)
+    {
+        journal_map = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void unmap_journal(void)
+{
+    if (journal_map != NULL)
+    {
+        munmap(journal_map, journal_map_size);
+    }
+    if (journal_fd >= 0)
+    {
+        close(journal_fd);
+    }
+    journal_map = NULL;
+    journal_map_size = 0;
+    journal_fd = -1;
+}
+
+/**
+ * @brief Grows the file and the mapping so that need more bytes fit.
+ */
+static bool grow_journal(size_t need)
+{
+    size_t size = journal_map_size;
+    while (journal_tail + need > size)
+    {
+        size += AUDIO_JOURNAL_GROW_BYTES;
+    }
+    if (posix_fallocate(journal_fd, 0, (off_t)size) != 0 && ftruncate(journal_fd, (off_t)size) != 0)
+    {
+        return false;
+    }
+    void *map = mremap(journal_map, journal_map_size, size, MREMAP_MAYMOVE);
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+    journal_map = map;
+    journal_map_size = size;
+    return true;
+}
+
+// ====================================================================================
+// Recovery
+
+/**
+ * @brief Dispatches one journal record and checks the state it produced.
+ */
+static void replay_record(const uint8_t *record, audio_journal_recovery_t *recovery)
+{
+    uint32_t len = get_u32(record + 4);
+    uint32_t state = get_u32(record + 16);
+    dispatch_command_slice((const char *)record + AUDIO_JOURNAL_RECORD_BYTES, len);
+    if ((audio_state_word() ^ state) & AUDIO_STATE_VALUE_BITS)
+    {
+        audio_state_restore(state);                   // The record is authoritative
+        recovery->corrected++;
+    }
+    recovery->replayed++;
+}
+
+/**
+ * @brief Replays the records after the snapshot and finds the end of the journal.
+ *
+ * @param after Last sequence already covered by the snapshot.
+ * @param recovery Receives the counts.
+ */
+static void replay_journal(uint64_t after, audio_journal_recovery_t *recovery)
+{
+    uint64_t expected = get_u64(journal_map + 8);
+    size_t offset = AUDIO_JOURNAL_HEADER_BYTES;
+    if (expected > after + 1)
+    {
+        LOG_WARNING("Journal starts at sequence %llu but the snapshot ends at %llu; state may be incomplete",
+                    (unsigned long long)expected, (unsigned long long)after);
+    }
+
+    int saved_level = log_runtime_level;
+    log_set_runtime_level(LOG_SEVERITY_NONE);         // Replayed handlers stay quiet
+    journal_replaying = true;
+    while (offset + AUDIO_JOURNAL_RECORD_BYTES <= journal_map_size)
+    {
+        const uint8_t *record = journal_map + offset;
+        uint32_t len = get_u32(record + 4);
+        if (len == 0 && get_u32(record) == 0)
+        {
+            break;                                    // Zero fill: the clean end
+        }
+        size_t size = RECORD_SIZE(len);
+        if (len > journal_map_size || offset + size > journal_map_size || get_u64(record + 8) != expected ||
+            get_u32(record) != audio_crc32c(0, record + 4, size - 4))
+        {
+            recovery->torn_tail = true;
+            break;
+        }
+        if (expected > after)
+        {
+            replay_record(record, recovery);
+        }
+        expected++;
+        offset += size;
+    }
+    journal_replaying = false;
+    log_set_runtime_level(saved_level);
+
+    if (recovery->torn_tail)
+    {
+        memset(journal_map + offset, 0, journal_map_size - offset);   // Never replay what follows a torn record
+    }
+    journal_tail = offset;
+    appended_sequence = (expected > after + 1) ? expected - 1 : after;
+    synced_sequence = appended_sequence;
+}
+
+// ====================================================================================
+// Appending
+
+/**
+ * @brief Appends one command and its resulting state.
+ *
+ * @return The record's sequence, or 0 if it could not be written.
+ */
+static uint64_t append_record(const aud_command_line_t *line, uint32_t state)
+{
+    size_t len = line->name.len + (line->args.len > 0 ? 1 + line->args.len : 0);
+    size_t size = RECORD_SIZE(len);
+
+    pthread_mutex_lock(&journal_lock);
+    if (journal_map == NULL || (journal_tail + size > journal_map_size && !grow_journal(size)))
+    {
+        pthread_mutex_unlock(&journal_lock);
+        LOG_ERROR("Journal append failed: %s", strerror(errno));
+        return 0;
+    }
+    uint8_t *record = journal_map + journal_tail;
+    uint8_t *text = record + AUDIO_JOURNAL_RECORD_BYTES;
+    uint64_t sequence = ++appended_sequence;
+    memcpy(text, line->name.ptr, line->name.len);
+    if (line->args.len > 0)
+    {
+        text[line->name.len] = ' ';
+        memcpy(text + line->name.len + 1, line->args.ptr, line->args.len);
+    }
+    memset(text + len, 0, size - AUDIO_JOURNAL_RECORD_BYTES - len);
+    put_u32(record + 4, (uint32_t)len);
+    put_u64(record + 8, sequence);
+    put_u32(record + 16, state);
+    put_u32(record + 20, 0);
+    put_u32(record, audio_crc32c(0, record + 4, size - 4));
+    journal_tail += size;
+    journal_stats.records++;
+    journal_stats.bytes += size;
+    journal_stats.sequence = sequence;
+    pthread_cond_signal(&journal_work);
+
+    if (journal_config.durable)
+    {
+        while (synced_sequence < sequence && journal_running)
+        {
+            pthread_cond_wait(&journal_synced, &journal_lock);
+        }
+    }
+    pthread_mutex_unlock(&journal_lock);
+    return sequence;
+}
+
+/**
+ * @brief Command observer: journals every command that changed the process-wide state.
+ *
+ * Every state transition bumps the change counter, so comparing the whole
+ * word with the one after the last journaled command tells whether the
+ * command changed anything.
+ */
+static void journal_observer(const aud_command_line_t *line, aud_dispatch_status_t status)
+{
+    if (status != AUD_DISPATCH_OK || journal_replaying || audio_session_current() != NULL)
+    {
+        return;
+    }
+    uint32_t state = audio_state_word();
+    if (state == journaled_state)
+    {
+        return;
+    }
+    journaled_state = state;
+    if (append_record(line, state) != 0 && journal_config.snapshot_every > 0 &&
+        ++records_since_snapshot >= journal_config.snapshot_every)
+    {
+        audio_journal_snapshot();
+    }
+}
+
+/**
+ * @brief Flush thread: one fdatasync() per group of appends.
+ */
+static void *journal_flush_thread(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&journal_lock);
+    for (;;)
+    {
+        while (journal_running && synced_sequence >= appended_sequence)
+        {
+            pthread_cond_wait(&journal_work, &journal_lock);
+        }
+        if (synced_sequence >= appended_sequence)
+        {
+            break;                                    // Stopped with nothing left to sync
+        }
+        if (journal_config.commit_interval_ns > 0 && journal_running)
+        {
+            // Let the group fill: appends during the window share the sync
+            struct timespec window = { (time_t)(journal_config.commit_interval_ns / 1000000000ULL),
+                                       (long)(journal_config.commit_interval_ns % 1000000000ULL) };
+            pthread_mutex_unlock(&journal_lock);
+            nanosleep(&window, NULL);
+            pthread_mutex_lock(&journal_lock);
+            if (synced_sequence >= appended_sequence)
+            {
+                continue;                             // A snapshot made the group durable meanwhile
+            }
+        }
+
+        uint64_t target = appended_sequence;
+        int fd = journal_fd;
+        journal_syncing = true;
+        pthread_mutex_unlock(&journal_lock);
+        int result = fdatasync(fd);
+        pthread_mutex_lock(&journal_lock);
+        journal_syncing = false;
+        if (result != 0)
+        {
+            LOG_ERROR("Journal fdatasync failed: %s", strerror(errno));
+        }
+        uint64_t group = target - synced_sequence;
+        journal_stats.largest_group = (group > journal_stats.largest_group) ? group : journal_stats.largest_group;
+        journal_stats.syncs++;
+        synced_sequence = target;
+        pthread_cond_broadcast(&journal_synced);
+    }
+    pthread_mutex_unlock(&journal_lock);
+    return NULL;
+}
+
+// ====================================================================================
+// Public interface
+
+/**
+ * @brief Fills in the default journal configuration.
+ */
+void audio_journal_default_config(audio_journal_config_t *config)
+{
+    config->path = NULL;
+    config->commit_interval_ns = AUDIO_JOURNAL_COMMIT_NS;
+    config->snapshot_every = AUDIO_JOURNAL_SNAPSHOT_EVERY;
+    config->durable = false;
+}
+
+/**
+ * @brief Recovers the state from the snapshot and journal, then starts journaling.
+ *
+ * Call after the commands are registered and frozen and before the pipeline
+ * starts. A missing or unreadable journal starts a new one.
+ *
+ * @param config Journal configuration; config->path is required.
+ * @param recovery Receives what was recovered; may be NULL.
+ * @return false if the journal cannot be created or mapped.
+ */
+bool audio_journal_open(const audio_journal_config_t *config, audio_journal_recovery_t *recovery)
+{
+    audio_journal_recovery_t local;
+    recovery = (recovery != NULL) ? recovery : &local;
+    memset(recovery, 0, sizeof(*recovery));
+    if (config->path == NULL || strlen(config->path) + 8 >= sizeof(journal_path))
+    {
+        LOG_ERROR("Invalid journal path");
+        return false;
+    }
+    journal_config = *config;
+    snprintf(journal_path, sizeof(journal_path), "%s", config->path);
+    snprintf(snapshot_path, sizeof(snapshot_path), "%s.snap", config->path);
+    memset(&journal_stats, 0, sizeof(journal_stats));
+
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    uint64_t after = 0;
+    recovery->snapshot_loaded = load_snapshot(&after);
+    recovery->snapshot_sequence = after;
+
+    if (!map_journal() || !valid_header(journal_map))
+    {
+        unmap_journal();
+        if (!create_journal(after + 1) || !map_journal())
+        {
+            LOG_ERROR("Cannot create journal %s: %s", journal_path, strerror(errno));
+            unmap_journal();
+            return false;
+        }
+    }
+    replay_journal(after, recovery);
+    audio_state_set_flags(0, AUDIO_FLAG_PLAYING);     // Playback is not resumed, so neither is the flag
+
+    struct timespec finished;
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    recovery->seconds = (double)(finished.tv_sec - started.tv_sec) + (double)(finished.tv_nsec - started.tv_nsec) / 1e9;
+    if (recovery->torn_tail)
+    {
+        LOG_WARNING("Journal %s ends in a torn record after sequence %llu; later bytes dropped",
+                    journal_path, (unsigned long long)appended_sequence);
+    }
+    LOG_INFO("Journal %s: replayed %llu commands after sequence %llu in %.3f ms",
+             journal_path, (unsigned long long)recovery->replayed, (unsigned long long)after, recovery->seconds * 1e3);
+
+    journal_stats.sequence = appended_sequence;
+    journaled_state = audio_state_word();
+    records_since_snapshot = (size_t)(appended_sequence - after);
+    journal_running = true;
+    if (pthread_create(&journal_flusher, NULL, journal_flush_thread, NULL) != 0)
+    {
+        journal_running = false;
+        unmap_journal();
+        LOG_ERROR("Cannot start the journal flush thread");
+        return false;
+    }
+    set_command_observer(journal_observer);
+    return true;
+}
+
+/**
+ * @brief Writes a snapshot of the current state and restarts the journal after it.
+ *
+ * Run on the dispatching thread, between commands, so the state matches the
+ * last journaled sequence.
+ *
+ * @return false if the snapshot or the new journal could not be written; the
+ *         old journal then stays in use.
+ */
+bool audio_journal_snapshot(void)
+{
+    pthread_mutex_lock(&journal_lock);
+    if (journal_map == NULL)
+    {
+        pthread_mutex_unlock(&journal_lock);
+        return false;
+    }
+    while (journal_syncing)
+    {
+        pthread_cond_wait(&journal_synced, &journal_lock);
+    }
+
+    bool ok = write_snapshot(appended_sequence, audio_state_word()) && create_journal(appended_sequence + 1);
+    if (ok)
+    {
+        unmap_journal();
+        ok = map_journal();
+        journal_tail = AUDIO_JOURNAL_HEADER_BYTES;
+        synced_sequence = appended_sequence;          // Everything so far is in the synced snapshot
+        records_since_snapshot = 0;
+        journal_stats.snapshots++;
+        pthread_cond_broadcast(&journal_synced);
+    }
+    pthread_mutex_unlock(&journal_lock);
+    if (!ok)
+    {
+        LOG_ERROR("Journal snapshot failed: %s", strerror(errno));
+    }
+    return ok;
+}
+
+/**
+ * @brief Snapshots the state, stops the flush thread and unmaps the journal.
+ */
+void audio_journal_close(void)
+{
+    if (!journal_running)
+    {
+        return;
+    }
+    set_command_observer(NULL);
+    audio_journal_snapshot();
+
+    pthread_mutex_lock(&journal_lock);
+    journal_running = false;
+    pthread_cond_broadcast(&journal_work);
+    pthread_mutex_unlock(&journal_lock);
+    pthread_join(journal_flusher, NULL);
+    unmap_journal();
+}
+
+/**
+ * @brief Returns the journal counters since open.
+ */
+audio_journal_stats_t audio_journal_stats(void)
+{
+    pthread_mutex_lock(&journal_lock);
+    audio_journal_stats_t stats = journal_stats;
+    pthread_mutex_unlock(&journal_lock);
+    return stats;
+}
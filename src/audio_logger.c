@@ -6,32 +6,567 @@
  * @param level The log level (INFO, WARNING, ERROR, INPUT).
  * @param format The format string for the log message.
  * @param ... Additional arguments for the format string.
+ *
+ * In asynchronous mode the message is rendered into a bounded multi-producer
+ * queue (one sequence number per cell, so producers never take a lock) and a
+ * flush thread writes batches of records to stdout.
+ *
+ * In binary mode nothing is formatted: the format pointer, a timestamp and the
+ * raw arguments are appended to a compact buffer (see audio_log_binary.h).
  */
 
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include "audio_logger.h"
+#include "audio_log_binary.h"
+
+#define LOG_QUEUE_CAPACITY 1024                       // Records held by the async queue (power of two)
+#define LOG_RECORD_TEXT 240                           // Longest message kept per record
+#define LOG_BATCH_BYTES 65536                         // Bytes collected before one write()
+
+typedef struct {
+    atomic_size_t sequence;                           // Cell turn: pos when free, pos + 1 when filled
+    log_level_t level;                                // Level of the record
+    uint32_t length;                                  // Bytes of text
+    char text[LOG_RECORD_TEXT];                       // Rendered message without prefix or newline
+} log_cell_t;
+
+static log_cell_t *log_queue = NULL;                  // Async queue, NULL in synchronous mode
+static _Alignas(64) atomic_size_t log_enqueue_pos;    // Next cell claimed by a producer
+static _Alignas(64) atomic_size_t log_written_pos;    // Records written by the flush thread
+static atomic_bool log_async_active;                  // Whether log calls go to the queue
+static atomic_uint log_async_producers;               // Log calls inside the queue path right now
+static atomic_flag log_async_atexit = ATOMIC_FLAG_INIT;   // Set once log_stop_async() is registered with atexit()
+static atomic_bool log_stop_requested;                // Tells the flush thread to drain and exit
+static atomic_uint_fast64_t log_dropped;              // Records lost to LOG_OVERFLOW_DROP
+static log_overflow_policy_t log_overflow = LOG_OVERFLOW_DROP;
+static pthread_t log_thread;
+
+#define LOG_BINARY_BUFFER (1u << 20)                  // Bytes buffered before the binary log is written
+#define LOG_BINARY_FORMATS 512                        // Format strings remembered (power of two)
+#define LOG_BINARY_MAX_ARGS 16                        // Arguments cached per format signature
+#define LOG_BINARY_PRECISION 0x80                     // Kind flag: this int is a '.*' precision
+
+typedef struct {
+    const char *format;                               // Format string pointer (NULL = empty entry)
+    uint8_t arg_count;                                // Number of encoded arguments
+    uint8_t kinds[LOG_BINARY_MAX_ARGS];               // log_arg_kind_t of each argument
+} log_signature_t;
+
+int log_runtime_level = LOG_SEVERITY_INFO;            // Runtime minimum severity
+
+static atomic_bool log_binary_active;                 // Whether log calls are encoded
+static atomic_flag log_binary_atexit = ATOMIC_FLAG_INIT;  // Set once log_stop_binary() is registered with atexit()
+static pthread_mutex_t log_binary_lock = PTHREAD_MUTEX_INITIALIZER;
+static FILE *log_binary_file = NULL;                  // Destination of the binary log
+static unsigned char *log_binary_buffer = NULL;       // Pending encoded records
+static size_t log_binary_used = 0;                    // Bytes pending in the buffer
+static log_signature_t log_binary_signatures[LOG_BINARY_FORMATS];   // Parsed formats, keyed by pointer
 
 /**
- * @brief Logs a message at the specified log level.
+ * @brief Returns the printed prefix of a level.
  */
-void log_message(log_level_t level, const char *format, ...) 
+static const char *log_level_prefix(log_level_t level)
 {
-    const char *level_str;
     switch (level) {
-        case LOG_LEVEL_INFO:    level_str = "[INFO] "; break;
-        case LOG_LEVEL_WARNING: level_str = "[WARNING] "; break;
-        case LOG_LEVEL_ERROR:   level_str = "[ERROR] "; break;
-        case LOG_LEVEL_INPUT:   level_str = "[INPUT] "; break;
-        default:                level_str = "[LOG] "; break;
+        case LOG_LEVEL_INFO:    return "[INFO] ";
+        case LOG_LEVEL_WARNING: return "[WARNING] ";
+        case LOG_LEVEL_ERROR:   return "[ERROR] ";
+        case LOG_LEVEL_INPUT:   return "[INPUT] ";
+        default:                return "[LOG] ";
+    }
+}
+
+/**
+ * @brief Writes a whole buffer to stdout, retrying short writes.
+ */
+static void write_all(const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(STDOUT_FILENO, data, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+/**
+ * @brief Claims a queue cell for a producer.
+ *
+ * @return The claimed cell (its position in *pos), or NULL if the queue is full.
+ */
+static log_cell_t *log_claim_cell(size_t *pos)
+{
+    size_t p = atomic_load_explicit(&log_enqueue_pos, memory_order_relaxed);
+    while (1)
+    {
+        log_cell_t *cell = &log_queue[p & (LOG_QUEUE_CAPACITY - 1)];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)p;
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&log_enqueue_pos, &p, p + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                *pos = p;
+                return cell;
+            }
+        }
+        else if (diff < 0)
+        {
+            return NULL;                              // The flush thread has not freed this cell yet
+        }
+        else
+        {
+            p = atomic_load_explicit(&log_enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Renders a message into the async queue.
+ */
+static void log_enqueue(log_level_t level, const char *format, va_list args)
+{
+    size_t pos;
+    log_cell_t *cell;
+    while ((cell = log_claim_cell(&pos)) == NULL)
+    {
+        if (log_overflow == LOG_OVERFLOW_DROP)
+        {
+            atomic_fetch_add_explicit(&log_dropped, 1, memory_order_relaxed);
+            return;
+        }
+        sched_yield();                                // LOG_OVERFLOW_BLOCK: wait for the flush thread
+    }
+
+    int n = vsnprintf(cell->text, sizeof(cell->text), format, args);
+    cell->level = level;
+    cell->length = (n < 0) ? 0 : (n >= (int)sizeof(cell->text)) ? sizeof(cell->text) - 1 : (uint32_t)n;
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);   // Publish to the flush thread
+}
+
+/**
+ * @brief Flush thread: drains the queue into batched writes.
+ */
+static void *log_flush_main(void *arg)
+{
+    (void)arg;
+    char *batch = malloc(LOG_BATCH_BYTES);
+    size_t used = 0;
+    size_t pos = atomic_load_explicit(&log_written_pos, memory_order_relaxed);
+
+    while (batch != NULL)
+    {
+        log_cell_t *cell = &log_queue[pos & (LOG_QUEUE_CAPACITY - 1)];
+        if (atomic_load_explicit(&cell->sequence, memory_order_acquire) == pos + 1)
+        {
+            const char *prefix = log_level_prefix(cell->level);
+            size_t prefix_len = strlen(prefix);
+            if (used + prefix_len + cell->length + 1 > LOG_BATCH_BYTES)
+            {
+                write_all(batch, used);
+                used = 0;
+            }
+            memcpy(batch + used, prefix, prefix_len);
+            memcpy(batch + used + prefix_len, cell->text, cell->length);
+            used += prefix_len + cell->length;
+            batch[used++] = '\n';
+
+            atomic_store_explicit(&cell->sequence, pos + LOG_QUEUE_CAPACITY, memory_order_release);  // Free the cell
+            pos++;
+            continue;
+        }
+
+        // Queue drained: write the batch, then publish progress for log_flush()
+        if (used > 0)
+        {
+            write_all(batch, used);
+            used = 0;
+        }
+        atomic_store_explicit(&log_written_pos, pos, memory_order_release);
+
+        if (atomic_load_explicit(&log_stop_requested, memory_order_acquire) &&
+            pos == atomic_load_explicit(&log_enqueue_pos, memory_order_acquire))
+        {
+            break;
+        }
+        struct timespec idle = { 0, 500000 };         // 0.5 ms
+        nanosleep(&idle, NULL);
+    }
+
+    free(batch);
+    return NULL;
+}
+
+// ====================================================================================
+// Binary deferred-formatting mode
+
+/**
+ * @brief Sets the runtime minimum severity.
+ */
+void log_set_runtime_level(int severity)
+{
+    log_runtime_level = severity;
+}
+
+static uint64_t log_timestamp_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void log_binary_drain(void)
+{
+    if (log_binary_used > 0)
+    {
+        fwrite(log_binary_buffer, 1, log_binary_used, log_binary_file);
+        log_binary_used = 0;
+    }
+}
+
+static void log_binary_put(const void *data, size_t len)
+{
+    if (log_binary_used + len > LOG_BINARY_BUFFER)
+    {
+        log_binary_drain();
+    }
+    memcpy(log_binary_buffer + log_binary_used, data, len);
+    log_binary_used += len;
+}
+
+/**
+ * @brief Returns the cached argument signature of a format, parsing it on first use.
+ *
+ * The first use also emits the format definition record. Called with
+ * log_binary_lock held.
+ */
+static const log_signature_t *log_binary_signature(const char *format, log_signature_t *scratch)
+{
+    size_t slot = ((uintptr_t)format >> 3) & (LOG_BINARY_FORMATS - 1);
+    for (size_t probe = 0; probe < LOG_BINARY_FORMATS; probe++)
+    {
+        log_signature_t *sig = &log_binary_signatures[(slot + probe) & (LOG_BINARY_FORMATS - 1)];
+        if (sig->format == format)
+        {
+            return sig;
+        }
+        if (sig->format == NULL)
+        {
+            scratch = sig;                            // Cache the new signature here
+            break;
+        }
     }
 
-    printf("%s", level_str);
+    // First use of this format: describe its arguments and define it in the file
+    scratch->format = format;
+    scratch->arg_count = 0;
+    log_spec_t spec;
+    for (const char *p = format; log_next_spec(p, &spec); p = spec.end)
+    {
+        for (int i = 0; i < spec.star_count && scratch->arg_count < LOG_BINARY_MAX_ARGS; i++)
+        {
+            bool precision = spec.precision_star && i == spec.star_count - 1;
+            scratch->kinds[scratch->arg_count++] = LOG_ARG_INT | (precision ? LOG_BINARY_PRECISION : 0);
+        }
+        if (spec.kind != LOG_ARG_NONE && scratch->arg_count < LOG_BINARY_MAX_ARGS)
+        {
+            scratch->kinds[scratch->arg_count++] = (uint8_t)spec.kind;
+        }
+    }
 
+    uint8_t tag = LOG_BINARY_TAG_FORMAT;
+    uint64_t id = (uint64_t)(uintptr_t)format;
+    uint32_t len = (uint32_t)strlen(format);
+    log_binary_put(&tag, sizeof(tag));
+    log_binary_put(&id, sizeof(id));
+    log_binary_put(&len, sizeof(len));
+    log_binary_put(format, len);
+    return scratch;
+}
+
+/**
+ * @brief Appends one record with raw arguments to the binary log.
+ */
+static void log_binary_record(log_level_t level, const char *format, va_list args)
+{
+    unsigned char payload[LOG_BINARY_MAX_ARGS * (sizeof(uint16_t) + LOG_BINARY_MAX_STRING)];
+    size_t used = 0;
+    uint64_t timestamp = log_timestamp_ns();
+
+    pthread_mutex_lock(&log_binary_lock);
+    if (log_binary_file == NULL)
+    {
+        pthread_mutex_unlock(&log_binary_lock);
+        return;
+    }
+
+    log_signature_t scratch;
+    const log_signature_t *sig = log_binary_signature(format, &scratch);
+    int precision = -1;                               // Pending '.*' precision for the next string
+    for (uint8_t i = 0; i < sig->arg_count; i++)
+    {
+        uint64_t word = 0;
+        switch (sig->kinds[i] & ~LOG_BINARY_PRECISION)
+        {
+            case LOG_ARG_INT:
+            {
+                int v = va_arg(args, int);
+                if (sig->kinds[i] & LOG_BINARY_PRECISION)
+                {
+                    precision = v;
+                }
+                word = (uint64_t)(int64_t)v;
+                break;
+            }
+            case LOG_ARG_INT64:
+                word = (uint64_t)va_arg(args, long long);
+                break;
+            case LOG_ARG_PTR:
+                word = (uint64_t)(uintptr_t)va_arg(args, void *);
+                break;
+            case LOG_ARG_DOUBLE:
+            {
+                double d = va_arg(args, double);
+                memcpy(&word, &d, sizeof(word));
+                break;
+            }
+            case LOG_ARG_STRING:
+            {
+                const char *str = va_arg(args, const char *);
+                size_t max = (precision >= 0 && precision < LOG_BINARY_MAX_STRING) ? (size_t)precision : LOG_BINARY_MAX_STRING;
+                uint16_t len = (str != NULL) ? (uint16_t)strnlen(str, max) : 0;
+                memcpy(payload + used, &len, sizeof(len));
+                memcpy(payload + used + sizeof(len), str, len);
+                used += sizeof(len) + len;
+                precision = -1;
+                continue;
+            }
+        }
+        memcpy(payload + used, &word, sizeof(word));
+        used += sizeof(word);
+        if (!(sig->kinds[i] & LOG_BINARY_PRECISION))
+        {
+            precision = -1;                           // A precision only applies to the conversion that follows it
+        }
+    }
+
+    uint8_t tag = LOG_BINARY_TAG_RECORD;
+    uint64_t id = (uint64_t)(uintptr_t)format;
+    uint8_t lvl = (uint8_t)level;
+    uint16_t payload_len = (uint16_t)used;
+    log_binary_put(&tag, sizeof(tag));
+    log_binary_put(&id, sizeof(id));
+    log_binary_put(&timestamp, sizeof(timestamp));
+    log_binary_put(&lvl, sizeof(lvl));
+    log_binary_put(&payload_len, sizeof(payload_len));
+    log_binary_put(payload, used);
+    pthread_mutex_unlock(&log_binary_lock);
+}
+
+/**
+ * @brief Switches logging to binary deferred-formatting mode.
+ */
+bool log_start_binary(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        LOG_ERROR("Cannot open binary log: %s", path);
+        return false;
+    }
+    unsigned char *buffer = malloc(LOG_BINARY_BUFFER);
+    if (buffer == NULL)
+    {
+        fclose(file);
+        LOG_ERROR("Memory allocation failed for binary log buffer");
+        return false;
+    }
+
+    pthread_mutex_lock(&log_binary_lock);
+    log_binary_file = file;
+    log_binary_buffer = buffer;
+    log_binary_used = 0;
+    memset(log_binary_signatures, 0, sizeof(log_binary_signatures));
+    log_binary_put(LOG_BINARY_MAGIC, sizeof(LOG_BINARY_MAGIC));
+    pthread_mutex_unlock(&log_binary_lock);
+
+    atomic_store_explicit(&log_binary_active, true, memory_order_release);
+    if (!atomic_flag_test_and_set(&log_binary_atexit))
+    {
+        atexit(log_stop_binary);
+    }
+    return true;
+}
+
+/**
+ * @brief Writes buffered binary records, closes the file and returns to text logging.
+ */
+void log_stop_binary(void)
+{
+    if (!atomic_exchange(&log_binary_active, false))
+    {
+        return;
+    }
+    pthread_mutex_lock(&log_binary_lock);
+    log_binary_drain();
+    fclose(log_binary_file);
+    free(log_binary_buffer);
+    log_binary_file = NULL;
+    log_binary_buffer = NULL;
+    pthread_mutex_unlock(&log_binary_lock);
+}
+
+// ====================================================================================
+
+/**
+ * @brief Logs a message at the specified log level.
+ */
+void log_message(log_level_t level, const char *format, ...) 
+{
     va_list args;
     va_start(args, format);
+
+    if (atomic_load_explicit(&log_binary_active, memory_order_acquire))
+    {
+        log_binary_record(level, format, args);
+        va_end(args);
+        return;
+    }
+
+    if (atomic_load_explicit(&log_async_active, memory_order_acquire))
+    {
+        // Announce the call, then check again: log_stop_async() clears the flag before it waits for
+        // the announced calls, so either it waits for this one or this one sees the flag cleared
+        atomic_fetch_add(&log_async_producers, 1);
+        if (atomic_load(&log_async_active))
+        {
+            log_enqueue(level, format, args);
+            atomic_fetch_sub_explicit(&log_async_producers, 1, memory_order_release);
+            va_end(args);
+            return;
+        }
+        atomic_fetch_sub_explicit(&log_async_producers, 1, memory_order_release);   // Stopping: write synchronously
+    }
+
+    flockfile(stdout);                                // Keep the three parts of a line together across threads
+    printf("%s", log_level_prefix(level));
     vprintf(format, args);
+    printf("\n");
+    funlockfile(stdout);
+
     va_end(args);
+}
 
-    printf("\n");
+/**
+ * @brief Switches logging to asynchronous mode.
+ */
+bool log_start_async(log_overflow_policy_t policy)
+{
+    if (atomic_load(&log_async_active))
+    {
+        return true;
+    }
+
+    log_queue = malloc(sizeof(log_cell_t) * LOG_QUEUE_CAPACITY);
+    if (log_queue == NULL)
+    {
+        LOG_ERROR("Memory allocation failed for log queue");
+        return false;
+    }
+    for (size_t i = 0; i < LOG_QUEUE_CAPACITY; i++)
+    {
+        atomic_init(&log_queue[i].sequence, i);
+    }
+    atomic_store(&log_enqueue_pos, 0);
+    atomic_store(&log_written_pos, 0);
+    atomic_store(&log_stop_requested, false);
+    log_overflow = policy;
+
+    fflush(stdout);                                   // Earlier synchronous output goes first
+    if (pthread_create(&log_thread, NULL, log_flush_main, NULL) != 0)
+    {
+        free(log_queue);
+        log_queue = NULL;
+        LOG_ERROR("Failed to start log flush thread");
+        return false;
+    }
+    atomic_store_explicit(&log_async_active, true, memory_order_release);
+    if (!atomic_flag_test_and_set(&log_async_atexit))
+    {
+        atexit(log_stop_async);                       // Flush even if the program exits early
+    }
+    return true;
+}
+
+/**
+ * @brief Waits until every record queued before the call has been written.
+ */
+void log_flush(void)
+{
+    if (!atomic_load_explicit(&log_async_active, memory_order_acquire))
+    {
+        fflush(stdout);
+        return;
+    }
+
+    fflush(stdout);
+    size_t target = atomic_load_explicit(&log_enqueue_pos, memory_order_acquire);
+    while (atomic_load_explicit(&log_written_pos, memory_order_acquire) < target)
+    {
+        struct timespec wait = { 0, 100000 };         // 0.1 ms
+        nanosleep(&wait, NULL);
+    }
+}
+
+/**
+ * @brief Flushes the queue, stops the flush thread and returns to synchronous logging.
+ */
+void log_stop_async(void)
+{
+    if (!atomic_exchange(&log_async_active, false))   // New log calls now write synchronously
+    {
+        return;
+    }
+    while (atomic_load_explicit(&log_async_producers, memory_order_acquire) != 0)
+    {
+        sched_yield();                                // Calls already in the queue path finish first
+    }
+
+    fflush(stdout);
+    atomic_store_explicit(&log_stop_requested, true, memory_order_release);
+    pthread_join(log_thread, NULL);
+    free(log_queue);
+    log_queue = NULL;
+
+    uint64_t dropped = atomic_load(&log_dropped);
+    if (dropped > 0)
+    {
+        LOG_WARNING("%llu log records dropped (queue full)", (unsigned long long)dropped);
+    }
+}
+
+/**
+ * @brief Returns the number of records dropped by the overflow policy.
+ */
+uint64_t log_dropped_count(void)
+{
+    return atomic_load(&log_dropped);
 }
@@ -0,0 +1,750 @@
+/**
+ * @file src/audio_mixer.c
+ * @brief Multi-Stream Mixer Implementation
+ *
+ * The accumulate kernels widen int16 input to float, so the sum of any
+ * number of streams is kept without wrapping; saturation happens once, in
+ * the store kernel. The kernel variant follows audio_gain_active_isa(), so
+ * audio_gain_select_isa() switches the gain stage and the mixer together.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "audio_mixer.h"
+#include "audio_gain.h"
+#include "audio_logger.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AUDIO_MIX_X86 1
+#include <immintrin.h>
+#endif
+
+#define MIXER_FEED_IDLE_NS 1000000                    // Feeder sleep when every ring is full (1 ms)
+
+// ====================================================================================
+// Scalar kernels
+
+static void acc_s16_scalar(float *acc, const int16_t *in, size_t count, float gain)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        acc[i] += (float)in[i] * gain;
+    }
+}
+
+static void acc_f32_scalar(float *acc, const float *in, size_t count, float gain)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        acc[i] += in[i] * gain;
+    }
+}
+
+static void store_s16_scalar(int16_t *out, const float *acc, size_t count, float gain)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        float v = acc[i] * gain;
+        v = (v > 32767.0f) ? 32767.0f : (v < -32768.0f) ? -32768.0f : v;
+        out[i] = (int16_t)__builtin_lrintf(v);
+    }
+}
+
+static void store_f32_scalar(float *out, const float *acc, size_t count, float gain)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        float v = acc[i] * gain;
+        out[i] = (v > 1.0f) ? 1.0f : (v < -1.0f) ? -1.0f : v;
+    }
+}
+
+#ifdef AUDIO_MIX_X86
+// ====================================================================================
+// SSE2 kernels
+
+__attribute__((target("sse2")))
+static void acc_s16_sse2(float *acc, const int16_t *in, size_t count, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128 a = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+        __m128 b = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(a, g)));
+        _mm_storeu_ps(acc + i + 4, _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(b, g)));
+    }
+    acc_s16_scalar(acc + i, in + i, count - i, gain);
+}
+
+__attribute__((target("sse2")))
+static void acc_f32_sse2(float *acc, const float *in, size_t count, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(_mm_loadu_ps(in + i), g)));
+    }
+    acc_f32_scalar(acc + i, in + i, count - i, gain);
+}
+
+__attribute__((target("sse2")))
+static void store_s16_sse2(int16_t *out, const float *acc, size_t count, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(acc + i), g), lo), hi);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(acc + i + 4), g), lo), hi);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+    store_s16_scalar(out + i, acc + i, count - i, gain);
+}
+
+__attribute__((target("sse2")))
+static void store_f32_sse2(float *out, const float *acc, size_t count, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(out + i, _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(acc + i), g), lo), hi));
+    }
+    store_f32_scalar(out + i, acc + i, count - i, gain);
+}
+
+// ====================================================================================
+// AVX2 kernels
+
+__attribute__((target("avx2")))
+static void acc_s16_avx2(float *acc, const int16_t *in, size_t count, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256 a = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(in + i))));
+        __m256 b = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(in + i + 8))));
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(a, g)));
+        _mm256_storeu_ps(acc + i + 8, _mm256_add_ps(_mm256_loadu_ps(acc + i + 8), _mm256_mul_ps(b, g)));
+    }
+    _mm256_zeroupper();                               // The tail runs legacy SSE code
+    acc_s16_sse2(acc + i, in + i, count - i, gain);
+}
+
+__attribute__((target("avx2")))
+static void acc_f32_avx2(float *acc, const float *in, size_t count, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(_mm256_loadu_ps(in + i), g)));
+    }
+    _mm256_zeroupper();                               // The tail runs legacy SSE code
+    acc_f32_sse2(acc + i, in + i, count - i, gain);
+}
+
+__attribute__((target("avx2")))
+static void store_s16_avx2(int16_t *out, const float *acc, size_t count, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    const __m256 hi = _mm256_set1_ps(32767.0f);
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(acc + i), g), lo), hi);
+        __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(acc + i + 8), g), lo), hi);
+        __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);                 // Undo the per-lane interleave of packs
+        _mm256_storeu_si256((__m256i *)(out + i), packed);
+    }
+    _mm256_zeroupper();                               // The tail runs legacy SSE code
+    store_s16_sse2(out + i, acc + i, count - i, gain);
+}
+
+__attribute__((target("avx2")))
+static void store_f32_avx2(float *out, const float *acc, size_t count, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    const __m256 hi = _mm256_set1_ps(1.0f);
+    const __m256 lo = _mm256_set1_ps(-1.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_ps(out + i, _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(acc + i), g), lo), hi));
+    }
+    _mm256_zeroupper();                               // The tail runs legacy SSE code
+    store_f32_sse2(out + i, acc + i, count - i, gain);
+}
+#endif // AUDIO_MIX_X86
+
+// ====================================================================================
+// Kernel selection
+
+typedef struct {
+    void (*acc_s16)(float *acc, const int16_t *in, size_t count, float gain);
+    void (*acc_f32)(float *acc, const float *in, size_t count, float gain);
+    void (*store_s16)(int16_t *out, const float *acc, size_t count, float gain);
+    void (*store_f32)(float *out, const float *acc, size_t count, float gain);
+} mix_kernels_t;
+
+static const mix_kernels_t mix_kernels[AUDIO_ISA_COUNT] = {
+    [AUDIO_ISA_SCALAR] = { acc_s16_scalar, acc_f32_scalar, store_s16_scalar, store_f32_scalar },
+#ifdef AUDIO_MIX_X86
+    [AUDIO_ISA_SSE2] = { acc_s16_sse2, acc_f32_sse2, store_s16_sse2, store_f32_sse2 },
+    [AUDIO_ISA_AVX2] = { acc_s16_avx2, acc_f32_avx2, store_s16_avx2, store_f32_avx2 },
+#else
+    [AUDIO_ISA_SSE2] = { acc_s16_scalar, acc_f32_scalar, store_s16_scalar, store_f32_scalar },
+    [AUDIO_ISA_AVX2] = { acc_s16_scalar, acc_f32_scalar, store_s16_scalar, store_f32_scalar },
+#endif
+};
+
+static inline const mix_kernels_t *active_kernels(void)
+{
+    return &mix_kernels[audio_gain_active_isa()];
+}
+
+/**
+ * @brief Adds int16 samples times a gain to a float accumulator.
+ */
+void audio_mix_accumulate_s16(float *acc, const int16_t *in, size_t count, float gain)
+{
+    active_kernels()->acc_s16(acc, in, count, gain);
+}
+
+/**
+ * @brief Adds float samples times a gain to a float accumulator.
+ */
+void audio_mix_accumulate_f32(float *acc, const float *in, size_t count, float gain)
+{
+    active_kernels()->acc_f32(acc, in, count, gain);
+}
+
+/**
+ * @brief Scales the accumulator into int16 samples with signed saturation.
+ */
+void audio_mix_store_s16(int16_t *out, const float *acc, size_t count, float gain)
+{
+    active_kernels()->store_s16(out, acc, count, gain);
+}
+
+/**
+ * @brief Scales the accumulator into float samples clamped to [-1, 1].
+ */
+void audio_mix_store_f32(float *out, const float *acc, size_t count, float gain)
+{
+    active_kernels()->store_f32(out, acc, count, gain);
+}
+
+// ====================================================================================
+// Mixer lifetime
+
+/**
+ * @brief Prepares a mixer for chunks of one format.
+ *
+ * @param mixer The mixer.
+ * @param config Format of the output and of every stream.
+ * @return true on success, false on allocation failure.
+ */
+bool audio_mixer_init(audio_mixer_t *mixer, const audio_pcm_config_t *config)
+{
+    memset(mixer, 0, sizeof(*mixer));
+    mixer->config = *config;
+
+    size_t samples = (size_t)config->frames_per_chunk * config->channels;
+    size_t acc_bytes = (samples * sizeof(float) + AUDIO_CACHE_LINE - 1) & ~(size_t)(AUDIO_CACHE_LINE - 1);
+    size_t chunk_bytes = sizeof(audio_pcm_chunk_t) + samples * audio_pcm_sample_bytes(config->format);
+    chunk_bytes = (chunk_bytes + AUDIO_CACHE_LINE - 1) & ~(size_t)(AUDIO_CACHE_LINE - 1);
+    mixer->accumulator = aligned_alloc(AUDIO_CACHE_LINE, acc_bytes);
+    mixer->scratch = aligned_alloc(AUDIO_CACHE_LINE, chunk_bytes);
+    if (mixer->accumulator == NULL || mixer->scratch == NULL)
+    {
+        LOG_ERROR("Memory allocation failed for the mixer");
+        free(mixer->accumulator);
+        free(mixer->scratch);
+        return false;
+    }
+    memset(mixer->scratch, 0, sizeof(audio_pcm_chunk_t));
+
+    for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++)
+    {
+        atomic_init(&mixer->streams[i].state, AUDIO_STREAM_FREE);
+        atomic_init(&mixer->streams[i].gain, 1.0f);
+    }
+    return true;
+}
+
+/**
+ * @brief Releases every stream ring and the mix buffers.
+ *
+ * The feeder must be stopped and no thread may be mixing.
+ */
+void audio_mixer_free(audio_mixer_t *mixer)
+{
+    for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++)
+    {
+        audio_mix_stream_t *s = &mixer->streams[i];
+        if (s->wav.mapped)
+        {
+            audio_wav_close(&s->wav);
+        }
+        if (s->ring_ready)
+        {
+            audio_pcm_ring_free(&s->ring);
+        }
+    }
+    free(mixer->accumulator);
+    free(mixer->scratch);
+    memset(mixer, 0, sizeof(*mixer));
+}
+
+// ====================================================================================
+// Feeder side
+
+/**
+ * @brief Moves a stream whose source has gone from one state to another.
+ *
+ * A stop request wins: if the stream is no longer in the expected state it
+ * was stopped, and it is left for the STOPPING pass to release.
+ */
+static void stream_transition(audio_mix_stream_t *s, int from, int to)
+{
+    atomic_compare_exchange_strong_explicit(&s->state, &from, to, memory_order_acq_rel, memory_order_acquire);
+}
+
+/**
+ * @brief Decodes into a stream's ring until it is full or the source ends.
+ */
+static size_t fill_stream(audio_mixer_t *mixer, audio_mix_stream_t *s)
+{
+    size_t decoded = 0;
+    int64_t seek = atomic_exchange_explicit(&s->seek_frame, -1, memory_order_relaxed);
+    if (seek >= 0)
+    {
+        s->next_frame = (s->tone_hz > 0.0 || (uint64_t)seek < s->wav.frames) ? (uint64_t)seek : s->wav.frames;
+    }
+    audio_pcm_chunk_t *chunk;
+    while ((chunk = audio_pcm_acquire_write(&s->ring)) != NULL)
+    {
+        if (s->tone_hz > 0.0)
+        {
+            audio_pcm_fill_tone(chunk, &mixer->config, s->tone_hz, s->next_frame);
+        }
+        else
+        {
+            chunk->frames = audio_wav_decode(&s->wav, s->next_frame, mixer->config.frames_per_chunk,
+                                             &mixer->config, audio_pcm_samples(chunk));
+            if (chunk->frames == 0)
+            {
+                audio_wav_close(&s->wav);
+                stream_transition(s, AUDIO_STREAM_ACTIVE, AUDIO_STREAM_ENDED);
+                break;
+            }
+        }
+        chunk->sequence = (uint32_t)(s->next_frame / mixer->config.frames_per_chunk);
+        s->next_frame += chunk->frames;
+        audio_pcm_commit_write(&s->ring, chunk);
+        decoded++;
+    }
+    return decoded;
+}
+
+/**
+ * @brief Opens the source of a newly claimed stream.
+ */
+static void open_stream(audio_mixer_t *mixer, audio_mix_stream_t *s)
+{
+    if (!s->ring_ready)
+    {
+        if (!audio_pcm_ring_init(&s->ring, AUDIO_MIXER_STREAM_CHUNKS, &mixer->config))
+        {
+            LOG_ERROR("Failed to create a stream ring");
+            stream_transition(s, AUDIO_STREAM_OPENING, AUDIO_STREAM_DRAINED);
+            return;
+        }
+        s->ring_ready = true;
+    }
+
+    char *end;
+    s->tone_hz = strtod(s->source, &end);
+    s->next_frame = 0;
+    if (end == s->source || *end != '\0' || s->tone_hz <= 0.0)
+    {
+        s->tone_hz = 0.0;
+        if (!audio_wav_open(&s->wav, s->source))
+        {
+            stream_transition(s, AUDIO_STREAM_OPENING, AUDIO_STREAM_DRAINED);
+            return;
+        }
+    }
+    fill_stream(mixer, s);                            // Start mixing with a full ring
+    stream_transition(s, AUDIO_STREAM_OPENING, AUDIO_STREAM_ACTIVE);
+}
+
+/**
+ * @brief Runs one pass of the feeder over every stream.
+ *
+ * Opens claimed streams, tops up the rings of active ones and releases the
+ * sources of stopped ones. The feeder thread calls this in a loop; it is
+ * public so a benchmark can feed without the thread.
+ *
+ * @return Chunks decoded during the pass.
+ */
+size_t audio_mixer_feed(audio_mixer_t *mixer)
+{
+    size_t decoded = 0;
+    for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++)
+    {
+        audio_mix_stream_t *s = &mixer->streams[i];
+        switch (atomic_load_explicit(&s->state, memory_order_acquire))
+        {
+            case AUDIO_STREAM_OPENING:
+                open_stream(mixer, s);
+                break;
+            case AUDIO_STREAM_ACTIVE:
+                decoded += fill_stream(mixer, s);
+                break;
+            case AUDIO_STREAM_STOPPING:
+                if (s->wav.mapped)
+                {
+                    audio_wav_close(&s->wav);
+                }
+                atomic_store_explicit(&s->state, AUDIO_STREAM_DRAINED, memory_order_release);
+                break;
+            default:
+                break;
+        }
+    }
+    return decoded;
+}
+
+static void *feeder_main(void *arg)
+{
+    audio_mixer_t *mixer = arg;
+    while (atomic_load_explicit(&mixer->feeder_running, memory_order_acquire))
+    {
+        if (audio_mixer_feed(mixer) == 0)
+        {
+            struct timespec pause = { 0, MIXER_FEED_IDLE_NS };
+            nanosleep(&pause, NULL);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Starts the feeder thread.
+ */
+bool audio_mixer_start_feeder(audio_mixer_t *mixer)
+{
+    atomic_store(&mixer->feeder_running, true);
+    if (pthread_create(&mixer->feeder, NULL, feeder_main, mixer) != 0)
+    {
+        LOG_ERROR("Failed to start the stream feeder thread");
+        return false;
+    }
+    mixer->feeder_started = true;
+    return true;
+}
+
+/**
+ * @brief Stops and joins the feeder thread.
+ */
+void audio_mixer_stop_feeder(audio_mixer_t *mixer)
+{
+    if (!mixer->feeder_started)
+    {
+        return;
+    }
+    atomic_store(&mixer->feeder_running, false);
+    pthread_join(mixer->feeder, NULL);
+    mixer->feeder_started = false;
+}
+
+// ====================================================================================
+// Control (any thread)
+
+/**
+ * @brief Claims a free slot for a new stream.
+ *
+ * The source is opened later by the feeder, so this never blocks on a file.
+ *
+ * @param mixer The mixer.
+ * @param source WAV path, or a tone frequency in Hz (not NUL-terminated).
+ * @param len Length of the source.
+ * @param gain Initial linear gain.
+ * @return The stream id, or -1 if the source is too long or every slot is taken.
+ */
+int audio_mixer_add_stream(audio_mixer_t *mixer, const char *source, size_t len, float gain)
+{
+    if (len == 0 || len >= AUDIO_MIXER_SOURCE_MAX)
+    {
+        return -1;
+    }
+    for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++)
+    {
+        audio_mix_stream_t *s = &mixer->streams[i];
+        int expected = AUDIO_STREAM_FREE;
+        if (atomic_load_explicit(&s->state, memory_order_relaxed) != AUDIO_STREAM_FREE ||
+            !atomic_compare_exchange_strong_explicit(&s->state, &expected, AUDIO_STREAM_CLAIMED,
+                                                     memory_order_acquire, memory_order_relaxed))
+        {
+            continue;
+        }
+        memcpy(s->source, source, len);
+        s->source[len] = '\0';
+        s->chunks_mixed = 0;
+        s->underruns = 0;
+        atomic_store_explicit(&s->gain, gain, memory_order_relaxed);
+        atomic_store_explicit(&s->seek_frame, -1, memory_order_relaxed);
+        atomic_store_explicit(&s->state, AUDIO_STREAM_OPENING, memory_order_release);
+        return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Requests a stream stop; its queued chunks are dropped.
+ *
+ * @return false if the id names no playing stream.
+ */
+bool audio_mixer_stop_stream(audio_mixer_t *mixer, int id)
+{
+    if (id < 0 || id >= AUDIO_MIXER_MAX_STREAMS)
+    {
+        return false;
+    }
+    audio_mix_stream_t *s = &mixer->streams[id];
+    int state = atomic_load_explicit(&s->state, memory_order_acquire);
+    while (state == AUDIO_STREAM_OPENING || state == AUDIO_STREAM_ACTIVE || state == AUDIO_STREAM_ENDED)
+    {
+        if (atomic_compare_exchange_weak_explicit(&s->state, &state, AUDIO_STREAM_STOPPING,
+                                                  memory_order_acq_rel, memory_order_acquire))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Requests a stop of every stream.
+ */
+void audio_mixer_stop_all(audio_mixer_t *mixer)
+{
+    for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++)
+    {
+        audio_mixer_stop_stream(mixer, i);
+    }
+}
+
+/**
+ * @brief Changes the gain of a stream; it applies from the next period.
+ *
+ * @return false if the id names no playing stream.
+ */
+bool audio_mixer_set_gain(audio_mixer_t *mixer, int id, float gain)
+{
+    if (id < 0 || id >= AUDIO_MIXER_MAX_STREAMS)
+    {
+        return false;
+    }
+    audio_mix_stream_t *s = &mixer->streams[id];
+    int state = atomic_load_explicit(&s->state, memory_order_acquire);
+    if (state != AUDIO_STREAM_OPENING && state != AUDIO_STREAM_ACTIVE && state != AUDIO_STREAM_ENDED)
+    {
+        return false;
+    }
+    atomic_store_explicit(&s->gain, gain, memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Moves a stream's decode position.
+ *
+ * The feeder applies it before its next decode, so the chunks already in
+ * the stream's ring still play first. A file stream sought past its end
+ * ends.
+ *
+ * @param frame Frame to continue from.
+ * @return false if the id names no stream that is still decoding.
+ */
+bool audio_mixer_seek(audio_mixer_t *mixer, int id, uint64_t frame)
+{
+    if (id < 0 || id >= AUDIO_MIXER_MAX_STREAMS || frame > INT64_MAX)
+    {
+        return false;
+    }
+    audio_mix_stream_t *s = &mixer->streams[id];
+    int state = atomic_load_explicit(&s->state, memory_order_acquire);
+    if (state != AUDIO_STREAM_OPENING && state != AUDIO_STREAM_ACTIVE)
+    {
+        return false;
+    }
+    atomic_store_explicit(&s->seek_frame, (int64_t)frame, memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Returns whether every slot is free.
+ */
+bool audio_mixer_idle(audio_mixer_t *mixer)
+{
+    for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++)
+    {
+        if (atomic_load_explicit(&mixer->streams[i].state, memory_order_acquire) != AUDIO_STREAM_FREE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ====================================================================================
+// Consumer side (playback thread)
+
+/**
+ * @brief Frees finished slots and counts the streams that have audio to mix.
+ *
+ * @return Streams that are active, or ended with chunks still queued.
+ */
+unsigned audio_mixer_live(audio_mixer_t *mixer)
+{
+    unsigned live = 0;
+    for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++)
+    {
+        audio_mix_stream_t *s = &mixer->streams[i];
+        switch (atomic_load_explicit(&s->state, memory_order_acquire))
+        {
+            case AUDIO_STREAM_ACTIVE:
+                live++;
+                break;
+            case AUDIO_STREAM_ENDED:
+                if (audio_spsc_ring_count(&s->ring.ring) > 0)
+                {
+                    live++;
+                    break;
+                }
+                stream_transition(s, AUDIO_STREAM_ENDED, AUDIO_STREAM_FREE);
+                break;
+            case AUDIO_STREAM_DRAINED:
+                if (s->ring_ready)
+                {
+                    audio_spsc_ring_discard(&s->ring.ring);
+                }
+                atomic_store_explicit(&s->state, AUDIO_STREAM_FREE, memory_order_release);
+                break;
+            default:
+                break;
+        }
+    }
+    return live;
+}
+
+/**
+ * @brief Mixes one period of every live stream.
+ *
+ * @param mixer The mixer.
+ * @param base Chunk from the main play queue, mixed at unity and overwritten
+ *             with the result; NULL to mix into the mixer's scratch chunk.
+ * @param master Gain applied to the sum before it saturates.
+ * @return The mixed chunk (base, or the scratch chunk), always a full chunk.
+ */
+audio_pcm_chunk_t *audio_mixer_mix(audio_mixer_t *mixer, audio_pcm_chunk_t *base, float master)
+{
+    const mix_kernels_t *k = active_kernels();
+    const audio_pcm_config_t *cfg = &mixer->config;
+    bool f32 = (cfg->format == AUDIO_SAMPLE_F32);
+    size_t count = (size_t)cfg->frames_per_chunk * cfg->channels;
+    float *acc = mixer->accumulator;
+
+    memset(acc, 0, count * sizeof(float));
+    if (base != NULL)
+    {
+        size_t n = (size_t)base->frames * cfg->channels;
+        f32 ? k->acc_f32(acc, audio_pcm_samples(base), n, 1.0f) : k->acc_s16(acc, audio_pcm_samples(base), n, 1.0f);
+    }
+
+    for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++)
+    {
+        audio_mix_stream_t *s = &mixer->streams[i];
+        int state = atomic_load_explicit(&s->state, memory_order_acquire);
+        if (state != AUDIO_STREAM_ACTIVE && state != AUDIO_STREAM_ENDED)
+        {
+            continue;
+        }
+        audio_pcm_chunk_t *chunk = audio_pcm_acquire_read(&s->ring);
+        if (chunk == NULL)
+        {
+            s->underruns += (state == AUDIO_STREAM_ACTIVE);  // The feeder fell behind
+            continue;
+        }
+        size_t n = (size_t)chunk->frames * cfg->channels;
+        float gain = atomic_load_explicit(&s->gain, memory_order_relaxed);
+        f32 ? k->acc_f32(acc, audio_pcm_samples(chunk), n, gain) : k->acc_s16(acc, audio_pcm_samples(chunk), n, gain);
+        audio_pcm_release_read(&s->ring);
+        s->chunks_mixed++;
+    }
+
+    audio_pcm_chunk_t *out = base;
+    if (out == NULL)
+    {
+        out = mixer->scratch;
+        out->sequence = ++mixer->scratch_sequence;
+    }
+    f32 ? k->store_f32(audio_pcm_samples(out), acc, count, master) : k->store_s16(audio_pcm_samples(out), acc, count, master);
+    out->frames = cfg->frames_per_chunk;
+    return out;
+}
+
+// ====================================================================================
+// Reporting
+
+static const char *stream_state_name(int state)
+{
+    switch (state)
+    {
+        case AUDIO_STREAM_CLAIMED:
+        case AUDIO_STREAM_OPENING:  return "opening";
+        case AUDIO_STREAM_ACTIVE:   return "active";
+        case AUDIO_STREAM_ENDED:    return "ended";
+        case AUDIO_STREAM_STOPPING:
+        case AUDIO_STREAM_DRAINED:  return "stopping";
+        default:                    return "free";
+    }
+}
+
+/**
+ * @brief Prints every claimed stream.
+ */
+void print_audio_mixer_streams(audio_mixer_t *mixer)
+{
+    unsigned shown = 0;
+    printf("\n%-4s %-9s %6s %10s %10s  %s\n", "id", "state", "gain", "mixed", "underruns", "source");
+    for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++)
+    {
+        audio_mix_stream_t *s = &mixer->streams[i];
+        int state = atomic_load_explicit(&s->state, memory_order_acquire);
+        if (state == AUDIO_STREAM_FREE)
+        {
+            continue;
+        }
+        printf("%-4d %-9s %6.2f %10llu %10llu  %s\n", i, stream_state_name(state),
+               atomic_load_explicit(&s->gain, memory_order_relaxed), (unsigned long long)s->chunks_mixed,
+               (unsigned long long)s->underruns, s->source);
+        shown++;
+    }
+    printf("Streams: %u / %d\n\n", shown, AUDIO_MIXER_MAX_STREAMS);
+}
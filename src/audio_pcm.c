@@ -0,0 +1,162 @@
+/**
+ * @file src/audio_pcm.c
+ * @brief PCM Frame Ring Implementation
+ */
+
+#include <math.h>
+#include "audio_pcm.h"
+
+/**
+ * @brief Returns the size of one sample.
+ *
+ * @param format The sample format.
+ * @return Bytes per sample.
+ */
+size_t audio_pcm_sample_bytes(audio_sample_format_t format)
+{
+    return (format == AUDIO_SAMPLE_F32) ? sizeof(float) : sizeof(int16_t);
+}
+
+/**
+ * @brief Returns a printable name for a sample format.
+ *
+ * @param format The sample format.
+ */
+const char *audio_pcm_format_name(audio_sample_format_t format)
+{
+    return (format == AUDIO_SAMPLE_F32) ? "f32" : "s16";
+}
+
+/**
+ * @brief Initializes a PCM ring.
+ *
+ * Slots are sized for one chunk header plus frames_per_chunk frames and are
+ * padded to a cache line so every sample array is vector aligned.
+ *
+ * @param ring Pointer to the ring to initialize.
+ * @param capacity Requested number of chunks; rounded up to a power of two.
+ * @param config Format of the chunks.
+ * @return true on success, false on an invalid config or allocation failure.
+ */
+bool audio_pcm_ring_init(audio_pcm_ring_t *ring, size_t capacity, const audio_pcm_config_t *config)
+{
+    if (config->channels == 0 || config->frames_per_chunk == 0 || capacity == 0)
+    {
+        return false;
+    }
+
+    ring->config = *config;
+    ring->frame_bytes = config->channels * audio_pcm_sample_bytes(config->format);
+
+    size_t slot_size = sizeof(audio_pcm_chunk_t) + config->frames_per_chunk * ring->frame_bytes;
+    slot_size = (slot_size + AUDIO_CACHE_LINE - 1) & ~(size_t)(AUDIO_CACHE_LINE - 1);
+    return audio_spsc_ring_init(&ring->ring, capacity, slot_size);
+}
+
+/**
+ * @brief Releases the ring storage.
+ *
+ * @param ring Pointer to the ring.
+ */
+void audio_pcm_ring_free(audio_pcm_ring_t *ring)
+{
+    audio_spsc_ring_free(&ring->ring);
+}
+
+/**
+ * @brief Returns a free chunk for the producer to decode into.
+ *
+ * The header is cleared; the producer fills the samples and sets frames.
+ *
+ * @param ring Pointer to the ring.
+ * @return The chunk, or NULL if the ring is full.
+ */
+audio_pcm_chunk_t *audio_pcm_acquire_write(audio_pcm_ring_t *ring)
+{
+    audio_pcm_chunk_t *chunk = audio_spsc_ring_acquire_write(&ring->ring);
+    if (chunk != NULL)
+    {
+        chunk->frames = 0;
+        chunk->generation = 0;
+        chunk->sequence = 0;
+        chunk->reserved = 0;
+    }
+    return chunk;
+}
+
+/**
+ * @brief Publishes a chunk returned by audio_pcm_acquire_write().
+ *
+ * @param ring Pointer to the ring.
+ * @param chunk The chunk; chunk->frames must not exceed frames_per_chunk.
+ */
+void audio_pcm_commit_write(audio_pcm_ring_t *ring, audio_pcm_chunk_t *chunk)
+{
+    if (chunk->frames > ring->config.frames_per_chunk)
+    {
+        chunk->frames = ring->config.frames_per_chunk;
+    }
+    audio_spsc_ring_commit_write(&ring->ring, sizeof(audio_pcm_chunk_t) + chunk->frames * ring->frame_bytes);
+}
+
+/**
+ * @brief Returns the oldest queued chunk for the consumer to process in place.
+ *
+ * The consumer owns the chunk until it is released and may modify its samples.
+ *
+ * @param ring Pointer to the ring.
+ * @return The chunk, or NULL if the ring is empty.
+ */
+audio_pcm_chunk_t *audio_pcm_acquire_read(audio_pcm_ring_t *ring)
+{
+    return (audio_pcm_chunk_t *)audio_spsc_ring_acquire_read(&ring->ring, NULL);
+}
+
+/**
+ * @brief Hands the chunk returned by audio_pcm_acquire_read() back.
+ *
+ * @param ring Pointer to the ring.
+ */
+void audio_pcm_release_read(audio_pcm_ring_t *ring)
+{
+    audio_spsc_ring_release_read(&ring->ring);
+}
+
+/**
+ * @brief Fills a chunk with a sine tone at half scale on every channel.
+ *
+ * @param chunk The chunk to fill (frames is set to a full chunk).
+ * @param config Format of the chunk.
+ * @param hz Tone frequency.
+ * @param first_frame Stream position of the first frame, so chunks join without clicks.
+ */
+void audio_pcm_fill_tone(audio_pcm_chunk_t *chunk, const audio_pcm_config_t *config, double hz, uint64_t first_frame)
+{
+    double step = 2.0 * M_PI * hz / config->sample_rate;
+
+    if (config->format == AUDIO_SAMPLE_F32)
+    {
+        float *out = audio_pcm_samples(chunk);
+        for (uint32_t f = 0; f < config->frames_per_chunk; f++)
+        {
+            float v = (float)(0.5 * sin(step * (double)(first_frame + f)));
+            for (uint32_t c = 0; c < config->channels; c++)
+            {
+                *out++ = v;
+            }
+        }
+    }
+    else
+    {
+        int16_t *out = audio_pcm_samples(chunk);
+        for (uint32_t f = 0; f < config->frames_per_chunk; f++)
+        {
+            int16_t v = (int16_t)(16383.0 * sin(step * (double)(first_frame + f)));
+            for (uint32_t c = 0; c < config->channels; c++)
+            {
+                *out++ = v;
+            }
+        }
+    }
+    chunk->frames = config->frames_per_chunk;
+}
@@ -0,0 +1,951 @@
+/**
+ * @file src/audio_pipeline.c
+ * @brief Audio Pipeline Implementation
+ *
+ * The decoder thread is the only producer and the playback thread the only
+ * consumer of the pipeline ring. Chunks are decoded straight into ring slots
+ * and played in place. A flush bumps a generation counter: the decoder
+ * abandons the request it is working on and the playback thread discards
+ * queued chunks, including any chunk stamped with an old generation.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include "audio_pipeline.h"
+#include "audio_gain.h"
+#include "audio_logger.h"
+#include "audio_mixer.h"
+#include "audio_stats.h"
+#include "audio_systemState.h"
+#include "audio_wav.h"
+
+#define PIPELINE_SOURCE_MAX 256                       // Longest source name accepted by a play request
+#define PIPELINE_SPINS_BEFORE_SLEEP 64                // Yields before the idle side starts sleeping
+#define PIPELINE_TONE_HZ 440.0                        // Test tone produced for a play request without a file
+
+static audio_pcm_ring_t pipeline_ring;
+static pthread_t decoder_thread;
+static pthread_t playback_thread;
+static bool pipeline_started = false;
+
+static pthread_mutex_t request_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t request_ready = PTHREAD_COND_INITIALIZER;
+static char request_source[PIPELINE_SOURCE_MAX];      // Pending play request (guarded by request_lock)
+static bool request_pending = false;
+static bool pipeline_running = false;
+
+static atomic_uint flush_generation;                  // Bumped by every flush
+static atomic_bool decoder_done;                      // Set once the decoder thread has exited
+static atomic_bool decoder_busy;                      // A play request is being decoded
+
+static audio_sink_t pipeline_sink;                    // Where the playback thread sends chunks
+static audio_mixer_t pipeline_mixer;                  // Streams played next to the main queue
+static bool pipeline_realtime = false;                // Lock memory and run playback under SCHED_FIFO
+static audio_resample_quality_t pipeline_quality;     // Resampler quality for files at another rate
+static audio_resampler_t pipeline_resampler;          // Owned by the decoder thread; kept across files
+static float *resample_input;                         // Decoded input frames for one output chunk
+
+/**
+ * @brief Playback statistics as the playback thread keeps them.
+ *
+ * Only the playback thread writes; readers on the command thread take a
+ * snapshot. Every field is atomic and accessed relaxed, so no access races,
+ * and the sequence count (odd while an update is in progress) lets a reader
+ * retry until it has copied every field from the same period.
+ */
+typedef struct {
+    _Atomic uint32_t sequence;                        // Bumped before and after every update
+    _Atomic uint64_t periods;
+    _Atomic uint64_t underruns;
+    _Atomic uint64_t late_wakeups;
+    _Atomic uint64_t resyncs;
+    _Atomic uint64_t max_lateness_ns;
+    _Atomic size_t min_fill;
+    _Atomic uint32_t lateness[AUDIO_STATS_BUCKETS];
+    _Atomic uint32_t fill[AUDIO_STATS_BUCKETS];
+} playback_counters_t;
+
+static playback_counters_t playback_stats;            // Written by the playback thread only
+static atomic_bool playback_stats_reset;              // Asks the playback thread to clear its stats
+static _Atomic uint64_t ramp_request;                 // Pending gain ramp: target bits | frames << 32 | curve << 63; 0 = none
+
+/**
+ * @brief Fills the default pipeline configuration.
+ *
+ * @param config Receives the defaults.
+ */
+void audio_pipeline_default_config(audio_pipeline_config_t *config)
+{
+    config->capacity = AUDIO_PCM_DEFAULT_CAPACITY;
+    config->pcm.format = AUDIO_SAMPLE_S16;
+    config->pcm.channels = AUDIO_PCM_DEFAULT_CHANNELS;
+    config->pcm.frames_per_chunk = AUDIO_PCM_DEFAULT_FRAMES;
+    config->pcm.sample_rate = AUDIO_PCM_DEFAULT_RATE;
+    config->sink = NULL;
+    config->realtime = false;
+    config->resample_quality = AUDIO_RESAMPLE_MEDIUM;
+}
+
+/**
+ * @brief Yields, then sleeps, while a side of the ring has nothing to do.
+ */
+static void pipeline_backoff(unsigned *spins)
+{
+    if (++(*spins) < PIPELINE_SPINS_BEFORE_SLEEP)
+    {
+        sched_yield();
+        return;
+    }
+    struct timespec pause = { 0, 1000000 };           // 1 ms
+    nanosleep(&pause, NULL);
+}
+
+/**
+ * @brief Waits for a free ring slot.
+ *
+ * @return The slot, or NULL once a flush abandons the request.
+ */
+static audio_pcm_chunk_t *acquire_chunk(uint32_t generation)
+{
+    audio_pcm_chunk_t *chunk;
+    unsigned spins = 0;
+    while ((chunk = audio_pcm_acquire_write(&pipeline_ring)) == NULL &&
+           atomic_load_explicit(&flush_generation, memory_order_acquire) == generation)
+    {
+        pipeline_backoff(&spins);
+    }
+    return chunk;
+}
+
+/**
+ * @brief Publishes a decoded chunk.
+ *
+ * @return false once a flush abandons the request.
+ */
+static bool publish_chunk(audio_pcm_chunk_t *chunk, uint32_t generation, uint32_t sequence)
+{
+    chunk->generation = generation;
+    chunk->sequence = sequence;
+    audio_pcm_commit_write(&pipeline_ring, chunk);
+    return atomic_load_explicit(&flush_generation, memory_order_acquire) == generation;
+}
+
+/**
+ * @brief Clears the playing flag once nothing is left to play.
+ *
+ * Runs under request_lock, where request_audio_playback() sets the flag again
+ * for every new request, so a play posted meanwhile keeps it. A flush since
+ * @p generation means pause already cleared it.
+ */
+static void finish_playing(uint32_t generation)
+{
+    pthread_mutex_lock(&request_lock);
+    if (!request_pending && !atomic_load_explicit(&decoder_busy, memory_order_acquire) &&
+        atomic_load_explicit(&flush_generation, memory_order_acquire) == generation &&
+        (audio_state_word() & AUDIO_FLAG_PLAYING) != 0)
+    {
+        audio_state_set_flags(0, AUDIO_FLAG_PLAYING);
+    }
+    pthread_mutex_unlock(&request_lock);
+}
+
+/**
+ * @brief Streams a WAV file into the ring, one chunk per slot.
+ */
+static void decode_file(audio_wav_t *wav, uint32_t generation)
+{
+    const audio_pcm_config_t *cfg = &pipeline_ring.config;
+    uint64_t frame = 0;
+    for (uint32_t sequence = 1; frame < wav->frames; sequence++)
+    {
+        audio_pcm_chunk_t *chunk = acquire_chunk(generation);
+        if (chunk == NULL)
+        {
+            return;                                   // Request abandoned by a flush
+        }
+        chunk->frames = audio_wav_decode(wav, frame, cfg->frames_per_chunk, cfg, audio_pcm_samples(chunk));
+        frame += chunk->frames;
+        if (!publish_chunk(chunk, generation, sequence))
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Readies the resampler for a file at in_rate.
+ *
+ * The tables are rebuilt only when the input rate changes; otherwise the
+ * history is just cleared.
+ *
+ * @return false if the rate pair cannot be converted.
+ */
+static bool prepare_resampler(uint32_t in_rate)
+{
+    const audio_pcm_config_t *cfg = &pipeline_ring.config;
+    if (pipeline_resampler.coeffs != NULL && pipeline_resampler.in_rate == in_rate)
+    {
+        audio_resampler_reset(&pipeline_resampler);
+        return true;
+    }
+    audio_resampler_free(&pipeline_resampler);
+    free(resample_input);
+    resample_input = NULL;
+    if (!audio_resampler_init(&pipeline_resampler, in_rate, cfg->sample_rate, cfg->channels,
+                              cfg->frames_per_chunk, pipeline_quality))
+    {
+        audio_resampler_free(&pipeline_resampler);
+        return false;
+    }
+    resample_input = malloc((size_t)pipeline_resampler.max_in * cfg->channels * sizeof(float));
+    if (resample_input == NULL)
+    {
+        audio_resampler_free(&pipeline_resampler);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Streams a WAV file at another sample rate into the ring.
+ *
+ * Each chunk decodes exactly the input frames its output needs as float,
+ * then converts them straight into the slot. Past the end of the file the
+ * filter is fed silence until the converted length is reached.
+ */
+static void decode_file_resampled(audio_wav_t *wav, uint32_t generation)
+{
+    const audio_pcm_config_t *cfg = &pipeline_ring.config;
+    audio_resampler_t *rs = &pipeline_resampler;
+    const audio_pcm_config_t in_cfg = { AUDIO_SAMPLE_F32, cfg->channels, rs->max_in, wav->sample_rate };
+    const uint64_t total = (wav->frames * rs->phases + rs->step - 1) / rs->step;
+    uint64_t frame = 0;
+    uint64_t produced = 0;
+    for (uint32_t sequence = 1; produced < total; sequence++)
+    {
+        audio_pcm_chunk_t *chunk = acquire_chunk(generation);
+        if (chunk == NULL)
+        {
+            return;
+        }
+        uint32_t want = (total - produced < cfg->frames_per_chunk) ? (uint32_t)(total - produced) : cfg->frames_per_chunk;
+        uint32_t need = audio_resampler_input_needed(rs, want);
+        uint32_t got = (frame < wav->frames) ? audio_wav_decode(wav, frame, need, &in_cfg, resample_input) : 0;
+        memset(resample_input + (size_t)got * cfg->channels, 0, (size_t)(need - got) * cfg->channels * sizeof(float));
+        frame += got;
+        chunk->frames = audio_resampler_process(rs, resample_input, need, NULL, cfg, audio_pcm_samples(chunk), want);
+        if (chunk->frames == 0)
+        {
+            return;
+        }
+        produced += chunk->frames;
+        if (!publish_chunk(chunk, generation, sequence))
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Produces the test tone for a play request without a file.
+ */
+static void decode_tone_request(uint32_t generation)
+{
+    for (uint32_t i = 1; i <= AUDIO_PIPELINE_CHUNKS_PER_REQUEST; i++)
+    {
+        audio_pcm_chunk_t *chunk = acquire_chunk(generation);
+        if (chunk == NULL)
+        {
+            return;
+        }
+        audio_pcm_fill_tone(chunk, &pipeline_ring.config, PIPELINE_TONE_HZ, (uint64_t)(i - 1) * pipeline_ring.config.frames_per_chunk);
+        if (!publish_chunk(chunk, generation, i))
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Decoder thread: turns play requests into chunks on the ring.
+ *
+ * Files are opened here rather than in the play handler, so a slow open
+ * never holds up command dispatch.
+ */
+static void *decoder_main(void *arg)
+{
+    (void)arg;
+    char source[PIPELINE_SOURCE_MAX];
+
+    while (1)
+    {
+        pthread_mutex_lock(&request_lock);
+        while (!request_pending && pipeline_running)
+        {
+            pthread_cond_wait(&request_ready, &request_lock);
+        }
+        if (!request_pending)
+        {
+            pthread_mutex_unlock(&request_lock);
+            break;                                    // Stopped with nothing left to decode
+        }
+        memcpy(source, request_source, sizeof(source));
+        request_pending = false;
+        atomic_store_explicit(&decoder_busy, true, memory_order_release);
+        pthread_mutex_unlock(&request_lock);
+
+        uint32_t generation = atomic_load_explicit(&flush_generation, memory_order_acquire);
+        const char *path = source + strspn(source, " \t");
+        audio_wav_t wav;
+        if (path[0] == '\0')
+        {
+            decode_tone_request(generation);         // Bare "play": the test tone
+        }
+        else if (audio_wav_open(&wav, path))
+        {
+            LOG_INFO("Streaming %s: %llu frames, %s, %u ch, %u Hz", path, (unsigned long long)wav.frames,
+                     audio_wav_encoding_name(wav.encoding), wav.channels, wav.sample_rate);
+            if (wav.sample_rate == pipeline_ring.config.sample_rate)
+            {
+                decode_file(&wav, generation);
+            }
+            else if (prepare_resampler(wav.sample_rate))
+            {
+                LOG_INFO("Resampling %s from %u Hz to %u Hz (%s quality, %u taps)", path, wav.sample_rate,
+                         pipeline_ring.config.sample_rate, audio_resample_quality_name(pipeline_quality),
+                         pipeline_resampler.taps);
+                decode_file_resampled(&wav, generation);
+            }
+            else
+            {
+                LOG_WARNING("%s is %u Hz; cannot convert it, playing it at %u Hz", path, wav.sample_rate,
+                            pipeline_ring.config.sample_rate);
+                decode_file(&wav, generation);
+            }
+            audio_wav_close(&wav);
+        }
+        else
+        {
+            LOG_ERROR("Cannot play %s: nothing queued", path);   // audio_wav_open() logged why
+        }
+        atomic_store_explicit(&decoder_busy, false, memory_order_release);
+        if (audio_spsc_ring_count(&pipeline_ring.ring) == 0)
+        {
+            finish_playing(generation);               // Nothing queued; otherwise playback clears it once drained
+        }
+    }
+
+    atomic_store_explicit(&decoder_done, true, memory_order_release);
+    return NULL;
+}
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Sleeps until an absolute CLOCK_MONOTONIC deadline.
+ */
+static void sleep_until(uint64_t deadline_ns)
+{
+    struct timespec ts = { (time_t)(deadline_ns / 1000000000ULL), (long)(deadline_ns % 1000000000ULL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    {
+    }
+}
+
+/**
+ * @brief Switches the calling thread to SCHED_FIFO if the process may.
+ */
+static void enter_realtime(void)
+{
+    struct sched_param param = { .sched_priority = AUDIO_PIPELINE_RT_PRIORITY };
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err != 0)
+    {
+        LOG_WARNING("SCHED_FIFO not permitted for the playback thread: %s", strerror(err));
+    }
+}
+
+// Single-writer increment: a relaxed load and store, no locked read-modify-write
+#define STAT_ADD(field, n) \
+    atomic_store_explicit(&(field), atomic_load_explicit(&(field), memory_order_relaxed) + (n), memory_order_relaxed)
+
+/**
+ * @brief Clears the playback statistics (playback thread, or before it starts).
+ */
+static void clear_playback_stats(playback_counters_t *st)
+{
+    atomic_store_explicit(&st->periods, 0, memory_order_relaxed);
+    atomic_store_explicit(&st->underruns, 0, memory_order_relaxed);
+    atomic_store_explicit(&st->late_wakeups, 0, memory_order_relaxed);
+    atomic_store_explicit(&st->resyncs, 0, memory_order_relaxed);
+    atomic_store_explicit(&st->max_lateness_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&st->min_fill, SIZE_MAX, memory_order_relaxed);
+    for (size_t i = 0; i < AUDIO_STATS_BUCKETS; i++)
+    {
+        atomic_store_explicit(&st->lateness[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&st->fill[i], 0, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Records the wakeup at one playback deadline.
+ *
+ * @param resync The thread fell a whole period behind and restarts its timeline.
+ * @param underrun The deadline found nothing to play.
+ */
+static void record_period(uint64_t lateness_ns, uint64_t period_ns, size_t fill, bool resync, bool underrun)
+{
+    playback_counters_t *st = &playback_stats;
+    uint32_t sequence = atomic_load_explicit(&st->sequence, memory_order_relaxed);
+    atomic_store_explicit(&st->sequence, sequence + 1, memory_order_relaxed);   // Odd: update in progress
+    atomic_thread_fence(memory_order_release);
+    if (atomic_exchange_explicit(&playback_stats_reset, false, memory_order_acq_rel))
+    {
+        clear_playback_stats(st);
+    }
+    STAT_ADD(st->periods, 1);
+    STAT_ADD(st->lateness[audio_stats_bucket(lateness_ns)], 1);
+    STAT_ADD(st->fill[audio_stats_bucket(fill)], 1);
+    if (lateness_ns > atomic_load_explicit(&st->max_lateness_ns, memory_order_relaxed))
+    {
+        atomic_store_explicit(&st->max_lateness_ns, lateness_ns, memory_order_relaxed);
+    }
+    if (lateness_ns > period_ns / 2)
+    {
+        STAT_ADD(st->late_wakeups, 1);
+    }
+    if (fill < atomic_load_explicit(&st->min_fill, memory_order_relaxed))
+    {
+        atomic_store_explicit(&st->min_fill, fill, memory_order_relaxed);
+    }
+    STAT_ADD(st->resyncs, resync);
+    STAT_ADD(st->underruns, underrun);
+    atomic_store_explicit(&st->sequence, sequence + 2, memory_order_release);   // Even: consistent again
+}
+
+/**
+ * @brief Copies the playback statistics as of one deadline (command thread).
+ */
+static void snapshot_playback_stats(audio_playback_stats_t *out)
+{
+    const playback_counters_t *st = &playback_stats;
+    for (;;)
+    {
+        uint32_t before = atomic_load_explicit(&st->sequence, memory_order_acquire);
+        if (before & 1u)
+        {
+            sched_yield();                            // The playback thread is mid-update
+            continue;
+        }
+        out->periods = atomic_load_explicit(&st->periods, memory_order_relaxed);
+        out->underruns = atomic_load_explicit(&st->underruns, memory_order_relaxed);
+        out->late_wakeups = atomic_load_explicit(&st->late_wakeups, memory_order_relaxed);
+        out->resyncs = atomic_load_explicit(&st->resyncs, memory_order_relaxed);
+        out->max_lateness_ns = atomic_load_explicit(&st->max_lateness_ns, memory_order_relaxed);
+        out->min_fill = atomic_load_explicit(&st->min_fill, memory_order_relaxed);
+        for (size_t i = 0; i < AUDIO_STATS_BUCKETS; i++)
+        {
+            out->lateness[i] = atomic_load_explicit(&st->lateness[i], memory_order_relaxed);
+            out->fill[i] = atomic_load_explicit(&st->fill[i], memory_order_relaxed);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&st->sequence, memory_order_relaxed) == before)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Playback thread: drains the ring at the sample rate of the stream.
+ *
+ * A stream starts when a chunk shows up while the thread is idle; that chunk
+ * plays at once and fixes the timeline. Every later chunk is handed to the
+ * sink at an absolute deadline one chunk duration after the previous one,
+ * slept for with clock_nanosleep(TIMER_ABSTIME), so wakeup error never
+ * accumulates. An empty ring at a deadline while the decoder is still busy
+ * is an underrun and plays a chunk of silence; an empty ring with the decoder
+ * idle ends the stream. A wakeup more than a whole period late restarts the
+ * timeline instead of bursting to catch up.
+ *
+ * While mixer streams are live, each period mixes them with the main chunk
+ * (if any) and applies the volume to the sum; otherwise the main chunk goes
+ * through the gain stage alone. A volume change jumps at the next chunk
+ * unless request_audio_gain_ramp() posted a ramp to that very gain, in which
+ * case the gain moves per frame until it gets there.
+ */
+static void *playback_main(void *arg)
+{
+    (void)arg;
+    uint32_t seen_generation = atomic_load_explicit(&flush_generation, memory_order_acquire);
+    const audio_pcm_config_t *cfg = &pipeline_ring.config;
+    bool streaming = false;
+    uint64_t deadline = 0;
+    unsigned spins = 0;
+    audio_gain_ramp_t ramp;
+    audio_gain_ramp_set(&ramp, 1.0f);
+
+    if (pipeline_realtime)
+    {
+        enter_realtime();
+    }
+
+    while (1)
+    {
+        uint32_t generation = atomic_load_explicit(&flush_generation, memory_order_acquire);
+        if (generation != seen_generation)
+        {
+            audio_spsc_ring_discard(&pipeline_ring.ring);
+            seen_generation = generation;
+        }
+
+        uint64_t lateness = 0;
+        size_t fill = 0;
+        if (streaming)
+        {
+            sleep_until(deadline);
+            lateness = monotonic_ns() - deadline;
+            fill = audio_spsc_ring_count(&pipeline_ring.ring);
+        }
+
+        audio_pcm_chunk_t *chunk = audio_pcm_acquire_read(&pipeline_ring);
+        if (chunk != NULL && chunk->generation != seen_generation)
+        {
+            audio_pcm_release_read(&pipeline_ring);   // Decoded before the last flush
+            continue;
+        }
+        bool busy = atomic_load_explicit(&decoder_busy, memory_order_acquire);
+        unsigned live = audio_mixer_live(&pipeline_mixer);
+        if (streaming && (chunk != NULL || busy || live > 0))
+        {
+            uint64_t period = (uint64_t)cfg->frames_per_chunk * 1000000000ULL / cfg->sample_rate;
+            record_period(lateness, period, fill, lateness > period, chunk == NULL && live == 0);
+            if (lateness > period)
+            {
+                deadline += lateness;                 // Fell a whole period behind: restart the timeline
+            }
+            if (chunk == NULL && live == 0)
+            {
+                audio_sink_write_silence(&pipeline_sink, cfg->frames_per_chunk);
+                deadline += period;
+                continue;
+            }
+        }
+        if (chunk == NULL && live == 0)
+        {
+            if (streaming)
+            {
+                finish_playing(seen_generation);      // The last chunk of the request has played
+            }
+            streaming = false;                        // Ring drained with nothing left to decode or mix
+            if (atomic_load_explicit(&decoder_done, memory_order_acquire) && audio_spsc_ring_count(&pipeline_ring.ring) == 0 &&
+                audio_mixer_idle(&pipeline_mixer))
+            {
+                break;
+            }
+            pipeline_backoff(&spins);
+            continue;
+        }
+
+        // Gain stage: follow the current volume and mute state, ramping when a ramp was requested
+        audioState state = snapshot_audio_state();
+        float target = audio_gain_from_volume(state.volume, state.flags.is_muted);
+        spins = 0;
+        if (!streaming)
+        {
+            streaming = true;
+            deadline = monotonic_ns();                // First chunk of a stream plays at once
+            atomic_store_explicit(&ramp_request, 0, memory_order_relaxed);
+            audio_gain_ramp_set(&ramp, target);       // Nothing audible to ramp from
+        }
+        else if (target != ramp.target)
+        {
+            uint64_t request = atomic_exchange_explicit(&ramp_request, 0, memory_order_acquire);
+            uint32_t bits = (uint32_t)request;
+            float requested;
+            memcpy(&requested, &bits, sizeof(requested));
+            if (request != 0 && requested == target)
+            {
+                audio_gain_ramp_start(&ramp, target, (uint32_t)(request >> 32) & 0x7FFFFFFFu,
+                                      (request >> 63) ? AUDIO_RAMP_EXPONENTIAL : AUDIO_RAMP_LINEAR);
+            }
+            else
+            {
+                audio_gain_ramp_set(&ramp, target);   // Plain volume change: jump
+            }
+        }
+
+        audio_pcm_chunk_t *out = chunk;
+        if (live > 0 && ramp.frames > 0)
+        {
+            out = audio_mixer_mix(&pipeline_mixer, chunk, 1.0f);   // Mix at unity, then ramp the sum
+            audio_gain_ramp_apply_chunk(&ramp, out, cfg);
+        }
+        else if (live > 0)
+        {
+            out = audio_mixer_mix(&pipeline_mixer, chunk, ramp.gain);   // Main chunk plus every stream, volume on the sum
+        }
+        else
+        {
+            audio_gain_ramp_apply_chunk(&ramp, chunk, cfg);
+        }
+        audio_sink_write(&pipeline_sink, out, ramp.gain);
+        deadline += (uint64_t)out->frames * 1000000000ULL / cfg->sample_rate;
+        if (chunk != NULL)
+        {
+            audio_pcm_release_read(&pipeline_ring);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Starts the decoder and playback threads.
+ *
+ * @param config Ring geometry and PCM format, or NULL for the defaults.
+ * @return true if both threads are running.
+ */
+bool start_audio_pipeline(const audio_pipeline_config_t *config)
+{
+    if (pipeline_started)
+    {
+        return true;
+    }
+
+    audio_pipeline_config_t defaults;
+    if (config == NULL)
+    {
+        audio_pipeline_default_config(&defaults);
+        config = &defaults;
+    }
+    if (!audio_pcm_ring_init(&pipeline_ring, config->capacity, &config->pcm))
+    {
+        LOG_ERROR("Failed to create audio pipeline ring");
+        return false;
+    }
+    if (!audio_sink_open(&pipeline_sink, config->sink, &config->pcm))
+    {
+        audio_pcm_ring_free(&pipeline_ring);
+        return false;
+    }
+    if (!audio_mixer_init(&pipeline_mixer, &config->pcm) || !audio_mixer_start_feeder(&pipeline_mixer))
+    {
+        audio_mixer_free(&pipeline_mixer);
+        audio_sink_close(&pipeline_sink);
+        audio_pcm_ring_free(&pipeline_ring);
+        return false;
+    }
+    pipeline_realtime = config->realtime;
+    pipeline_quality = config->resample_quality;
+    if (pipeline_realtime && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        LOG_WARNING("Cannot lock memory: %s", strerror(errno));
+    }
+
+    atomic_init(&flush_generation, 0);
+    atomic_init(&decoder_done, false);
+    atomic_init(&decoder_busy, false);
+    atomic_init(&playback_stats.sequence, 0);
+    clear_playback_stats(&playback_stats);
+    atomic_init(&playback_stats_reset, false);
+    pipeline_running = true;
+    request_pending = false;
+
+    if (pthread_create(&decoder_thread, NULL, decoder_main, NULL) != 0)
+    {
+        LOG_ERROR("Failed to start decoder thread");
+        audio_mixer_stop_feeder(&pipeline_mixer);
+        audio_mixer_free(&pipeline_mixer);
+        audio_sink_close(&pipeline_sink);
+        audio_pcm_ring_free(&pipeline_ring);
+        return false;
+    }
+    if (pthread_create(&playback_thread, NULL, playback_main, NULL) != 0)
+    {
+        LOG_ERROR("Failed to start playback thread");
+        pthread_mutex_lock(&request_lock);
+        pipeline_running = false;
+        pthread_cond_signal(&request_ready);
+        pthread_mutex_unlock(&request_lock);
+        pthread_join(decoder_thread, NULL);
+        audio_mixer_stop_feeder(&pipeline_mixer);
+        audio_mixer_free(&pipeline_mixer);
+        audio_sink_close(&pipeline_sink);
+        audio_pcm_ring_free(&pipeline_ring);
+        return false;
+    }
+
+    pipeline_started = true;
+    return true;
+}
+
+/**
+ * @brief Finishes queued work and joins both threads.
+ *
+ * A pending play request is still decoded and every queued chunk is played
+ * before the threads exit. Mixer streams are stopped, not played out.
+ */
+void stop_audio_pipeline(void)
+{
+    if (!pipeline_started)
+    {
+        return;
+    }
+
+    audio_mixer_stop_all(&pipeline_mixer);
+    pthread_mutex_lock(&request_lock);
+    pipeline_running = false;
+    pthread_cond_signal(&request_ready);
+    pthread_mutex_unlock(&request_lock);
+
+    pthread_join(decoder_thread, NULL);
+    pthread_join(playback_thread, NULL);
+    audio_resampler_free(&pipeline_resampler);
+    free(resample_input);
+    resample_input = NULL;
+    audio_mixer_stop_feeder(&pipeline_mixer);
+    audio_mixer_free(&pipeline_mixer);
+    audio_sink_close(&pipeline_sink);
+    audio_pcm_ring_free(&pipeline_ring);
+    if (pipeline_realtime)
+    {
+        munlockall();
+    }
+    pipeline_started = false;
+}
+
+/**
+ * @brief Posts a play request to the decoder thread.
+ *
+ * Never waits for decoding; a request that was not picked up yet is replaced.
+ * Sets the playing flag again under the request lock: the decoder or playback
+ * thread clears it when a request queues nothing or its last chunk has played,
+ * and must not clear it for a request posted in the meantime.
+ *
+ * @param source Name of the source to play (not NUL-terminated).
+ * @param len Length of the source name.
+ * @return true if the request was posted.
+ */
+bool request_audio_playback(const char *source, size_t len)
+{
+    if (!pipeline_started)
+    {
+        LOG_WARNING("Audio pipeline is not running");
+        return false;
+    }
+    if (len >= PIPELINE_SOURCE_MAX)
+    {
+        LOG_ERROR("Audio source name too long (%zu bytes)", len);
+        return false;
+    }
+
+    pthread_mutex_lock(&request_lock);
+    if (request_pending)
+    {
+        LOG_WARNING("Replacing pending play request: %s", request_source);
+    }
+    memcpy(request_source, source, len);
+    request_source[len] = '\0';
+    request_pending = true;
+    audio_state_set_flags(AUDIO_FLAG_PLAYING, 0);
+    pthread_cond_signal(&request_ready);
+    pthread_mutex_unlock(&request_lock);
+    return true;
+}
+
+/**
+ * @brief Asks the gain stage to ramp to a gain instead of jumping.
+ *
+ * Post this before changing the volume: the playback thread picks the ramp
+ * up at the chunk where it sees the new volume, and only if the ramp's
+ * target is the gain of that volume, so a stale request never applies to a
+ * later change. A newer request replaces one not yet picked up.
+ *
+ * @param target Linear gain the ramp ends at.
+ * @param duration_ns Ramp length.
+ * @param curve Linear or exponential.
+ * @return true if the request was posted.
+ */
+bool request_audio_gain_ramp(float target, uint64_t duration_ns, audio_ramp_curve_t curve)
+{
+    if (!pipeline_started)
+    {
+        return false;
+    }
+    uint64_t frames = duration_ns * pipeline_ring.config.sample_rate / 1000000000ULL;
+    frames = (frames > 0x7FFFFFFFu) ? 0x7FFFFFFFu : frames;
+    uint32_t bits;
+    memcpy(&bits, &target, sizeof(bits));
+    uint64_t request = (uint64_t)bits | (frames << 32) | ((uint64_t)(curve == AUDIO_RAMP_EXPONENTIAL) << 63);
+    atomic_store_explicit(&ramp_request, request, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Aborts decoding and drops every queued chunk.
+ */
+void flush_audio_pipeline(void)
+{
+    if (!pipeline_started)
+    {
+        return;
+    }
+    pthread_mutex_lock(&request_lock);
+    request_pending = false;
+    pthread_mutex_unlock(&request_lock);
+    atomic_fetch_add_explicit(&flush_generation, 1, memory_order_acq_rel);
+}
+
+/**
+ * @brief Starts a mixer stream next to the main play queue.
+ *
+ * @param source WAV path, or a tone frequency in Hz (not NUL-terminated).
+ * @param len Length of the source.
+ * @param gain Initial linear gain.
+ * @return The stream id, or -1.
+ */
+int start_audio_stream(const char *source, size_t len, float gain)
+{
+    if (!pipeline_started)
+    {
+        LOG_WARNING("Audio pipeline is not running");
+        return -1;
+    }
+    return audio_mixer_add_stream(&pipeline_mixer, source, len, gain);
+}
+
+/**
+ * @brief Stops a mixer stream and drops its queued chunks.
+ */
+bool stop_audio_stream(int id)
+{
+    return pipeline_started && audio_mixer_stop_stream(&pipeline_mixer, id);
+}
+
+/**
+ * @brief Changes the gain of a mixer stream.
+ */
+bool set_audio_stream_gain(int id, float gain)
+{
+    return pipeline_started && audio_mixer_set_gain(&pipeline_mixer, id, gain);
+}
+
+/**
+ * @brief Moves a mixer stream to a time offset from its start.
+ *
+ * @param id The stream id.
+ * @param offset_ns Offset from the start of the stream.
+ * @return false if the id names no stream that is still decoding.
+ */
+bool seek_audio_stream(int id, int64_t offset_ns)
+{
+    if (!pipeline_started || offset_ns < 0)
+    {
+        return false;
+    }
+    uint64_t frame = (uint64_t)((double)offset_ns * pipeline_mixer.config.sample_rate / 1e9);
+    return audio_mixer_seek(&pipeline_mixer, id, frame);
+}
+
+/**
+ * @brief Prints every mixer stream.
+ */
+void print_audio_streams(void)
+{
+    if (!pipeline_started)
+    {
+        LOG_WARNING("Audio pipeline is not running");
+        return;
+    }
+    print_audio_mixer_streams(&pipeline_mixer);
+}
+
+/**
+ * @brief Prints the fill state of the pipeline ring.
+ */
+void print_audio_pipeline_state(void)
+{
+    if (!pipeline_started)
+    {
+        return;
+    }
+    print_audio_spsc_ring_state(&pipeline_ring.ring);
+}
+
+/**
+ * @brief Captures the ring fill state for a coalesced report.
+ *
+ * @param view Receives the fill count and the front and rear slots.
+ * @return false if the pipeline is not running.
+ */
+bool audio_pipeline_ring_view(audio_ring_view_t *view)
+{
+    if (!pipeline_started)
+    {
+        return false;
+    }
+    *view = audio_spsc_ring_view(&pipeline_ring.ring);
+    return true;
+}
+
+/**
+ * @brief Prints the playback deadline statistics.
+ *
+ * Lateness is how long after its deadline the playback thread woke. Ring
+ * fill is sampled at every deadline: its low percentiles show how much of
+ * the ring the stream actually needed, which is what the capacity (-c)
+ * should be sized from.
+ */
+void print_audio_playback_stats(void)
+{
+    if (!pipeline_started)
+    {
+        LOG_WARNING("Audio pipeline is not running");
+        return;
+    }
+    audio_playback_stats_t snapshot;                  // Consistent copy: the playback thread keeps writing
+    snapshot_playback_stats(&snapshot);
+    const audio_playback_stats_t *st = &snapshot;
+    uint64_t period = (uint64_t)pipeline_ring.config.frames_per_chunk * 1000000000ULL / pipeline_ring.config.sample_rate;
+
+    printf("\nPlayback (%s sink, %.2f ms period, %zu-chunk ring)\n", audio_sink_kind_name(pipeline_sink.kind),
+           (double)period / 1e6, pipeline_ring.ring.capacity);
+    printf("Periods: %llu | Underruns: %llu | Late wakeups: %llu | Resyncs: %llu\n",
+           (unsigned long long)st->periods, (unsigned long long)st->underruns,
+           (unsigned long long)st->late_wakeups, (unsigned long long)st->resyncs);
+    if (st->periods == 0)
+    {
+        printf("\n");
+        return;
+    }
+    printf("Wakeup lateness us: p50 %.1f | p99 %.1f | p999 %.1f | max %.1f\n",
+           (double)audio_stats_percentile(st->lateness, st->periods, st->max_lateness_ns, 0.50) / 1e3,
+           (double)audio_stats_percentile(st->lateness, st->periods, st->max_lateness_ns, 0.99) / 1e3,
+           (double)audio_stats_percentile(st->lateness, st->periods, st->max_lateness_ns, 0.999) / 1e3,
+           (double)st->max_lateness_ns / 1e3);
+    printf("Ring fill at deadline (chunks): min %zu | p1 %llu | p10 %llu | p50 %llu\n\n", st->min_fill,
+           (unsigned long long)audio_stats_percentile(st->fill, st->periods, UINT64_MAX, 0.01),
+           (unsigned long long)audio_stats_percentile(st->fill, st->periods, UINT64_MAX, 0.10),
+           (unsigned long long)audio_stats_percentile(st->fill, st->periods, UINT64_MAX, 0.50));
+}
+
+/**
+ * @brief Clears the playback statistics at the next deadline.
+ */
+void reset_audio_playback_stats(void)
+{
+    atomic_store_explicit(&playback_stats_reset, true, memory_order_release);
+}
@@ -0,0 +1,171 @@
+/**
+ * @file src/audio_report.c
+ * @brief Coalesced State Reporting Implementation
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <time.h>
+#include "audio_report.h"
+#include "audio_buffer.h"
+#include "audio_logger.h"
+#include "audio_pipeline.h"
+#include "audio_session.h"
+#include "audio_systemState.h"
+
+#define REPORT_STATE 0x1u                             // System status is dirty
+#define REPORT_RING 0x2u                              // Playback ring is dirty
+
+static atomic_int report_mode = AUDIO_REPORT_IMMEDIATE;
+static atomic_uint report_dirty;
+static atomic_uint_fast64_t report_requested;
+
+// Flush side: only the dispatching thread touches these
+static uint64_t report_emitted;
+static uint64_t report_suppressed;
+static uint64_t last_flush_ns;
+static bool state_printed;
+static audioState last_state;
+static bool ring_printed;
+static audio_ring_view_t last_ring;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Returns true when a report should be printed by the caller now.
+ *
+ * Otherwise marks the view dirty for the next flush.
+ */
+static bool report_now(unsigned bit)
+{
+    atomic_fetch_add_explicit(&report_requested, 1, memory_order_relaxed);
+    if (atomic_load_explicit(&report_mode, memory_order_relaxed) == AUDIO_REPORT_IMMEDIATE ||
+        audio_session_current() != NULL)
+    {
+        return true;
+    }
+    atomic_fetch_or_explicit(&report_dirty, bit, memory_order_relaxed);
+    return false;
+}
+
+/**
+ * @brief Selects immediate or coalesced reporting.
+ *
+ * Switching to immediate flushes whatever is still pending.
+ */
+void audio_report_set_mode(audio_report_mode_t mode)
+{
+    audio_report_mode_t previous = (audio_report_mode_t)atomic_exchange(&report_mode, (int)mode);
+    if (previous == AUDIO_REPORT_COALESCED && mode == AUDIO_REPORT_IMMEDIATE)
+    {
+        audio_report_flush();
+    }
+}
+
+audio_report_mode_t audio_report_mode(void)
+{
+    return (audio_report_mode_t)atomic_load_explicit(&report_mode, memory_order_relaxed);
+}
+
+/**
+ * @brief Reports that the system status changed.
+ */
+void audio_report_state(void)
+{
+    if (report_now(REPORT_STATE))
+    {
+        print_audio_state();
+    }
+}
+
+/**
+ * @brief Reports that the playback ring changed.
+ */
+void audio_report_ring(void)
+{
+    if (report_now(REPORT_RING))
+    {
+        print_audio_pipeline_state();
+    }
+}
+
+/**
+ * @brief Prints every dirty view once.
+ *
+ * The ring is printed before the status, the order a play command prints
+ * them in. A view equal to the one printed last is counted and skipped.
+ */
+void audio_report_flush(void)
+{
+    unsigned dirty = atomic_exchange_explicit(&report_dirty, 0, memory_order_relaxed);
+    last_flush_ns = now_ns();
+    if (dirty == 0 || !LOG_ENABLED(LOG_SEVERITY_INFO))
+    {
+        return;
+    }
+
+    audio_ring_view_t ring;
+    if ((dirty & REPORT_RING) && audio_pipeline_ring_view(&ring))
+    {
+        if (ring_printed && ring.count == last_ring.count && ring.head == last_ring.head &&
+            ring.tail == last_ring.tail && ring.capacity == last_ring.capacity)
+        {
+            report_suppressed++;
+        }
+        else
+        {
+            print_audio_ring_report("Audio Ring", ring.count, ring.capacity, ring.head, ring.tail);
+            last_ring = ring;
+            ring_printed = true;
+            report_emitted++;
+        }
+    }
+
+    if (dirty & REPORT_STATE)
+    {
+        audioState state = snapshot_audio_state();
+        if (state_printed && state.volume == last_state.volume &&
+            state.flags.is_playing == last_state.flags.is_playing &&
+            state.flags.is_muted == last_state.flags.is_muted)
+        {
+            report_suppressed++;
+        }
+        else
+        {
+            print_audio_state();
+            last_state = state;
+            state_printed = true;
+            report_emitted++;
+        }
+    }
+}
+
+/**
+ * @brief Flushes when AUDIO_REPORT_TICK_NS have passed since the last flush.
+ */
+void audio_report_tick(void)
+{
+    if (atomic_load_explicit(&report_mode, memory_order_relaxed) == AUDIO_REPORT_COALESCED &&
+        now_ns() - last_flush_ns >= AUDIO_REPORT_TICK_NS)
+    {
+        audio_report_flush();
+    }
+}
+
+/**
+ * @brief Returns the coalescing counters since startup.
+ */
+audio_report_counters_t audio_report_counters(void)
+{
+    audio_report_counters_t counters = {
+        atomic_load_explicit(&report_requested, memory_order_relaxed),
+        report_emitted,
+        report_suppressed,
+    };
+    return counters;
+}
@@ -0,0 +1,418 @@
+/**
+ * @file src/audio_resampler.c
+ * @brief Polyphase Sample-Rate Converter Implementation
+ *
+ * Output frame n sits at input position n * M / L. Its integer part selects
+ * the window of taps input frames and its fraction, always a multiple of
+ * 1/L, selects the coefficient row, so the position is tracked exactly as a
+ * window start plus a phase in [0, L). Every row is normalized to unity DC
+ * gain so the phases do not ripple.
+ *
+ * Input is deinterleaved into one plane per channel, which makes every dot
+ * product two contiguous vectors. Consumed frames are moved out of the
+ * planes after each call; only the window tail stays.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_resampler.h"
+#include "audio_gain.h"
+#include "audio_mixer.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AUDIO_RESAMPLE_X86 1
+#include <immintrin.h>
+#endif
+
+#define RESAMPLER_MAX_TAPS 256                        // Cap on taps per phase after widening for downsampling
+#define RESAMPLER_ALIGN 32                            // Coefficient rows are aligned for 256-bit loads
+
+typedef struct {
+    uint32_t taps;                                    // Taps per phase at unity ratio
+    double beta;                                      // Kaiser window shape (stopband depth)
+    double rolloff;                                   // Cutoff as a fraction of the lower Nyquist rate
+} resample_design_t;
+
+static const resample_design_t resample_designs[AUDIO_RESAMPLE_QUALITY_COUNT] = {
+    [AUDIO_RESAMPLE_LOW] = { 8, 6.0, 0.84 },
+    [AUDIO_RESAMPLE_MEDIUM] = { 16, 8.0, 0.91 },
+    [AUDIO_RESAMPLE_HIGH] = { 32, 10.0, 0.95 },
+};
+
+static const char *const resample_quality_names[AUDIO_RESAMPLE_QUALITY_COUNT] = { "low", "medium", "high" };
+
+// ====================================================================================
+// Filter design
+
+static uint32_t gcd_u32(uint32_t a, uint32_t b)
+{
+    while (b != 0)
+    {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * @brief Modified Bessel function of the first kind, order 0 (power series).
+ */
+static double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 64 && term > sum * 1e-15; k++)
+    {
+        double t = x / (2.0 * k);
+        term *= t * t;
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * @brief Fills the coefficient table: row p holds the taps for fraction p / L.
+ *
+ * Window frame k of row p sits (p / L + taps / 2 - 1 - k) input frames from
+ * the output position.
+ */
+static void design_filter(audio_resampler_t *rs, const resample_design_t *design)
+{
+    const double half = rs->taps / 2.0;
+    const double cutoff = design->rolloff * ((rs->out_rate < rs->in_rate) ? (double)rs->phases / rs->step : 1.0);
+    const double norm = bessel_i0(design->beta);
+    for (uint32_t p = 0; p < rs->phases; p++)
+    {
+        float *row = rs->coeffs + (size_t)p * rs->taps;
+        double sum = 0.0;
+        double h[RESAMPLER_MAX_TAPS];
+        for (uint32_t k = 0; k < rs->taps; k++)
+        {
+            double x = (double)p / rs->phases + half - 1.0 - k;
+            double r = x / half;
+            double window = (r > -1.0 && r < 1.0) ? bessel_i0(design->beta * sqrt(1.0 - r * r)) / norm : 0.0;
+            double u = M_PI * cutoff * x;
+            h[k] = cutoff * ((u == 0.0) ? 1.0 : sin(u) / u) * window;
+            sum += h[k];
+        }
+        for (uint32_t k = 0; k < rs->taps; k++)
+        {
+            row[k] = (float)(h[k] / sum);
+        }
+    }
+}
+
+// ====================================================================================
+// Kernels
+
+/**
+ * @brief Runs frames outputs: one dot product per channel, then the position advances.
+ *
+ * Inlined into each ISA wrapper with that wrapper's dot product.
+ */
+static inline __attribute__((always_inline)) void filter_frames(audio_resampler_t *rs, float *out, uint32_t frames,
+                                                                float (*dot)(const float *, const float *, uint32_t))
+{
+    const uint32_t taps = rs->taps;
+    const uint32_t whole = rs->step / rs->phases;
+    const uint32_t frac = rs->step % rs->phases;
+    size_t start = rs->start;
+    uint32_t phase = rs->phase;
+    for (uint32_t n = 0; n < frames; n++)
+    {
+        const float *row = rs->coeffs + (size_t)phase * taps;
+        const float *x = rs->history + start;
+        for (uint32_t ch = 0; ch < rs->channels; ch++, x += rs->stride)
+        {
+            *out++ = dot(row, x, taps);
+        }
+        start += whole;
+        phase += frac;
+        if (phase >= rs->phases)
+        {
+            phase -= rs->phases;
+            start++;
+        }
+    }
+    rs->start = start;
+    rs->phase = phase;
+}
+
+static inline float dot_scalar(const float *c, const float *x, uint32_t taps)
+{
+    float acc = 0.0f;
+    for (uint32_t k = 0; k < taps; k++)
+    {
+        acc += c[k] * x[k];
+    }
+    return acc;
+}
+
+static void filter_scalar(audio_resampler_t *rs, float *out, uint32_t frames)
+{
+    filter_frames(rs, out, frames, dot_scalar);
+}
+
+#ifdef AUDIO_RESAMPLE_X86
+__attribute__((target("sse2")))
+static inline float dot_sse2(const float *c, const float *x, uint32_t taps)
+{
+    __m128 a = _mm_setzero_ps();
+    __m128 b = _mm_setzero_ps();
+    for (uint32_t k = 0; k < taps; k += 8)
+    {
+        a = _mm_add_ps(a, _mm_mul_ps(_mm_load_ps(c + k), _mm_loadu_ps(x + k)));
+        b = _mm_add_ps(b, _mm_mul_ps(_mm_load_ps(c + k + 4), _mm_loadu_ps(x + k + 4)));
+    }
+    a = _mm_add_ps(a, b);
+    a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    a = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+    return _mm_cvtss_f32(a);
+}
+
+__attribute__((target("sse2")))
+static void filter_sse2(audio_resampler_t *rs, float *out, uint32_t frames)
+{
+    filter_frames(rs, out, frames, dot_sse2);
+}
+
+__attribute__((target("avx2")))
+static inline float dot_avx2(const float *c, const float *x, uint32_t taps)
+{
+    __m256 acc = _mm256_mul_ps(_mm256_load_ps(c), _mm256_loadu_ps(x));
+    __m256 odd = _mm256_setzero_ps();                 // Second chain hides the add latency on long filters
+    uint32_t k = 8;
+    for (; k + 16 <= taps; k += 16)
+    {
+        odd = _mm256_add_ps(odd, _mm256_mul_ps(_mm256_load_ps(c + k), _mm256_loadu_ps(x + k)));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_load_ps(c + k + 8), _mm256_loadu_ps(x + k + 8)));
+    }
+    if (k < taps)
+    {
+        odd = _mm256_add_ps(odd, _mm256_mul_ps(_mm256_load_ps(c + k), _mm256_loadu_ps(x + k)));
+    }
+    acc = _mm256_add_ps(acc, odd);
+    __m128 a = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    a = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+    return _mm_cvtss_f32(a);
+}
+
+__attribute__((target("avx2")))
+static void filter_avx2(audio_resampler_t *rs, float *out, uint32_t frames)
+{
+    filter_frames(rs, out, frames, dot_avx2);
+}
+#endif
+
+typedef void (*filter_fn)(audio_resampler_t *rs, float *out, uint32_t frames);
+
+static const filter_fn filter_kernels[AUDIO_ISA_COUNT] = {
+    [AUDIO_ISA_SCALAR] = filter_scalar,
+#ifdef AUDIO_RESAMPLE_X86
+    [AUDIO_ISA_SSE2] = filter_sse2,
+    [AUDIO_ISA_AVX2] = filter_avx2,
+#else
+    [AUDIO_ISA_SSE2] = filter_scalar,
+    [AUDIO_ISA_AVX2] = filter_scalar,
+#endif
+};
+
+// ====================================================================================
+// Public interface
+
+/**
+ * @brief Builds a converter for one rate pair.
+ *
+ * @param rs Converter to initialize.
+ * @param in_rate Input frames per second.
+ * @param out_rate Output frames per second.
+ * @param channels Interleaved channels per frame.
+ * @param max_out Most output frames asked for per call (e.g. frames per chunk).
+ * @param quality Filter length and stopband.
+ * @return false for unusable rates or when memory runs out.
+ */
+bool audio_resampler_init(audio_resampler_t *rs, uint32_t in_rate, uint32_t out_rate, uint32_t channels,
+                          uint32_t max_out, audio_resample_quality_t quality)
+{
+    memset(rs, 0, sizeof(*rs));
+    if (in_rate == 0 || out_rate == 0 || channels == 0 || max_out == 0 || quality >= AUDIO_RESAMPLE_QUALITY_COUNT)
+    {
+        return false;
+    }
+    uint32_t g = gcd_u32(in_rate, out_rate);
+    const resample_design_t *design = &resample_designs[quality];
+    rs->in_rate = in_rate;
+    rs->out_rate = out_rate;
+    rs->phases = out_rate / g;
+    rs->step = in_rate / g;
+    rs->channels = channels;
+    rs->max_out = max_out;
+    rs->quality = quality;
+    if (rs->phases > AUDIO_RESAMPLER_MAX_PHASES)
+    {
+        return false;
+    }
+
+    // Downsampling narrows the cutoff, so the window widens to keep the same number of sinc lobes
+    uint64_t taps = design->taps;
+    if (rs->step > rs->phases)
+    {
+        taps = (taps * rs->step + rs->phases - 1) / rs->phases;
+    }
+    taps = (taps + 7) & ~(uint64_t)7;
+    rs->taps = (uint32_t)((taps > RESAMPLER_MAX_TAPS) ? RESAMPLER_MAX_TAPS : taps);
+    rs->max_in = (uint32_t)(((uint64_t)max_out * rs->step + rs->phases - 1) / rs->phases) + rs->taps + 2;
+    rs->stride = (size_t)rs->taps + rs->max_in;
+
+    rs->coeffs = aligned_alloc(RESAMPLER_ALIGN, (size_t)rs->phases * rs->taps * sizeof(float));
+    rs->history = malloc(rs->stride * channels * sizeof(float));
+    rs->scratch = malloc((size_t)max_out * channels * sizeof(float));
+    if (rs->coeffs == NULL || rs->history == NULL || rs->scratch == NULL)
+    {
+        audio_resampler_free(rs);
+        return false;
+    }
+    design_filter(rs, design);
+    audio_resampler_reset(rs);
+    return true;
+}
+
+/**
+ * @brief Releases the tables and history.
+ */
+void audio_resampler_free(audio_resampler_t *rs)
+{
+    free(rs->coeffs);
+    free(rs->history);
+    free(rs->scratch);
+    rs->coeffs = NULL;
+    rs->history = NULL;
+    rs->scratch = NULL;
+}
+
+/**
+ * @brief Starts a new stream: the window before the first frame reads as silence.
+ */
+void audio_resampler_reset(audio_resampler_t *rs)
+{
+    rs->count = rs->taps - 1;
+    rs->start = rs->taps / 2;                         // Centres output 0 on input 0
+    rs->phase = 0;
+    for (uint32_t ch = 0; ch < rs->channels; ch++)
+    {
+        memset(rs->history + ch * rs->stride, 0, rs->count * sizeof(float));
+    }
+}
+
+/**
+ * @brief Returns how many more input frames out_frames output frames need.
+ */
+uint32_t audio_resampler_input_needed(const audio_resampler_t *rs, uint32_t out_frames)
+{
+    if (out_frames == 0)
+    {
+        return 0;
+    }
+    uint64_t last = rs->start + ((uint64_t)rs->phase + (uint64_t)(out_frames - 1) * rs->step) / rs->phases;
+    uint64_t end = last + rs->taps;
+    return (end > rs->count) ? (uint32_t)(end - rs->count) : 0;
+}
+
+/**
+ * @brief Feeds input frames and produces as many output frames as they allow.
+ *
+ * @param rs The converter.
+ * @param in Interleaved float input with rs->channels channels.
+ * @param in_frames Input frames offered.
+ * @param consumed Receives the input frames accepted (at most rs->max_in per call when drained); may be NULL.
+ * @param out_config Output format (channels must match the converter).
+ * @param out Interleaved output samples.
+ * @param out_frames Most frames to produce (capped at rs->max_out).
+ * @return Output frames written.
+ */
+uint32_t audio_resampler_process(audio_resampler_t *rs, const float *in, uint32_t in_frames, uint32_t *consumed,
+                                 const audio_pcm_config_t *out_config, void *out, uint32_t out_frames)
+{
+    const uint32_t channels = rs->channels;
+    size_t accept = rs->stride - rs->count;
+    accept = (in_frames < accept) ? in_frames : accept;
+    for (uint32_t ch = 0; ch < channels; ch++)
+    {
+        float *plane = rs->history + ch * rs->stride + rs->count;
+        const float *src = in + ch;
+        for (size_t i = 0; i < accept; i++, src += channels)
+        {
+            plane[i] = *src;
+        }
+    }
+    rs->count += accept;
+    if (consumed != NULL)
+    {
+        *consumed = (uint32_t)accept;
+    }
+
+    // Output j fits while its window ends inside the planes: floor((phase + j*M) / L) <= count - taps - start
+    uint32_t frames = 0;
+    if (rs->count >= rs->start + rs->taps)
+    {
+        uint64_t span = (uint64_t)(rs->count - rs->taps - rs->start + 1) * rs->phases - 1 - rs->phase;
+        uint64_t fit = span / rs->step + 1;
+        out_frames = (out_frames < rs->max_out) ? out_frames : rs->max_out;
+        frames = (fit < out_frames) ? (uint32_t)fit : out_frames;
+    }
+    if (frames > 0)
+    {
+        filter_kernels[audio_gain_active_isa()](rs, rs->scratch, frames);
+        if (out_config->format == AUDIO_SAMPLE_F32)
+        {
+            audio_mix_store_f32(out, rs->scratch, (size_t)frames * channels, 1.0f);
+        }
+        else
+        {
+            audio_mix_store_s16(out, rs->scratch, (size_t)frames * channels, 32768.0f);
+        }
+    }
+
+    // Keep only what later windows still read
+    size_t drop = (rs->start < rs->count) ? rs->start : rs->count;
+    if (drop > 0)
+    {
+        for (uint32_t ch = 0; ch < channels; ch++)
+        {
+            float *plane = rs->history + ch * rs->stride;
+            memmove(plane, plane + drop, (rs->count - drop) * sizeof(float));
+        }
+        rs->count -= drop;
+        rs->start -= drop;
+    }
+    return frames;
+}
+
+/**
+ * @brief Returns a printable quality name.
+ */
+const char *audio_resample_quality_name(audio_resample_quality_t quality)
+{
+    return (quality < AUDIO_RESAMPLE_QUALITY_COUNT) ? resample_quality_names[quality] : "unknown";
+}
+
+/**
+ * @brief Parses a quality name.
+ *
+ * @return false if the name is not "low", "medium" or "high".
+ */
+bool audio_resample_quality_parse(const char *name, audio_resample_quality_t *quality)
+{
+    for (int q = 0; q < AUDIO_RESAMPLE_QUALITY_COUNT; q++)
+    {
+        if (strcmp(name, resample_quality_names[q]) == 0)
+        {
+            *quality = (audio_resample_quality_t)q;
+            return true;
+        }
+    }
+    return false;
+}
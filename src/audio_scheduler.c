@@ -0,0 +1,403 @@
+/**
+ * @file src/audio_scheduler.c
+ * @brief Session Scheduler Implementation
+ *
+ * The deques follow Chase and Lev with the C11 orderings of Le et al.
+ * ("Correct and Efficient Work-Stealing for Weak Memory Models"). The owner
+ * pushes and pops at the bottom without locks; thieves take from the top with
+ * one compare-and-swap. Deques have a fixed capacity; a full deque spills to
+ * the injection queue.
+ *
+ * Idle workers sleep on a condition variable with a short timeout, so a pool
+ * larger than the number of CPUs does not spin.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "audio_scheduler.h"
+#include "audio_logger.h"
+
+#define SCHEDULER_IDLE_WAIT_NS 1000000                // Longest sleep of an idle worker (1 ms)
+
+typedef struct {
+    _Alignas(AUDIO_CACHE_LINE) atomic_llong top;      // Next index stolen (thieves)
+    _Alignas(AUDIO_CACHE_LINE) atomic_llong bottom;   // Next index pushed (owner)
+    _Alignas(AUDIO_CACHE_LINE) _Atomic(audio_session_t *) slots[AUDIO_SCHEDULER_DEQUE_CAPACITY];
+} ws_deque_t;
+
+typedef struct {
+    ws_deque_t deque;                                 // Sessions scheduled by this worker
+    pthread_t thread;
+    unsigned index;                                   // Position in the pool
+    uint32_t rng;                                     // Victim selection state
+} scheduler_worker_t;
+
+static scheduler_worker_t *workers = NULL;
+static unsigned worker_count = 0;
+static bool scheduler_started = false;
+static __thread scheduler_worker_t *self_worker = NULL;   // Worker running on this thread, if any
+
+static pthread_mutex_t inject_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_ready = PTHREAD_COND_INITIALIZER;   // Signalled when work arrives
+static pthread_cond_t idle_ready = PTHREAD_COND_INITIALIZER;   // Signalled when the last session goes idle
+static audio_session_t *inject_head = NULL;           // Sessions scheduled from outside the pool (FIFO)
+static audio_session_t *inject_tail = NULL;
+static atomic_bool inject_nonempty;                   // Lets workers skip the lock when the queue is empty
+
+static atomic_uint sleeping_workers;                  // Workers waiting on work_ready
+static atomic_long scheduled_sessions;                // Sessions queued or running
+static atomic_bool scheduler_stopping;
+
+// ====================================================================================
+// Work-stealing deque
+
+static void deque_init(ws_deque_t *deque)
+{
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    for (size_t i = 0; i < AUDIO_SCHEDULER_DEQUE_CAPACITY; i++)
+    {
+        atomic_init(&deque->slots[i], NULL);
+    }
+}
+
+// Owner only
+static bool deque_push(ws_deque_t *deque, audio_session_t *session)
+{
+    long long b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long long t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (b - t >= AUDIO_SCHEDULER_DEQUE_CAPACITY)
+    {
+        return false;
+    }
+    atomic_store_explicit(&deque->slots[b & (AUDIO_SCHEDULER_DEQUE_CAPACITY - 1)], session, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    return true;
+}
+
+// Owner only
+static audio_session_t *deque_pop(ws_deque_t *deque)
+{
+    long long b = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (t > b)
+    {
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);   // Empty
+        return NULL;
+    }
+
+    audio_session_t *session = atomic_load_explicit(&deque->slots[b & (AUDIO_SCHEDULER_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (t == b)
+    {
+        // Last element: race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+        {
+            session = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    }
+    return session;
+}
+
+// Any thread
+static audio_session_t *deque_steal(ws_deque_t *deque)
+{
+    long long t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long b = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (t >= b)
+    {
+        return NULL;
+    }
+
+    audio_session_t *session = atomic_load_explicit(&deque->slots[t & (AUDIO_SCHEDULER_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+    {
+        return NULL;                                  // Lost the race to another thief or the owner
+    }
+    return session;
+}
+
+// ====================================================================================
+// Injection queue
+
+static void inject_push(audio_session_t *session)
+{
+    pthread_mutex_lock(&inject_lock);
+    session->next_ready = NULL;
+    if (inject_tail != NULL)
+    {
+        inject_tail->next_ready = session;
+    }
+    else
+    {
+        inject_head = session;
+    }
+    inject_tail = session;
+    atomic_store_explicit(&inject_nonempty, true, memory_order_release);
+    pthread_cond_signal(&work_ready);
+    pthread_mutex_unlock(&inject_lock);
+}
+
+static audio_session_t *inject_pop(void)
+{
+    if (!atomic_load_explicit(&inject_nonempty, memory_order_acquire))
+    {
+        return NULL;
+    }
+    pthread_mutex_lock(&inject_lock);
+    audio_session_t *session = inject_head;
+    if (session != NULL)
+    {
+        inject_head = session->next_ready;
+        if (inject_head == NULL)
+        {
+            inject_tail = NULL;
+            atomic_store_explicit(&inject_nonempty, false, memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&inject_lock);
+    return session;
+}
+
+// ====================================================================================
+// Workers
+
+static audio_session_t *steal_work(scheduler_worker_t *self)
+{
+    self->rng = self->rng * 1664525u + 1013904223u;
+    unsigned start = (self->rng >> 16) % worker_count;
+    for (unsigned i = 0; i < worker_count; i++)
+    {
+        scheduler_worker_t *victim = &workers[(start + i) % worker_count];
+        if (victim == self)
+        {
+            continue;
+        }
+        audio_session_t *session = deque_steal(&victim->deque);
+        if (session != NULL)
+        {
+            return session;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Puts a session scheduled by a worker on that worker's deque.
+ */
+static void enqueue_ready(audio_session_t *session)
+{
+    if (self_worker != NULL && deque_push(&self_worker->deque, session))
+    {
+        if (atomic_load_explicit(&sleeping_workers, memory_order_relaxed) > 0)
+        {
+            pthread_cond_signal(&work_ready);         // Let an idle worker steal it
+        }
+        return;
+    }
+    inject_push(session);
+}
+
+/**
+ * @brief Runs one batch of a session, then reschedules or retires it.
+ */
+static void run_scheduled(audio_session_t *session)
+{
+    audio_session_run(session, AUDIO_SESSION_BATCH);
+
+    // Retire the session; a submitter that sees it retired schedules it again.
+    // The exchange pairs with the submitter's, so a command it queued is visible below.
+    atomic_exchange_explicit(&session->scheduled, false, memory_order_acq_rel);
+    if (audio_session_has_pending(session) &&
+        !atomic_exchange_explicit(&session->scheduled, true, memory_order_acq_rel))
+    {
+        enqueue_ready(session);                       // Still has work and nobody rescheduled it
+        return;
+    }
+
+    if (atomic_fetch_sub_explicit(&scheduled_sessions, 1, memory_order_acq_rel) == 1)
+    {
+        pthread_mutex_lock(&inject_lock);
+        pthread_cond_broadcast(&idle_ready);
+        pthread_mutex_unlock(&inject_lock);
+    }
+}
+
+static void *worker_main(void *arg)
+{
+    scheduler_worker_t *self = arg;
+    self_worker = self;
+
+    while (1)
+    {
+        audio_session_t *session = deque_pop(&self->deque);
+        if (session == NULL)
+        {
+            session = inject_pop();
+        }
+        if (session == NULL && worker_count > 1)
+        {
+            session = steal_work(self);
+        }
+        if (session != NULL)
+        {
+            run_scheduled(session);
+            continue;
+        }
+
+        pthread_mutex_lock(&inject_lock);
+        if (atomic_load(&scheduler_stopping) && atomic_load(&scheduled_sessions) == 0)
+        {
+            pthread_mutex_unlock(&inject_lock);
+            break;
+        }
+        if (inject_head == NULL)
+        {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += SCHEDULER_IDLE_WAIT_NS;
+            if (deadline.tv_nsec >= 1000000000L)
+            {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            atomic_fetch_add(&sleeping_workers, 1);
+            pthread_cond_timedwait(&work_ready, &inject_lock, &deadline);
+            atomic_fetch_sub(&sleeping_workers, 1);
+        }
+        pthread_mutex_unlock(&inject_lock);
+    }
+    return NULL;
+}
+
+// ====================================================================================
+// Public API
+
+/**
+ * @brief Starts the worker pool.
+ *
+ * @param count Number of workers, or 0 for one per online CPU.
+ * @return true if every worker is running.
+ */
+bool audio_scheduler_start(unsigned count)
+{
+    if (scheduler_started)
+    {
+        return true;
+    }
+    if (count == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        count = (cpus > 0) ? (unsigned)cpus : 1;
+    }
+    if (count > AUDIO_SCHEDULER_MAX_WORKERS)
+    {
+        count = AUDIO_SCHEDULER_MAX_WORKERS;
+    }
+
+    workers = aligned_alloc(AUDIO_CACHE_LINE, sizeof(scheduler_worker_t) * count);
+    if (workers == NULL)
+    {
+        LOG_ERROR("Memory allocation failed for scheduler workers");
+        return false;
+    }
+
+    atomic_store(&scheduler_stopping, false);
+    atomic_store(&scheduled_sessions, 0);
+    atomic_store(&sleeping_workers, 0);
+    worker_count = count;
+    for (unsigned i = 0; i < count; i++)
+    {
+        deque_init(&workers[i].deque);
+        workers[i].index = i;
+        workers[i].rng = 0x9E3779B9u * (i + 1);
+    }
+    for (unsigned i = 0; i < count; i++)
+    {
+        if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) != 0)
+        {
+            LOG_ERROR("Failed to start scheduler worker %u", i);
+            atomic_store(&scheduler_stopping, true);
+            pthread_mutex_lock(&inject_lock);
+            pthread_cond_broadcast(&work_ready);
+            pthread_mutex_unlock(&inject_lock);
+            for (unsigned j = 0; j < i; j++)
+            {
+                pthread_join(workers[j].thread, NULL);
+            }
+            free(workers);
+            workers = NULL;
+            worker_count = 0;
+            return false;
+        }
+    }
+
+    scheduler_started = true;
+    return true;
+}
+
+/**
+ * @brief Runs every queued command, then joins the workers.
+ */
+void audio_scheduler_stop(void)
+{
+    if (!scheduler_started)
+    {
+        return;
+    }
+
+    audio_scheduler_wait_idle();
+    atomic_store(&scheduler_stopping, true);
+    pthread_mutex_lock(&inject_lock);
+    pthread_cond_broadcast(&work_ready);
+    pthread_mutex_unlock(&inject_lock);
+
+    for (unsigned i = 0; i < worker_count; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+    }
+    free(workers);
+    workers = NULL;
+    worker_count = 0;
+    scheduler_started = false;
+}
+
+/**
+ * @brief Blocks until every scheduled session has run out of commands.
+ */
+void audio_scheduler_wait_idle(void)
+{
+    pthread_mutex_lock(&inject_lock);
+    while (atomic_load_explicit(&scheduled_sessions, memory_order_acquire) > 0)
+    {
+        pthread_cond_wait(&idle_ready, &inject_lock);
+    }
+    pthread_mutex_unlock(&inject_lock);
+}
+
+/**
+ * @brief Hands a session with pending commands to the pool.
+ *
+ * Called by audio_session_submit() when it sets the session's scheduled flag.
+ */
+void audio_scheduler_schedule(audio_session_t *session)
+{
+    atomic_fetch_add_explicit(&scheduled_sessions, 1, memory_order_acq_rel);
+    enqueue_ready(session);
+}
+
+/**
+ * @brief Returns the number of workers in the running pool.
+ */
+unsigned audio_scheduler_worker_count(void)
+{
+    return worker_count;
+}
@@ -0,0 +1,526 @@
+/**
+ * @file src/audio_server.c
+ * @brief Unix Domain Socket Command Server Implementation
+ */
+
+#define _GNU_SOURCE                                   // accept4()
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "audio_batch.h"
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "audio_report.h"
+#include "audio_server.h"
+#include "audio_timer.h"
+
+#define SERVER_READ_MAX 16384                         // Bytes taken from a socket per readiness event
+#define SERVER_REPLY_BUFFER 16384                     // Replies gathered before a send()
+
+typedef struct server_conn {
+    struct server_conn *prev;                         // Links in the list of open connections
+    struct server_conn *next;
+    int fd;
+    bool discarding;                                  // Dropping an over-long line up to its newline
+    bool closing;                                     // Close once the pending replies are sent
+    bool writing;                                     // Waiting for EPOLLOUT instead of EPOLLIN
+    uint32_t partial_len;                             // Bytes of an unfinished line
+    char *pending;                                    // Replies the socket has not taken yet (heap, rare)
+    size_t pending_len;
+    size_t pending_sent;
+    size_t pending_capacity;
+    char partial[AUDIO_SERVER_LINE_MAX];              // Unfinished line carried to the next read
+} server_conn_t;
+
+static int server_listen_fd = -1;
+static int server_epoll_fd = -1;
+static int server_stop_fd = -1;
+static char server_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static size_t server_max_connections;
+static server_conn_t *server_connections;            // Every open connection
+static audio_server_stats_t server_stats;
+
+static char server_listen_tag;                        // epoll data of the listening socket
+static char server_stop_tag;                          // epoll data of the stop eventfd
+static char read_buffer[AUDIO_SERVER_LINE_MAX + SERVER_READ_MAX];   // Partial line, then the new bytes
+static char reply_buffer[SERVER_REPLY_BUFFER];
+static size_t reply_len;
+
+static const char *const reply_text[] = {
+    [AUD_DISPATCH_OK] = "ok\n",
+    [AUD_DISPATCH_EMPTY] = "error empty command\n",
+    [AUD_DISPATCH_UNKNOWN] = "error unknown command\n",
+    [AUD_DISPATCH_BAD_ARGS] = "error invalid arguments\n",
+};
+static const char reply_too_long[] = "error line too long\n";
+
+/**
+ * @brief Fills in the default server configuration.
+ */
+void audio_server_default_config(audio_server_config_t *config)
+{
+    config->path = NULL;
+    config->max_connections = AUDIO_SERVER_MAX_CONNECTIONS;
+}
+
+/**
+ * @brief Raises the open-file limit so the connection limit can be reached.
+ */
+static void raise_file_limit(size_t wanted)
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur >= wanted)
+    {
+        return;
+    }
+    limit.rlim_cur = (limit.rlim_max == RLIM_INFINITY || limit.rlim_max >= wanted) ? wanted : limit.rlim_max;
+    if (setrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur < wanted)
+    {
+        LOG_WARNING("Open-file limit is %llu; fewer than %zu connections fit", (unsigned long long)limit.rlim_cur, wanted);
+    }
+}
+
+static bool watch(int fd, uint32_t events, void *tag)
+{
+    struct epoll_event event = { .events = events, .data.ptr = tag };
+    return epoll_ctl(server_epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+/**
+ * @brief Binds the socket, starts listening and creates the event loop.
+ *
+ * An existing file at the socket path is removed first.
+ *
+ * @param config Server configuration; config->path is required.
+ * @return false if any step fails (the reason is logged).
+ */
+bool audio_server_open(const audio_server_config_t *config)
+{
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    if (config->path == NULL || strlen(config->path) >= sizeof(address.sun_path))
+    {
+        LOG_ERROR("Invalid server socket path");
+        return false;
+    }
+    strcpy(address.sun_path, config->path);
+    strcpy(server_path, config->path);
+    server_max_connections = config->max_connections;
+    memset(&server_stats, 0, sizeof(server_stats));
+    raise_file_limit(server_max_connections + 64);
+
+    unlink(server_path);
+    server_listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    server_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    server_stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (server_listen_fd < 0 || server_epoll_fd < 0 || server_stop_fd < 0 ||
+        bind(server_listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(server_listen_fd, SOMAXCONN) != 0 ||
+        !watch(server_listen_fd, EPOLLIN, &server_listen_tag) ||
+        !watch(server_stop_fd, EPOLLIN, &server_stop_tag))
+    {
+        LOG_ERROR("Cannot serve on %s: %s", server_path, strerror(errno));
+        audio_server_close();
+        return false;
+    }
+    LOG_INFO("Serving commands on %s (up to %zu connections)", server_path, server_max_connections);
+    return true;
+}
+
+static void close_connection(server_conn_t *conn)
+{
+    if (conn->prev != NULL)
+    {
+        conn->prev->next = conn->next;
+    }
+    else
+    {
+        server_connections = conn->next;
+    }
+    if (conn->next != NULL)
+    {
+        conn->next->prev = conn->prev;
+    }
+    close(conn->fd);                                  // Also removes it from the epoll set
+    free(conn->pending);
+    free(conn);
+    server_stats.open--;
+}
+
+/**
+ * @brief Accepts every connection waiting on the listening socket.
+ */
+static void accept_connections(void)
+{
+    for (;;)
+    {
+        int fd = accept4(server_listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED)
+            {
+                LOG_WARNING("accept failed: %s", strerror(errno));
+            }
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            return;
+        }
+
+        server_conn_t *conn = (server_stats.open < server_max_connections) ? malloc(sizeof(*conn)) : NULL;
+        if (conn == NULL)
+        {
+            close(fd);
+            server_stats.refused++;
+            continue;
+        }
+        conn->fd = fd;
+        conn->discarding = false;
+        conn->closing = false;
+        conn->writing = false;
+        conn->partial_len = 0;
+        conn->pending = NULL;
+        conn->pending_len = 0;
+        conn->pending_sent = 0;
+        conn->pending_capacity = 0;
+        if (!watch(fd, EPOLLIN, conn))
+        {
+            close(fd);
+            free(conn);
+            server_stats.refused++;
+            continue;
+        }
+        conn->prev = NULL;
+        conn->next = server_connections;
+        if (server_connections != NULL)
+        {
+            server_connections->prev = conn;
+        }
+        server_connections = conn;
+        server_stats.accepted++;
+        server_stats.open++;
+        server_stats.peak = (server_stats.open > server_stats.peak) ? server_stats.open : server_stats.peak;
+    }
+}
+
+/**
+ * @brief Switches a connection between waiting to read and waiting to write.
+ */
+static void set_writing(server_conn_t *conn, bool writing)
+{
+    if (conn->writing == writing)
+    {
+        return;
+    }
+    struct epoll_event event = { .events = writing ? EPOLLOUT : EPOLLIN, .data.ptr = conn };
+    epoll_ctl(server_epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+    conn->writing = writing;
+}
+
+/**
+ * @brief Keeps replies the socket did not take, in order, until it drains.
+ */
+static bool queue_pending(server_conn_t *conn, const char *data, size_t len)
+{
+    if (conn->pending_len + len > conn->pending_capacity)
+    {
+        size_t capacity = conn->pending_capacity ? conn->pending_capacity : SERVER_REPLY_BUFFER;
+        while (capacity < conn->pending_len + len)
+        {
+            capacity *= 2;
+        }
+        char *grown = realloc(conn->pending, capacity);
+        if (grown == NULL)
+        {
+            return false;
+        }
+        conn->pending = grown;
+        conn->pending_capacity = capacity;
+    }
+    memcpy(conn->pending + conn->pending_len, data, len);
+    conn->pending_len += len;
+    return true;
+}
+
+/**
+ * @brief Sends the gathered replies, queueing what the socket does not take.
+ *
+ * @return false if the connection failed and must be closed.
+ */
+static bool send_replies(server_conn_t *conn)
+{
+    size_t sent = 0;
+    if (conn->pending_len == 0)
+    {
+        while (sent < reply_len)
+        {
+            ssize_t n = send(conn->fd, reply_buffer + sent, reply_len - sent, MSG_NOSIGNAL);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    reply_len = 0;
+                    return false;
+                }
+                break;
+            }
+            sent += (size_t)n;
+        }
+        server_stats.bytes_out += sent;
+    }
+    bool ok = true;
+    if (sent < reply_len)
+    {
+        server_stats.stalled++;
+        ok = queue_pending(conn, reply_buffer + sent, reply_len - sent);
+        set_writing(conn, true);                      // Stop reading until the client takes its replies
+    }
+    reply_len = 0;
+    return ok;
+}
+
+static bool add_reply(server_conn_t *conn, const char *text, size_t len)
+{
+    if (reply_len + len > sizeof(reply_buffer) && !send_replies(conn))
+    {
+        return false;
+    }
+    memcpy(reply_buffer + reply_len, text, len);
+    reply_len += len;
+    return true;
+}
+
+/**
+ * @brief Dispatches every complete line of a read and replies to each.
+ *
+ * @param conn The connection.
+ * @param data The partial line from the last read followed by the new bytes.
+ * @param len Length of data.
+ * @return false if the connection must be closed.
+ */
+static bool serve_lines(server_conn_t *conn, char *data, size_t len)
+{
+    const char *p = data;
+    const char *end = data + len;
+    while (p < end && !conn->closing)
+    {
+        const char *newline = find_next_newline(p, end);
+        if (newline == end)
+        {
+            break;
+        }
+        size_t line_len = (size_t)(newline - p);
+        if (line_len > 0 && p[line_len - 1] == '\r')
+        {
+            line_len--;
+        }
+
+        if (conn->discarding || line_len >= AUDIO_SERVER_LINE_MAX)
+        {
+            conn->discarding = false;                 // End of an over-long line
+            server_stats.errors++;
+            if (!add_reply(conn, reply_too_long, sizeof(reply_too_long) - 1))
+            {
+                return false;
+            }
+        }
+        else if (line_len == 4 && memcmp(p, "exit", 4) == 0)
+        {
+            conn->closing = true;
+        }
+        else
+        {
+            aud_dispatch_status_t status = dispatch_command_slice(p, line_len);
+            const char *reply = reply_text[status];
+            server_stats.commands++;
+            server_stats.errors += (status != AUD_DISPATCH_OK);
+            if (!add_reply(conn, reply, strlen(reply)))
+            {
+                return false;
+            }
+        }
+        p = newline + 1;
+    }
+
+    // Carry an unfinished line to the next read; drop one that can never fit
+    size_t rest = conn->closing ? 0 : (size_t)(end - p);
+    if (rest >= AUDIO_SERVER_LINE_MAX)
+    {
+        conn->discarding = true;
+        rest = 0;
+    }
+    memmove(conn->partial, p, rest);
+    conn->partial_len = (uint32_t)rest;
+    return send_replies(conn);
+}
+
+/**
+ * @brief Reads what a connection sent and serves its lines.
+ *
+ * @return false if the connection must be closed.
+ */
+static bool handle_readable(server_conn_t *conn)
+{
+    size_t carried = conn->partial_len;
+    memcpy(read_buffer, conn->partial, carried);
+    ssize_t n = recv(conn->fd, read_buffer + carried, SERVER_READ_MAX, 0);
+    if (n < 0)
+    {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    if (n == 0)
+    {
+        return false;                                 // Client closed its side
+    }
+    server_stats.reads++;
+    server_stats.bytes_in += (uint64_t)n;
+    if (!serve_lines(conn, read_buffer, carried + (size_t)n))
+    {
+        return false;
+    }
+    return !(conn->closing && conn->pending_len == 0);
+}
+
+/**
+ * @brief Sends pending replies once the client reads again.
+ *
+ * @return false if the connection must be closed.
+ */
+static bool handle_writable(server_conn_t *conn)
+{
+    while (conn->pending_sent < conn->pending_len)
+    {
+        ssize_t n = send(conn->fd, conn->pending + conn->pending_sent, conn->pending_len - conn->pending_sent, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        conn->pending_sent += (size_t)n;
+        server_stats.bytes_out += (uint64_t)n;
+    }
+    conn->pending_len = 0;
+    conn->pending_sent = 0;
+    if (conn->closing)
+    {
+        return false;
+    }
+    set_writing(conn, false);
+    return true;
+}
+
+/**
+ * @brief Runs the event loop until audio_server_stop() is called.
+ *
+ * Coalesced state reports are flushed after every round of events and at
+ * least every AUDIO_REPORT_TICK_NS while idle. Delayed commands run after
+ * every round too; the wait never outlasts the next one.
+ *
+ * @return 0 when stopped, -1 if epoll fails.
+ */
+int audio_server_run(void)
+{
+    struct epoll_event events[AUDIO_SERVER_EVENTS];
+    const int tick_ms = (int)(AUDIO_REPORT_TICK_NS / 1000000ULL);
+    for (;;)
+    {
+        int timeout_ms = audio_next_command_timeout_ms();
+        timeout_ms = (timeout_ms < 0 || timeout_ms > tick_ms) ? tick_ms : timeout_ms;
+        int ready = epoll_wait(server_epoll_fd, events, AUDIO_SERVER_EVENTS, timeout_ms);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            LOG_ERROR("epoll_wait failed: %s", strerror(errno));
+            return -1;
+        }
+
+        for (int i = 0; i < ready; i++)
+        {
+            void *tag = events[i].data.ptr;
+            if (tag == &server_listen_tag)
+            {
+                accept_connections();
+                continue;
+            }
+            if (tag == &server_stop_tag)
+            {
+                uint64_t count;
+                ssize_t ignored = read(server_stop_fd, &count, sizeof(count));
+                (void)ignored;
+                audio_report_flush();
+                return 0;
+            }
+
+            server_conn_t *conn = tag;
+            bool keep = (events[i].events & EPOLLOUT) ? handle_writable(conn) : handle_readable(conn);
+            if (!keep || (events[i].events & EPOLLERR))
+            {
+                close_connection(conn);
+            }
+        }
+        audio_run_due_commands();
+        audio_report_flush();
+    }
+}
+
+/**
+ * @brief Asks the event loop to return.
+ *
+ * Safe from a signal handler or another thread.
+ */
+void audio_server_stop(void)
+{
+    uint64_t one = 1;
+    if (server_stop_fd >= 0)
+    {
+        ssize_t ignored = write(server_stop_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+/**
+ * @brief Closes every connection and the listening socket, and removes the socket file.
+ */
+void audio_server_close(void)
+{
+    while (server_connections != NULL)
+    {
+        close_connection(server_connections);
+    }
+    if (server_listen_fd >= 0)
+    {
+        close(server_listen_fd);
+        unlink(server_path);
+    }
+    if (server_epoll_fd >= 0)
+    {
+        close(server_epoll_fd);
+    }
+    if (server_stop_fd >= 0)
+    {
+        close(server_stop_fd);
+    }
+    server_listen_fd = -1;
+    server_epoll_fd = -1;
+    server_stop_fd = -1;
+}
+
+/**
+ * @brief Returns the server counters.
+ */
+audio_server_stats_t audio_server_stats(void)
+{
+    return server_stats;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file src/audio_session.c
+ * @brief Audio Session Implementation
+ *
+ * The command queue uses one sequence number per cell, as the async logger
+ * does: submitters claim a position with compare-and-swap and never take a
+ * lock; the single worker running the session consumes cells in order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_session.h"
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "audio_scheduler.h"
+
+static __thread audio_session_t *current_session = NULL;   // Session running on this thread
+
+/**
+ * @brief Allocates a session at the default state.
+ *
+ * @param id Caller-chosen session id.
+ * @return The session, or NULL on allocation failure.
+ */
+audio_session_t *audio_session_create(uint32_t id)
+{
+    audio_session_t *session = aligned_alloc(AUDIO_CACHE_LINE,
+                                             (sizeof(audio_session_t) + AUDIO_CACHE_LINE - 1) & ~(size_t)(AUDIO_CACHE_LINE - 1));
+    if (session == NULL)
+    {
+        LOG_ERROR("Memory allocation failed for session %u", id);
+        return NULL;
+    }
+
+    session->id = id;
+    audio_state_cell_init(&session->state);
+    if (!init_audio_buffer(&session->chunks, AUDIO_SESSION_CHUNK_BYTES))
+    {
+        free(session);
+        return NULL;
+    }
+    session->commands_run = 0;
+    session->chunks_played = 0;
+    atomic_init(&session->enqueue_pos, 0);
+    session->dequeue_pos = 0;
+    atomic_init(&session->scheduled, false);
+    session->next_ready = NULL;
+    for (size_t i = 0; i < AUDIO_SESSION_QUEUE_CAPACITY; i++)
+    {
+        atomic_init(&session->queue[i].sequence, i);
+    }
+    return session;
+}
+
+/**
+ * @brief Frees a session.
+ *
+ * The session must be idle: nothing queued and not scheduled.
+ */
+void audio_session_destroy(audio_session_t *session)
+{
+    free_audio_buffer(&session->chunks);
+    free(session);
+}
+
+/**
+ * @brief Queues a command for a session and makes sure it is scheduled.
+ *
+ * Safe from any thread.
+ *
+ * @param session The target session.
+ * @param line The command line (not necessarily terminated).
+ * @param len Length of the command line.
+ * @return false if the line is too long or the session queue is full.
+ */
+bool audio_session_submit(audio_session_t *session, const char *line, size_t len)
+{
+    if (len > AUDIO_SESSION_COMMAND_MAX)
+    {
+        LOG_ERROR("Session %u: command too long (%zu bytes)", session->id, len);
+        return false;
+    }
+
+    size_t pos = atomic_load_explicit(&session->enqueue_pos, memory_order_relaxed);
+    audio_session_cell_t *cell;
+    while (1)
+    {
+        cell = &session->queue[pos & (AUDIO_SESSION_QUEUE_CAPACITY - 1)];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&session->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;                                   // Queue full: the worker has not caught up
+        }
+        else
+        {
+            pos = atomic_load_explicit(&session->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    memcpy(cell->text, line, len);
+    cell->length = (uint32_t)len;
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+
+    if (!atomic_exchange_explicit(&session->scheduled, true, memory_order_acq_rel))
+    {
+        audio_scheduler_schedule(session);                  // First pending command: hand the session to a worker
+    }
+    return true;
+}
+
+/**
+ * @brief Whether the session has a command ready to run.
+ *
+ * Only meaningful on the thread that runs the session.
+ */
+bool audio_session_has_pending(const audio_session_t *session)
+{
+    const audio_session_cell_t *cell = &session->queue[session->dequeue_pos & (AUDIO_SESSION_QUEUE_CAPACITY - 1)];
+    return atomic_load_explicit(&cell->sequence, memory_order_acquire) == session->dequeue_pos + 1;
+}
+
+/**
+ * @brief Runs queued commands of a session on the calling thread.
+ *
+ * The thread is bound to the session while the commands run, and queued
+ * chunks are played afterwards. Must not run concurrently for one session;
+ * the scheduler guarantees that.
+ *
+ * @param session The session to run.
+ * @param max_commands Most commands to run before returning.
+ * @return Number of commands run.
+ */
+size_t audio_session_run(audio_session_t *session, size_t max_commands)
+{
+    audio_session_t *previous_session = current_session;
+    audio_state_cell_t *previous_state = audio_state_bind(&session->state);
+    current_session = session;
+
+    size_t ran = 0;
+    while (ran < max_commands && audio_session_has_pending(session))
+    {
+        audio_session_cell_t *cell = &session->queue[session->dequeue_pos & (AUDIO_SESSION_QUEUE_CAPACITY - 1)];
+        dispatch_command_slice(cell->text, cell->length);
+        atomic_store_explicit(&cell->sequence, session->dequeue_pos + AUDIO_SESSION_QUEUE_CAPACITY, memory_order_release);
+        session->dequeue_pos++;
+        ran++;
+    }
+    session->commands_run += ran;
+
+    // Play whatever the commands queued, reading each chunk in place
+    size_t len;
+    while (peek_audio_record(&session->chunks, &len) != NULL)
+    {
+        release_audio_record(&session->chunks);
+        session->chunks_played++;
+    }
+
+    current_session = previous_session;
+    audio_state_bind(previous_state);
+    return ran;
+}
+
+/**
+ * @brief Returns the session running on the calling thread, or NULL.
+ */
+audio_session_t *audio_session_current(void)
+{
+    return current_session;
+}
+
+/**
+ * @brief Queues the chunks of a play request on a session's buffer.
+ *
+ * Each chunk is formatted straight into its record in the byte ring.
+ *
+ * @param session The session.
+ * @param source Name of the source (not terminated).
+ * @param len Length of the source name.
+ */
+void audio_session_queue_chunks(audio_session_t *session, const char *source, size_t len)
+{
+    size_t most = len + 8;                            // "<source>#<n>" with a terminator for snprintf()
+    for (int i = 1; i <= AUDIO_SESSION_CHUNKS_PER_REQUEST; i++)
+    {
+        char *chunk = reserve_audio_record(&session->chunks, most);
+        if (chunk == NULL)
+        {
+            break;                                    // Ring full: the rest of the request is dropped
+        }
+        int written = snprintf(chunk, most, "%.*s#%d", (int)len, source, i);
+        commit_audio_record(&session->chunks, (size_t)written);
+    }
+}
+
+/**
+ * @brief Drops every queued chunk of a session.
+ */
+void audio_session_flush_chunks(audio_session_t *session)
+{
+    reset_audio_buffer(&session->chunks);
+}
@@ -0,0 +1,224 @@
+/**
+ * @file src/audio_sink.c
+ * @brief Playback Sink Implementation
+ */
+
+#include <signal.h>
+#include <string.h>
+#include "audio_sink.h"
+#include "audio_logger.h"
+
+#define SINK_WAV_HEADER_BYTES 44
+#define SINK_SILENCE_BYTES 4096                       // Zeros written per fwrite while filling an underrun
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static size_t frame_bytes(const audio_sink_t *sink)
+{
+    return audio_pcm_sample_bytes(sink->config.format) * sink->config.channels;
+}
+
+/**
+ * @brief Writes the canonical 44-byte WAV header for the frames written so far.
+ */
+static bool write_wav_header(audio_sink_t *sink)
+{
+    uint8_t header[SINK_WAV_HEADER_BYTES];
+    uint32_t block_align = (uint32_t)frame_bytes(sink);
+    uint64_t data_len = sink->frames_written * block_align;
+    if (data_len > UINT32_MAX - 36)
+    {
+        data_len = UINT32_MAX - 36;                   // RIFF sizes are 32-bit; players read the rest anyway
+    }
+
+    memcpy(header, "RIFF", 4);
+    put_u32(header + 4, (uint32_t)(36 + data_len));
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put_u32(header + 16, 16);
+    put_u16(header + 20, (sink->config.format == AUDIO_SAMPLE_F32) ? 3 : 1);   // IEEE float or PCM
+    put_u16(header + 22, (uint16_t)sink->config.channels);
+    put_u32(header + 24, sink->config.sample_rate);
+    put_u32(header + 28, sink->config.sample_rate * block_align);
+    put_u16(header + 32, (uint16_t)block_align);
+    put_u16(header + 34, (uint16_t)(audio_pcm_sample_bytes(sink->config.format) * 8));
+    memcpy(header + 36, "data", 4);
+    put_u32(header + 40, (uint32_t)data_len);
+    return fwrite(header, 1, sizeof(header), sink->out) == sizeof(header);
+}
+
+/**
+ * @brief Opens a sink.
+ *
+ * @param sink Receives the sink.
+ * @param spec "log", "null", "raw:<path>", "wav:<path>" or "pipe:<command>"; NULL means "log".
+ * @param config Format of the chunks that will be written.
+ * @return true if the sink is ready.
+ */
+bool audio_sink_open(audio_sink_t *sink, const char *spec, const audio_pcm_config_t *config)
+{
+    memset(sink, 0, sizeof(*sink));
+    sink->config = *config;
+    if (spec == NULL || strcmp(spec, "log") == 0)
+    {
+        sink->kind = AUDIO_SINK_LOG;
+        return true;
+    }
+    if (strcmp(spec, "null") == 0)
+    {
+        sink->kind = AUDIO_SINK_NULL;
+        return true;
+    }
+
+    if (strncmp(spec, "raw:", 4) == 0)
+    {
+        sink->kind = AUDIO_SINK_RAW;
+        sink->out = fopen(spec + 4, "wb");
+    }
+    else if (strncmp(spec, "wav:", 4) == 0)
+    {
+        sink->kind = AUDIO_SINK_WAV;
+        sink->out = fopen(spec + 4, "wb");
+        if (sink->out != NULL && !write_wav_header(sink))
+        {
+            fclose(sink->out);
+            sink->out = NULL;
+        }
+    }
+    else if (strncmp(spec, "pipe:", 5) == 0)
+    {
+        sink->kind = AUDIO_SINK_PIPE;
+        signal(SIGPIPE, SIG_IGN);                     // A reader that exits turns into a write error, not a kill
+        sink->out = popen(spec + 5, "w");
+    }
+    else
+    {
+        LOG_ERROR("Unknown audio sink: %s", spec);
+        return false;
+    }
+
+    if (sink->out == NULL)
+    {
+        LOG_ERROR("Cannot open audio sink: %s", spec);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Marks the sink failed after a short write.
+ */
+static void sink_failed(audio_sink_t *sink)
+{
+    if (!sink->failed)
+    {
+        LOG_ERROR("Audio sink %s write failed; discarding samples", audio_sink_kind_name(sink->kind));
+        sink->failed = true;
+    }
+}
+
+/**
+ * @brief Plays one chunk.
+ *
+ * @param sink The sink.
+ * @param chunk The chunk, already scaled by the gain stage.
+ * @param gain Gain that was applied (printed by the log sink).
+ */
+void audio_sink_write(audio_sink_t *sink, const audio_pcm_chunk_t *chunk, float gain)
+{
+    sink->frames_written += chunk->frames;
+    if (sink->kind == AUDIO_SINK_LOG)
+    {
+        printf("[AUDIO] Playing chunk: AUDIO_CHUNK_%u (%u frames, %s, %u ch, gain %.2f)\n",
+               chunk->sequence, chunk->frames, audio_pcm_format_name(sink->config.format), sink->config.channels, gain);
+        return;
+    }
+    if (sink->out == NULL || sink->failed)
+    {
+        return;
+    }
+
+    size_t bytes = (size_t)chunk->frames * frame_bytes(sink);
+    if (fwrite(audio_pcm_samples(chunk), 1, bytes, sink->out) != bytes)
+    {
+        sink_failed(sink);
+    }
+}
+
+/**
+ * @brief Writes silence for frames that had no chunk at their deadline.
+ */
+void audio_sink_write_silence(audio_sink_t *sink, uint32_t frames)
+{
+    static const uint8_t zeros[SINK_SILENCE_BYTES];
+
+    sink->frames_written += frames;
+    if (sink->out == NULL || sink->failed)
+    {
+        return;
+    }
+    size_t bytes = (size_t)frames * frame_bytes(sink);
+    while (bytes > 0)
+    {
+        size_t n = (bytes < sizeof(zeros)) ? bytes : sizeof(zeros);
+        if (fwrite(zeros, 1, n, sink->out) != n)
+        {
+            sink_failed(sink);
+            return;
+        }
+        bytes -= n;
+    }
+}
+
+/**
+ * @brief Flushes and closes the sink.
+ *
+ * A WAV sink rewrites its header with the final data size.
+ */
+void audio_sink_close(audio_sink_t *sink)
+{
+    if (sink->out != NULL)
+    {
+        if (sink->kind == AUDIO_SINK_WAV && !sink->failed)
+        {
+            fflush(sink->out);
+            if (fseek(sink->out, 0, SEEK_SET) != 0 || !write_wav_header(sink))
+            {
+                LOG_ERROR("Cannot complete the WAV header");
+            }
+        }
+        if (sink->kind == AUDIO_SINK_PIPE)
+        {
+            pclose(sink->out);
+        }
+        else
+        {
+            fclose(sink->out);
+        }
+    }
+    memset(sink, 0, sizeof(*sink));
+}
+
+/**
+ * @brief Returns a printable sink kind.
+ */
+const char *audio_sink_kind_name(audio_sink_kind_t kind)
+{
+    switch (kind)
+    {
+        case AUDIO_SINK_NULL: return "null";
+        case AUDIO_SINK_RAW:  return "raw";
+        case AUDIO_SINK_WAV:  return "wav";
+        case AUDIO_SINK_PIPE: return "pipe";
+        default:              return "log";
+    }
+}
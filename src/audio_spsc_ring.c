@@ -0,0 +1,241 @@
+/**
+ * @file src/audio_spsc_ring.c
+ * @brief Lock-free Single-Producer/Single-Consumer Audio Ring Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_spsc_ring.h"
+#include "audio_buffer.h"
+
+/**
+ * @brief Initializes the ring.
+ *
+ * @param ring Pointer to the ring to initialize.
+ * @param capacity Requested number of slots; rounded up to a power of two.
+ * @param slot_size Maximum payload bytes per slot.
+ * @return true on success, false if the storage could not be allocated.
+ */
+bool audio_spsc_ring_init(audio_spsc_ring_t *ring, size_t capacity, size_t slot_size)
+{
+    size_t slots = 2;
+    while (slots < capacity)
+    {
+        slots <<= 1;
+    }
+
+    size_t bytes = slots * slot_size;
+    bytes = (bytes + AUDIO_CACHE_LINE - 1) & ~(size_t)(AUDIO_CACHE_LINE - 1);        // aligned_alloc needs a multiple of the alignment
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->cached_tail = 0;
+    ring->cached_head = 0;
+    ring->capacity = slots;
+    ring->mask = slots - 1;
+    ring->slot_size = slot_size;
+    ring->lengths = calloc(slots, sizeof(uint32_t));
+    ring->slots = aligned_alloc(AUDIO_CACHE_LINE, bytes);
+    if (ring->lengths == NULL || ring->slots == NULL)
+    {
+        audio_spsc_ring_free(ring);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Releases the ring storage.
+ *
+ * @param ring Pointer to the ring.
+ */
+void audio_spsc_ring_free(audio_spsc_ring_t *ring)
+{
+    free(ring->lengths);
+    free(ring->slots);
+    ring->lengths = NULL;
+    ring->slots = NULL;
+    ring->capacity = 0;
+}
+
+/**
+ * @brief Returns the next free slot for the producer to fill in place.
+ *
+ * The slot stays invisible to the consumer until audio_spsc_ring_commit_write().
+ *
+ * @param ring Pointer to the ring.
+ * @return Pointer to slot_size writable bytes, or NULL if the ring is full.
+ */
+void *audio_spsc_ring_acquire_write(audio_spsc_ring_t *ring)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (tail - ring->cached_head == ring->capacity)
+    {
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail - ring->cached_head == ring->capacity)
+        {
+            return NULL;
+        }
+    }
+    return ring->slots + (tail & ring->mask) * ring->slot_size;
+}
+
+/**
+ * @brief Publishes the slot returned by audio_spsc_ring_acquire_write().
+ *
+ * @param ring Pointer to the ring.
+ * @param len Number of payload bytes written (at most slot_size).
+ */
+void audio_spsc_ring_commit_write(audio_spsc_ring_t *ring, size_t len)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    ring->lengths[tail & ring->mask] = (uint32_t)len;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);             // Publish the slot to the consumer
+}
+
+/**
+ * @brief Returns the oldest queued slot for the consumer to read in place.
+ *
+ * The slot stays owned by the consumer until audio_spsc_ring_release_read().
+ *
+ * @param ring Pointer to the ring.
+ * @param len Receives the payload length; may be NULL.
+ * @return Pointer to the payload, or NULL if the ring is empty.
+ */
+const void *audio_spsc_ring_acquire_read(audio_spsc_ring_t *ring, size_t *len)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head == ring->cached_tail)
+    {
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head == ring->cached_tail)
+        {
+            return NULL;
+        }
+    }
+
+    size_t index = head & ring->mask;
+    if (len != NULL)
+    {
+        *len = ring->lengths[index];
+    }
+    return ring->slots + index * ring->slot_size;
+}
+
+/**
+ * @brief Hands the slot returned by audio_spsc_ring_acquire_read() back.
+ *
+ * @param ring Pointer to the ring.
+ */
+void audio_spsc_ring_release_read(audio_spsc_ring_t *ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);             // Hand the slot back to the producer
+}
+
+/**
+ * @brief Copies one chunk into the ring (producer side).
+ *
+ * Payloads longer than the slot size are truncated.
+ *
+ * @param ring Pointer to the ring.
+ * @param data The chunk to add.
+ * @param len Length of the chunk in bytes.
+ * @return true if the chunk was added, false if the ring is full.
+ */
+bool audio_spsc_ring_push(audio_spsc_ring_t *ring, const void *data, size_t len)
+{
+    void *slot = audio_spsc_ring_acquire_write(ring);
+    if (slot == NULL)
+    {
+        return false;
+    }
+    if (len > ring->slot_size)
+    {
+        len = ring->slot_size;
+    }
+    memcpy(slot, data, len);
+    audio_spsc_ring_commit_write(ring, len);
+    return true;
+}
+
+/**
+ * @brief Copies one chunk out of the ring (consumer side).
+ *
+ * @param ring Pointer to the ring.
+ * @param out Destination of at least slot_size bytes.
+ * @param len Receives the chunk length; may be NULL.
+ * @return true if a chunk was removed, false if the ring is empty.
+ */
+bool audio_spsc_ring_pop(audio_spsc_ring_t *ring, void *out, size_t *len)
+{
+    size_t chunk_len;
+    const void *slot = audio_spsc_ring_acquire_read(ring, &chunk_len);
+    if (slot == NULL)
+    {
+        return false;
+    }
+    memcpy(out, slot, chunk_len);
+    if (len != NULL)
+    {
+        *len = chunk_len;
+    }
+    audio_spsc_ring_release_read(ring);
+    return true;
+}
+
+/**
+ * @brief Drops every queued chunk (consumer side).
+ *
+ * @param ring Pointer to the ring.
+ * @return Number of chunks dropped.
+ */
+size_t audio_spsc_ring_discard(audio_spsc_ring_t *ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    ring->cached_tail = tail;
+    atomic_store_explicit(&ring->head, tail, memory_order_release);
+    return tail - head;
+}
+
+/**
+ * @brief Returns the number of queued chunks.
+ *
+ * Exact only when called from the producer or consumer thread while the other
+ * side is idle; otherwise a snapshot that may be stale by the time it is used.
+ *
+ * @param ring Pointer to the ring.
+ */
+size_t audio_spsc_ring_count(const audio_spsc_ring_t *ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return tail - head;
+}
+
+/**
+ * @brief Captures the fill state of the ring for reporting.
+ *
+ * @param ring Pointer to the ring.
+ * @return Occupied slots and the front and rear slot indices.
+ */
+audio_ring_view_t audio_spsc_ring_view(const audio_spsc_ring_t *ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    audio_ring_view_t view = { (int)(tail - head), (int)ring->capacity, (int)(head & ring->mask), (int)(tail & ring->mask) };
+    return view;
+}
+
+/**
+ * @brief Prints the fill state of the ring with the buffer view.
+ *
+ * @param ring Pointer to the ring.
+ */
+void print_audio_spsc_ring_state(const audio_spsc_ring_t *ring)
+{
+    audio_ring_view_t view = audio_spsc_ring_view(ring);
+    print_audio_ring_report("Audio Ring", view.count, view.capacity, view.head, view.tail);
+}
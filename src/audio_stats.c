@@ -0,0 +1,211 @@
+/**
+ * @file src/audio_stats.c
+ * @brief Per-Command Latency Statistics Implementation
+ *
+ * Samples are kept in latency clock ticks. The tick rate is derived when
+ * reporting, from the ticks and CLOCK_MONOTONIC nanoseconds elapsed since the
+ * first stats entry was created, so no calibration loop runs at startup.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "audio_stats.h"
+#include "audio_logger.h"
+
+/**
+ * @brief Returns the largest tick count that maps to a bucket.
+ */
+static uint64_t bucket_upper(uint32_t index)
+{
+    if (index < 2 * AUDIO_STATS_SUB_COUNT)
+    {
+        return index;
+    }
+    uint32_t shift = index / AUDIO_STATS_SUB_COUNT - 1;
+    uint64_t lower = (uint64_t)(AUDIO_STATS_SUB_COUNT + index % AUDIO_STATS_SUB_COUNT) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+/**
+ * @brief Returns the value below which a fraction of the samples fall.
+ *
+ * @param buckets A histogram filled through audio_stats_bucket().
+ * @param count Samples in the histogram.
+ * @param max Largest sample (caps the bucket's upper bound).
+ * @param fraction Fraction of the samples, e.g. 0.99.
+ */
+uint64_t audio_stats_percentile(const uint32_t *buckets, uint64_t count, uint64_t max, double fraction)
+{
+    uint64_t target = (uint64_t)(fraction * (double)count + 0.999999);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < AUDIO_STATS_BUCKETS; i++)
+    {
+        seen += buckets[i];
+        if (seen >= target && seen > 0)
+        {
+            uint64_t upper = bucket_upper(i);
+            return (upper < max) ? upper : max;
+        }
+    }
+    return max;
+}
+
+#ifdef AUDIO_COMMAND_STATS
+
+static audio_command_stats_t *stats_list = NULL;      // Every stats entry, newest first
+static _Atomic uint64_t unknown_commands;             // Dispatches that matched no command
+static uint64_t epoch_ticks = 0;                      // Latency clock when the first entry was created
+static uint64_t epoch_ns = 0;                         // CLOCK_MONOTONIC at the same moment
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Returns nanoseconds per latency clock tick.
+ */
+static double ns_per_tick(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t ticks = audio_stats_now() - epoch_ticks;
+    uint64_t ns = monotonic_ns() - epoch_ns;
+    return (ticks > 0) ? (double)ns / (double)ticks : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+/**
+ * @brief Copies one command's histogram while recorders may be running.
+ *
+ * @return Samples in the copy (the sum of its buckets).
+ */
+static uint64_t snapshot_buckets(const audio_command_stats_t *stats, uint32_t *buckets)
+{
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < AUDIO_STATS_BUCKETS; i++)
+    {
+        buckets[i] = atomic_load_explicit(&stats->buckets[i], memory_order_relaxed);
+        count += buckets[i];
+    }
+    return count;
+}
+
+/**
+ * @brief Allocates the statistics of a command.
+ *
+ * @param command_name Name of the command (not copied).
+ * @return The zeroed stats entry, or NULL on allocation failure.
+ */
+audio_command_stats_t *audio_stats_create(const char *command_name)
+{
+    audio_command_stats_t *stats = calloc(1, sizeof(audio_command_stats_t));
+    if (stats == NULL)
+    {
+        LOG_ERROR("Memory allocation failed for command statistics");
+        return NULL;
+    }
+    if (stats_list == NULL && epoch_ticks == 0)
+    {
+        epoch_ticks = audio_stats_now();
+        epoch_ns = monotonic_ns();
+    }
+    stats->command_name = command_name;
+    stats->next = stats_list;
+    stats_list = stats;
+    return stats;
+}
+
+/**
+ * @brief Counts one dispatch that matched no command.
+ */
+void audio_stats_count_unknown(void)
+{
+    atomic_fetch_add_explicit(&unknown_commands, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Clears every histogram and counter.
+ *
+ * Safe while other threads record: each field is cleared with an atomic
+ * store, and a sample recorded during the reset lands either before or after
+ * its field was cleared.
+ */
+void audio_stats_reset(void)
+{
+    for (audio_command_stats_t *s = stats_list; s != NULL; s = s->next)
+    {
+        atomic_store_explicit(&s->hits, 0, memory_order_relaxed);
+        atomic_store_explicit(&s->max_ticks, 0, memory_order_relaxed);
+        for (uint32_t i = 0; i < AUDIO_STATS_BUCKETS; i++)
+        {
+            atomic_store_explicit(&s->buckets[i], 0, memory_order_relaxed);
+        }
+    }
+    atomic_store_explicit(&unknown_commands, 0, memory_order_relaxed);
+}
+
+/**
+ * @brief Releases every stats entry.
+ */
+void audio_stats_free_all(void)
+{
+    audio_command_stats_t *s = stats_list;
+    while (s != NULL)
+    {
+        audio_command_stats_t *next = s->next;
+        free(s);
+        s = next;
+    }
+    stats_list = NULL;
+    atomic_store_explicit(&unknown_commands, 0, memory_order_relaxed);
+}
+
+/**
+ * @brief Prints hits and handler latency percentiles for every command.
+ */
+void print_command_stats(void)
+{
+    double scale = ns_per_tick();
+    uint32_t buckets[AUDIO_STATS_BUCKETS];
+
+    printf("\n%-12s %10s %10s %10s %10s %10s\n", "command", "hits", "p50 ns", "p99 ns", "p999 ns", "max ns");
+    for (audio_command_stats_t *s = stats_list; s != NULL; s = s->next)
+    {
+        uint64_t hits = snapshot_buckets(s, buckets);
+        uint64_t max = atomic_load_explicit(&s->max_ticks, memory_order_relaxed);
+        if (hits == 0)
+        {
+            printf("%-12s %10d %10s %10s %10s %10s\n", s->command_name, 0, "-", "-", "-", "-");
+            continue;
+        }
+        printf("%-12s %10llu %10.0f %10.0f %10.0f %10.0f\n", s->command_name, (unsigned long long)hits,
+               (double)audio_stats_percentile(buckets, hits, max, 0.50) * scale,
+               (double)audio_stats_percentile(buckets, hits, max, 0.99) * scale,
+               (double)audio_stats_percentile(buckets, hits, max, 0.999) * scale, (double)max * scale);
+    }
+    printf("Unknown commands: %llu\n\n",
+           (unsigned long long)atomic_load_explicit(&unknown_commands, memory_order_relaxed));
+}
+
+#else // !AUDIO_COMMAND_STATS
+
+audio_command_stats_t *audio_stats_create(const char *command_name)
+{
+    (void)command_name;
+    return NULL;
+}
+
+void audio_stats_count_unknown(void) {}
+void audio_stats_reset(void) {}
+void audio_stats_free_all(void) {}
+
+void print_command_stats(void)
+{
+    LOG_WARNING("Command statistics are compiled out (build with COMMAND_STATS=1)");
+}
+
+#endif // AUDIO_COMMAND_STATS
@@ -1,41 +1,186 @@
 /**
  * @brief System State Management
  * This file contains the implementation of the audio system state functions.
+ *
+ * Packed word layout: bits 0-7 flags, bits 8-15 volume, bits 16-31 change
+ * counter. Transitions load the word, compute the next one and publish it
+ * with compare-and-swap, retrying if another writer got there first.
  */
 
+#include <stdatomic.h>
 #include <stdio.h>
 #include "audio_systemState.h"
 #include "audio_logger.h"
 
-// Static instance of audioState to hold the current state
-static audioState system_state = {
-    .flags = {0},
-    .volume = 50  // Start at mid-level volume
-};
+#define STATE_FLAGS_MASK 0xFFu
+#define STATE_VOLUME_SHIFT 8
+#define STATE_GENERATION_SHIFT 16
 
-// Function to get the current audio system state
-audioState* get_audio_state(void) {
-    return &system_state;
+#define STATE_PACK(flags, volume, generation) \
+    (((uint32_t)(flags) & STATE_FLAGS_MASK) | ((uint32_t)(volume) << STATE_VOLUME_SHIFT) | ((uint32_t)(generation) << STATE_GENERATION_SHIFT))
+
+// Process-wide state (flags clear, mid-level volume)
+static audio_state_cell_t system_state = { STATE_PACK(0, AUDIO_VOLUME_DEFAULT, 0) };
+static __thread audio_state_cell_t *bound_state = NULL;  // Cell of the session this thread is running
+
+static inline _Atomic uint32_t *current_word(void)
+{
+    return (bound_state != NULL) ? &bound_state->word : &system_state.word;
+}
+
+static audioState unpack_state(uint32_t word)
+{
+    audioState state;
+    state.flags.is_playing = (word & AUDIO_FLAG_PLAYING) != 0;
+    state.flags.is_muted = (word & AUDIO_FLAG_MUTED) != 0;
+    state.flags.reserved = 0;
+    state.volume = (int)((word >> STATE_VOLUME_SHIFT) & 0xFFu);
+    state.generation = (uint16_t)(word >> STATE_GENERATION_SHIFT);
+    return state;
+}
+
+// Returns the word that follows 'word' with new flags and volume
+static uint32_t next_state(uint32_t word, uint32_t flags, int volume)
+{
+    uint32_t generation = (word >> STATE_GENERATION_SHIFT) + 1;
+    return STATE_PACK(flags, volume, generation & 0xFFFFu);
+}
+
+// Function to start a cell at the default state
+void audio_state_cell_init(audio_state_cell_t *cell)
+{
+    atomic_init(&cell->word, STATE_PACK(0, AUDIO_VOLUME_DEFAULT, 0));
+}
+
+// Function to bind the calling thread to a state cell
+audio_state_cell_t *audio_state_bind(audio_state_cell_t *cell)
+{
+    audio_state_cell_t *previous = bound_state;
+    bound_state = cell;
+    return previous;
+}
+
+// Function to take a consistent copy of the current state
+audioState snapshot_audio_state(void)
+{
+    return unpack_state(atomic_load_explicit(current_word(), memory_order_acquire));
+}
+
+// Function to read the packed word, e.g. to save it
+uint32_t audio_state_word(void)
+{
+    return atomic_load_explicit(current_word(), memory_order_acquire);
+}
+
+// Function to publish a saved packed word as the current state
+void audio_state_restore(uint32_t word)
+{
+    atomic_store_explicit(current_word(), word, memory_order_release);
+}
+
+// Function to step the volume, clamped to 0-100
+audioState audio_state_step_volume(int delta)
+{
+    _Atomic uint32_t *state = current_word();
+    uint32_t word = atomic_load_explicit(state, memory_order_relaxed);
+    uint32_t next;
+    do
+    {
+        int volume = (int)((word >> STATE_VOLUME_SHIFT) & 0xFFu) + delta;
+        if (volume > AUDIO_VOLUME_MAX)
+        {
+            volume = AUDIO_VOLUME_MAX;                           // Cap volume at 100
+        }
+        else if (volume < AUDIO_VOLUME_MIN)
+        {
+            volume = AUDIO_VOLUME_MIN;                           // Cap volume at 0
+        }
+        next = next_state(word, word & STATE_FLAGS_MASK, volume);
+    } while (!atomic_compare_exchange_weak_explicit(state, &word, next,
+                                                    memory_order_acq_rel, memory_order_relaxed));
+    return unpack_state(next);
+}
+
+// Function to set the volume, clamped to 0-100
+audioState audio_state_set_volume(int volume)
+{
+    if (volume > AUDIO_VOLUME_MAX)
+    {
+        volume = AUDIO_VOLUME_MAX;
+    }
+    else if (volume < AUDIO_VOLUME_MIN)
+    {
+        volume = AUDIO_VOLUME_MIN;
+    }
+    _Atomic uint32_t *state = current_word();
+    uint32_t word = atomic_load_explicit(state, memory_order_relaxed);
+    uint32_t next;
+    do
+    {
+        next = next_state(word, word & STATE_FLAGS_MASK, volume);
+    } while (!atomic_compare_exchange_weak_explicit(state, &word, next,
+                                                    memory_order_acq_rel, memory_order_relaxed));
+    return unpack_state(next);
+}
+
+// Function to set and clear flag bits in one transition
+audioState audio_state_set_flags(unsigned set, unsigned clear)
+{
+    _Atomic uint32_t *state = current_word();
+    uint32_t word = atomic_load_explicit(state, memory_order_relaxed);
+    uint32_t next;
+    do
+    {
+        uint32_t flags = ((word & STATE_FLAGS_MASK) | set) & ~clear;
+        next = next_state(word, flags, (int)((word >> STATE_VOLUME_SHIFT) & 0xFFu));
+    } while (!atomic_compare_exchange_weak_explicit(state, &word, next,
+                                                    memory_order_acq_rel, memory_order_relaxed));
+    return unpack_state(next);
+}
+
+// Function to start playing unless muted (checked and set in one transition)
+bool audio_state_start_playing(void)
+{
+    _Atomic uint32_t *state = current_word();
+    uint32_t word = atomic_load_explicit(state, memory_order_relaxed);
+    uint32_t next;
+    do
+    {
+        if (word & AUDIO_FLAG_MUTED)
+        {
+            return false;
+        }
+        next = next_state(word, (word & STATE_FLAGS_MASK) | AUDIO_FLAG_PLAYING, (int)((word >> STATE_VOLUME_SHIFT) & 0xFFu));
+    } while (!atomic_compare_exchange_weak_explicit(state, &word, next,
+                                                    memory_order_acq_rel, memory_order_relaxed));
+    return true;
 }
 
 // Function to reset the audio system state
-void reset_audio_system(void) 
+void reset_audio_system(void)
 {
-    system_state.flags.is_playing = 0;
-    system_state.flags.is_muted = 0;
-    system_state.volume = 50;
-    LOG_INFO("System reset: volume = %d | playing = %d | muted = %d", 
-             system_state.volume, 
-             system_state.flags.is_playing,
-             system_state.flags.is_muted);
+    _Atomic uint32_t *state = current_word();
+    uint32_t word = atomic_load_explicit(state, memory_order_relaxed);
+    uint32_t next;
+    do
+    {
+        next = next_state(word, 0, AUDIO_VOLUME_DEFAULT);
+    } while (!atomic_compare_exchange_weak_explicit(state, &word, next,
+                                                    memory_order_acq_rel, memory_order_relaxed));
+
+    audioState published = unpack_state(next);
+    LOG_INFO("System reset: volume = %d | playing = %d | muted = %d",
+             published.volume,
+             published.flags.is_playing,
+             published.flags.is_muted);
 }
 
 // Function to print the current audio system status
-void print_audio_state(void) 
+void print_audio_state(void)
 {
+    audioState state = snapshot_audio_state();
     LOG_INFO("System Status: Volume: %d | Playing: %s | Muted: %s",
-             system_state.volume,
-             system_state.flags.is_playing ? "Yes" : "No",
-             system_state.flags.is_muted ? "Yes" : "No");
+             state.volume,
+             state.flags.is_playing ? "Yes" : "No",
+             state.flags.is_muted ? "Yes" : "No");
 }
-
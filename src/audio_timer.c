@@ -0,0 +1,537 @@
+/**
+ * @file src/audio_timer.c
+ * @brief Hierarchical Timer Wheel Implementation
+ *
+ * Lists are numbered level * AUDIO_TIMER_SLOTS + slot for the wheel slots,
+ * then the overflow list and the expired list. The process-wide wheel is
+ * only locked to schedule, cancel, advance and pop: a due command is copied
+ * out and dispatched after the lock is released, so it may itself schedule
+ * or cancel timers.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "audio_timer.h"
+
+#define TIMER_NIL UINT32_MAX                          // No entry
+#define TIMER_OVERFLOW_LIST (AUDIO_TIMER_LEVELS * AUDIO_TIMER_SLOTS)   // Beyond the top level
+#define TIMER_EXPIRED_LIST (TIMER_OVERFLOW_LIST + 1)                  // Due, waiting to be popped
+#define TIMER_LIST_COUNT (TIMER_EXPIRED_LIST + 1)
+#define TIMER_FREE_LIST UINT16_MAX                    // Marks entries in the free list
+#define TIMER_LEVEL_SHIFT(level) ((level) * AUDIO_TIMER_SLOT_BITS)
+#define TIMER_ID(generation, index) (((uint64_t)((generation) - 1) << 32) | ((uint64_t)(index) + 1))   // First use: 1, 2, ...
+#define TIMER_SPAN_BITS (AUDIO_TIMER_LEVELS * AUDIO_TIMER_SLOT_BITS)  // Ticks covered by the levels: 2^24
+
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static audio_timer_wheel_t timer_wheel;               // Process-wide wheel (guarded by timer_lock)
+static bool timer_ready = false;
+
+// ====================================================================================
+// Lists and the entry pool
+
+static void list_append(audio_timer_wheel_t *wheel, uint32_t list, uint32_t index)
+{
+    audio_timer_entry_t *e = &wheel->entries[index];
+    e->list = (uint16_t)list;
+    e->next = TIMER_NIL;
+    e->prev = wheel->tails[list];
+    if (e->prev == TIMER_NIL)
+    {
+        wheel->heads[list] = index;
+    }
+    else
+    {
+        wheel->entries[e->prev].next = index;
+    }
+    wheel->tails[list] = index;
+    if (list < TIMER_OVERFLOW_LIST)
+    {
+        wheel->occupied[list / AUDIO_TIMER_SLOTS] |= 1ULL << (list % AUDIO_TIMER_SLOTS);
+    }
+}
+
+static void list_unlink(audio_timer_wheel_t *wheel, uint32_t index)
+{
+    audio_timer_entry_t *e = &wheel->entries[index];
+    uint32_t list = e->list;
+    if (e->prev == TIMER_NIL)
+    {
+        wheel->heads[list] = e->next;
+    }
+    else
+    {
+        wheel->entries[e->prev].next = e->next;
+    }
+    if (e->next == TIMER_NIL)
+    {
+        wheel->tails[list] = e->prev;
+    }
+    else
+    {
+        wheel->entries[e->next].prev = e->prev;
+    }
+    if (list < TIMER_OVERFLOW_LIST && wheel->heads[list] == TIMER_NIL)
+    {
+        wheel->occupied[list / AUDIO_TIMER_SLOTS] &= ~(1ULL << (list % AUDIO_TIMER_SLOTS));
+    }
+}
+
+// Threads entries [from, to) onto the free list
+static void pool_release_range(audio_timer_wheel_t *wheel, uint32_t from, uint32_t to)
+{
+    for (uint32_t i = to; i-- > from;)
+    {
+        wheel->entries[i].list = TIMER_FREE_LIST;
+        wheel->entries[i].next = wheel->free_head;
+        wheel->free_head = i;
+    }
+}
+
+static uint32_t pool_take(audio_timer_wheel_t *wheel)
+{
+    if (wheel->free_head == TIMER_NIL)
+    {
+        if (wheel->capacity >= UINT32_MAX / 2)
+        {
+            return TIMER_NIL;
+        }
+        uint32_t capacity = wheel->capacity * 2;
+        audio_timer_entry_t *entries = realloc(wheel->entries, (size_t)capacity * sizeof(*entries));
+        if (entries == NULL)
+        {
+            return TIMER_NIL;
+        }
+        memset(entries + wheel->capacity, 0, (size_t)(capacity - wheel->capacity) * sizeof(*entries));
+        wheel->entries = entries;
+        pool_release_range(wheel, wheel->capacity, capacity);
+        wheel->capacity = capacity;
+    }
+    uint32_t index = wheel->free_head;
+    wheel->free_head = wheel->entries[index].next;
+    return index;
+}
+
+static void pool_give(audio_timer_wheel_t *wheel, uint32_t index)
+{
+    audio_timer_entry_t *e = &wheel->entries[index];
+    e->generation++;                                  // Outstanding ids of this entry go stale
+    e->generation += (e->generation == 0);
+    e->list = TIMER_FREE_LIST;
+    e->next = wheel->free_head;
+    wheel->free_head = index;
+}
+
+// ====================================================================================
+// Wheel
+
+/**
+ * @brief Files an entry by its expiry relative to the current tick.
+ *
+ * The level is the highest 6-bit digit in which the expiry differs from the
+ * current tick; the slot is the expiry's digit at that level.
+ */
+static void wheel_place(audio_timer_wheel_t *wheel, uint32_t index)
+{
+    uint64_t expiry = wheel->entries[index].expiry;
+    uint64_t diff = expiry ^ wheel->now;
+    if (expiry <= wheel->now)
+    {
+        list_append(wheel, TIMER_EXPIRED_LIST, index);
+        return;
+    }
+    unsigned level = (unsigned)(63 - __builtin_clzll(diff)) / AUDIO_TIMER_SLOT_BITS;
+    if (level >= AUDIO_TIMER_LEVELS)
+    {
+        list_append(wheel, TIMER_OVERFLOW_LIST, index);
+        return;
+    }
+    uint32_t slot = (uint32_t)(expiry >> TIMER_LEVEL_SHIFT(level)) & (AUDIO_TIMER_SLOTS - 1);
+    list_append(wheel, level * AUDIO_TIMER_SLOTS + slot, index);
+}
+
+// Re-files every entry of a list against the current tick (detached first: overflow entries may go back to it)
+static void wheel_cascade(audio_timer_wheel_t *wheel, uint32_t list)
+{
+    uint32_t index = wheel->heads[list];
+    wheel->heads[list] = TIMER_NIL;
+    wheel->tails[list] = TIMER_NIL;
+    if (list < TIMER_OVERFLOW_LIST)
+    {
+        wheel->occupied[list / AUDIO_TIMER_SLOTS] &= ~(1ULL << (list % AUDIO_TIMER_SLOTS));
+    }
+    while (index != TIMER_NIL)
+    {
+        uint32_t next = wheel->entries[index].next;
+        wheel_place(wheel, index);
+        index = next;
+    }
+}
+
+/**
+ * @brief Next tick after the current one at which a slot fires or cascades.
+ *
+ * Every occupied slot of a level lies after the current tick's digit at that
+ * level (entries at the current digit were cascaded when it was reached), so
+ * the first set bit of each bitmap is that level's next event.
+ */
+static uint64_t wheel_next_event(const audio_timer_wheel_t *wheel)
+{
+    uint64_t best = UINT64_MAX;
+    for (unsigned level = 0; level < AUDIO_TIMER_LEVELS; level++)
+    {
+        if (wheel->occupied[level] != 0)
+        {
+            unsigned shift = TIMER_LEVEL_SHIFT(level);
+            uint64_t base = wheel->now >> (shift + AUDIO_TIMER_SLOT_BITS) << (shift + AUDIO_TIMER_SLOT_BITS);
+            uint64_t tick = base + ((uint64_t)__builtin_ctzll(wheel->occupied[level]) << shift);
+            best = (tick < best) ? tick : best;
+        }
+    }
+    if (wheel->heads[TIMER_OVERFLOW_LIST] != TIMER_NIL)
+    {
+        uint64_t tick = ((wheel->now >> TIMER_SPAN_BITS) + 1) << TIMER_SPAN_BITS;
+        best = (tick < best) ? tick : best;
+    }
+    return best;
+}
+
+// Makes tick the current tick: cascades the slots starting there, then expires level 0
+static void wheel_process_tick(audio_timer_wheel_t *wheel, uint64_t tick)
+{
+    wheel->now = tick;
+    if ((tick & ((1ULL << TIMER_SPAN_BITS) - 1)) == 0)
+    {
+        wheel_cascade(wheel, TIMER_OVERFLOW_LIST);
+    }
+    for (unsigned level = AUDIO_TIMER_LEVELS - 1; level > 0; level--)
+    {
+        unsigned shift = TIMER_LEVEL_SHIFT(level);
+        if ((tick & ((1ULL << shift) - 1)) == 0)
+        {
+            uint32_t slot = (uint32_t)(tick >> shift) & (AUDIO_TIMER_SLOTS - 1);
+            wheel_cascade(wheel, level * AUDIO_TIMER_SLOTS + slot);
+        }
+    }
+    wheel_cascade(wheel, (uint32_t)tick & (AUDIO_TIMER_SLOTS - 1));   // Level 0 entries expire now
+}
+
+/**
+ * @brief Creates an empty wheel.
+ *
+ * @param wheel The wheel to initialize.
+ * @param now_ns Time of tick 0 (any clock, as long as later calls use it too).
+ * @return true on success.
+ */
+bool audio_timer_wheel_init(audio_timer_wheel_t *wheel, uint64_t now_ns)
+{
+    memset(wheel, 0, sizeof(*wheel));
+    wheel->entries = calloc(AUDIO_TIMER_INITIAL_ENTRIES, sizeof(*wheel->entries));
+    wheel->heads = malloc(TIMER_LIST_COUNT * sizeof(uint32_t));
+    wheel->tails = malloc(TIMER_LIST_COUNT * sizeof(uint32_t));
+    if (wheel->entries == NULL || wheel->heads == NULL || wheel->tails == NULL)
+    {
+        audio_timer_wheel_free(wheel);
+        return false;
+    }
+    memset(wheel->heads, 0xFF, TIMER_LIST_COUNT * sizeof(uint32_t));
+    memset(wheel->tails, 0xFF, TIMER_LIST_COUNT * sizeof(uint32_t));
+    wheel->capacity = AUDIO_TIMER_INITIAL_ENTRIES;
+    wheel->free_head = TIMER_NIL;
+    pool_release_range(wheel, 0, wheel->capacity);
+    wheel->start_ns = now_ns;
+    return true;
+}
+
+/**
+ * @brief Releases the pool; pending timers are dropped.
+ */
+void audio_timer_wheel_free(audio_timer_wheel_t *wheel)
+{
+    free(wheel->entries);
+    free(wheel->heads);
+    free(wheel->tails);
+    memset(wheel, 0, sizeof(*wheel));
+}
+
+/**
+ * @brief Adds a timer.
+ *
+ * The expiry is rounded up to a whole tick and is at least one tick after
+ * the last tick processed, so a timer never fires early.
+ *
+ * @param wheel The wheel.
+ * @param now_ns Current time.
+ * @param delay_ns Delay from now_ns.
+ * @param text Command to hold (copied).
+ * @param len Length of the command, at most AUDIO_TIMER_TEXT_MAX.
+ * @return The timer id, or 0 if the command is too long or memory ran out.
+ */
+uint64_t audio_timer_wheel_schedule(audio_timer_wheel_t *wheel, uint64_t now_ns, uint64_t delay_ns,
+                                    const char *text, size_t len)
+{
+    if (len > AUDIO_TIMER_TEXT_MAX)
+    {
+        return 0;
+    }
+    uint32_t index = pool_take(wheel);
+    if (index == TIMER_NIL)
+    {
+        return 0;
+    }
+    audio_timer_entry_t *e = &wheel->entries[index];
+    uint64_t offset = (now_ns > wheel->start_ns) ? now_ns - wheel->start_ns : 0;
+    uint64_t due = (delay_ns > UINT64_MAX - offset - AUDIO_TIMER_TICK_NS) ? UINT64_MAX - AUDIO_TIMER_TICK_NS : offset + delay_ns;
+    e->expiry = (due + AUDIO_TIMER_TICK_NS - 1) / AUDIO_TIMER_TICK_NS;
+    e->expiry = (e->expiry > wheel->now) ? e->expiry : wheel->now + 1;
+    e->generation += (e->generation == 0);
+    e->len = (uint16_t)len;
+    memcpy(e->text, text, len);
+    wheel_place(wheel, index);
+    wheel->pending++;
+    return TIMER_ID(e->generation, index);
+}
+
+/**
+ * @brief Drops a timer that has not been popped yet.
+ *
+ * @return false if the id is unknown, already fired or already cancelled.
+ */
+bool audio_timer_wheel_cancel(audio_timer_wheel_t *wheel, uint64_t id)
+{
+    uint32_t index = (uint32_t)id - 1;
+    if (index >= wheel->capacity)
+    {
+        return false;
+    }
+    audio_timer_entry_t *e = &wheel->entries[index];
+    if (e->list == TIMER_FREE_LIST || e->generation != (uint32_t)(id >> 32) + 1)
+    {
+        return false;
+    }
+    list_unlink(wheel, index);
+    pool_give(wheel, index);
+    wheel->pending--;
+    return true;
+}
+
+/**
+ * @brief Moves every timer due by now_ns to the expired list.
+ *
+ * Jumps straight from one event tick to the next; ticks with nothing to
+ * fire or cascade are skipped.
+ */
+void audio_timer_wheel_advance(audio_timer_wheel_t *wheel, uint64_t now_ns)
+{
+    uint64_t target = (now_ns > wheel->start_ns) ? (now_ns - wheel->start_ns) / AUDIO_TIMER_TICK_NS : 0;
+    while (wheel->now < target)
+    {
+        uint64_t tick = wheel_next_event(wheel);
+        if (tick > target)
+        {
+            wheel->now = target;                      // Nothing due in between
+            break;
+        }
+        wheel_process_tick(wheel, tick);
+    }
+}
+
+/**
+ * @brief Takes the oldest expired timer.
+ *
+ * @param wheel The wheel.
+ * @param id Receives the timer id (may be NULL).
+ * @param text Receives the command (AUDIO_TIMER_TEXT_MAX bytes).
+ * @param len Receives the command length.
+ * @return false if no timer has expired.
+ */
+bool audio_timer_wheel_pop(audio_timer_wheel_t *wheel, uint64_t *id, char *text, size_t *len)
+{
+    uint32_t index = wheel->heads[TIMER_EXPIRED_LIST];
+    if (index == TIMER_NIL)
+    {
+        return false;
+    }
+    audio_timer_entry_t *e = &wheel->entries[index];
+    if (id != NULL)
+    {
+        *id = TIMER_ID(e->generation, index);
+    }
+    memcpy(text, e->text, e->len);
+    *len = e->len;
+    list_unlink(wheel, index);
+    pool_give(wheel, index);
+    wheel->pending--;
+    return true;
+}
+
+/**
+ * @brief Time at which the wheel next has work (a timer or a cascade).
+ *
+ * @return 0 if timers are waiting to be popped, UINT64_MAX if none pending.
+ */
+uint64_t audio_timer_wheel_next_ns(const audio_timer_wheel_t *wheel)
+{
+    if (wheel->heads[TIMER_EXPIRED_LIST] != TIMER_NIL)
+    {
+        return 0;
+    }
+    if (wheel->pending == 0)
+    {
+        return UINT64_MAX;
+    }
+    return wheel->start_ns + wheel_next_event(wheel) * AUDIO_TIMER_TICK_NS;
+}
+
+// ====================================================================================
+// Process-wide delayed commands
+
+static uint64_t timer_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Called with timer_lock held
+static bool timer_wheel_ready(void)
+{
+    if (!timer_ready)
+    {
+        timer_ready = audio_timer_wheel_init(&timer_wheel, timer_now_ns());
+    }
+    return timer_ready;
+}
+
+/**
+ * @brief Schedules a command line to be dispatched later.
+ *
+ * @param delay_ns Delay from now.
+ * @param text Command line (copied).
+ * @param len Length of the command line.
+ * @return The timer id (for audio_cancel_command()), or 0 on failure.
+ */
+uint64_t audio_delay_command(uint64_t delay_ns, const char *text, size_t len)
+{
+    uint64_t id = 0;
+    pthread_mutex_lock(&timer_lock);
+    if (timer_wheel_ready())
+    {
+        id = audio_timer_wheel_schedule(&timer_wheel, timer_now_ns(), delay_ns, text, len);
+    }
+    pthread_mutex_unlock(&timer_lock);
+    return id;
+}
+
+/**
+ * @brief Cancels a delayed command that has not run yet.
+ */
+bool audio_cancel_command(uint64_t id)
+{
+    pthread_mutex_lock(&timer_lock);
+    bool cancelled = timer_ready && audio_timer_wheel_cancel(&timer_wheel, id);
+    pthread_mutex_unlock(&timer_lock);
+    return cancelled;
+}
+
+/**
+ * @brief Dispatches every delayed command that is due, oldest first.
+ *
+ * @return Number of commands dispatched.
+ */
+size_t audio_run_due_commands(void)
+{
+    char text[AUDIO_TIMER_TEXT_MAX];
+    size_t ran = 0;
+    for (;;)
+    {
+        size_t len = 0;
+        uint64_t id = 0;
+        pthread_mutex_lock(&timer_lock);
+        bool due = false;
+        if (timer_ready && timer_wheel.pending > 0)
+        {
+            audio_timer_wheel_advance(&timer_wheel, timer_now_ns());
+            due = audio_timer_wheel_pop(&timer_wheel, &id, text, &len);
+        }
+        pthread_mutex_unlock(&timer_lock);
+        if (!due)
+        {
+            return ran;
+        }
+        LOG_INPUT("Timer %llu: \"%.*s\"", (unsigned long long)id, (int)len, text);
+        dispatch_command_slice(text, len);
+        ran++;
+    }
+}
+
+/**
+ * @brief How long a command loop may wait before the next delayed command.
+ *
+ * @return Milliseconds (rounded up), 0 if one is due, -1 if none is pending.
+ */
+int audio_next_command_timeout_ms(void)
+{
+    pthread_mutex_lock(&timer_lock);
+    uint64_t next = timer_ready ? audio_timer_wheel_next_ns(&timer_wheel) : UINT64_MAX;
+    pthread_mutex_unlock(&timer_lock);
+    if (next == UINT64_MAX)
+    {
+        return -1;
+    }
+    uint64_t now = timer_now_ns();
+    if (next <= now)
+    {
+        return 0;
+    }
+    uint64_t ms = (next - now + 999999ULL) / 1000000ULL;
+    return (ms > INT_MAX) ? INT_MAX : (int)ms;
+}
+
+/**
+ * @brief Number of delayed commands that have not run yet.
+ */
+size_t audio_pending_commands(void)
+{
+    pthread_mutex_lock(&timer_lock);
+    size_t pending = timer_ready ? timer_wheel.pending : 0;
+    pthread_mutex_unlock(&timer_lock);
+    return pending;
+}
+
+/**
+ * @brief Sleeps and runs delayed commands until none is pending.
+ *
+ * Commands scheduled by the delayed commands themselves are waited for too.
+ */
+void audio_drain_delayed_commands(void)
+{
+    int timeout;
+    while ((timeout = audio_next_command_timeout_ms()) >= 0)
+    {
+        struct timespec ts = { timeout / 1000, (long)(timeout % 1000) * 1000000L };
+        while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+        {
+        }
+        audio_run_due_commands();
+    }
+}
+
+/**
+ * @brief Drops every pending delayed command and releases the wheel.
+ */
+void audio_free_delayed_commands(void)
+{
+    pthread_mutex_lock(&timer_lock);
+    if (timer_ready)
+    {
+        audio_timer_wheel_free(&timer_wheel);
+        timer_ready = false;
+    }
+    pthread_mutex_unlock(&timer_lock);
+}
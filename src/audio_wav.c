@@ -0,0 +1,299 @@
+/**
+ * @file src/audio_wav.c
+ * @brief Memory-Mapped WAV Reader Implementation
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "audio_wav.h"
+#include "audio_logger.h"
+
+#define WAV_FORMAT_PCM 0x0001                         // WAVE_FORMAT_PCM
+#define WAV_FORMAT_FLOAT 0x0003                       // WAVE_FORMAT_IEEE_FLOAT
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE                  // Sub-format in the first two bytes of the GUID
+#define WAV_PAGE_SIZE 4096                            // Alignment of readahead hints
+
+static inline uint16_t read_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t read_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Parses a RIFF/WAVE image.
+ *
+ * @param wav Receives the stream description; map and map_len are set to the image.
+ * @param bytes The file contents.
+ * @param len Size of the file contents.
+ * @return true if the image holds a supported fmt chunk and a data chunk.
+ */
+bool audio_wav_parse(audio_wav_t *wav, const uint8_t *bytes, size_t len)
+{
+    memset(wav, 0, sizeof(*wav));
+    wav->map = bytes;
+    wav->map_len = len;
+    if (len < 12 || memcmp(bytes, "RIFF", 4) != 0 || memcmp(bytes + 8, "WAVE", 4) != 0)
+    {
+        return false;
+    }
+
+    bool have_fmt = false;
+    uint16_t format = 0;
+    uint16_t bits = 0;
+    size_t pos = 12;
+    while (pos + 8 <= len)
+    {
+        const uint8_t *chunk = bytes + pos;
+        size_t size = read_u32(chunk + 4);
+        size_t body = pos + 8;
+        size_t available = len - body;
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16 && size <= available)
+        {
+            format = read_u16(chunk + 8);
+            wav->channels = read_u16(chunk + 10);
+            wav->sample_rate = read_u32(chunk + 12);
+            wav->block_align = read_u16(chunk + 20);
+            bits = read_u16(chunk + 22);
+            if (format == WAV_FORMAT_EXTENSIBLE && size >= 40)
+            {
+                format = read_u16(chunk + 32);         // First two bytes of the sub-format GUID
+            }
+            have_fmt = true;
+        }
+        else if (memcmp(chunk, "data", 4) == 0 && have_fmt)
+        {
+            if (size > available)
+            {
+                size = available;                     // Truncated file: play what is there
+            }
+            if (format == WAV_FORMAT_PCM && bits == 16)
+            {
+                wav->encoding = AUDIO_WAV_PCM16;
+            }
+            else if (format == WAV_FORMAT_PCM && bits == 24)
+            {
+                wav->encoding = AUDIO_WAV_PCM24;
+            }
+            else if (format == WAV_FORMAT_FLOAT && bits == 32)
+            {
+                wav->encoding = AUDIO_WAV_F32;
+            }
+            else
+            {
+                return false;
+            }
+            if (wav->channels == 0 || wav->block_align != wav->channels * (bits / 8))
+            {
+                return false;
+            }
+            wav->data = chunk + 8;
+            wav->frames = size / wav->block_align;
+            return true;
+        }
+
+        pos = body + size + (size & 1);               // Chunks are padded to an even size
+    }
+    return false;
+}
+
+/**
+ * @brief Opens and maps a WAV file.
+ *
+ * The open never blocks: FIFOs and devices are rejected, so the call is
+ * bounded by one open, one fstat and one mmap.
+ *
+ * @param wav Receives the stream.
+ * @param path File to open.
+ * @return true if the file was mapped and parsed.
+ */
+bool audio_wav_open(audio_wav_t *wav, const char *path)
+{
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_WARNING("Cannot open audio file: %s", path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < 12)
+    {
+        LOG_WARNING("Not a playable file: %s", path);
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+    const uint8_t *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);                                        // The mapping keeps the file alive
+    if (map == MAP_FAILED)
+    {
+        LOG_WARNING("Cannot map audio file: %s", path);
+        return false;
+    }
+    madvise((void *)map, size, MADV_SEQUENTIAL);      // Aggressive readahead, early page reclaim
+
+    if (!audio_wav_parse(wav, map, size))
+    {
+        LOG_WARNING("Unsupported WAV format: %s", path);
+        munmap((void *)map, size);
+        memset(wav, 0, sizeof(*wav));
+        return false;
+    }
+    wav->mapped = true;
+    return true;
+}
+
+/**
+ * @brief Unmaps a file opened with audio_wav_open().
+ */
+void audio_wav_close(audio_wav_t *wav)
+{
+    if (wav->mapped)
+    {
+        munmap((void *)wav->map, wav->map_len);
+    }
+    memset(wav, 0, sizeof(*wav));
+}
+
+/**
+ * @brief Hints the kernel to read the next window before the decoder gets there.
+ */
+static void wav_readahead(audio_wav_t *wav, size_t offset)
+{
+    size_t data_offset = (size_t)(wav->data - wav->map);
+    size_t data_len = (size_t)wav->frames * wav->block_align;
+    if (!wav->mapped || offset + AUDIO_WAV_READAHEAD / 2 < wav->advised_end || wav->advised_end >= data_len)
+    {
+        return;                                       // Still well inside the advised window
+    }
+
+    size_t start = (data_offset + wav->advised_end) & ~(size_t)(WAV_PAGE_SIZE - 1);
+    size_t end = data_offset + offset + AUDIO_WAV_READAHEAD;
+    if (end > data_offset + data_len)
+    {
+        end = data_offset + data_len;
+    }
+    if (end > start)
+    {
+        madvise((void *)(wav->map + start), end - start, MADV_WILLNEED);
+    }
+    wav->advised_end = end - data_offset;
+}
+
+// Reads one sample as a float in [-1, 1)
+static inline float wav_sample_f32(const audio_wav_t *wav, const uint8_t *p)
+{
+    switch (wav->encoding)
+    {
+        case AUDIO_WAV_PCM16:
+            return (float)(int16_t)read_u16(p) * (1.0f / 32768.0f);
+        case AUDIO_WAV_PCM24:
+            return (float)((int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8) * (1.0f / 8388608.0f);
+        default:
+        {
+            float v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+    }
+}
+
+// Reads one sample as int16 (24-bit keeps its top 16 bits, float saturates)
+static inline int16_t wav_sample_s16(const audio_wav_t *wav, const uint8_t *p)
+{
+    switch (wav->encoding)
+    {
+        case AUDIO_WAV_PCM16:
+            return (int16_t)read_u16(p);
+        case AUDIO_WAV_PCM24:
+            return (int16_t)read_u16(p + 1);
+        default:
+        {
+            float v = wav_sample_f32(wav, p) * 32768.0f;
+            v = (v > 32767.0f) ? 32767.0f : (v < -32768.0f) ? -32768.0f : v;
+            return (int16_t)__builtin_lrintf(v);
+        }
+    }
+}
+
+/**
+ * @brief Decodes frames into a chunk.
+ *
+ * Output channel c takes input channel c modulo the input channel count, so
+ * mono files play on every output channel.
+ *
+ * @param wav The stream.
+ * @param first_frame First frame to decode.
+ * @param max_frames Frame capacity of the output.
+ * @param out Output format.
+ * @param samples Output samples.
+ * @return Frames written (0 at the end of the stream).
+ */
+uint32_t audio_wav_decode(audio_wav_t *wav, uint64_t first_frame, uint32_t max_frames,
+                          const audio_pcm_config_t *out, void *samples)
+{
+    if (first_frame >= wav->frames)
+    {
+        return 0;
+    }
+    uint32_t frames = (wav->frames - first_frame < max_frames) ? (uint32_t)(wav->frames - first_frame) : max_frames;
+    size_t offset = (size_t)first_frame * wav->block_align;
+    const uint8_t *src = wav->data + offset;
+    size_t sample_bytes = wav->block_align / wav->channels;
+    wav_readahead(wav, offset);
+
+    bool same_layout = (wav->channels == out->channels) &&
+                       ((wav->encoding == AUDIO_WAV_PCM16 && out->format == AUDIO_SAMPLE_S16) ||
+                        (wav->encoding == AUDIO_WAV_F32 && out->format == AUDIO_SAMPLE_F32));
+    if (same_layout)
+    {
+        memcpy(samples, src, (size_t)frames * wav->block_align);   // Straight from the mapping
+        return frames;
+    }
+
+    if (out->format == AUDIO_SAMPLE_F32)
+    {
+        float *dst = samples;
+        for (uint32_t f = 0; f < frames; f++, src += wav->block_align)
+        {
+            for (uint32_t c = 0; c < out->channels; c++)
+            {
+                *dst++ = wav_sample_f32(wav, src + (c % wav->channels) * sample_bytes);
+            }
+        }
+    }
+    else
+    {
+        int16_t *dst = samples;
+        for (uint32_t f = 0; f < frames; f++, src += wav->block_align)
+        {
+            for (uint32_t c = 0; c < out->channels; c++)
+            {
+                *dst++ = wav_sample_s16(wav, src + (c % wav->channels) * sample_bytes);
+            }
+        }
+    }
+    return frames;
+}
+
+/**
+ * @brief Returns a printable encoding name.
+ */
+const char *audio_wav_encoding_name(audio_wav_encoding_t encoding)
+{
+    switch (encoding)
+    {
+        case AUDIO_WAV_PCM24: return "pcm24";
+        case AUDIO_WAV_F32:   return "f32";
+        default:              return "pcm16";
+    }
+}
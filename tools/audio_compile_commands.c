@@ -0,0 +1,77 @@
+/**
+ * @file tools/audio_compile_commands.c
+ * @brief Compiles a text command script to the binary replay format
+ *
+ * Registers the same commands as audio_command_processor, freezes them to
+ * get their opcodes and writes every line of the script as a binary record
+ * (see audio_command_binary.h). The processor replays the output like any
+ * script: ./audio_command_processor commands.bin
+ *
+ * Usage:
+ *   audio_compile_commands <script.txt> <script.bin>
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "audio_command_binary.h"
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+
+extern void register_audio_commands(void);
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s <script.txt> <script.bin>\n", argv[0]);
+        return 1;
+    }
+
+    int fd = open(argv[1], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    size_t size = (size_t)st.st_size;
+    const char *text = "";
+    if (size > 0)
+    {
+        text = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (text == MAP_FAILED)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+    close(fd);
+
+    FILE *out = fopen(argv[2], "wb");
+    if (out == NULL)
+    {
+        perror(argv[2]);
+        return 1;
+    }
+
+    log_set_runtime_level(LOG_SEVERITY_WARNING);
+    register_audio_commands();
+    freeze_command_processor();
+
+    aud_binary_compile_result_t result;
+    bool ok = aud_binary_compile(text, size, out, &result);
+    ok = (fclose(out) == 0) && ok;
+    free_command_processor();
+    if (!ok)
+    {
+        fprintf(stderr, "%s: write failed\n", argv[2]);
+        return 1;
+    }
+
+    printf("%s: %zu records (%zu typed, %zu unknown, %zu skipped), %zu bytes from %zu bytes of text\n",
+           argv[2], result.records, result.typed, result.unknown, result.skipped, result.bytes, size);
+    return 0;
+}
@@ -0,0 +1,882 @@
+/**
+ * @file tools/audio_load.c
+ * @brief Seeded load generator and end-to-end throughput/latency harness
+ *
+ * Generates a workload from a weighted command mix and drives the command
+ * processor with it, either in-process (the same registry, dispatcher and
+ * pipeline as audio_command_processor, with the null sink) or through the
+ * standard input of a running audio_command_processor. The workload depends
+ * only on the mix and the seed, so two builds can be compared on exactly the
+ * same commands; -w writes it out as a script instead of running it.
+ *
+ * A mix file holds one entry per line, "<weight> <template>"; blank lines and
+ * lines starting with '#' are skipped. Templates are command lines with
+ * placeholders:
+ *   {lo-hi}      integer drawn uniformly from [lo, hi]
+ *   {lo-hi^k}    integer skewed towards lo: lo + (hi - lo + 1) * u^k
+ *   {a|b|c}      one of the words, uniformly
+ *
+ * Closed loop (the default) sends the next command as soon as one completes;
+ * through stdin, -c keeps that many commands in flight. Open loop (-r) sends
+ * on a fixed schedule, or with Poisson arrivals (-P), whatever the processor
+ * does, and measures latency from the scheduled time, so a stall shows up in
+ * every command queued behind it instead of being hidden. Through stdin a
+ * command completes when the processor prints its next prompt, which it does
+ * once per line read; mixes for that mode must not contain "after", whose
+ * timers print extra prompts.
+ *
+ * Latencies land in the log-linear histograms of audio_stats.h (about 6%
+ * precision), overall and per mix entry. The report gives commands/sec,
+ * p50/p90/p99/p99.9/max latency and the peak resident set (ru_maxrss) of the
+ * processor: the whole process in-process, with the growth during the run
+ * shown separately, or the child process through stdin. -j prints the same
+ * as one JSON object for regression tracking.
+ *
+ * Usage:
+ *   audio_load [options] [-x <program> [-- program options]]
+ */
+
+#define _GNU_SOURCE                                   // wait4()
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "audio_command_processor.h"
+#include "audio_logger.h"
+#include "audio_pipeline.h"
+#include "audio_stats.h"
+
+#define LOAD_MIX_MAX 64                               // Entries in a mix
+#define LOAD_TEMPLATE_MAX 128                         // Longest template
+#define LOAD_LINE_MAX 256                             // Longest generated command (the processor's line limit)
+#define LOAD_SPIN_NS 100000ULL                        // Open loop: spin, not sleep, this close to a send time
+#define LOAD_PROMPT "Enter command: "                 // Printed once per line the processor reads
+
+extern void register_audio_commands(void);
+
+typedef struct {
+    unsigned weight;                                  // Relative frequency
+    char template[LOAD_TEMPLATE_MAX];                 // Command line with placeholders
+    uint64_t count;                                   // Commands generated from this entry
+    uint64_t max_ns;                                  // Slowest of them
+    uint32_t buckets[AUDIO_STATS_BUCKETS];            // Their latency histogram (ns)
+} load_entry_t;
+
+typedef struct {
+    size_t commands;                                  // Commands to generate
+    uint64_t seed;
+    double rate;                                      // Open loop: commands/sec (0: closed loop)
+    bool poisson;                                     // Open loop: exponential gaps instead of fixed ones
+    unsigned depth;                                   // Closed loop through stdin: commands in flight
+    const char *mix_path;                             // Mix file (NULL: built-in mix)
+    const char *script_path;                          // Write the workload here instead of running it
+    const char *program;                              // Drive this program's stdin (NULL: in-process)
+    char **program_args;                              // Its options
+    int log_level;                                    // In-process log level
+    bool json;
+} load_options_t;
+
+typedef struct {
+    load_entry_t entries[LOAD_MIX_MAX];
+    size_t entry_count;
+    unsigned total_weight;
+    char *text;                                       // Every command, newline-terminated, back to back
+    size_t *offsets;                                  // Start of command i; offsets[commands] is the end
+    uint8_t *kinds;                                   // Mix entry of command i
+    size_t commands;
+    uint32_t buckets[AUDIO_STATS_BUCKETS];            // Latency histogram of every command (ns)
+    uint64_t max_ns;
+    uint64_t completed;
+    double seconds;                                   // First send to last completion
+    long max_rss_kib;                                 // Peak resident set of the processor
+    long rss_growth_kib;                              // In-process: growth of the peak during the run
+} load_t;
+
+static const char *const default_mix[] = {
+    "30 volumeSet {0-100}",
+    "15 volumeGet",
+    "10 volumeUp",
+    "10 volumeDown",
+    "5 mute",
+    "5 unmute",
+    "8 play",
+    "5 pause",
+    "4 ramp {0-100} {10-500}ms",
+    "1 stats",
+    "5 volumeSett {0-100^3}",                         // Unknown command: the dispatch miss path
+    "2 volumeSet {150-200}",                          // Out of range: the argument error path
+};
+
+// ====================================================================================
+// Workload generation
+
+static uint64_t splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static double uniform01(uint64_t *state)
+{
+    return (double)(splitmix64(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Expands one placeholder (the text between the braces).
+ *
+ * @return Bytes written to out, or -1 if the placeholder is malformed.
+ */
+static int expand_placeholder(const char *p, size_t len, uint64_t *rng, char *out, size_t cap)
+{
+    char spec[LOAD_TEMPLATE_MAX];
+    memcpy(spec, p, len);
+    spec[len] = '\0';
+    if (strchr(spec, '|') != NULL)
+    {
+        size_t words = 1;
+        for (size_t i = 0; i < len; i++)
+        {
+            words += (spec[i] == '|');
+        }
+        size_t pick = (size_t)(splitmix64(rng) % words);
+        const char *word = spec;
+        while (pick-- > 0)
+        {
+            word = strchr(word, '|') + 1;
+        }
+        size_t word_len = strcspn(word, "|");
+        return (word_len < cap) ? snprintf(out, cap, "%.*s", (int)word_len, word) : -1;
+    }
+
+    char *end;
+    long lo = strtol(spec, &end, 10);
+    if (end == spec || *end != '-')
+    {
+        return -1;
+    }
+    char *hi_start = end + 1;
+    long hi = strtol(hi_start, &end, 10);
+    double skew = 1.0;
+    if (end == hi_start || hi < lo)
+    {
+        return -1;
+    }
+    if (*end == '^')
+    {
+        char *skew_start = end + 1;
+        skew = strtod(skew_start, &end);
+        if (end == skew_start || skew <= 0.0)
+        {
+            return -1;
+        }
+    }
+    if (*end != '\0')
+    {
+        return -1;
+    }
+    double span = (double)(hi - lo) + 1.0;
+    long value = lo + (long)(span * pow(uniform01(rng), skew));
+    value = (value > hi) ? hi : value;
+    return snprintf(out, cap, "%ld", value);
+}
+
+/**
+ * @brief Expands a template into one command line (without newline).
+ *
+ * @return Length of the line, or -1 if the template is malformed or too long.
+ */
+static int expand_template(const char *template, uint64_t *rng, char *out, size_t cap)
+{
+    size_t n = 0;
+    for (const char *p = template; *p != '\0';)
+    {
+        if (*p == '{')
+        {
+            const char *close = strchr(p, '}');
+            if (close == NULL)
+            {
+                return -1;
+            }
+            int written = expand_placeholder(p + 1, (size_t)(close - p - 1), rng, out + n, cap - n);
+            if (written < 0 || (size_t)written >= cap - n)
+            {
+                return -1;
+            }
+            n += (size_t)written;
+            p = close + 1;
+            continue;
+        }
+        if (n + 1 >= cap)
+        {
+            return -1;
+        }
+        out[n++] = *p++;
+    }
+    out[n] = '\0';
+    return (int)n;
+}
+
+static bool add_entry(load_t *load, const char *line, const char *where)
+{
+    char *end;
+    unsigned long weight = strtoul(line, &end, 10);
+    while (*end == ' ' || *end == '\t')
+    {
+        end++;
+    }
+    size_t len = strcspn(end, "\r\n");
+    uint64_t probe = 1;
+    char expanded[LOAD_LINE_MAX];
+    if (end == line || weight == 0 || len == 0 || len >= LOAD_TEMPLATE_MAX || load->entry_count >= LOAD_MIX_MAX)
+    {
+        fprintf(stderr, "%s: expected \"<weight> <template>\": %s\n", where, line);
+        return false;
+    }
+    load_entry_t *entry = &load->entries[load->entry_count];
+    memcpy(entry->template, end, len);
+    entry->template[len] = '\0';
+    if (expand_template(entry->template, &probe, expanded, sizeof(expanded)) < 0)
+    {
+        fprintf(stderr, "%s: bad placeholder or line too long: %s\n", where, entry->template);
+        return false;
+    }
+    entry->weight = (unsigned)weight;
+    load->total_weight += entry->weight;
+    load->entry_count++;
+    return true;
+}
+
+static bool load_mix(load_t *load, const char *path)
+{
+    if (path == NULL)
+    {
+        for (size_t i = 0; i < sizeof(default_mix) / sizeof(default_mix[0]); i++)
+        {
+            if (!add_entry(load, default_mix[i], "built-in mix"))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    char line[LOAD_TEMPLATE_MAX + 32];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file) != NULL)
+    {
+        const char *p = line + strspn(line, " \t");
+        if (*p != '#' && *p != '\n' && *p != '\r' && *p != '\0')
+        {
+            ok = add_entry(load, p, path);
+        }
+    }
+    fclose(file);
+    if (ok && load->entry_count == 0)
+    {
+        fprintf(stderr, "%s: empty mix\n", path);
+        ok = false;
+    }
+    return ok;
+}
+
+/**
+ * @brief Generates every command of the workload up front.
+ *
+ * Generation stays out of the timed loop, and the same seed and mix always
+ * give the same bytes.
+ */
+static bool generate_workload(load_t *load, const load_options_t *options)
+{
+    uint64_t rng = options->seed;
+    size_t capacity = options->commands * 16 + LOAD_LINE_MAX;
+    load->commands = options->commands;
+    load->text = malloc(capacity);
+    load->offsets = malloc((options->commands + 1) * sizeof(size_t));
+    load->kinds = malloc(options->commands + 1);
+    if (load->text == NULL || load->offsets == NULL || load->kinds == NULL)
+    {
+        return false;
+    }
+    size_t used = 0;
+    for (size_t i = 0; i < options->commands; i++)
+    {
+        if (capacity - used < LOAD_LINE_MAX + 1)
+        {
+            capacity *= 2;
+            char *text = realloc(load->text, capacity);
+            if (text == NULL)
+            {
+                return false;
+            }
+            load->text = text;
+        }
+        unsigned pick = (unsigned)(splitmix64(&rng) % load->total_weight);
+        size_t kind = 0;
+        while (pick >= load->entries[kind].weight)
+        {
+            pick -= load->entries[kind++].weight;
+        }
+        int len = expand_template(load->entries[kind].template, &rng, load->text + used, LOAD_LINE_MAX);
+        load->offsets[i] = used;
+        load->kinds[i] = (uint8_t)kind;
+        used += (size_t)len;
+        load->text[used++] = '\n';
+    }
+    load->offsets[options->commands] = used;
+    return true;
+}
+
+// ====================================================================================
+// Timing
+
+static uint64_t load_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Sleeps until close to deadline_ns, then spins the rest for a precise send time
+static void wait_until(uint64_t deadline_ns)
+{
+    uint64_t now = load_now_ns();
+    if (deadline_ns > now + LOAD_SPIN_NS)
+    {
+        uint64_t wake = deadline_ns - LOAD_SPIN_NS;
+        struct timespec ts = { (time_t)(wake / 1000000000ULL), (long)(wake % 1000000000ULL) };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        {
+        }
+    }
+    while (load_now_ns() < deadline_ns)
+    {
+    }
+}
+
+// Open loop: time of the next send after the previous one (fixed gap or exponential)
+static uint64_t next_send_ns(uint64_t previous, const load_options_t *options, uint64_t *rng)
+{
+    double gap = 1e9 / options->rate;
+    if (options->poisson)
+    {
+        gap *= -log(1.0 - uniform01(rng));
+    }
+    return previous + (uint64_t)gap;
+}
+
+static void record_latency(load_t *load, size_t command, uint64_t ns)
+{
+    load_entry_t *entry = &load->entries[load->kinds[command]];
+    load->buckets[audio_stats_bucket(ns)]++;
+    load->max_ns = (ns > load->max_ns) ? ns : load->max_ns;
+    entry->buckets[audio_stats_bucket(ns)]++;
+    entry->max_ns = (ns > entry->max_ns) ? ns : entry->max_ns;
+    entry->count++;
+}
+
+static long peak_rss_kib(int who)
+{
+    struct rusage usage;
+    return (getrusage(who, &usage) == 0) ? usage.ru_maxrss : 0;
+}
+
+// ====================================================================================
+// In-process driver
+
+static bool run_in_process(load_t *load, const load_options_t *options)
+{
+    log_set_runtime_level(options->log_level);
+    register_audio_commands();
+    freeze_command_processor();
+    audio_pipeline_config_t config;
+    audio_pipeline_default_config(&config);
+    config.sink = "null";
+    if (!start_audio_pipeline(&config))
+    {
+        free_command_processor();
+        return false;
+    }
+
+    fflush(stdout);                                   // Handlers print (stats, help): keep that out of the report
+    int saved_stdout = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (saved_stdout >= 0 && null_fd >= 0)
+    {
+        dup2(null_fd, STDOUT_FILENO);
+    }
+
+    long baseline = peak_rss_kib(RUSAGE_SELF);
+    uint64_t rng = options->seed ^ 0x5DEECE66DULL;    // Arrival times: a stream apart from the commands
+    uint64_t start = load_now_ns();
+    uint64_t send = start;
+    for (size_t i = 0; i < load->commands; i++)
+    {
+        const char *line = load->text + load->offsets[i];
+        size_t len = load->offsets[i + 1] - load->offsets[i] - 1;
+        if (options->rate > 0.0)
+        {
+            wait_until(send);                         // Latency counts from here even when behind
+        }
+        else
+        {
+            send = load_now_ns();
+        }
+        dispatch_command_slice(line, len);
+        uint64_t done = load_now_ns();
+        record_latency(load, i, done - send);
+        if (options->rate > 0.0)
+        {
+            send = next_send_ns(send, options, &rng);
+        }
+    }
+    load->seconds = (double)(load_now_ns() - start) / 1e9;
+    load->completed = load->commands;
+    load->max_rss_kib = peak_rss_kib(RUSAGE_SELF);
+    load->rss_growth_kib = load->max_rss_kib - baseline;
+
+    stop_audio_pipeline();
+    free_command_processor();
+    fflush(stdout);
+    if (saved_stdout >= 0 && null_fd >= 0)
+    {
+        dup2(saved_stdout, STDOUT_FILENO);
+    }
+    close(saved_stdout);
+    close(null_fd);
+    return true;
+}
+
+// ====================================================================================
+// Standard input driver
+
+typedef struct {
+    load_t *load;
+    int fd;                                           // The processor's stdout
+    uint64_t *sent_ns;                                // Send (or scheduled) time of every command
+    uint64_t last_done_ns;
+    pthread_mutex_t lock;
+    pthread_cond_t progress;                          // A command completed
+    uint64_t completed;                               // Guarded by lock
+} load_pipe_t;
+
+/**
+ * @brief Reader thread: every prompt after the first completes the oldest command.
+ */
+static void *prompt_reader(void *arg)
+{
+    load_pipe_t *pipe_state = arg;
+    const size_t prompt_len = strlen(LOAD_PROMPT);
+    char buffer[65536 + sizeof(LOAD_PROMPT)];
+    size_t kept = 0;                                  // Tail of the last read that may start a prompt
+    bool first = true;                                // The prompt before the first command
+    for (;;)
+    {
+        ssize_t got = read(pipe_state->fd, buffer + kept, sizeof(buffer) - kept);
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got <= 0)
+        {
+            break;
+        }
+        uint64_t now = load_now_ns();
+        size_t size = kept + (size_t)got;
+        size_t matches = 0;
+        const char *p = buffer;
+        const char *end = buffer + size;
+        const char *hit;
+        while ((hit = memmem(p, (size_t)(end - p), LOAD_PROMPT, prompt_len)) != NULL)
+        {
+            matches++;
+            p = hit + prompt_len;
+        }
+        kept = (size_t)(end - p) < prompt_len - 1 ? (size_t)(end - p) : prompt_len - 1;
+        memmove(buffer, end - kept, kept);
+
+        if (first && matches > 0)
+        {
+            matches--;
+            first = false;
+        }
+        pthread_mutex_lock(&pipe_state->lock);
+        for (size_t m = 0; m < matches && pipe_state->completed < pipe_state->load->commands; m++)
+        {
+            size_t command = pipe_state->completed++;
+            record_latency(pipe_state->load, command, now - pipe_state->sent_ns[command]);
+        }
+        if (matches > 0)
+        {
+            pipe_state->last_done_ns = now;
+            pthread_cond_signal(&pipe_state->progress);
+        }
+        pthread_mutex_unlock(&pipe_state->lock);
+    }
+    return NULL;
+}
+
+static bool write_all(int fd, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t put = write(fd, data, len);
+        if (put < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (put <= 0)
+        {
+            return false;
+        }
+        data += put;
+        len -= (size_t)put;
+    }
+    return true;
+}
+
+static pid_t spawn_processor(const load_options_t *options, int *to_child, int *from_child)
+{
+    int in[2];
+    int out[2];
+    if (pipe(in) != 0 || pipe(out) != 0)
+    {
+        perror("pipe");
+        return -1;
+    }
+    pid_t child = fork();
+    if (child == 0)
+    {
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        close(in[0]);
+        close(in[1]);
+        close(out[0]);
+        close(out[1]);
+        execvp(options->program, options->program_args);
+        perror(options->program);
+        _exit(127);
+    }
+    close(in[0]);
+    close(out[1]);
+    *to_child = in[1];
+    *from_child = out[0];
+    return child;
+}
+
+static bool run_through_stdin(load_t *load, const load_options_t *options)
+{
+    int to_child;
+    int from_child;
+    pid_t child = spawn_processor(options, &to_child, &from_child);
+    if (child < 0)
+    {
+        return false;
+    }
+    signal(SIGPIPE, SIG_IGN);                         // A dead processor ends the run, not the tool
+
+    load_pipe_t pipe_state = { .load = load, .fd = from_child };
+    pipe_state.sent_ns = malloc(load->commands * sizeof(uint64_t));
+    pthread_mutex_init(&pipe_state.lock, NULL);
+    pthread_cond_init(&pipe_state.progress, NULL);
+    pthread_t reader;
+    if (pipe_state.sent_ns == NULL || pthread_create(&reader, NULL, prompt_reader, &pipe_state) != 0)
+    {
+        kill(child, SIGKILL);
+        waitpid(child, NULL, 0);
+        return false;
+    }
+
+    uint64_t rng = options->seed ^ 0x5DEECE66DULL;
+    uint64_t start = load_now_ns();
+    uint64_t send = start;
+    bool alive = true;
+    for (size_t i = 0; alive && i < load->commands;)
+    {
+        size_t count = 1;
+        if (options->rate > 0.0)
+        {
+            wait_until(send);
+            pipe_state.sent_ns[i] = send;
+            send = next_send_ns(send, options, &rng);
+        }
+        else
+        {
+            pthread_mutex_lock(&pipe_state.lock);     // Keep depth commands in flight
+            while (i - pipe_state.completed >= options->depth)
+            {
+                pthread_cond_wait(&pipe_state.progress, &pipe_state.lock);
+            }
+            count = options->depth - (size_t)(i - pipe_state.completed);
+            pthread_mutex_unlock(&pipe_state.lock);
+            count = (count > load->commands - i) ? load->commands - i : count;
+            uint64_t now = load_now_ns();
+            for (size_t k = 0; k < count; k++)
+            {
+                pipe_state.sent_ns[i + k] = now;
+            }
+        }
+        alive = write_all(to_child, load->text + load->offsets[i], load->offsets[i + count] - load->offsets[i]);
+        i += count;
+    }
+    close(to_child);                                  // End of input: the processor exits
+
+    pthread_join(reader, NULL);
+    close(from_child);
+    struct rusage usage;
+    int status = 0;
+    memset(&usage, 0, sizeof(usage));
+    wait4(child, &status, 0, &usage);
+    load->seconds = (double)((pipe_state.last_done_ns > start ? pipe_state.last_done_ns : start) - start) / 1e9;
+    load->completed = pipe_state.completed;
+    load->max_rss_kib = usage.ru_maxrss;
+    load->rss_growth_kib = -1;
+    pthread_mutex_destroy(&pipe_state.lock);
+    pthread_cond_destroy(&pipe_state.progress);
+    free(pipe_state.sent_ns);
+    if (load->completed != load->commands)
+    {
+        fprintf(stderr, "%s completed %llu of %zu commands (exit status %d)\n", options->program,
+                (unsigned long long)load->completed, load->commands, WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        return false;
+    }
+    return true;
+}
+
+// ====================================================================================
+// Report
+
+static double percentile(const uint32_t *buckets, uint64_t count, uint64_t max, double fraction)
+{
+    return (double)audio_stats_percentile(buckets, count, max, fraction);
+}
+
+static void describe_mode(const load_options_t *options, char *out, size_t cap)
+{
+    const char *driver = (options->program != NULL) ? "stdin" : "in-process";
+    if (options->rate > 0.0)
+    {
+        snprintf(out, cap, "%s, open loop at %.0f/s%s", driver, options->rate, options->poisson ? " (Poisson)" : "");
+    }
+    else
+    {
+        snprintf(out, cap, "%s, closed loop, depth %u", driver, (options->program != NULL) ? options->depth : 1u);
+    }
+}
+
+static void print_text_report(const load_t *load, const load_options_t *options)
+{
+    char mode[96];
+    describe_mode(options, mode, sizeof(mode));
+    uint64_t n = load->completed;
+    printf("mode        %s\n", mode);
+    printf("workload    %zu commands, seed %llu, mix %s (%zu entries)\n", load->commands,
+           (unsigned long long)options->seed, options->mix_path ? options->mix_path : "built-in", load->entry_count);
+    printf("elapsed     %.3f s\n", load->seconds);
+    printf("throughput  %.0f commands/sec\n", load->seconds > 0.0 ? (double)n / load->seconds : 0.0);
+    printf("latency     p50 %.0f ns | p90 %.0f ns | p99 %.0f ns | p99.9 %.0f ns | max %llu ns\n",
+           percentile(load->buckets, n, load->max_ns, 0.50), percentile(load->buckets, n, load->max_ns, 0.90),
+           percentile(load->buckets, n, load->max_ns, 0.99), percentile(load->buckets, n, load->max_ns, 0.999),
+           (unsigned long long)load->max_ns);
+    if (load->rss_growth_kib >= 0)
+    {
+        printf("memory      peak RSS %ld KiB (+%ld KiB during the run)\n", load->max_rss_kib, load->rss_growth_kib);
+    }
+    else
+    {
+        printf("memory      peak RSS %ld KiB (processor)\n", load->max_rss_kib);
+    }
+    printf("\n%-32s %10s %12s %12s %12s\n", "template", "commands", "p50 ns", "p99 ns", "max ns");
+    for (size_t i = 0; i < load->entry_count; i++)
+    {
+        const load_entry_t *e = &load->entries[i];
+        printf("%-32s %10llu %12.0f %12.0f %12llu\n", e->template, (unsigned long long)e->count,
+               percentile(e->buckets, e->count, e->max_ns, 0.50), percentile(e->buckets, e->count, e->max_ns, 0.99),
+               (unsigned long long)e->max_ns);
+    }
+}
+
+// Writes s as a JSON string (templates contain no control characters)
+static void print_json_string(const char *s)
+{
+    putchar('"');
+    for (; *s != '\0'; s++)
+    {
+        if (*s == '"' || *s == '\\')
+        {
+            putchar('\\');
+        }
+        putchar(*s);
+    }
+    putchar('"');
+}
+
+static void print_json_report(const load_t *load, const load_options_t *options)
+{
+    char mode[96];
+    describe_mode(options, mode, sizeof(mode));
+    uint64_t n = load->completed;
+    printf("{\n  \"tool\": \"audio_load\",\n  \"mode\": ");
+    print_json_string(mode);
+    printf(",\n  \"seed\": %llu,\n  \"commands\": %llu,\n  \"seconds\": %.6f,\n  \"commands_per_sec\": %.1f,\n",
+           (unsigned long long)options->seed, (unsigned long long)n, load->seconds,
+           load->seconds > 0.0 ? (double)n / load->seconds : 0.0);
+    printf("  \"latency_ns\": { \"p50\": %.0f, \"p90\": %.0f, \"p99\": %.0f, \"p999\": %.0f, \"max\": %llu },\n",
+           percentile(load->buckets, n, load->max_ns, 0.50), percentile(load->buckets, n, load->max_ns, 0.90),
+           percentile(load->buckets, n, load->max_ns, 0.99), percentile(load->buckets, n, load->max_ns, 0.999),
+           (unsigned long long)load->max_ns);
+    printf("  \"max_rss_kib\": %ld,\n  \"rss_growth_kib\": %ld,\n  \"mix\": [\n", load->max_rss_kib, load->rss_growth_kib);
+    for (size_t i = 0; i < load->entry_count; i++)
+    {
+        const load_entry_t *e = &load->entries[i];
+        printf("    { \"template\": ");
+        print_json_string(e->template);
+        printf(", \"weight\": %u, \"commands\": %llu, \"p50\": %.0f, \"p99\": %.0f, \"max\": %llu }%s\n", e->weight,
+               (unsigned long long)e->count, percentile(e->buckets, e->count, e->max_ns, 0.50),
+               percentile(e->buckets, e->count, e->max_ns, 0.99), (unsigned long long)e->max_ns,
+               (i + 1 < load->entry_count) ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+// ====================================================================================
+
+static void print_usage(const char *program)
+{
+    printf("Usage: %s [options] [-x <program> [-- program options]]\n", program);
+    printf("  -n <count>    commands to send (default 1000000)\n");
+    printf("  -s <seed>     workload seed (default 1)\n");
+    printf("  -m <file>     command mix: \"<weight> <template>\" per line (default: built-in mix below)\n");
+    printf("  -r <rate>     open loop: send this many commands/sec on schedule (default: closed loop)\n");
+    printf("  -P            open loop with Poisson arrivals instead of a fixed gap\n");
+    printf("  -c <depth>    closed loop through stdin: commands in flight (default 1)\n");
+    printf("  -x <program>  drive <program>'s stdin (default options: -o null -V none) instead of in-process\n");
+    printf("  -V <level>    in-process log level: info, warning, error or none (default none)\n");
+    printf("  -w <file>     write the workload as a script and exit\n");
+    printf("  -j            print the report as JSON\n");
+    printf("Templates: {lo-hi} uniform integer, {lo-hi^k} skewed towards lo, {a|b|c} one of the words.\n");
+    printf("Built-in mix:\n");
+    for (size_t i = 0; i < sizeof(default_mix) / sizeof(default_mix[0]); i++)
+    {
+        printf("  %s\n", default_mix[i]);
+    }
+}
+
+static bool parse_options(int argc, char *argv[], load_options_t *options)
+{
+    static const char *const levels[] = { "info", "warning", "error", "none" };
+    static char *default_args[] = { NULL, "-o", "null", "-V", "none", NULL };
+    memset(options, 0, sizeof(*options));
+    options->commands = 1000000;
+    options->seed = 1;
+    options->depth = 1;
+    options->log_level = LOG_SEVERITY_NONE;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:m:r:Pc:x:V:w:jh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': options->commands = strtoul(optarg, NULL, 10); break;
+            case 's': options->seed = strtoull(optarg, NULL, 10); break;
+            case 'm': options->mix_path = optarg; break;
+            case 'r': options->rate = strtod(optarg, NULL); break;
+            case 'P': options->poisson = true; break;
+            case 'c': options->depth = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'x': options->program = optarg; break;
+            case 'w': options->script_path = optarg; break;
+            case 'j': options->json = true; break;
+            case 'V':
+                options->log_level = -1;
+                for (int i = 0; i < 4; i++)
+                {
+                    options->log_level = (strcmp(optarg, levels[i]) == 0) ? i : options->log_level;
+                }
+                if (options->log_level < 0)
+                {
+                    return false;
+                }
+                break;
+            default: return false;
+        }
+    }
+    if (options->commands == 0 || options->depth == 0 || options->rate < 0.0 || (options->poisson && options->rate == 0.0))
+    {
+        return false;
+    }
+    if (options->program != NULL)
+    {
+        if (optind < argc)
+        {
+            optind--;                                 // Reuse argv: the program name goes where "--" (or the last option) was
+            argv[optind] = (char *)options->program;
+            options->program_args = &argv[optind];
+        }
+        else
+        {
+            default_args[0] = (char *)options->program;
+            options->program_args = default_args;
+        }
+    }
+    return optind >= argc || options->program != NULL;
+}
+
+static bool write_script(const load_t *load, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    size_t size = load->offsets[load->commands];
+    bool ok = fwrite(load->text, 1, size, file) == size;
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    load_options_t options;
+    if (!parse_options(argc, argv, &options))
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+    static load_t load;
+    if (!load_mix(&load, options.mix_path) || !generate_workload(&load, &options))
+    {
+        return 1;
+    }
+    if (options.script_path != NULL)
+    {
+        bool ok = write_script(&load, options.script_path);
+        fprintf(stderr, "%zu commands written to %s\n", load.commands, options.script_path);
+        return ok ? 0 : 1;
+    }
+
+    bool ok = (options.program != NULL) ? run_through_stdin(&load, &options) : run_in_process(&load, &options);
+    if (load.completed > 0)
+    {
+        options.json ? print_json_report(&load, &options) : print_text_report(&load, &options);
+    }
+    free(load.text);
+    free(load.offsets);
+    free(load.kinds);
+    return ok ? 0 : 1;
+}
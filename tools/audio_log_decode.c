@@ -0,0 +1,284 @@
+/**
+ * @file tools/audio_log_decode.c
+ * @brief Offline decoder for binary logs
+ *
+ * Turns a log written with `audio_command_processor -L <file>` back into the
+ * text the synchronous logger would have printed, prefixed with the time since
+ * the first record.
+ *
+ * Usage:
+ *   audio_log_decode <file>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_log_binary.h"
+
+typedef struct {
+    uint64_t id;                                      // Format pointer in the logging process
+    char *text;                                       // NUL-terminated format string
+} decode_format_t;
+
+static decode_format_t *formats = NULL;
+static size_t format_count = 0;
+static size_t format_capacity = 0;
+
+static const char *find_format(uint64_t id)
+{
+    for (size_t i = format_count; i > 0; i--)         // Newest first: ids are only reused after a restart
+    {
+        if (formats[i - 1].id == id)
+        {
+            return formats[i - 1].text;
+        }
+    }
+    return NULL;
+}
+
+static int add_format(uint64_t id, char *text)
+{
+    if (format_count == format_capacity)
+    {
+        size_t capacity = format_capacity ? format_capacity * 2 : 64;
+        decode_format_t *grown = realloc(formats, capacity * sizeof(decode_format_t));
+        if (grown == NULL)
+        {
+            return 0;
+        }
+        formats = grown;
+        format_capacity = capacity;
+    }
+    formats[format_count].id = id;
+    formats[format_count].text = text;
+    format_count++;
+    return 1;
+}
+
+static const char *level_prefix(uint8_t level)
+{
+    switch (level)
+    {
+        case 0:  return "[INFO] ";
+        case 1:  return "[WARNING] ";
+        case 2:  return "[ERROR] ";
+        case 3:  return "[INPUT] ";
+        default: return "[LOG] ";
+    }
+}
+
+/**
+ * @brief Reads the next 8-byte argument word from a payload.
+ */
+static uint64_t take_word(const unsigned char **p, const unsigned char *end)
+{
+    uint64_t word = 0;
+    if (end - *p >= (long)sizeof(word))
+    {
+        memcpy(&word, *p, sizeof(word));
+        *p += sizeof(word);
+    }
+    else
+    {
+        *p = end;
+    }
+    return word;
+}
+
+/**
+ * @brief Renders one record by replaying its format against the stored arguments.
+ */
+static void render(const char *format, const unsigned char *p, const unsigned char *end)
+{
+    log_spec_t spec;
+    const char *text = format;
+    char conversion[64];
+    char str[LOG_BINARY_MAX_STRING + 1];
+
+    while (log_next_spec(text, &spec))
+    {
+        fwrite(text, 1, (size_t)(spec.start - text), stdout);
+        text = spec.end;
+
+        int stars[2] = { 0, 0 };
+        for (int i = 0; i < spec.star_count && i < 2; i++)
+        {
+            stars[i] = (int)(int64_t)take_word(&p, end);
+        }
+
+        size_t conv_len = (size_t)(spec.end - spec.start);
+        if (spec.kind == LOG_ARG_NONE || conv_len >= sizeof(conversion))
+        {
+            if (spec.start[1] == '%')
+            {
+                putchar('%');
+            }
+            else
+            {
+                fwrite(spec.start, 1, conv_len, stdout);
+            }
+            continue;
+        }
+        memcpy(conversion, spec.start, conv_len);
+        conversion[conv_len] = '\0';
+
+        char out[LOG_BINARY_MAX_STRING + 64];
+        switch (spec.kind)
+        {
+            case LOG_ARG_STRING:
+            {
+                uint16_t len = 0;
+                if (end - p >= (long)sizeof(len))
+                {
+                    memcpy(&len, p, sizeof(len));
+                    p += sizeof(len);
+                }
+                if (len > end - p)
+                {
+                    len = (uint16_t)(end - p);
+                }
+                memcpy(str, p, len);
+                str[len] = '\0';
+                p += len;
+                if (spec.star_count == 2)       snprintf(out, sizeof(out), conversion, stars[0], stars[1], str);
+                else if (spec.star_count == 1)  snprintf(out, sizeof(out), conversion, stars[0], str);
+                else                            snprintf(out, sizeof(out), conversion, str);
+                break;
+            }
+            case LOG_ARG_DOUBLE:
+            {
+                uint64_t word = take_word(&p, end);
+                double d;
+                memcpy(&d, &word, sizeof(d));
+                if (spec.star_count == 2)       snprintf(out, sizeof(out), conversion, stars[0], stars[1], d);
+                else if (spec.star_count == 1)  snprintf(out, sizeof(out), conversion, stars[0], d);
+                else                            snprintf(out, sizeof(out), conversion, d);
+                break;
+            }
+            case LOG_ARG_PTR:
+            {
+                void *ptr = (void *)(uintptr_t)take_word(&p, end);
+                snprintf(out, sizeof(out), conversion, ptr);
+                break;
+            }
+            case LOG_ARG_INT64:
+            {
+                long long v = (long long)take_word(&p, end);
+                if (spec.star_count == 2)       snprintf(out, sizeof(out), conversion, stars[0], stars[1], v);
+                else if (spec.star_count == 1)  snprintf(out, sizeof(out), conversion, stars[0], v);
+                else                            snprintf(out, sizeof(out), conversion, v);
+                break;
+            }
+            default:
+            {
+                int v = (int)(int64_t)take_word(&p, end);
+                if (spec.star_count == 2)       snprintf(out, sizeof(out), conversion, stars[0], stars[1], v);
+                else if (spec.star_count == 1)  snprintf(out, sizeof(out), conversion, stars[0], v);
+                else                            snprintf(out, sizeof(out), conversion, v);
+                break;
+            }
+        }
+        fputs(out, stdout);
+    }
+    fputs(text, stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s <file>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (in == NULL)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    char magic[sizeof(LOG_BINARY_MAGIC)];
+    if (fread(magic, 1, sizeof(magic), in) != sizeof(magic) || memcmp(magic, LOG_BINARY_MAGIC, sizeof(magic)) != 0)
+    {
+        fprintf(stderr, "%s: not a binary audio log\n", argv[1]);
+        fclose(in);
+        return 1;
+    }
+
+    unsigned char payload[65536];
+    uint64_t first_ns = 0;
+    size_t records = 0;
+    int tag;
+    while ((tag = fgetc(in)) != EOF)
+    {
+        uint64_t id;
+        if (fread(&id, sizeof(id), 1, in) != 1)
+        {
+            break;
+        }
+
+        if (tag == LOG_BINARY_TAG_FORMAT)
+        {
+            uint32_t len;
+            if (fread(&len, sizeof(len), 1, in) != 1)
+            {
+                break;
+            }
+            char *text = malloc((size_t)len + 1);
+            if (text == NULL || fread(text, 1, len, in) != len)
+            {
+                free(text);
+                break;
+            }
+            text[len] = '\0';
+            if (!add_format(id, text))
+            {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+            }
+        }
+        else if (tag == LOG_BINARY_TAG_RECORD)
+        {
+            uint64_t timestamp;
+            uint8_t level;
+            uint16_t len;
+            if (fread(&timestamp, sizeof(timestamp), 1, in) != 1 ||
+                fread(&level, sizeof(level), 1, in) != 1 ||
+                fread(&len, sizeof(len), 1, in) != 1 ||
+                fread(payload, 1, len, in) != len)
+            {
+                break;
+            }
+            if (records++ == 0)
+            {
+                first_ns = timestamp;
+            }
+
+            const char *format = find_format(id);
+            printf("[+%.6f] %s", (double)(timestamp - first_ns) / 1e9, level_prefix(level));
+            if (format != NULL)
+            {
+                render(format, payload, payload + len);
+            }
+            else
+            {
+                printf("<unknown format %#llx>", (unsigned long long)id);
+            }
+            putchar('\n');
+        }
+        else
+        {
+            fprintf(stderr, "%s: corrupt record tag %#x\n", argv[1], tag);
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < format_count; i++)
+    {
+        free(formats[i].text);
+    }
+    free(formats);
+    fclose(in);
+    return 0;
+}
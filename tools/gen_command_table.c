@@ -0,0 +1,140 @@
+/**
+ * @file tools/gen_command_table.c
+ * @brief Compile-time generator for the frozen command table
+ *
+ * Builds the perfect-hash table for a static command list and prints it as C
+ * source, so a firmware image can carry the table in read-only data and skip
+ * the freeze step at startup.
+ *
+ * Usage:
+ *   gen_command_table <prefix> name:handler[:slice|:schema=<symbol>] [...] > table.h
+ *
+ * A ":slice" suffix marks a command_slice_handler_t handler; otherwise the
+ * handler is a legacy command_handler_t. A ":schema=<symbol>" suffix marks a
+ * typed command: a slice handler that reads line->values, parsed with the
+ * aud_arg_schema_t named <symbol>. Typed commands must carry their schema,
+ * or their handlers would run with no parsed values.
+ *
+ * The handlers and schemas must be declared before the generated file is included; the
+ * table is then activated with install_command_table(&<prefix>_table), which
+ * checks it first. Every empty slot is emitted as AUD_COMMAND_SLOT_EMPTY.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_command_hash.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <prefix> name:handler[:slice|:schema=<symbol>] [...]\n", argv[0]);
+        return 1;
+    }
+
+    const char *prefix = argv[1];
+    size_t count = (size_t)(argc - 2);
+    aud_command_slot_t *entries = calloc(count, sizeof(aud_command_slot_t));
+    const char **handlers = calloc(count, sizeof(const char *));
+    const char **schemas = calloc(count, sizeof(const char *));
+    bool *slice = calloc(count, sizeof(bool));
+    if (entries == NULL || handlers == NULL || schemas == NULL || slice == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        char *spec = argv[i + 2];
+        char *colon = strchr(spec, ':');
+        if (colon == NULL || colon == spec || colon[1] == '\0')
+        {
+            fprintf(stderr, "invalid command spec: %s\n", spec);
+            return 1;
+        }
+        *colon = '\0';
+        entries[i].command_name = spec;
+        entries[i].name_len = (uint32_t)strlen(spec);
+        handlers[i] = colon + 1;
+
+        char *kind = strchr(colon + 1, ':');
+        if (kind != NULL)
+        {
+            *kind++ = '\0';
+            if (strncmp(kind, "schema=", 7) == 0 && kind[7] != '\0')
+            {
+                schemas[i] = kind + 7;
+                slice[i] = true;                     // Typed commands always have slice handlers
+            }
+            else if (strcmp(kind, "slice") == 0)
+            {
+                slice[i] = true;
+            }
+            else
+            {
+                fprintf(stderr, "invalid handler kind \"%s\" for %s (expected slice or schema=<symbol>)\n", kind, spec);
+                return 1;
+            }
+        }
+    }
+
+    aud_command_hash_t table;
+    if (!build_command_hash(entries, count, &table))
+    {
+        fprintf(stderr, "failed to build command table\n");
+        return 1;
+    }
+
+    printf("/* Generated by tools/gen_command_table.c - do not edit. */\n\n");
+    printf("static const uint16_t %s_displacements[%u] = {", prefix, table.bucket_count);
+    for (uint32_t b = 0; b < table.bucket_count; b++)
+    {
+        printf("%s%u", (b % 16 == 0) ? "\n    " : " ", table.displacements[b]);
+        if (b + 1 < table.bucket_count)
+        {
+            printf(",");
+        }
+    }
+    printf("\n};\n\n");
+
+    printf("static const aud_command_slot_t %s_slots[%u] = {\n", prefix, table.slot_mask + 1);
+    for (uint32_t s = 0; s <= table.slot_mask; s++)
+    {
+        const aud_command_slot_t *slot = &table.slots[s];
+        if (slot->command_name == NULL)
+        {
+            printf("    [%u] = AUD_COMMAND_SLOT_EMPTY,\n", s);        // Zero-filled slots would match the empty name
+            continue;
+        }
+        size_t index = 0;
+        while (entries[index].command_name != slot->command_name)
+        {
+            index++;
+        }
+        printf("    [%u] = { .command_name = \"%s\", .name_len = %u, .%s = %s", s, slot->command_name,
+               slot->name_len, slice[index] ? "slice_handler" : "handler", handlers[index]);
+        if (schemas[index] != NULL)
+        {
+            printf(", .schema = &%s", schemas[index]);
+        }
+        printf(" },\n");
+    }
+    printf("};\n\n");
+
+    printf("static const aud_command_hash_t %s_table = {\n", prefix);
+    printf("    .seed = %uu,\n", table.seed);
+    printf("    .slot_mask = %uu,\n", table.slot_mask);
+    printf("    .bucket_count = %uu,\n", table.bucket_count);
+    printf("    .displacements = %s_displacements,\n", prefix);
+    printf("    .slots = %s_slots,\n", prefix);
+    printf("};\n");
+
+    free_command_hash(&table);
+    free(entries);
+    free(handlers);
+    free(schemas);
+    free(slice);
+    return 0;
+}